@@ -0,0 +1,18 @@
+#ifndef __BENCH_RANDOM_H__
+#define __BENCH_RANDOM_H__
+
+#include "utils/consts.h"
+
+// small lcg shared by the benchmarks, fixed seeds keep the inputs identical
+// between runs so timings stay comparable
+static inline unsigned nextRandom(unsigned *s) {
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 8;
+}
+
+// [-range, range)
+static inline nml_t randomCoord(unsigned *s, nml_t range) {
+    return (nml_t)(nextRandom(s) % 65536) / 32768.0 * range - range;
+}
+
+#endif // !__BENCH_RANDOM_H__
@@ -0,0 +1,44 @@
+#ifndef __BENCH_TIMER_H__
+#define __BENCH_TIMER_H__
+
+#include <time.h>
+
+// monotonic wall clock in seconds
+static inline double benchSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * best of reps timed runs, the first run also warms caches and page tables.
+ * every pass through the loop body is timed, run.rep counts them from 0:
+ *
+ *     BenchBest run = benchBestOf(REPS);
+ *     while (benchNextRun(&run))
+ *         work();
+ *     return run.best;
+ */
+typedef struct BenchBest {
+    int rep, reps;
+    double best, t0;
+} BenchBest;
+
+static inline BenchBest benchBestOf(int reps) {
+    BenchBest run = {-1, reps, 1e30, 0.0};
+    return run;
+}
+
+// closes the run in flight and starts the next one, 0 once reps are done
+static inline int benchNextRun(BenchBest *run) {
+    if (run->rep >= 0) {
+        double t = benchSeconds() - run->t0;
+        run->best = t < run->best ? t : run->best;
+    }
+    if (++run->rep >= run->reps)
+        return 0;
+    run->t0 = benchSeconds();
+    return 1;
+}
+
+#endif // !__BENCH_TIMER_H__
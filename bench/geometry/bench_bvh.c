@@ -0,0 +1,170 @@
+#include "geometry/bvh.h"
+#include "utils/cpu.h"
+#include "utils/thread.h"
+#include "bench_random.h"
+#include "bench_timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPS 3
+// quads per side of the height field, 2 * GRID * GRID triangles (~1M)
+#define GRID 708
+#define RAYS (1u << 16)
+#define BRUTE_RAYS 16u
+#define BOXES 4096u
+
+static nml_t height(nml_t x, nml_t y, nml_t phase) {
+    return 4.0 * sin(0.05 * x + phase) * cos(0.07 * y) + sin(0.3 * x * y / GRID);
+}
+
+// a rolling height field over [0, GRID]^2, two triangles per quad
+static void heightField(nml_t phase, nml_t *c) {
+    size_t n = 2u * GRID * GRID, t = 0;
+    for (size_t j = 0; j < GRID; j++) {
+        for (size_t i = 0; i < GRID; i++) {
+            nml_t x0 = (nml_t)i, y0 = (nml_t)j;
+            nml_t quad[4][3] = {
+                {x0, y0, height(x0, y0, phase)},
+                {x0 + 1, y0, height(x0 + 1, y0, phase)},
+                {x0, y0 + 1, height(x0, y0 + 1, phase)},
+                {x0 + 1, y0 + 1, height(x0 + 1, y0 + 1, phase)},
+            };
+            int tris[2][3] = {{0, 1, 2}, {1, 3, 2}};
+            for (int k = 0; k < 2; k++, t++) {
+                for (int v = 0; v < 3; v++) {
+                    for (int a = 0; a < 3; a++)
+                        c[(3 * v + a) * n + t] = quad[tris[k][v]][a];
+                }
+            }
+        }
+    }
+}
+
+// rays down onto the field, 8 neighbours per packet
+static void makeRays(Ray *rays) {
+    unsigned s = 9;
+    for (uint32_t r = 0; r < RAYS; r += NML_RAY_PACKET) {
+        nml_t x = (nml_t)(nextRandom(&s) % (GRID - 8)) + 4.0;
+        nml_t y = (nml_t)(nextRandom(&s) % (GRID - 8)) + 4.0;
+        for (uint32_t k = 0; k < NML_RAY_PACKET; k++) {
+            Ray ray = {{{x + 0.3 * k, y + 0.1 * k, 20.0}},
+                       {{randomCoord(&s, 0.2), randomCoord(&s, 0.2), -1.0}},
+                       100.0};
+            rays[r + k] = ray;
+        }
+    }
+}
+
+static double timeBuild(const TriangleStream *tris, BVH *bvh) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        // the tree of the previous run is freed inside the timed region, a
+        // few frees next to a build of ~1M triangles
+        if (run.rep > 0)
+            bvhFree(bvh);
+        bvhBuildTriangles(tris, 0, bvh);
+    }
+    return run.best;
+}
+
+static volatile uint32_t sink;
+
+int main(void) {
+    size_t n = 2u * GRID * GRID;
+    nml_t *c = malloc(n * 9 * sizeof(nml_t));
+    nml_t *moved = malloc(n * 9 * sizeof(nml_t));
+    Ray *rays = malloc(RAYS * sizeof(Ray));
+    uint32_t *found = malloc(n * sizeof(uint32_t));
+    if (!c || !moved || !rays || !found) {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+    heightField(0.0, c);
+    heightField(0.5, moved);
+    TriangleStream tris = {{c, c + n, c + 2 * n, n},
+                           {c + 3 * n, c + 4 * n, c + 5 * n, n},
+                           {c + 6 * n, c + 7 * n, c + 8 * n, n}};
+    TriangleStream next = {{moved, moved + n, moved + 2 * n, n},
+                           {moved + 3 * n, moved + 4 * n, moved + 5 * n, n},
+                           {moved + 6 * n, moved + 7 * n, moved + 8 * n, n}};
+    makeRays(rays);
+
+    printf("bvh over %zu triangles (%s, %d threads)\n", n, cpuBackendName(),
+           threadCount());
+    BVH bvh;
+    int threads = threadCount();
+    threadSetCount(1);
+    double tSerial = timeBuild(&tris, &bvh);
+    bvhFree(&bvh);
+    threadSetCount(threads);
+    double tBuild = timeBuild(&tris, &bvh);
+    printf("%26s %10.1f ms  (%zu nodes, 1 thread %.1f ms)\n", "build",
+           tBuild * 1e3, bvh.nodeCount, tSerial * 1e3);
+
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        bvhRefitTriangles(&bvh, run.rep % 2 ? &tris : &next);
+    }
+    bvhRefitTriangles(&bvh, &tris);
+    printf("%26s %10.1f ms\n", "refit", run.best * 1e3);
+
+    // closest hit, one ray at a time, in packets, and without the tree
+    uint32_t acc = 0, hits = 0;
+    run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (uint32_t r = 0; r < RAYS; r++) {
+            RayHit hit;
+            bvhIntersectRay(&bvh, &rays[r], &hit);
+            acc += hit.index;
+            hits += hit.index != NML_RAY_MISS;
+        }
+    }
+    printf("%26s %10.4g rays/s  (%u of %u hit)\n", "ray", RAYS / run.best,
+           hits / REPS, RAYS);
+
+    run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (uint32_t r = 0; r < RAYS; r += NML_RAY_PACKET) {
+            RayPacket packet;
+            rayPacketInit(&rays[r], NML_RAY_PACKET, &packet);
+            bvhIntersectPacket(&bvh, &packet);
+            acc += packet.index[0];
+        }
+    }
+    printf("%26s %10.4g rays/s\n", "8 ray packet", RAYS / run.best);
+
+    double t0 = benchSeconds();
+    for (uint32_t r = 0; r < BRUTE_RAYS; r++) {
+        RayHit hit;
+        rayClosestTriangle(&rays[r], &tris, &hit);
+        acc += hit.index;
+    }
+    double tBrute = benchSeconds() - t0;
+    printf("%26s %10.4g rays/s\n", "brute force", BRUTE_RAYS / tBrute);
+
+    // boxes of a few units around random points of the field
+    unsigned s = 5;
+    size_t total = 0;
+    run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (uint32_t q = 0; q < BOXES; q++) {
+            nml_t x = (nml_t)(nextRandom(&s) % GRID);
+            nml_t y = (nml_t)(nextRandom(&s) % GRID);
+            AABB box = {{{x, y, -10.0}}, {{x + 4.0, y + 4.0, 10.0}}};
+            size_t count;
+            bvhQueryBox(&bvh, &box, found, n, &count);
+            total += count;
+        }
+    }
+    printf("%26s %10.4g queries/s  (%.1f triangles each)\n", "box query",
+           BOXES / run.best, (double)total / (REPS * BOXES));
+    sink = acc;
+
+    bvhFree(&bvh);
+    free(c);
+    free(moved);
+    free(rays);
+    free(found);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+#include "geometry/frustum.h"
+#include "utils/cpu.h"
+#include "bench_random.h"
+#include "bench_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPS 7
+#define COUNT (1u << 17)
+#define PASSES 32
+
+/*
+ * the per object loop the batch tests replace: six plane tests with an
+ * early out, appending visible indices as it goes
+ */
+
+static size_t scalarCullSpheres(const Frustum *fr, const Vec3Stream *c,
+                                const nml_t *r, uint32_t *indices) {
+    size_t visible = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        int in = 1;
+        for (int p = 0; p < 6 && in; p++) {
+            const nml_t *e = fr->planes[p].elems;
+            in = e[0] * c->x[i] + e[1] * c->y[i] + e[2] * c->z[i] + e[3] >=
+                 -r[i];
+        }
+        if (in)
+            indices[visible++] = (uint32_t)i;
+    }
+    return visible;
+}
+
+static size_t scalarCullBoxes(const Frustum *fr, const Vec3Stream *lo,
+                              const Vec3Stream *hi, uint32_t *indices) {
+    size_t visible = 0;
+    for (size_t i = 0; i < lo->count; i++) {
+        int in = 1;
+        for (int p = 0; p < 6 && in; p++) {
+            const nml_t *e = fr->planes[p].elems;
+            nml_t x = e[0] >= 0.0 ? hi->x[i] : lo->x[i];
+            nml_t y = e[1] >= 0.0 ? hi->y[i] : lo->y[i];
+            nml_t z = e[2] >= 0.0 ? hi->z[i] : lo->z[i];
+            in = e[0] * x + e[1] * y + e[2] * z + e[3] >= 0.0;
+        }
+        if (in)
+            indices[visible++] = (uint32_t)i;
+    }
+    return visible;
+}
+
+static volatile size_t sink;
+
+typedef enum { RUN_SCALAR, RUN_BITS, RUN_INDICES } Mode;
+
+static double bench(Mode mode, int boxes, const Frustum *fr,
+                    const Vec3Stream *a, const Vec3Stream *b, const nml_t *r,
+                    uint32_t *bits, uint32_t *indices) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        size_t visible = 0;
+        for (int p = 0; p < PASSES; p++) {
+            switch (mode) {
+            case RUN_SCALAR:
+                visible += boxes ? scalarCullBoxes(fr, a, b, indices)
+                                 : scalarCullSpheres(fr, a, r, indices);
+                break;
+            case RUN_BITS:
+                if (boxes)
+                    frustumTestBoxes(fr, a, b, bits);
+                else
+                    frustumTestSpheres(fr, a, r, bits);
+                visible += bits[0];
+                break;
+            case RUN_INDICES: {
+                size_t n = 0;
+                if (boxes)
+                    frustumCullBoxes(fr, a, b, indices, &n);
+                else
+                    frustumCullSpheres(fr, a, r, indices, &n);
+                visible += n;
+            } break;
+            }
+        }
+        sink = visible;
+    }
+    return run.best;
+}
+
+int main(void) {
+    nml_t *buf = malloc((size_t)COUNT * 7 * sizeof(nml_t));
+    uint32_t *bits = malloc((COUNT + 31) / 32 * sizeof(uint32_t));
+    uint32_t *indices = malloc(COUNT * sizeof(uint32_t));
+    if (!buf || !bits || !indices) {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+    nml_t *x = buf, *y = buf + COUNT, *z = buf + 2 * COUNT;
+    nml_t *r = buf + 3 * COUNT, *hx = buf + 4 * COUNT;
+    nml_t *hy = buf + 5 * COUNT, *hz = buf + 6 * COUNT;
+    // a scene around the camera, roughly a fifth of it in view, so the
+    // early out of the scalar loop takes its branch unpredictably
+    unsigned s = 1;
+    for (size_t i = 0; i < COUNT; i++) {
+        x[i] = (nml_t)(nextRandom(&s) % 4096) / 16.0 - 128.0;
+        y[i] = (nml_t)(nextRandom(&s) % 4096) / 64.0 - 32.0;
+        z[i] = (nml_t)(nextRandom(&s) % 4096) / 16.0 - 128.0;
+        r[i] = (nml_t)(nextRandom(&s) % 256) / 64.0;
+        hx[i] = x[i] + r[i];
+        hy[i] = y[i] + r[i];
+        hz[i] = z[i] + r[i];
+    }
+
+    // 90 degree perspective looking down -z, near 0.1, far 200
+    Mat4 vp;
+    Frustum fr;
+    nml_t n = 0.1, f = 200.0;
+    mat4InitZero(&vp);
+    vp.elems[0] = 1.0;
+    vp.elems[5] = 1.0;
+    vp.elems[10] = (f + n) / (n - f);
+    vp.elems[11] = -1.0;
+    vp.elems[14] = 2.0 * f * n / (n - f);
+    frustumFromMat4(&vp, 0, &fr);
+
+    Vec3Stream centers = {x, y, z, COUNT}, maxs = {hx, hy, hz, COUNT};
+    size_t visible = 0;
+    frustumCullSpheres(&fr, &centers, r, indices, &visible);
+
+    const double objs = (double)COUNT * PASSES;
+    printf("frustum culling of %u objects, %zu spheres visible (%s)\n", COUNT,
+           visible, cpuBackendName());
+    printf("%8s %16s %16s %16s %9s\n", "bounds", "scalar obj/s", "bits obj/s",
+           "indices obj/s", "speedup");
+    for (int boxes = 0; boxes <= 1; boxes++) {
+        double tScalar = bench(RUN_SCALAR, boxes, &fr, &centers, &maxs, r,
+                               bits, indices);
+        double tBits = bench(RUN_BITS, boxes, &fr, &centers, &maxs, r, bits,
+                             indices);
+        double tIdx = bench(RUN_INDICES, boxes, &fr, &centers, &maxs, r, bits,
+                            indices);
+        printf("%8s %16.4g %16.4g %16.4g %8.2fx\n",
+               boxes ? "boxes" : "spheres", objs / tScalar, objs / tBits,
+               objs / tIdx, tScalar / tIdx);
+    }
+
+    free(buf);
+    free(bits);
+    free(indices);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+#include "geometry/ray.h"
+#include "utils/cpu.h"
+#include "vector/vec3d.h"
+#include "bench_random.h"
+#include "bench_timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPS 5
+#define RAYS 1024u
+#define TRIS 4096u
+
+/*
+ * closest hit the way callers wrote it before the kernels: moller-trumbore
+ * out of the vec3 api calls, one triangle at a time
+ */
+static uint32_t scalarClosest(Ray *ray, Vec3 *v0, Vec3 *v1, Vec3 *v2) {
+    uint32_t best = NML_RAY_MISS;
+    nml_t tBest = ray->tMax;
+    for (uint32_t i = 0; i < TRIS; i++) {
+        Vec3 e1, e2, p, s, q;
+        vec3Sub(&v1[i], &v0[i], &e1);
+        vec3Sub(&v2[i], &v0[i], &e2);
+        vec3Cross(&ray->dir, &e2, &p);
+        nml_t det = vec3Dot(&e1, &p);
+        if (fabs(det) < 1e-12)
+            continue;
+        nml_t inv = 1.0 / det;
+        vec3Sub(&ray->origin, &v0[i], &s);
+        nml_t u = vec3Dot(&s, &p) * inv;
+        if (u < 0.0 || u > 1.0)
+            continue;
+        vec3Cross(&s, &e1, &q);
+        nml_t v = vec3Dot(&ray->dir, &q) * inv;
+        if (v < 0.0 || u + v > 1.0)
+            continue;
+        nml_t t = vec3Dot(&e2, &q) * inv;
+        if (t >= 0.0 && t < tBest) {
+            tBest = t;
+            best = i;
+        }
+    }
+    return best;
+}
+
+static volatile uint32_t sink;
+
+typedef enum { RUN_SCALAR, RUN_STREAM, RUN_PACKET, RUN_BOXES } Mode;
+
+typedef struct Scene {
+    Ray *rays;
+    Vec3 *v0, *v1, *v2;
+    TriangleStream tris;
+    Vec3Stream mins, maxs;
+    nml_t *t;
+    uint32_t *bits;
+} Scene;
+
+static double bench(Mode mode, Scene *sc) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        uint32_t acc = 0;
+        switch (mode) {
+        case RUN_SCALAR:
+            for (uint32_t r = 0; r < RAYS; r++)
+                acc += scalarClosest(&sc->rays[r], sc->v0, sc->v1, sc->v2);
+            break;
+        case RUN_STREAM:
+            for (uint32_t r = 0; r < RAYS; r++) {
+                RayHit hit;
+                rayClosestTriangle(&sc->rays[r], &sc->tris, &hit);
+                acc += hit.index;
+            }
+            break;
+        case RUN_PACKET:
+            for (uint32_t r = 0; r < RAYS; r += NML_RAY_PACKET) {
+                RayPacket packet;
+                rayPacketInit(&sc->rays[r], NML_RAY_PACKET, &packet);
+                for (uint32_t i = 0; i < TRIS; i++) {
+                    rayPacketIntersectTriangle(&packet, &sc->v0[i],
+                                               &sc->v1[i], &sc->v2[i], i,
+                                               NULL);
+                }
+                acc += packet.index[0];
+            }
+            break;
+        case RUN_BOXES:
+            for (uint32_t r = 0; r < RAYS; r++) {
+                rayTestBoxes(&sc->rays[r], &sc->mins, &sc->maxs, sc->t,
+                             sc->bits);
+                acc += sc->bits[0];
+            }
+            break;
+        }
+        sink = acc;
+    }
+    return run.best;
+}
+
+int main(void) {
+    Scene sc;
+    nml_t *buf = malloc((size_t)TRIS * 15 * sizeof(nml_t));
+    sc.rays = malloc(RAYS * sizeof(Ray));
+    sc.v0 = malloc(TRIS * sizeof(Vec3));
+    sc.v1 = malloc(TRIS * sizeof(Vec3));
+    sc.v2 = malloc(TRIS * sizeof(Vec3));
+    sc.t = malloc(TRIS * sizeof(nml_t));
+    sc.bits = malloc((TRIS + 31) / 32 * sizeof(uint32_t));
+    if (!buf || !sc.rays || !sc.v0 || !sc.v1 || !sc.v2 || !sc.t || !sc.bits) {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+    nml_t *c[15];
+    for (int k = 0; k < 15; k++)
+        c[k] = buf + (size_t)k * TRIS;
+
+    // small triangles scattered through a box, rays from one side of it
+    unsigned s = 3;
+    for (uint32_t i = 0; i < TRIS; i++) {
+        Vec3 center = {{randomCoord(&s, 50.0), randomCoord(&s, 50.0),
+                        randomCoord(&s, 50.0)}};
+        Vec3 *v[3] = {&sc.v0[i], &sc.v1[i], &sc.v2[i]};
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 3; k++) {
+                v[j]->elems[k] = center.elems[k] + randomCoord(&s, 2.0);
+                c[3 * j + k][i] = v[j]->elems[k];
+            }
+        }
+        for (int k = 0; k < 3; k++) {
+            nml_t a = c[k][i], b = c[3 + k][i], d = c[6 + k][i];
+            nml_t lo = a < b ? a : b, hi = a < b ? b : a;
+            c[9 + k][i] = lo < d ? lo : d;
+            c[12 + k][i] = hi > d ? hi : d;
+        }
+    }
+    for (uint32_t r = 0; r < RAYS; r++) {
+        Ray ray = {{{randomCoord(&s, 50.0), randomCoord(&s, 50.0), -60.0}},
+                   {{randomCoord(&s, 0.3), randomCoord(&s, 0.3), 1.0}},
+                   200.0};
+        sc.rays[r] = ray;
+    }
+    sc.tris = (TriangleStream){{c[0], c[1], c[2], TRIS},
+                               {c[3], c[4], c[5], TRIS},
+                               {c[6], c[7], c[8], TRIS}};
+    sc.mins = (Vec3Stream){c[9], c[10], c[11], TRIS};
+    sc.maxs = (Vec3Stream){c[12], c[13], c[14], TRIS};
+
+    const double tests = (double)RAYS * TRIS;
+    printf("%u rays against %u primitives, brute force (%s)\n", RAYS, TRIS,
+           cpuBackendName());
+    printf("%22s %14s %14s %9s\n", "kernel", "rays/s", "tests/s", "speedup");
+    double tScalar = bench(RUN_SCALAR, &sc);
+    const char *names[] = {"vec3 api triangles", "1 ray x N triangles",
+                           "8 rays x 1 triangle", "1 ray x N boxes"};
+    for (Mode m = RUN_SCALAR; m <= RUN_BOXES; m++) {
+        double t = m == RUN_SCALAR ? tScalar : bench(m, &sc);
+        printf("%22s %14.4g %14.4g %8.2fx\n", names[m], RAYS / t, tests / t,
+               tScalar / t);
+    }
+
+    free(buf);
+    free(sc.rays);
+    free(sc.v0);
+    free(sc.v1);
+    free(sc.v2);
+    free(sc.t);
+    free(sc.bits);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+#include "matrix/mat3d.h"
+#include "utils/cpu.h"
+#include "bench_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPS 7
+#define COUNT (1u << 16)
+#define PASSES 32
+
+/*
+ * the scalar mat3 code the simd kernels replaced. both sides are called
+ * through a function table so the call overhead is the same and only the
+ * bodies are compared
+ */
+
+static int scalarMulVec3(Mat3 *mat, Vec3 *vec, Vec3 *vOut) {
+    vOut->x = mat->cols[0].x * vec->x + mat->cols[1].x * vec->y +
+              mat->cols[2].x * vec->z;
+    vOut->y = mat->cols[0].y * vec->x + mat->cols[1].y * vec->y +
+              mat->cols[2].y * vec->z;
+    vOut->z = mat->cols[0].z * vec->x + mat->cols[1].z * vec->y +
+              mat->cols[2].z * vec->z;
+    return 0;
+}
+
+static int scalarMul(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut) {
+    scalarMulVec3(mat1, &mat2->cols[0], &mOut->cols[0]);
+    scalarMulVec3(mat1, &mat2->cols[1], &mOut->cols[1]);
+    scalarMulVec3(mat1, &mat2->cols[2], &mOut->cols[2]);
+    return 0;
+}
+
+static int scalarAdd(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut) {
+    for (int i = 0; i < 9; i++) {
+        mOut->elems[i] = mat1->elems[i] + mat2->elems[i];
+    }
+    return 0;
+}
+
+static int scalarScale(Mat3 *mat, nml_t s, Mat3 *mOut) {
+    for (int i = 0; i < 9; i++) {
+        mOut->elems[i] = mat->elems[i] * s;
+    }
+    return 0;
+}
+
+static int scalarTranspose(Mat3 *mat, Mat3 *mOut) {
+    nml_t *e = mOut->elems;
+    if (mat != mOut)
+        *mOut = *mat;
+    for (int c = 0; c < 3; c++) {
+        for (int r = c + 1; r < 3; r++) {
+            nml_t t = e[c * 3 + r];
+            e[c * 3 + r] = e[r * 3 + c];
+            e[r * 3 + c] = t;
+        }
+    }
+    return 0;
+}
+
+typedef struct Mat3Impl {
+    int (*mul)(Mat3 *, Mat3 *, Mat3 *);
+    int (*mulVec3)(Mat3 *, Vec3 *, Vec3 *);
+    int (*add)(Mat3 *, Mat3 *, Mat3 *);
+    int (*scale)(Mat3 *, nml_t, Mat3 *);
+    int (*transpose)(Mat3 *, Mat3 *);
+} Mat3Impl;
+
+static const Mat3Impl scalarImpl = {scalarMul, scalarMulVec3, scalarAdd,
+                                    scalarScale, scalarTranspose};
+static const Mat3Impl simdImpl = {mat3MulMat3, mat3MulVec3, mat3Add, mat3Scale,
+                                  mat3Transpose};
+
+typedef enum { OP_MUL, OP_MUL_VEC3, OP_ADD, OP_SCALE, OP_TRANSPOSE } Op;
+
+static const char *opNames[] = {"mul", "mulVec3", "add", "scale", "transpose"};
+
+static void runOnce(Op op, const Mat3Impl *impl, Mat3 *a, Mat3 *b, Mat3 *out,
+                    Vec3 *vecs) {
+    for (size_t i = 0; i < COUNT; i++) {
+        switch (op) {
+        case OP_MUL:
+            impl->mul(&a[i], &b[i], &out[i]);
+            break;
+        case OP_MUL_VEC3:
+            impl->mulVec3(&a[i], &vecs[i], &out[i].cols[0]);
+            break;
+        case OP_ADD:
+            impl->add(&a[i], &b[i], &out[i]);
+            break;
+        case OP_SCALE:
+            impl->scale(&a[i], 0.5, &out[i]);
+            break;
+        case OP_TRANSPOSE:
+            impl->transpose(&a[i], &out[i]);
+            break;
+        }
+    }
+}
+
+static double bench(Op op, const Mat3Impl *impl, Mat3 *a, Mat3 *b, Mat3 *out,
+                    Vec3 *vecs) {
+    // read back through a volatile so the table can not be devirtualized
+    const Mat3Impl *volatile table = impl;
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (int p = 0; p < PASSES; p++) {
+            runOnce(op, table, a, b, out, vecs);
+        }
+    }
+    return run.best;
+}
+
+int main(void) {
+    Mat3 *a = malloc(COUNT * sizeof(Mat3));
+    Mat3 *b = malloc(COUNT * sizeof(Mat3));
+    Mat3 *out = malloc(COUNT * sizeof(Mat3));
+    Vec3 *vecs = malloc(COUNT * sizeof(Vec3));
+    if (!a || !b || !out || !vecs) {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < COUNT; i++) {
+        for (int k = 0; k < 9; k++) {
+            a[i].elems[k] = (nml_t)((i + k) % 11) * 0.25;
+            b[i].elems[k] = (nml_t)((i * 3 + k) % 7) * 0.5;
+        }
+        vec3Init((nml_t)(i % 5), 1.0, 2.0, &vecs[i]);
+    }
+
+    const double ops = (double)COUNT * PASSES;
+    printf("mat3 ops over %u matrices (%s)\n", COUNT, cpuBackendName());
+    printf("%10s %18s %18s %8s\n", "op", "scalar op/s", "simd op/s", "speedup");
+    for (Op op = OP_MUL; op <= OP_TRANSPOSE; op++) {
+        double t_scalar = bench(op, &scalarImpl, a, b, out, vecs);
+        double t_simd = bench(op, &simdImpl, a, b, out, vecs);
+        printf("%10s %18.4g %18.4g %7.2fx\n", opNames[op], ops / t_scalar,
+               ops / t_simd, t_scalar / t_simd);
+    }
+
+    free(a);
+    free(b);
+    free(out);
+    free(vecs);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+#include "matrix/mat4d.h"
+#include "utils/cpu.h"
+#include "bench_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPS 5
+
+static double benchPerCall(Mat4 *m, Vec4 *in, Vec4 *out, size_t n) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (size_t i = 0; i < n; i++) {
+            mat4MulVec4(m, &in[i], &out[i]);
+        }
+    }
+    return run.best;
+}
+
+static double benchBatch(Mat4 *m, Vec4 *in, Vec4 *out, size_t n) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        mat4MulVec4Batch(m, in, out, n);
+    }
+    return run.best;
+}
+
+int main(void) {
+    const size_t sizes[] = {1024, 65536, 1u << 20, 5u << 20};
+    const size_t max_n = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+    Vec4 *in = malloc(max_n * sizeof(Vec4));
+    Vec4 *out = malloc(max_n * sizeof(Vec4));
+    if (!in || !out) {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < max_n; i++) {
+        vec4Init((nml_t)i, (nml_t)(i >> 1), (nml_t)(i >> 2), 1.0, &in[i]);
+    }
+
+    Mat4 m;
+    mat4Diagonal(2.0, &m);
+    m.cols[3].x = 1.0;
+    m.cols[3].y = 2.0;
+    m.cols[3].z = 3.0;
+
+    printf("mat4MulVec4 (%s)\n", cpuBackendName());
+    printf("%10s %18s %18s %8s\n", "vectors", "per-call vec/s", "batch vec/s",
+           "speedup");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        double t_call = benchPerCall(&m, in, out, n);
+        double t_batch = benchBatch(&m, in, out, n);
+        printf("%10zu %18.4g %18.4g %7.2fx\n", n, n / t_call, n / t_batch,
+               t_call / t_batch);
+    }
+
+    free(in);
+    free(out);
+    return EXIT_SUCCESS;
+}
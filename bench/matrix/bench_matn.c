@@ -0,0 +1,122 @@
+#include "matrix/matn.h"
+#include "utils/cpu.h"
+#include "utils/thread.h"
+#include "bench_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// the naive loop gets a single run from NAIVE_SINGLE_RUN up, it takes seconds
+#define REPS 5
+#define NAIVE_SINGLE_RUN 512
+#define SCALING_SIZE 2048
+
+static void fill(MatN *mat, unsigned seed) {
+    unsigned s = seed * 2654435761u + 1;
+    for (size_t j = 0; j < mat->cols; j++) {
+        for (size_t i = 0; i < mat->rows; i++) {
+            s = s * 1103515245u + 12345u;
+            MATN_AT(mat, i, j) = (nml_t)((s >> 8) % 2048) / 1024.0 - 1.0;
+        }
+    }
+}
+
+// textbook triple loop, one dot product per element of c
+static int naiveMul(const MatN *a, const MatN *b, MatN *c) {
+    for (size_t i = 0; i < c->rows; i++) {
+        for (size_t j = 0; j < c->cols; j++) {
+            nml_t sum = 0.0;
+            for (size_t p = 0; p < a->cols; p++) {
+                sum += MATN_AT(a, i, p) * MATN_AT(b, p, j);
+            }
+            MATN_AT(c, i, j) = sum;
+        }
+    }
+    return 0;
+}
+
+typedef int (*MulFn)(const MatN *, const MatN *, MatN *);
+
+static double bench(MulFn fn, int reps, const MatN *a, const MatN *b, MatN *c) {
+    BenchBest run = benchBestOf(reps);
+    while (benchNextRun(&run)) {
+        fn(a, b, c);
+    }
+    return run.best;
+}
+
+// strong scaling: one fixed problem on 1, 2, 4 ... maxThreads threads
+static int benchScaling(int maxThreads) {
+    size_t n = SCALING_SIZE;
+    MatN a, b, c;
+    if (matNInit(n, n, &a) || matNInit(n, n, &b) || matNInit(n, n, &c)) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+    fill(&a, 1);
+    fill(&b, 2);
+
+    printf("\nstrong scaling, n = %zu\n", n);
+    printf("%8s %10s %10s %11s\n", "threads", "GF/s", "speedup", "efficiency");
+    double flops = 2.0 * n * n * n;
+    double single = 0.0;
+    for (int t = 1;; t = t * 2 < maxThreads ? t * 2 : maxThreads) {
+        threadSetCount(t);
+        double time = bench(matNMul, REPS, &a, &b, &c);
+        if (t == 1)
+            single = time;
+        printf("%8d %10.2f %9.2fx %10.0f%%\n", t, flops / time / 1e9,
+               single / time, single / time / t * 100.0);
+        if (t == maxThreads)
+            break;
+    }
+
+    matNFree(&a);
+    matNFree(&b);
+    matNFree(&c);
+    return 0;
+}
+
+// usage: bench_matn [max threads], defaults to the pool size
+int main(int argc, char **argv) {
+    int maxThreads = argc > 1 ? atoi(argv[1]) : threadCount();
+    maxThreads = maxThreads < 1 ? 1 : maxThreads;
+
+    // the first table is single threaded, the naive loop has no pool
+    threadSetCount(1);
+
+    // called through volatile pointers so neither side is inlined into main
+    MulFn volatile naive = naiveMul;
+    MulFn volatile blocked = matNMul;
+    size_t sizes[] = {64, 128, 256, 512, 1024, 2048};
+
+    printf("matn gemm, square matrices, %s build, backend %s\n",
+           sizeof(nml_t) == 8 ? "double" : "float", cpuBackendName());
+    printf("%6s %12s %12s %10s\n", "n", "naive GF/s", "blocked GF/s",
+           "speedup");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        MatN a, b, c;
+        if (matNInit(n, n, &a) || matNInit(n, n, &b) || matNInit(n, n, &c)) {
+            fprintf(stderr, "allocation failed\n");
+            return 1;
+        }
+        fill(&a, 1);
+        fill(&b, 2);
+
+        double flops = 2.0 * n * n * n;
+        double tb = bench(blocked, REPS, &a, &b, &c);
+        if (n <= 1024) {
+            double tn = bench(naive, n < NAIVE_SINGLE_RUN ? REPS : 1, &a, &b, &c);
+            printf("%6zu %12.2f %12.2f %9.2fx\n", n, flops / tn / 1e9,
+                   flops / tb / 1e9, tn / tb);
+        } else {
+            printf("%6zu %12s %12.2f %10s\n", n, "-", flops / tb / 1e9, "-");
+        }
+
+        matNFree(&a);
+        matNFree(&b);
+        matNFree(&c);
+    }
+    return benchScaling(maxThreads);
+}
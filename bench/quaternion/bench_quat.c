@@ -0,0 +1,120 @@
+#include "quaternion/quat.h"
+#include "utils/cpu.h"
+#include "bench_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPS 5
+
+typedef int (*LerpFn)(Quat *, Quat *, nml_t, Quat *);
+typedef int (*LerpBatchFn)(const Quat *, const Quat *, nml_t, Quat *, size_t);
+
+static double benchLerpPerCall(LerpFn fn, Quat *a, Quat *b, Quat *out,
+                               size_t n) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (size_t i = 0; i < n; i++) {
+            fn(&a[i], &b[i], 0.3, &out[i]);
+        }
+    }
+    return run.best;
+}
+
+static double benchLerpBatch(LerpBatchFn fn, Quat *a, Quat *b, Quat *out,
+                             size_t n) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        fn(a, b, 0.3, out, n);
+    }
+    return run.best;
+}
+
+static double benchToMat4PerCall(Quat *q, Mat4 *m, size_t n) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (size_t i = 0; i < n; i++) {
+            quatToMat4(&q[i], &m[i]);
+        }
+    }
+    return run.best;
+}
+
+static double benchToMat4Batch(Quat *q, Mat4 *m, size_t n) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        quatToMat4Batch(q, m, n);
+    }
+    return run.best;
+}
+
+static double benchRotatePerCall(Quat *q, Vec3 *in, Vec3 *out, size_t n) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (size_t i = 0; i < n; i++) {
+            quatRotateVec3(q, &in[i], &out[i]);
+        }
+    }
+    return run.best;
+}
+
+static double benchRotateBatch(Quat *q, Vec3 *in, Vec3 *out, size_t n) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        quatRotateVec3Batch(q, in, out, n);
+    }
+    return run.best;
+}
+
+static void row(const char *name, size_t n, double tCall, double tBatch) {
+    printf("%-14s %10zu %16.4g %16.4g %7.2fx\n", name, n, n / tCall,
+           n / tBatch, tCall / tBatch);
+}
+
+int main(void) {
+    const size_t sizes[] = {1024, 65536, 1u << 20};
+    const size_t maxN = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+    Quat *a = malloc(maxN * sizeof(Quat));
+    Quat *b = malloc(maxN * sizeof(Quat));
+    Quat *q = malloc(maxN * sizeof(Quat));
+    Mat4 *m = malloc(maxN * sizeof(Mat4));
+    Vec3 *in = malloc(maxN * sizeof(Vec3));
+    Vec3 *out = malloc(maxN * sizeof(Vec3));
+    if (!a || !b || !q || !m || !in || !out) {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+    // a spread of angles between the pairs so both slerp paths are taken
+    for (size_t i = 0; i < maxN; i++) {
+        Vec3 axisA = {{1.0, (nml_t)(i % 7), 0.5}};
+        Vec3 axisB = {{-0.5, 1.0, (nml_t)(i % 5)}};
+        quatFromAxisAngle(&axisA, 0.001 * (nml_t)(i % 3000), &a[i]);
+        quatFromAxisAngle(&axisB, 0.002 * (nml_t)(i % 1500), &b[i]);
+        vec3Init((nml_t)i, (nml_t)(i >> 1), (nml_t)(i >> 2), &in[i]);
+    }
+    LerpFn volatile slerp = quatSlerp;
+    LerpFn volatile nlerp = quatNlerp;
+
+    printf("quaternion batches (%s)\n", cpuBackendName());
+    printf("%-14s %10s %16s %16s %8s\n", "function", "count", "per-call /s",
+           "batch /s", "speedup");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        row("slerp", n, benchLerpPerCall(slerp, a, b, q, n),
+            benchLerpBatch(quatSlerpBatch, a, b, q, n));
+        row("nlerp", n, benchLerpPerCall(nlerp, a, b, q, n),
+            benchLerpBatch(quatNlerpBatch, a, b, q, n));
+        row("toMat4", n, benchToMat4PerCall(a, m, n),
+            benchToMat4Batch(a, m, n));
+        row("rotateVec3", n, benchRotatePerCall(&b[7], in, out, n),
+            benchRotateBatch(&b[7], in, out, n));
+    }
+
+    free(a);
+    free(b);
+    free(q);
+    free(m);
+    free(in);
+    free(out);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,229 @@
+#include "sparse/sparse.h"
+#include "utils/cpu.h"
+#include "utils/thread.h"
+#include "bench_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPS 7
+#define RHS 8
+
+/*
+ * synthetic meshes: graph laplacians of regular grids, one row per vertex
+ * with the degree on the diagonal and -1 per neighbour
+ */
+
+typedef struct Triplets {
+    uint32_t *r, *c;
+    nml_t *v;
+    size_t n;
+} Triplets;
+
+static void push(Triplets *t, size_t r, size_t c, nml_t v) {
+    t->r[t->n] = (uint32_t)r;
+    t->c[t->n] = (uint32_t)c;
+    t->v[t->n] = v;
+    t->n++;
+}
+
+// nx x ny x nz grid, nz = 1 gives the 5 point stencil, otherwise 7 point
+static int gridLaplacian(size_t nx, size_t ny, size_t nz, SparseCSR *out) {
+    size_t vertices = nx * ny * nz, cap = vertices * 7;
+    Triplets t = {malloc(cap * sizeof(uint32_t)), malloc(cap * sizeof(uint32_t)),
+                  malloc(cap * sizeof(nml_t)), 0};
+    if (!t.r || !t.c || !t.v)
+        return 1;
+
+    for (size_t z = 0; z < nz; z++) {
+        for (size_t y = 0; y < ny; y++) {
+            for (size_t x = 0; x < nx; x++) {
+                size_t i = (z * ny + y) * nx + x;
+                size_t degree = 0;
+                size_t neighbours[6];
+                if (x > 0)
+                    neighbours[degree++] = i - 1;
+                if (x + 1 < nx)
+                    neighbours[degree++] = i + 1;
+                if (y > 0)
+                    neighbours[degree++] = i - nx;
+                if (y + 1 < ny)
+                    neighbours[degree++] = i + nx;
+                if (z > 0)
+                    neighbours[degree++] = i - nx * ny;
+                if (z + 1 < nz)
+                    neighbours[degree++] = i + nx * ny;
+                push(&t, i, i, (nml_t)degree);
+                for (size_t k = 0; k < degree; k++) {
+                    push(&t, i, neighbours[k], -1.0);
+                }
+            }
+        }
+    }
+
+    int err = sparseCSRFromCOO(vertices, vertices, t.r, t.c, t.v, t.n, out);
+    free(t.r);
+    free(t.c);
+    free(t.v);
+    return err;
+}
+
+// n x n with perRow nonzeros per row at random columns, nothing a cache
+// line of x or of the dense block brings in is used twice in a row
+static int scatteredMatrix(size_t n, size_t perRow, SparseCSR *out) {
+    size_t cap = n * perRow;
+    Triplets t = {malloc(cap * sizeof(uint32_t)), malloc(cap * sizeof(uint32_t)),
+                  malloc(cap * sizeof(nml_t)), 0};
+    if (!t.r || !t.c || !t.v)
+        return 1;
+
+    unsigned s = 1;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t k = 0; k < perRow; k++) {
+            s = s * 1103515245u + 12345u;
+            push(&t, i, (s >> 4) % n, (nml_t)(k + 1) * 0.125);
+        }
+    }
+
+    int err = sparseCSRFromCOO(n, n, t.r, t.c, t.v, t.n, out);
+    free(t.r);
+    free(t.c);
+    free(t.v);
+    return err;
+}
+
+// the textbook loop, one running sum per row
+static int naiveMulVec(const SparseCSR *mat, const nml_t *x, nml_t *y) {
+    for (size_t i = 0; i < mat->rows; i++) {
+        nml_t sum = 0.0;
+        for (size_t p = mat->rowPtr[i]; p < mat->rowPtr[i + 1]; p++) {
+            sum += mat->values[p] * x[mat->colIdx[p]];
+        }
+        y[i] = sum;
+    }
+    return 0;
+}
+
+typedef int (*MulVecFn)(const SparseCSR *, const nml_t *, nml_t *);
+
+static double benchMulVec(MulVecFn fn, const SparseCSR *mat, const nml_t *x,
+                          nml_t *y) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        fn(mat, x, y);
+    }
+    return run.best;
+}
+
+static double benchCSC(const SparseCSC *mat, const nml_t *x, nml_t *y) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        sparseCSCMulVec(mat, x, y);
+    }
+    return run.best;
+}
+
+// the block one column at a time through the textbook loop
+static double benchNaiveMulMatN(const SparseCSR *mat, const MatN *b, MatN *c) {
+    MulVecFn volatile naive = naiveMulVec;
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (size_t j = 0; j < b->cols; j++) {
+            naive(mat, &MATN_AT(b, 0, j), &MATN_AT(c, 0, j));
+        }
+    }
+    return run.best;
+}
+
+static double benchMulMatN(const SparseCSR *mat, const MatN *b, MatN *c) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        sparseCSRMulMatN(mat, b, c);
+    }
+    return run.best;
+}
+
+static void row(const char *name, double seconds, double flops) {
+    printf("  %-28s %9.3f ms %8.2f GF/s\n", name, seconds * 1e3,
+           flops / seconds / 1e9);
+}
+
+// takes ownership of csr
+static int benchMatrix(const char *name, SparseCSR csr, int threads) {
+    SparseCSC csc;
+    if (sparseCSRToCSC(&csr, &csc)) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+    size_t n = csr.rows;
+    nml_t *x = malloc(n * sizeof(nml_t));
+    nml_t *y = malloc(n * sizeof(nml_t));
+    MatN b, c;
+    if (!x || !y || matNInit(n, RHS, &b) || matNInit(n, RHS, &c)) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        x[i] = (nml_t)(i % 17) * 0.125;
+        for (size_t j = 0; j < RHS; j++) {
+            MATN_AT(&b, i, j) = x[i] + (nml_t)j;
+        }
+    }
+
+    printf("%s: %zu rows, %zu nonzeros\n", name, n, csr.nnz);
+    double flops = 2.0 * csr.nnz;
+    MulVecFn volatile naive = naiveMulVec;
+    MulVecFn volatile kernel = sparseCSRMulVec;
+
+    threadSetCount(1);
+    row("csr naive loop", benchMulVec(naive, &csr, x, y), flops);
+    row("csr spmv, 1 thread", benchMulVec(kernel, &csr, x, y), flops);
+    row("csc spmv, 1 thread", benchCSC(&csc, x, y), flops);
+    row("csr spmm x8, column loop", benchNaiveMulMatN(&csr, &b, &c),
+        flops * RHS);
+    row("csr spmm x8, 1 thread", benchMulMatN(&csr, &b, &c), flops * RHS);
+    if (threads > 1) {
+        char label[64];
+        threadSetCount(threads);
+        snprintf(label, sizeof(label), "csr spmv, %d threads", threads);
+        row(label, benchMulVec(kernel, &csr, x, y), flops);
+        snprintf(label, sizeof(label), "csc spmv, %d threads", threads);
+        row(label, benchCSC(&csc, x, y), flops);
+        snprintf(label, sizeof(label), "csr spmm x8, %d threads", threads);
+        row(label, benchMulMatN(&csr, &b, &c), flops * RHS);
+    }
+
+    free(x);
+    free(y);
+    matNFree(&b);
+    matNFree(&c);
+    sparseCSRFree(&csr);
+    sparseCSCFree(&csc);
+    return 0;
+}
+
+static int benchMesh(const char *name, size_t nx, size_t ny, size_t nz,
+                     int threads) {
+    SparseCSR csr;
+    if (gridLaplacian(nx, ny, nz, &csr)) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+    return benchMatrix(name, csr, threads);
+}
+
+// usage: bench_sparse [threads], defaults to the pool size
+int main(int argc, char **argv) {
+    int threads = argc > 1 ? atoi(argv[1]) : threadCount();
+    printf("sparse products, %s build, backend %s\n",
+           sizeof(nml_t) == 8 ? "double" : "float", cpuBackendName());
+    if (benchMesh("2d grid 1024^2, 5 point", 1024, 1024, 1, threads))
+        return 1;
+    if (benchMesh("3d grid 100^3, 7 point", 100, 100, 100, threads))
+        return 1;
+    SparseCSR scattered;
+    if (scatteredMatrix(200000, 16, &scattered)) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+    return benchMatrix("scattered 200k rows, 16 per row", scattered, threads);
+}
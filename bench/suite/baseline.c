@@ -0,0 +1,185 @@
+#include "suite.h"
+#include "utils/errors.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * reads back the json written by numen_bench --json. not a general json
+ * parser, it relies on the layout writeJson produces: flat result objects
+ * without nested braces and keys that appear once per object
+ */
+
+// start of the value of key in [obj, the next nul), NULL when it's missing
+static const char *findValue(const char *obj, const char *key) {
+    char pattern[40];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+    const char *at = strstr(obj, pattern);
+    if (!at)
+        return NULL;
+    at += strlen(pattern);
+    while (*at == ' ' || *at == '\t' || *at == '\n' || *at == '\r')
+        at++;
+    if (*at != ':')
+        return NULL;
+    at++;
+    while (*at == ' ' || *at == '\t' || *at == '\n' || *at == '\r')
+        at++;
+    return at;
+}
+
+static int readString(const char *obj,
+                      const char *key,
+                      char *out,
+                      size_t size) {
+    const char *at = findValue(obj, key);
+    if (!at || *at != '"')
+        return NML_EINVAL;
+    at++;
+    size_t len = 0;
+    while (at[len] && at[len] != '"')
+        len++;
+    if (at[len] != '"' || len >= size)
+        return NML_EINVAL;
+    memcpy(out, at, len);
+    out[len] = '\0';
+    return NML_SUCCESS;
+}
+
+static int readNumber(const char *obj, const char *key, double *out) {
+    const char *at = findValue(obj, key);
+    if (!at)
+        return NML_EINVAL;
+    char *end;
+    *out = strtod(at, &end);
+    return end == at ? NML_EINVAL : NML_SUCCESS;
+}
+
+static char *readFile(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return NULL;
+    char *text = NULL;
+    long size;
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) >= 0 &&
+        fseek(f, 0, SEEK_SET) == 0 && (text = malloc((size_t)size + 1))) {
+        if (fread(text, 1, (size_t)size, f) == (size_t)size) {
+            text[size] = '\0';
+        } else {
+            free(text);
+            text = NULL;
+        }
+    }
+    fclose(f);
+    return text;
+}
+
+static int parseBaseline(char *text, BenchBaseline *baseline) {
+    char *results = strstr(text, "\"results\"");
+    if (!results)
+        return NML_EINVAL;
+    // the header fields come before the results
+    *results = '\0';
+    double reps;
+    if (readNumber(text, "repetitions", &reps) != NML_SUCCESS || reps < 1 ||
+        readString(text, "backend", baseline->backend,
+                   sizeof(baseline->backend)) != NML_SUCCESS ||
+        readString(text, "scalar", baseline->scalar,
+                   sizeof(baseline->scalar)) != NML_SUCCESS)
+        return NML_EINVAL;
+    baseline->reps = (size_t)reps;
+    results++;
+
+    size_t capacity = 0;
+    for (const char *c = results; *c; c++)
+        capacity += *c == '{';
+    baseline->entries = calloc(capacity ? capacity : 1,
+                               sizeof(BenchBaselineEntry));
+    if (!baseline->entries)
+        return NML_ENOMEM;
+
+    char *obj = strchr(results, '{');
+    while (obj) {
+        char *end = strchr(obj, '}');
+        if (!end)
+            return NML_EINVAL;
+        *end = '\0';
+        BenchBaselineEntry *e = &baseline->entries[baseline->count];
+        double batch;
+        if (readString(obj, "group", e->group, sizeof(e->group)) !=
+                NML_SUCCESS ||
+            readString(obj, "name", e->name, sizeof(e->name)) !=
+                NML_SUCCESS ||
+            readNumber(obj, "batch", &batch) != NML_SUCCESS || batch < 1 ||
+            readNumber(obj, "median_ns", &e->medianNs) != NML_SUCCESS ||
+            !(e->medianNs > 0.0))
+            return NML_EINVAL;
+        // older files without a spread compare on the threshold alone
+        if (readNumber(obj, "mad_ns", &e->madNs) != NML_SUCCESS)
+            e->madNs = 0.0;
+        // confirmed cases hold more samples than the run's repetitions
+        double samples;
+        e->samples = readNumber(obj, "samples", &samples) == NML_SUCCESS &&
+                             samples >= 1
+                         ? (size_t)samples
+                         : baseline->reps;
+        e->batch = (size_t)batch;
+        baseline->count++;
+        obj = strchr(end + 1, '{');
+    }
+    return NML_SUCCESS;
+}
+
+int baselineLoad(const char *path, BenchBaseline *baseline) {
+    memset(baseline, 0, sizeof(*baseline));
+    char *text = readFile(path);
+    if (!text) {
+        fprintf(stderr, "numen_bench: can't read %s\n", path);
+        return NML_EINVAL;
+    }
+    int status = parseBaseline(text, baseline);
+    free(text);
+    if (status != NML_SUCCESS) {
+        fprintf(stderr, "numen_bench: %s is not numen_bench json\n", path);
+        baselineFree(baseline);
+    }
+    return status;
+}
+
+void baselineFree(BenchBaseline *baseline) {
+    free(baseline->entries);
+    baseline->entries = NULL;
+    baseline->count = 0;
+}
+
+const BenchBaselineEntry *baselineFind(const BenchBaseline *baseline,
+                                       const BenchCase *bench,
+                                       size_t batch) {
+    for (size_t i = 0; i < baseline->count; i++) {
+        const BenchBaselineEntry *e = &baseline->entries[i];
+        if (e->batch == batch && !strcmp(e->group, bench->group) &&
+            !strcmp(e->name, bench->name))
+            return e;
+    }
+    return NULL;
+}
+
+int baselineCompare(const BenchBaselineEntry *entry,
+                    const BenchResult *result,
+                    double threshold,
+                    double *change) {
+    double base = entry->medianNs, current = result->medianNs;
+    *change = current / base - 1.0;
+    if (fabs(*change) <= threshold)
+        return BENCH_SAME;
+
+    // standard errors of the two medians
+    const double k = 1.2533 * 1.4826;
+    double seBase = k * entry->madNs / sqrt((double)entry->samples);
+    double seCurrent = k * result->madNs / sqrt((double)result->samples);
+    double se = sqrt(seBase * seBase + seCurrent * seCurrent);
+    if (fabs(current - base) <= BENCH_NOISE_SIGMAS * se)
+        return BENCH_SAME;
+    return current > base ? BENCH_SLOWER : BENCH_FASTER;
+}
@@ -0,0 +1,53 @@
+// header-only mode (utils/inline.h), compare with the library cases of the
+// same name in the vec3, vec4, mat3 and mat4 groups
+#define NUMEN_INLINE
+#include "suite.h"
+
+BENCH(inline, vec3Add) {
+    for (size_t i = 0; i < n; i++)
+        vec3Add(&data->v3a[i], &data->v3b[i], &data->v3out[i]);
+}
+
+BENCH(inline, vec3Cross) {
+    for (size_t i = 0; i < n; i++)
+        vec3Cross(&data->v3a[i], &data->v3b[i], &data->v3out[i]);
+}
+
+BENCH(inline, vec3Normalize) {
+    for (size_t i = 0; i < n; i++)
+        vec3Normalize(&data->v3a[i], &data->v3out[i]);
+}
+
+BENCH(inline, vec4Add) {
+    for (size_t i = 0; i < n; i++)
+        vec4Add(&data->v4a[i], &data->v4b[i], &data->v4out[i]);
+}
+
+BENCH(inline, vec4Dot) {
+    nml_t sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+        sum += vec4Dot(&data->v4a[i], &data->v4b[i]);
+    benchSink = sum;
+}
+
+BENCH(inline, mat3MulVec3) {
+    for (size_t i = 0; i < n; i++)
+        mat3MulVec3(&data->m3a[i], &data->v3a[i], &data->v3out[i]);
+}
+
+BENCH(inline, mat4MulVec4) {
+    for (size_t i = 0; i < n; i++)
+        mat4MulVec4(&data->m4a[i], &data->v4a[i], &data->v4out[i]);
+}
+
+BENCH(inline, mat4MulMat4) {
+    for (size_t i = 0; i < n; i++)
+        mat4MulMat4(&data->m4a[i], &data->m4b[i], &data->m4out[i]);
+}
+
+BENCH(inline, mat4Inverse) {
+    for (size_t i = 0; i < n; i++)
+        mat4Inverse(&data->m4a[i], &data->m4out[i]);
+}
+
+BENCH_TRANSFORM_CHAIN(inline)
@@ -0,0 +1,88 @@
+#include "suite.h"
+#include "utils/math.h"
+#include "utils/vmath.h"
+
+/*
+ * math.h and the batch apis of vmath.h
+ */
+
+// sum of fn(sa[i])
+#define MATH_REDUCE(group, fn)                                                 \
+    BENCH(group, fn) {                                                         \
+        nml_t sum = 0.0;                                                       \
+        for (size_t i = 0; i < n; i++)                                         \
+            sum += fn(data->sa[i]);                                            \
+        benchSink = sum;                                                       \
+    }
+
+// out[i] = fn(sa[i]) in one call
+#define MATH_BATCH(group, fn)                                                  \
+    BENCH(group, fn) {                                                         \
+        fn(data->sa, data->sout, n);                                           \
+    }
+
+#define MATH_SQRT_BATCH(group, fn, tier, accuracy)                             \
+    BENCH(group, fn##_##tier) {                                                \
+        fn(data->sa, data->sout, n, accuracy);                                 \
+    }
+
+MATH_REDUCE(math, DegsToRads)
+MATH_REDUCE(math, RadsToDegs)
+MATH_REDUCE(math, Q_Sqrt)
+MATH_REDUCE(math, Q_RSqrt)
+
+BENCH(math, PowInt) {
+    nml_t sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+        sum += PowInt(data->sa[i], (int32_t)(i % 17) - 8);
+    benchSink = sum;
+}
+
+BENCH(math, PowUInt) {
+    nml_t sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+        sum += PowUInt(data->sa[i], (uint32_t)(i % 17));
+    benchSink = sum;
+}
+
+// integers from the lookup table and past it, the gamma function path is
+// timed separately
+BENCH(math, Factorial) {
+    (void)data;
+    nml_t sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+        sum += Factorial((nml_t)(i % 32));
+    benchSink = sum;
+}
+
+BENCH(math, Factorial_gamma) {
+    nml_t sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+        sum += Factorial(data->sa[i]);
+    benchSink = sum;
+}
+
+MATH_BATCH(vmath, SinBatch)
+MATH_BATCH(vmath, CosBatch)
+MATH_BATCH(vmath, TanBatch)
+MATH_BATCH(vmath, ExpBatch)
+MATH_BATCH(vmath, LogBatch)
+
+BENCH(vmath, SinCosBatch) {
+    SinCosBatch(data->sa, data->sout, data->sout2, n);
+}
+
+BENCH(vmath, Atan2Batch) {
+    Atan2Batch(data->sb, data->sa, data->sout, n);
+}
+
+BENCH(vmath, PowBatch) {
+    PowBatch(data->sa, data->sb, data->sout, n);
+}
+
+MATH_SQRT_BATCH(vmath, RSqrtBatch, fast, NML_SQRT_FAST)
+MATH_SQRT_BATCH(vmath, RSqrtBatch, refined, NML_SQRT_REFINED)
+MATH_SQRT_BATCH(vmath, RSqrtBatch, precise, NML_SQRT_PRECISE)
+MATH_SQRT_BATCH(vmath, SqrtBatch, fast, NML_SQRT_FAST)
+MATH_SQRT_BATCH(vmath, SqrtBatch, refined, NML_SQRT_REFINED)
+MATH_SQRT_BATCH(vmath, SqrtBatch, precise, NML_SQRT_PRECISE)
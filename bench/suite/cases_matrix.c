@@ -0,0 +1,129 @@
+#include "suite.h"
+
+/*
+ * mat2d.h, mat3d.h and mat4d.h
+ */
+
+#define MAT_INIT(group, fn, T)                                                 \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(data->T##a[i].elems, &data->T##out[i]);                         \
+    }
+
+#define MAT_INIT_ZERO(group, fn, T)                                            \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(&data->T##out[i]);                                              \
+    }
+
+#define MAT_DIAGONAL(group, fn, T)                                             \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(data->sa[i], &data->T##out[i]);                                 \
+    }
+
+// out[i] = fn(a[i])
+#define MAT_UNARY(group, fn, T)                                                \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(&data->T##a[i], &data->T##out[i]);                              \
+    }
+
+// out[i] = fn(a[i], b[i])
+#define MAT_BINARY(group, fn, T)                                               \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(&data->T##a[i], &data->T##b[i], &data->T##out[i]);              \
+    }
+
+#define MAT_SCALE(group, fn, T)                                                \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(&data->T##a[i], data->sa[i], &data->T##out[i]);                 \
+    }
+
+// vOut[i] = a[i] * vA[i]
+#define MAT_MUL_VEC(group, fn, T, V)                                           \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(&data->T##a[i], &data->V##a[i], &data->V##out[i]);              \
+    }
+
+MAT_INIT(mat2, mat2Init, m2)
+MAT_INIT_ZERO(mat2, mat2InitZero, m2)
+MAT_DIAGONAL(mat2, mat2Diagonal, m2)
+MAT_INIT_ZERO(mat2, mat2Identity, m2)
+MAT_BINARY(mat2, mat2Add, m2)
+MAT_BINARY(mat2, mat2Sub, m2)
+MAT_SCALE(mat2, mat2Scale, m2)
+MAT_UNARY(mat2, mat2Negate, m2)
+MAT_BINARY(mat2, mat2Hadamard, m2)
+MAT_MUL_VEC(mat2, mat2MulVec2, m2, v2)
+MAT_BINARY(mat2, mat2MulMat2, m2)
+MAT_UNARY(mat2, mat2Transpose, m2)
+
+MAT_INIT(mat3, mat3Init, m3)
+MAT_INIT_ZERO(mat3, mat3InitZero, m3)
+MAT_DIAGONAL(mat3, mat3Diagonal, m3)
+MAT_INIT_ZERO(mat3, mat3Identity, m3)
+MAT_BINARY(mat3, mat3Add, m3)
+MAT_BINARY(mat3, mat3Sub, m3)
+MAT_SCALE(mat3, mat3Scale, m3)
+MAT_UNARY(mat3, mat3Negate, m3)
+MAT_BINARY(mat3, mat3Hadamard, m3)
+MAT_MUL_VEC(mat3, mat3MulVec3, m3, v3)
+MAT_BINARY(mat3, mat3MulMat3, m3)
+MAT_UNARY(mat3, mat3Transpose, m3)
+
+MAT_INIT(mat4, mat4Init, m4)
+MAT_INIT_ZERO(mat4, mat4InitZero, m4)
+MAT_DIAGONAL(mat4, mat4Diagonal, m4)
+MAT_INIT_ZERO(mat4, mat4Identity, m4)
+MAT_BINARY(mat4, mat4Add, m4)
+MAT_BINARY(mat4, mat4Sub, m4)
+MAT_SCALE(mat4, mat4Scale, m4)
+MAT_UNARY(mat4, mat4Negate, m4)
+MAT_BINARY(mat4, mat4Hadamard, m4)
+MAT_MUL_VEC(mat4, mat4MulVec4, m4, v4)
+MAT_BINARY(mat4, mat4MulMat4, m4)
+MAT_UNARY(mat4, mat4Transpose, m4)
+MAT_UNARY(mat4, mat4Inverse, m4)
+MAT_UNARY(mat4, mat4InverseAffine, m4)
+
+BENCH(mat4, mat4Determinant) {
+    nml_t sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+        sum += mat4Determinant(&data->m4a[i]);
+    benchSink = sum;
+}
+
+BENCH_TRANSFORM_CHAIN(mat4)
+
+// the batch apis, one call over n elements
+BENCH(mat4, mat4MulVec4Batch) {
+    mat4MulVec4Batch(&data->m4a[0], data->v4a, data->v4out, n);
+}
+
+BENCH(mat4, mat4MulMat4Batch) {
+    mat4MulMat4Batch(&data->m4a[0], data->m4b, data->m4out, n);
+}
+
+BENCH(mat4, mat4MulChain) {
+    mat4MulChain(data->m4a, n, &data->m4out[0]);
+}
+
+BENCH(mat4, mat4TransposeBatch) {
+    mat4TransposeBatch(data->m4a, data->m4out, n);
+}
+
+BENCH(mat4, mat4DeterminantBatch) {
+    mat4DeterminantBatch(data->m4a, data->sout, n);
+}
+
+BENCH(mat4, mat4InverseBatch) {
+    mat4InverseBatch(data->m4a, data->m4out, n);
+}
+
+BENCH(mat4, mat4InverseAffineBatch) {
+    mat4InverseAffineBatch(data->m4a, data->m4out, n);
+}
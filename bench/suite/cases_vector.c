@@ -0,0 +1,118 @@
+#include "suite.h"
+
+/*
+ * vec2d.h, vec3d.h and vec4d.h
+ */
+
+#define VEC_INIT_ZERO(group, fn, T)                                            \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(&data->T##out[i]);                                              \
+    }
+
+// sum of fn(a[i])
+#define VEC_REDUCE(group, fn, T)                                               \
+    BENCH(group, fn) {                                                         \
+        nml_t sum = 0.0;                                                       \
+        for (size_t i = 0; i < n; i++)                                         \
+            sum += fn(&data->T##a[i]);                                         \
+        benchSink = sum;                                                       \
+    }
+
+// sum of fn(a[i], b[i])
+#define VEC_REDUCE2(group, fn, T)                                              \
+    BENCH(group, fn) {                                                         \
+        nml_t sum = 0.0;                                                       \
+        for (size_t i = 0; i < n; i++)                                         \
+            sum += fn(&data->T##a[i], &data->T##b[i]);                         \
+        benchSink = sum;                                                       \
+    }
+
+// out[i] = fn(a[i])
+#define VEC_UNARY(group, fn, T)                                                \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(&data->T##a[i], &data->T##out[i]);                              \
+    }
+
+// out[i] = fn(a[i], b[i])
+#define VEC_BINARY(group, fn, T)                                               \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(&data->T##a[i], &data->T##b[i], &data->T##out[i]);              \
+    }
+
+#define VEC_SCALE(group, fn, T)                                                \
+    BENCH(group, fn) {                                                         \
+        for (size_t i = 0; i < n; i++)                                         \
+            fn(&data->T##a[i], data->sa[i], &data->T##out[i]);                 \
+    }
+
+#define VEC_NORMALIZE_BATCH(group, fn, T)                                      \
+    BENCH(group, fn) {                                                         \
+        fn(data->T##a, data->T##out, n, NULL, data->valid);                    \
+    }
+
+BENCH(vec2, vec2Init) {
+    for (size_t i = 0; i < n; i++)
+        vec2Init(data->sa[i], data->sb[i], &data->v2out[i]);
+}
+VEC_INIT_ZERO(vec2, vec2InitZero, v2)
+VEC_REDUCE(vec2, vec2Length, v2)
+VEC_REDUCE(vec2, vec2LengthSqr, v2)
+VEC_UNARY(vec2, vec2Normalize, v2)
+VEC_NORMALIZE_BATCH(vec2, vec2NormalizeBatch, v2)
+VEC_BINARY(vec2, vec2Add, v2)
+VEC_BINARY(vec2, vec2Sub, v2)
+VEC_BINARY(vec2, vec2Mul, v2)
+VEC_BINARY(vec2, vec2Div, v2)
+VEC_REDUCE2(vec2, vec2Dot, v2)
+VEC_REDUCE2(vec2, vec2Cross, v2)
+VEC_SCALE(vec2, vec2Scale, v2)
+VEC_UNARY(vec2, vec2Negate, v2)
+VEC_BINARY(vec2, vec2Project, v2)
+VEC_BINARY(vec2, vec2Reject, v2)
+VEC_BINARY(vec2, vec2Reflect, v2)
+
+BENCH(vec3, vec3Init) {
+    for (size_t i = 0; i < n; i++)
+        vec3Init(data->sa[i], data->sb[i], data->sa[i], &data->v3out[i]);
+}
+VEC_INIT_ZERO(vec3, vec3InitZero, v3)
+VEC_REDUCE(vec3, vec3Length, v3)
+VEC_REDUCE(vec3, vec3LengthSqr, v3)
+VEC_UNARY(vec3, vec3Normalize, v3)
+VEC_NORMALIZE_BATCH(vec3, vec3NormalizeBatch, v3)
+VEC_BINARY(vec3, vec3Add, v3)
+VEC_BINARY(vec3, vec3Sub, v3)
+VEC_BINARY(vec3, vec3Mul, v3)
+VEC_BINARY(vec3, vec3Div, v3)
+VEC_REDUCE2(vec3, vec3Dot, v3)
+VEC_BINARY(vec3, vec3Cross, v3)
+VEC_SCALE(vec3, vec3Scale, v3)
+VEC_UNARY(vec3, vec3Negate, v3)
+VEC_BINARY(vec3, vec3Project, v3)
+VEC_BINARY(vec3, vec3Reject, v3)
+VEC_BINARY(vec3, vec3Reflect, v3)
+
+BENCH(vec4, vec4Init) {
+    for (size_t i = 0; i < n; i++)
+        vec4Init(data->sa[i], data->sb[i], data->sa[i], data->sb[i],
+                 &data->v4out[i]);
+}
+VEC_INIT_ZERO(vec4, vec4InitZero, v4)
+VEC_REDUCE(vec4, vec4Length, v4)
+VEC_REDUCE(vec4, vec4LengthSqr, v4)
+VEC_UNARY(vec4, vec4Normalize, v4)
+VEC_NORMALIZE_BATCH(vec4, vec4NormalizeBatch, v4)
+VEC_BINARY(vec4, vec4Add, v4)
+VEC_BINARY(vec4, vec4Sub, v4)
+VEC_BINARY(vec4, vec4Mul, v4)
+VEC_BINARY(vec4, vec4Div, v4)
+VEC_REDUCE2(vec4, vec4Dot, v4)
+VEC_BINARY(vec4, vec4Cross, v4)
+VEC_SCALE(vec4, vec4Scale, v4)
+VEC_UNARY(vec4, vec4Negate, v4)
+VEC_BINARY(vec4, vec4Project, v4)
+VEC_BINARY(vec4, vec4Reject, v4)
+VEC_BINARY(vec4, vec4Reflect, v4)
@@ -0,0 +1,142 @@
+#include "suite.h"
+#include "utils/errors.h"
+#include <stdio.h>
+#include <string.h>
+
+const char *const benchCounterNames[BENCH_COUNTER_COUNT] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses",
+};
+
+#if defined(__linux__)
+#    include <errno.h>
+#    include <linux/perf_event.h>
+#    include <stdint.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+
+#    define CACHE_READ_MISS(cache)                                             \
+        ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) |                        \
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} events[BENCH_COUNTER_COUNT] = {
+    [BENCH_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [BENCH_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [BENCH_L1D_MISSES] = {PERF_TYPE_HW_CACHE,
+                          CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    [BENCH_LLC_MISSES] = {PERF_TYPE_HW_CACHE,
+                          CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL)},
+    [BENCH_BRANCH_MISSES] = {PERF_TYPE_HARDWARE,
+                             PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+static int openEvent(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // this thread on any cpu, no group
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+int countersOpen(BenchCounters *counters, char *why, size_t whySize) {
+    counters->mask = 0;
+    int error = 0;
+    for (int i = 0; i < BENCH_COUNTER_COUNT; i++) {
+        counters->fds[i] = openEvent(events[i].type, events[i].config);
+        if (counters->fds[i] >= 0)
+            counters->mask |= 1u << i;
+        else if (!error)
+            error = errno;
+    }
+    if (counters->mask)
+        return NML_SUCCESS;
+
+    if (error == EACCES || error == EPERM)
+        snprintf(why, whySize,
+                 "%s, see /proc/sys/kernel/perf_event_paranoid",
+                 strerror(error));
+    else if (error == ENOENT || error == EOPNOTSUPP)
+        snprintf(why, whySize, "no hardware counters on this cpu or vm");
+    else if (error == ENOSYS)
+        snprintf(why, whySize, "perf_event_open isn't supported here");
+    else
+        snprintf(why, whySize, "%s", strerror(error));
+    return NML_EINVAL;
+}
+
+void countersClose(BenchCounters *counters) {
+    for (int i = 0; i < BENCH_COUNTER_COUNT; i++) {
+        if (counters->mask & (1u << i))
+            close(counters->fds[i]);
+    }
+    counters->mask = 0;
+}
+
+void countersStart(BenchCounters *counters) {
+    for (int i = 0; i < BENCH_COUNTER_COUNT; i++) {
+        if (counters->mask & (1u << i)) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+unsigned countersStop(BenchCounters *counters,
+                      double values[BENCH_COUNTER_COUNT]) {
+    unsigned counted = 0;
+    for (int i = 0; i < BENCH_COUNTER_COUNT; i++) {
+        if (counters->mask & (1u << i))
+            ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < BENCH_COUNTER_COUNT; i++) {
+        values[i] = 0.0;
+        // value, time enabled, time running
+        uint64_t data[3];
+        if (!(counters->mask & (1u << i)) ||
+            read(counters->fds[i], data, sizeof(data)) != sizeof(data) ||
+            data[2] == 0)
+            continue;
+        values[i] = (double)data[0];
+        if (data[2] < data[1])
+            values[i] *= (double)data[1] / (double)data[2];
+        counted |= 1u << i;
+    }
+    return counted;
+}
+
+#else
+
+int countersOpen(BenchCounters *counters, char *why, size_t whySize) {
+    counters->mask = 0;
+    snprintf(why, whySize, "hardware counters are only read on linux");
+    return NML_EINVAL;
+}
+
+void countersClose(BenchCounters *counters) {
+    counters->mask = 0;
+}
+
+void countersStart(BenchCounters *counters) {
+    (void)counters;
+}
+
+unsigned countersStop(BenchCounters *counters,
+                      double values[BENCH_COUNTER_COUNT]) {
+    (void)counters;
+    for (int i = 0; i < BENCH_COUNTER_COUNT; i++)
+        values[i] = 0.0;
+    return 0;
+}
+
+#endif
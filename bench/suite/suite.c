@@ -0,0 +1,585 @@
+#include "suite.h"
+#include "utils/cpu.h"
+#include "utils/errors.h"
+#include "utils/memory.h"
+#include "utils/thread.h"
+#include "bench_random.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef NUMEN_VERSION
+#    define NUMEN_VERSION "unknown"
+#endif
+
+#define MAX_SIZES 16
+#define DEFAULT_REPS 25
+#define DEFAULT_MIN_TIME_MS 1.0
+#define DEFAULT_THRESHOLD_PCT 10.0
+// exit status when a case got slower than the baseline
+#define EXIT_REGRESSION 2
+// extra measurements of a case that looks slower than the baseline
+#define CONFIRM_RUNS 2
+
+static BenchCase *benchCases;
+volatile nml_t benchSink;
+
+void benchRegister(BenchCase *bench) {
+    // after the last case of the same or an earlier group
+    BenchCase **at = &benchCases;
+    while (*at && strcmp((*at)->group, bench->group) <= 0)
+        at = &(*at)->next;
+    bench->next = *at;
+    *at = bench;
+}
+
+typedef struct Options {
+    const char *filter;
+    const char *jsonPath;
+    const char *baselinePath;
+    // smallest relative change against the baseline that counts
+    double threshold;
+    size_t sizes[MAX_SIZES];
+    size_t sizeCount;
+    size_t reps;
+    double minTimeNs;
+    int list;
+    int counters;
+} Options;
+
+static double nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// uniform in [lo, hi)
+static void fillRandom(nml_t *out, size_t n, nml_t lo, nml_t hi, unsigned *s) {
+    for (size_t i = 0; i < n; i++)
+        out[i] = lo + (hi - lo) * (nml_t)(nextRandom(s) % 65536) / 65536.0;
+}
+
+// rotation about a random axis and a translation in [-1, 1)
+static void rigidTransform(Mat4 *m, unsigned *s) {
+    nml_t q[4];
+    fillRandom(q, 4, -1.0, 1.0, s);
+    nml_t len = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    nml_t x = q[0] / len, y = q[1] / len, z = q[2] / len, w = q[3] / len;
+    nml_t t[3];
+    fillRandom(t, 3, -1.0, 1.0, s);
+    nml_t cols[16] = {
+        1 - 2 * (y * y + z * z), 2 * (x * y + w * z), 2 * (x * z - w * y), 0,
+        2 * (x * y - w * z), 1 - 2 * (x * x + z * z), 2 * (y * z + w * x), 0,
+        2 * (x * z + w * y), 2 * (y * z - w * x), 1 - 2 * (x * x + y * y), 0,
+        t[0], t[1], t[2], 1,
+    };
+    mat4Init(cols, m);
+}
+
+static void freeData(BenchData *data) {
+    void *arrays[] = {
+        data->v2a,  data->v2b, data->v2out, data->v3a,  data->v3b,
+        data->v3out, data->v4a, data->v4b,  data->v4out, data->m2a,
+        data->m2b,  data->m2out, data->m3a, data->m3b,  data->m3out,
+        data->m4a,  data->m4b, data->m4out, data->sa,   data->sb,
+        data->sout, data->sout2, data->valid,
+    };
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++)
+        alignedFree(arrays[i]);
+}
+
+#define ALLOC_ARRAY(ptr, n)                                                    \
+    ((ptr) = alignedAlloc(NML_ALIGNMENT, (n) * sizeof(*(ptr))), (ptr) != NULL)
+
+// every array of n elements, a and b arrays filled with random values
+static int initData(BenchData *data, size_t n) {
+    memset(data, 0, sizeof(*data));
+    int ok = ALLOC_ARRAY(data->v2a, n) & ALLOC_ARRAY(data->v2b, n) &
+             ALLOC_ARRAY(data->v2out, n) & ALLOC_ARRAY(data->v3a, n) &
+             ALLOC_ARRAY(data->v3b, n) & ALLOC_ARRAY(data->v3out, n) &
+             ALLOC_ARRAY(data->v4a, n) & ALLOC_ARRAY(data->v4b, n) &
+             ALLOC_ARRAY(data->v4out, n) & ALLOC_ARRAY(data->m2a, n) &
+             ALLOC_ARRAY(data->m2b, n) & ALLOC_ARRAY(data->m2out, n) &
+             ALLOC_ARRAY(data->m3a, n) & ALLOC_ARRAY(data->m3b, n) &
+             ALLOC_ARRAY(data->m3out, n) & ALLOC_ARRAY(data->m4a, n) &
+             ALLOC_ARRAY(data->m4b, n) & ALLOC_ARRAY(data->m4out, n) &
+             ALLOC_ARRAY(data->sa, n) & ALLOC_ARRAY(data->sb, n) &
+             ALLOC_ARRAY(data->sout, n) & ALLOC_ARRAY(data->sout2, n) &
+             ALLOC_ARRAY(data->valid, n);
+    if (!ok) {
+        freeData(data);
+        return NML_ENOMEM;
+    }
+
+    // vectors and matrices as flat scalars, padding lanes included. the
+    // components stay away from zero so divisions and normalizations are
+    // well defined
+    unsigned s = 1;
+#define FILL(ptr, lo, hi)                                                      \
+    fillRandom((nml_t *)(ptr), n * sizeof(*(ptr)) / sizeof(nml_t), lo, hi, &s)
+    FILL(data->v2a, 0.5, 1.5);
+    FILL(data->v2b, 0.5, 1.5);
+    FILL(data->v3a, 0.5, 1.5);
+    FILL(data->v3b, 0.5, 1.5);
+    FILL(data->v4a, 0.5, 1.5);
+    FILL(data->v4b, 0.5, 1.5);
+    FILL(data->m2a, -1.0, 1.0);
+    FILL(data->m2b, -1.0, 1.0);
+    FILL(data->m3a, -1.0, 1.0);
+    FILL(data->m3b, -1.0, 1.0);
+    FILL(data->m4b, -1.0, 1.0);
+#undef FILL
+    for (size_t i = 0; i < n; i++)
+        rigidTransform(&data->m4a[i], &s);
+    fillRandom(data->sa, n, 0.5, 8.0, &s);
+    fillRandom(data->sb, n, -1.0, 1.0, &s);
+    return NML_SUCCESS;
+}
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double runSample(const BenchCase *bench,
+                        BenchData *data,
+                        size_t batch,
+                        size_t iterations) {
+    double start = nowNs();
+    for (size_t i = 0; i < iterations; i++)
+        bench->run(data, batch);
+    return nowNs() - start;
+}
+
+// every sample of one case at one batch size, the confirm runs of a baseline
+// comparison add theirs to the same pool
+typedef struct SamplePool {
+    // nanoseconds per operation, room for reps * (1 + CONFIRM_RUNS)
+    double *ns;
+    // as many doubles, for sorting
+    double *scratch;
+    size_t count;
+    // counts summed over the samples, for the counters in counterMask
+    double counts[BENCH_COUNTER_COUNT];
+    unsigned counterMask;
+} SamplePool;
+
+/*
+ * one untimed call touches the outputs and wakes the thread pool, then the
+ * iteration count doubles until one sample takes minTimeNs
+ */
+static size_t calibrate(const BenchCase *bench,
+                        BenchData *data,
+                        size_t batch,
+                        const Options *opts) {
+    bench->run(data, batch);
+    size_t iterations = 1;
+    while (runSample(bench, data, batch, iterations) < opts->minTimeNs)
+        iterations *= 2;
+    return iterations;
+}
+
+// reps samples of iterations calls added to the pool. counters, unless NULL,
+// count over them
+static void addSamples(const BenchCase *bench,
+                       BenchData *data,
+                       size_t batch,
+                       size_t iterations,
+                       size_t reps,
+                       BenchCounters *counters,
+                       SamplePool *pool) {
+    double counts[BENCH_COUNTER_COUNT];
+    if (counters)
+        countersStart(counters);
+    for (size_t r = 0; r < reps; r++) {
+        double ns = runSample(bench, data, batch, iterations);
+        pool->ns[pool->count++] = ns / ((double)iterations * batch);
+    }
+    // a counter only counts for the pool when it counted in every run
+    pool->counterMask &= counters ? countersStop(counters, counts) : 0;
+    for (int c = 0; c < BENCH_COUNTER_COUNT; c++)
+        pool->counts[c] += pool->counterMask & (1u << c) ? counts[c] : 0.0;
+}
+
+static void summarize(const BenchCase *bench,
+                      size_t batch,
+                      size_t iterations,
+                      SamplePool *pool,
+                      BenchResult *result) {
+    size_t n = pool->count;
+    double *sorted = pool->scratch;
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sorted[i] = pool->ns[i];
+        sum += sorted[i];
+    }
+    qsort(sorted, n, sizeof(double), compareDouble);
+
+    // nearest rank percentiles
+    size_t p99 = (size_t)ceil(0.99 * n) - 1;
+    result->bench = bench;
+    result->batch = batch;
+    result->iterations = iterations;
+    result->samples = n;
+    result->minNs = sorted[0];
+    result->medianNs = sorted[(n - 1) / 2];
+    result->p99Ns = sorted[p99];
+    result->meanNs = sum / n;
+
+    for (size_t i = 0; i < n; i++)
+        sorted[i] = fabs(sorted[i] - result->medianNs);
+    qsort(sorted, n, sizeof(double), compareDouble);
+    result->madNs = sorted[(n - 1) / 2];
+
+    double ops = (double)iterations * batch * n;
+    result->counterMask = pool->counterMask;
+    for (int c = 0; c < BENCH_COUNTER_COUNT; c++)
+        result->perOp[c] =
+            pool->counterMask & (1u << c) ? pool->counts[c] / ops : 0.0;
+}
+
+static const char *scalarName(void) {
+    return sizeof(nml_t) == sizeof(double) ? "double" : "float";
+}
+
+static int hasIpc(const BenchResult *r) {
+    unsigned both = (1u << BENCH_CYCLES) | (1u << BENCH_INSTRUCTIONS);
+    return (r->counterMask & both) == both && r->perOp[BENCH_CYCLES] > 0.0;
+}
+
+static int writeJson(const char *path,
+                     const Options *opts,
+                     const BenchCounters *counters,
+                     const BenchResult *results,
+                     size_t count) {
+    FILE *f = strcmp(path, "-") ? fopen(path, "w") : stdout;
+    if (!f) {
+        fprintf(stderr, "numen_bench: can't open %s\n", path);
+        return NML_EINVAL;
+    }
+    fprintf(f, "{\n");
+    fprintf(f, "  \"library\": \"numen\",\n");
+    fprintf(f, "  \"version\": \"%s\",\n", NUMEN_VERSION);
+    fprintf(f, "  \"backend\": \"%s\",\n", cpuBackendName());
+    fprintf(f, "  \"scalar\": \"%s\",\n", scalarName());
+    fprintf(f, "  \"threads\": %d,\n", threadCount());
+    fprintf(f, "  \"repetitions\": %zu,\n", opts->reps);
+    fprintf(f, "  \"counters\": [");
+    for (int c = 0, first = 1; c < BENCH_COUNTER_COUNT; c++) {
+        if (counters->mask & (1u << c)) {
+            fprintf(f, "%s\"%s\"", first ? "" : ", ", benchCounterNames[c]);
+            first = 0;
+        }
+    }
+    fprintf(f, "],\n");
+    fprintf(f, "  \"results\": [");
+    for (size_t i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(f,
+                "%s\n    {\"group\": \"%s\", \"name\": \"%s\", "
+                "\"batch\": %zu, \"iterations\": %zu, \"samples\": %zu, "
+                "\"min_ns\": %.4f, \"median_ns\": %.4f, \"p99_ns\": %.4f, "
+                "\"mean_ns\": %.4f, \"mad_ns\": %.4f, "
+                "\"ops_per_sec\": %.6e",
+                i ? "," : "", r->bench->group, r->bench->name, r->batch,
+                r->iterations, r->samples, r->minNs, r->medianNs, r->p99Ns,
+                r->meanNs, r->madNs, 1e9 / r->medianNs);
+        for (int c = 0; c < BENCH_COUNTER_COUNT; c++) {
+            if (r->counterMask & (1u << c))
+                fprintf(f, ", \"%s_per_op\": %.4f", benchCounterNames[c],
+                        r->perOp[c]);
+        }
+        if (hasIpc(r))
+            fprintf(f, ", \"ipc\": %.3f",
+                    r->perOp[BENCH_INSTRUCTIONS] / r->perOp[BENCH_CYCLES]);
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n  ]\n}\n");
+    int status = ferror(f) ? NML_EINVAL : NML_SUCCESS;
+    if (f != stdout)
+        status = fclose(f) ? NML_EINVAL : status;
+    if (status != NML_SUCCESS)
+        fprintf(stderr, "numen_bench: error writing %s\n", path);
+    return status;
+}
+
+// per operation, - for a counter that didn't count
+static void printCounters(FILE *table, const BenchResult *r) {
+    static const int columns[] = {BENCH_CYCLES, BENCH_INSTRUCTIONS, -1,
+                                  BENCH_L1D_MISSES, BENCH_LLC_MISSES,
+                                  BENCH_BRANCH_MISSES};
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); i++) {
+        int c = columns[i];
+        if (c < 0 && hasIpc(r))
+            fprintf(table, " %6.2f",
+                    r->perOp[BENCH_INSTRUCTIONS] / r->perOp[BENCH_CYCLES]);
+        else if (c < 0)
+            fprintf(table, " %6s", "-");
+        else if (r->counterMask & (1u << c))
+            fprintf(table, " %10.3f", r->perOp[c]);
+        else
+            fprintf(table, " %10s", "-");
+    }
+}
+
+static void usage(FILE *f) {
+    fprintf(f,
+            "usage: numen_bench [options]\n"
+            "  --filter TEXT     only cases whose group/name contains TEXT\n"
+            "  --sizes N,N,...   batch sizes (default 16,1024,65536)\n"
+            "  --reps N          samples per case and size (default %d)\n"
+            "  --min-time MS     shortest sample in milliseconds "
+            "(default %.1f)\n"
+            "  --json FILE       also write the results as json, - for "
+            "stdout\n"
+            "  --baseline FILE   compare against the json of an earlier run, "
+            "exit with %d\n"
+            "                    when a case got slower\n"
+            "  --threshold PCT   smallest change against the baseline that "
+            "counts\n"
+            "                    (default %.1f)\n"
+            "  --counters        also count cycles, instructions, cache and "
+            "branch\n"
+            "                    misses per operation (linux perf events)\n"
+            "  --list            print the cases and exit\n",
+            DEFAULT_REPS, DEFAULT_MIN_TIME_MS, EXIT_REGRESSION,
+            DEFAULT_THRESHOLD_PCT);
+}
+
+static int parseSizes(const char *arg, Options *opts) {
+    opts->sizeCount = 0;
+    while (*arg) {
+        char *end;
+        unsigned long long size = strtoull(arg, &end, 10);
+        if (end == arg || size == 0 || opts->sizeCount == MAX_SIZES)
+            return NML_EINVAL;
+        opts->sizes[opts->sizeCount++] = (size_t)size;
+        if (*end == ',')
+            end++;
+        else if (*end)
+            return NML_EINVAL;
+        arg = end;
+    }
+    return opts->sizeCount ? NML_SUCCESS : NML_EINVAL;
+}
+
+static int parseOptions(int argc, char **argv, Options *opts) {
+    *opts = (Options){
+        .sizes = {16, 1024, 65536},
+        .sizeCount = 3,
+        .reps = DEFAULT_REPS,
+        .minTimeNs = DEFAULT_MIN_TIME_MS * 1e6,
+        .threshold = DEFAULT_THRESHOLD_PCT / 100.0,
+    };
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!strcmp(arg, "--list")) {
+            opts->list = 1;
+            continue;
+        }
+        if (!strcmp(arg, "--counters")) {
+            opts->counters = 1;
+            continue;
+        }
+        if (!strcmp(arg, "--help") || !strcmp(arg, "-h")) {
+            usage(stdout);
+            exit(EXIT_SUCCESS);
+        }
+        if (!value)
+            return NML_EINVAL;
+        i++;
+        if (!strcmp(arg, "--filter")) {
+            opts->filter = value;
+        } else if (!strcmp(arg, "--json")) {
+            opts->jsonPath = value;
+        } else if (!strcmp(arg, "--baseline")) {
+            opts->baselinePath = value;
+        } else if (!strcmp(arg, "--threshold")) {
+            double pct = strtod(value, NULL);
+            if (!(pct >= 0.0))
+                return NML_EINVAL;
+            opts->threshold = pct / 100.0;
+        } else if (!strcmp(arg, "--sizes")) {
+            if (parseSizes(value, opts) != NML_SUCCESS)
+                return NML_EINVAL;
+        } else if (!strcmp(arg, "--reps")) {
+            long reps = strtol(value, NULL, 10);
+            if (reps < 1)
+                return NML_EINVAL;
+            opts->reps = (size_t)reps;
+        } else if (!strcmp(arg, "--min-time")) {
+            double ms = strtod(value, NULL);
+            if (!(ms > 0.0))
+                return NML_EINVAL;
+            opts->minTimeNs = ms * 1e6;
+        } else {
+            return NML_EINVAL;
+        }
+    }
+    return NML_SUCCESS;
+}
+
+static int matches(const BenchCase *bench, const char *filter) {
+    if (!filter)
+        return 1;
+    char full[128];
+    snprintf(full, sizeof(full), "%s/%s", bench->group, bench->name);
+    return strstr(full, filter) != NULL;
+}
+
+int main(int argc, char **argv) {
+    Options opts;
+    if (parseOptions(argc, argv, &opts) != NML_SUCCESS) {
+        usage(stderr);
+        return EXIT_FAILURE;
+    }
+
+    size_t caseCount = 0;
+    for (BenchCase *b = benchCases; b; b = b->next) {
+        if (!matches(b, opts.filter))
+            continue;
+        if (opts.list)
+            printf("%s/%s\n", b->group, b->name);
+        caseCount++;
+    }
+    if (opts.list)
+        return EXIT_SUCCESS;
+    if (!caseCount) {
+        fprintf(stderr, "numen_bench: no case matches %s\n", opts.filter);
+        return EXIT_FAILURE;
+    }
+
+    BenchBaseline baseline = {0};
+    if (opts.baselinePath &&
+        baselineLoad(opts.baselinePath, &baseline) != NML_SUCCESS)
+        return EXIT_FAILURE;
+    if (opts.baselinePath && (strcmp(baseline.backend, cpuBackendName()) ||
+                              strcmp(baseline.scalar, scalarName())))
+        fprintf(stderr,
+                "numen_bench: warning, the baseline was recorded with %s, "
+                "%s\n",
+                baseline.backend, baseline.scalar);
+
+    // counting is optional, without counters the run is timing only
+    BenchCounters counters = {.mask = 0};
+    if (opts.counters) {
+        char why[128];
+        if (countersOpen(&counters, why, sizeof(why)) != NML_SUCCESS)
+            fprintf(stderr,
+                    "numen_bench: hardware counters unavailable (%s), "
+                    "timing only\n",
+                    why);
+    }
+    BenchCounters *counting = counters.mask ? &counters : NULL;
+
+    size_t maxSize = 0;
+    for (size_t i = 0; i < opts.sizeCount; i++)
+        maxSize = opts.sizes[i] > maxSize ? opts.sizes[i] : maxSize;
+    BenchData data;
+    BenchResult *results =
+        malloc(caseCount * opts.sizeCount * sizeof(BenchResult));
+    SamplePool pool;
+    pool.ns = malloc(opts.reps * (1 + CONFIRM_RUNS) * sizeof(double));
+    pool.scratch = malloc(opts.reps * (1 + CONFIRM_RUNS) * sizeof(double));
+    if (!results || !pool.ns || !pool.scratch ||
+        initData(&data, maxSize) != NML_SUCCESS) {
+        fprintf(stderr, "numen_bench: allocation failed\n");
+        free(results);
+        free(pool.ns);
+        free(pool.scratch);
+        baselineFree(&baseline);
+        countersClose(&counters);
+        return EXIT_FAILURE;
+    }
+
+    // the table goes to stderr when the json takes stdout
+    FILE *table = opts.jsonPath && !strcmp(opts.jsonPath, "-") ? stderr
+                                                                : stdout;
+    fprintf(table, "numen %s, %s, %s, %d threads, %zu samples\n",
+            NUMEN_VERSION, cpuBackendName(), scalarName(), threadCount(),
+            opts.reps);
+    fprintf(table, "%-32s %8s %12s %12s %12s %12s", "case", "batch",
+            "median ns/op", "p99 ns/op", "min ns/op", "ops/s");
+    if (counting)
+        fprintf(table, " %10s %10s %6s %10s %10s %10s", "cycles/op",
+                "instr/op", "ipc", "l1d miss", "llc miss", "br miss");
+    fprintf(table, "%s\n", opts.baselinePath ? "  vs baseline" : "");
+
+    size_t count = 0, compared = 0, slower = 0, faster = 0;
+    for (BenchCase *b = benchCases; b; b = b->next) {
+        if (!matches(b, opts.filter))
+            continue;
+        for (size_t i = 0; i < opts.sizeCount; i++) {
+            BenchResult *r = &results[count++];
+            size_t batch = opts.sizes[i];
+            pool.count = 0;
+            pool.counterMask = ~0u;
+            memset(pool.counts, 0, sizeof(pool.counts));
+            size_t iterations = calibrate(b, &data, batch, &opts);
+            addSamples(b, &data, batch, iterations, opts.reps, counting, &pool);
+            summarize(b, batch, iterations, &pool, r);
+            const BenchBaselineEntry *e =
+                opts.baselinePath ? baselineFind(&baseline, b, r->batch)
+                                  : NULL;
+            double change = 0.0;
+            int verdict = BENCH_SAME;
+            if (e) {
+                verdict = baselineCompare(e, r, opts.threshold, &change);
+                // a case that looks slower is measured again and judged on
+                // all its samples together. more samples narrow the noise
+                // band around the median without favoring fast runs, so a
+                // real regression stays visible
+                for (int k = 0; k < CONFIRM_RUNS && verdict == BENCH_SLOWER;
+                     k++) {
+                    addSamples(b, &data, batch, iterations, opts.reps,
+                               counting, &pool);
+                    summarize(b, batch, iterations, &pool, r);
+                    verdict = baselineCompare(e, r, opts.threshold, &change);
+                }
+                slower += verdict == BENCH_SLOWER;
+                faster += verdict == BENCH_FASTER;
+                compared++;
+            }
+
+            char full[128];
+            snprintf(full, sizeof(full), "%s/%s", b->group, b->name);
+            fprintf(table, "%-32s %8zu %12.3f %12.3f %12.3f %12.4g", full,
+                    r->batch, r->medianNs, r->p99Ns, r->minNs,
+                    1e9 / r->medianNs);
+            if (counting)
+                printCounters(table, r);
+            if (e)
+                fprintf(table, "  %+7.1f%%%s", change * 100.0,
+                        verdict == BENCH_SLOWER   ? " slower"
+                        : verdict == BENCH_FASTER ? " faster"
+                                                  : "");
+            else if (opts.baselinePath)
+                fprintf(table, "      new");
+            fprintf(table, "\n");
+            fflush(table);
+        }
+    }
+    if (opts.baselinePath)
+        fprintf(table,
+                "%zu of %zu compared slower, %zu faster (threshold %.1f%%, "
+                "%.0f sigma noise)\n",
+                slower, compared, faster, opts.threshold * 100.0,
+                BENCH_NOISE_SIGMAS);
+
+    int status = NML_SUCCESS;
+    if (opts.jsonPath)
+        status = writeJson(opts.jsonPath, &opts, &counters, results, count);
+
+    freeData(&data);
+    free(results);
+    free(pool.ns);
+    free(pool.scratch);
+    baselineFree(&baseline);
+    countersClose(&counters);
+    if (status != NML_SUCCESS)
+        return EXIT_FAILURE;
+    return slower ? EXIT_REGRESSION : EXIT_SUCCESS;
+}
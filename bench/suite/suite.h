@@ -0,0 +1,186 @@
+#ifndef __BENCH_SUITE_H__
+#define __BENCH_SUITE_H__
+
+#include "matrix/mat2d.h"
+#include "matrix/mat3d.h"
+#include "matrix/mat4d.h"
+#include "utils/consts.h"
+#include "vector/vec2d.h"
+#include "vector/vec3d.h"
+#include "vector/vec4d.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * numen_bench, one executable timing every public kernel at several batch
+ * sizes
+ *
+ * a case runs its kernel over the first n elements of the shared input
+ * arrays, one call per element for the single value apis and one call for
+ * the whole range for the batch apis, so every case costs n operations.
+ * the harness warms each case up, picks an iteration count that makes one
+ * sample last at least the minimum sample time and then takes the given
+ * number of samples. results are reported in nanoseconds per operation
+ */
+
+// inputs of every case, each array holds the largest batch size. the a and
+// b arrays are filled once and never written, cases write the out arrays
+typedef struct BenchData {
+    Vec2 *v2a, *v2b, *v2out;
+    Vec3 *v3a, *v3b, *v3out;
+    Vec4 *v4a, *v4b, *v4out;
+    Mat2 *m2a, *m2b, *m2out;
+    Mat3 *m3a, *m3b, *m3out;
+    // m4a are rigid transforms so chains and inverses stay well conditioned
+    Mat4 *m4a, *m4b, *m4out;
+    // sa in [0.5, 8), sb in [-1, 1)
+    nml_t *sa, *sb, *sout, *sout2;
+    uint8_t *valid;
+} BenchData;
+
+typedef void (*BenchFn)(BenchData *data, size_t n);
+
+typedef struct BenchCase {
+    // header the kernel is declared in, "vec3", "mat4", ...
+    const char *group;
+    // the kernel's name
+    const char *name;
+    BenchFn run;
+    struct BenchCase *next;
+} BenchCase;
+
+// keeps cases sorted by group, registration order within a group
+void benchRegister(BenchCase *bench);
+
+/*
+ * hardware counters, read through perf_event_open on linux
+ *
+ * every counter is a separate event covering user space only, so the
+ * default perf_event_paranoid of 2 allows them. when the pmu has fewer
+ * counters than events the kernel time shares them and the counts are
+ * scaled by the fraction of time each one was running. the counters are
+ * inherited by threads created after they are opened, which covers the
+ * thread pool as it starts on first use
+ */
+
+enum {
+    BENCH_CYCLES,
+    BENCH_INSTRUCTIONS,
+    BENCH_L1D_MISSES,
+    BENCH_LLC_MISSES,
+    BENCH_BRANCH_MISSES,
+    BENCH_COUNTER_COUNT,
+};
+
+typedef struct BenchCounters {
+    int fds[BENCH_COUNTER_COUNT];
+    // bit i set when counter i could be opened
+    unsigned mask;
+} BenchCounters;
+
+// the json key and table heading of each counter, "cycles", ...
+extern const char *const benchCounterNames[BENCH_COUNTER_COUNT];
+
+// opens whichever counters the host supports. NML_EINVAL when none is,
+// with a reason for the user in why
+int countersOpen(BenchCounters *counters, char *why, size_t whySize);
+void countersClose(BenchCounters *counters);
+void countersStart(BenchCounters *counters);
+// counts since countersStart, returns the mask of counters that counted
+unsigned countersStop(BenchCounters *counters,
+                      double values[BENCH_COUNTER_COUNT]);
+
+typedef struct BenchResult {
+    const BenchCase *bench;
+    size_t batch;
+    // kernel calls per sample, each over batch elements
+    size_t iterations;
+    // samples the statistics are over, reps or more after confirm runs
+    size_t samples;
+    // nanoseconds per operation over the samples, mad is the median absolute
+    // deviation from the median
+    double minNs, medianNs, p99Ns, meanNs, madNs;
+    // counts per operation over the samples, for the counters in counterMask
+    double perOp[BENCH_COUNTER_COUNT];
+    unsigned counterMask;
+} BenchResult;
+
+/*
+ * baselines, the json of an earlier run (--json) read back with --baseline
+ *
+ * a case regressed when its median grew by more than the threshold and the
+ * growth is outside the noise of both runs, more than BENCH_NOISE_SIGMAS
+ * standard errors of the difference of the medians. the standard error of
+ * a median of n samples is estimated as 1.2533 * 1.4826 * mad / sqrt(n),
+ * which holds for roughly normal samples and is robust to outliers
+ */
+
+#define BENCH_NOISE_SIGMAS 3.0
+
+typedef struct BenchBaselineEntry {
+    char group[32];
+    char name[64];
+    size_t batch;
+    // samples behind the median and mad
+    size_t samples;
+    double medianNs, madNs;
+} BenchBaselineEntry;
+
+typedef struct BenchBaseline {
+    BenchBaselineEntry *entries;
+    size_t count;
+    size_t reps;
+    char backend[32];
+    char scalar[16];
+} BenchBaseline;
+
+// verdicts of baselineCompare
+enum {
+    BENCH_SAME = 0,
+    BENCH_FASTER = 1,
+    BENCH_SLOWER = 2,
+};
+
+// NML_EINVAL for a file that can't be read or isn't numen_bench json,
+// release with baselineFree
+int baselineLoad(const char *path, BenchBaseline *baseline);
+void baselineFree(BenchBaseline *baseline);
+// the entry of bench at batch, NULL when the baseline has none
+const BenchBaselineEntry *baselineFind(const BenchBaseline *baseline,
+                                       const BenchCase *bench,
+                                       size_t batch);
+// result against entry, threshold is the smallest relative change that
+// counts. *change is the relative change of the median
+int baselineCompare(const BenchBaselineEntry *entry,
+                    const BenchResult *result,
+                    double threshold,
+                    double *change);
+
+// results of kernels returning a value are summed and stored here so the
+// calls can't be dropped
+extern volatile nml_t benchSink;
+
+#define BENCH(group, name)                                                     \
+    static void bench_##name(BenchData *data, size_t n);                       \
+    __attribute__((constructor)) static void register_##name(void) {           \
+        static BenchCase bench = {#group, #name, bench_##name, NULL};          \
+        benchRegister(&bench);                                                 \
+    }                                                                          \
+    static void bench_##name(BenchData *data, size_t n)
+
+// a short chain of single value calls whose results feed each other, timed
+// against the library by cases_matrix.c and in the header-only mode of
+// utils/inline.h by cases_inline.c
+#define BENCH_TRANSFORM_CHAIN(group)                                           \
+    BENCH(group, transformNormalizeDot) {                                      \
+        nml_t sum = 0.0;                                                       \
+        for (size_t i = 0; i < n; i++) {                                       \
+            Vec4 v = {{0}};                                                    \
+            mat4MulVec4(&data->m4a[i], &data->v4a[i], &v);                     \
+            vec4Normalize(&v, &v);                                             \
+            sum += vec4Dot(&v, &data->v4b[i]);                                 \
+        }                                                                      \
+        benchSink = sum;                                                       \
+    }
+
+#endif // !__BENCH_SUITE_H__
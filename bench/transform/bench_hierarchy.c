@@ -0,0 +1,146 @@
+#include "transform/hierarchy.h"
+#include "utils/cpu.h"
+#include "utils/thread.h"
+#include "bench_timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPS 5
+#define CHAIN_LENGTH 64
+#define CHAIN_REPS 20000
+
+static void localMatrix(size_t i, Mat4 *m) {
+    nml_t angle = 0.01 * (nml_t)(i % 31);
+    mat4Identity(m);
+    m->cols[0].x = cos(angle);
+    m->cols[0].y = sin(angle);
+    m->cols[1].x = -sin(angle);
+    m->cols[1].y = cos(angle);
+    m->cols[3].x = 0.5;
+}
+
+// what the evaluator replaces: every node folds its own parent chain
+static void foldChains(const int32_t *parents, const Mat4 *locals, size_t n,
+                       Mat4 *worlds) {
+    for (size_t i = 0; i < n; i++) {
+        Mat4 w = locals[i];
+        for (int32_t p = parents[i]; p >= 0; p = parents[p]) {
+            Mat4 l = locals[p];
+            mat4MulMat4(&l, &w, &w);
+        }
+        worlds[i] = w;
+    }
+}
+
+// one mat4MulMat4 per node, parents are stored before their children
+static void topological(const int32_t *parents, const Mat4 *locals, size_t n,
+                        Mat4 *worlds) {
+    for (size_t i = 0; i < n; i++) {
+        if (parents[i] < 0) {
+            worlds[i] = locals[i];
+        } else {
+            Mat4 l = locals[i];
+            mat4MulMat4(&worlds[parents[i]], &l, &worlds[i]);
+        }
+    }
+}
+
+typedef enum { FOLD, TOPOLOGICAL, EVALUATE } Method;
+
+static double bench(Method method, const Mat4Hierarchy *h, const int32_t *parents,
+                    const Mat4 *locals, size_t n, Mat4 *worlds) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        switch (method) {
+        case FOLD:
+            foldChains(parents, locals, n, worlds);
+            break;
+        case TOPOLOGICAL:
+            topological(parents, locals, n, worlds);
+            break;
+        case EVALUATE:
+            mat4HierarchyEvaluate(h, locals, worlds);
+            break;
+        }
+    }
+    return run.best;
+}
+
+static void benchChain(void) {
+    Mat4 mats[CHAIN_LENGTH], out;
+    for (size_t i = 0; i < CHAIN_LENGTH; i++) {
+        localMatrix(i, &mats[i]);
+    }
+
+    double fold = 1e30, chain = 1e30;
+    for (int r = 0; r < REPS; r++) {
+        double t0 = benchSeconds();
+        for (int k = 0; k < CHAIN_REPS; k++) {
+            out = mats[0];
+            for (size_t i = 1; i < CHAIN_LENGTH; i++) {
+                mat4MulMat4(&out, &mats[i], &out);
+            }
+        }
+        double t1 = benchSeconds();
+        for (int k = 0; k < CHAIN_REPS; k++) {
+            mat4MulChain(mats, CHAIN_LENGTH, &out);
+        }
+        double t2 = benchSeconds();
+        fold = t1 - t0 < fold ? t1 - t0 : fold;
+        chain = t2 - t1 < chain ? t2 - t1 : chain;
+    }
+    printf("\nchain of %d matrices\n", CHAIN_LENGTH);
+    printf("%24s %12.1f ns\n", "mat4MulMat4 fold", fold / CHAIN_REPS * 1e9);
+    printf("%24s %12.1f ns %7.2fx\n", "mat4MulChain", chain / CHAIN_REPS * 1e9,
+           fold / chain);
+}
+
+int main(void) {
+    const size_t sizes[] = {10000, 100000, 1000000};
+    const size_t max_n = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+    const int fanout = 4;
+
+    int32_t *parents = malloc(max_n * sizeof(int32_t));
+    Mat4 *locals = malloc(max_n * sizeof(Mat4));
+    Mat4 *worlds = malloc(max_n * sizeof(Mat4));
+    if (!parents || !locals || !worlds) {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    int threads = threadCount();
+    printf("transform hierarchy, %d-ary tree (%s, %d threads)\n", fanout,
+           cpuBackendName(), threads);
+    printf("%10s %14s %14s %14s %14s\n", "nodes", "fold node/s", "topo node/s",
+           "eval 1t node/s", "eval node/s");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        for (size_t i = 0; i < n; i++) {
+            parents[i] = i == 0 ? -1 : (int32_t)((i - 1) / fanout);
+            localMatrix(i, &locals[i]);
+        }
+
+        Mat4Hierarchy h;
+        if (mat4HierarchyInit(parents, n, &h) != 0) {
+            fprintf(stderr, "hierarchy init failed\n");
+            return EXIT_FAILURE;
+        }
+        double t_fold = bench(FOLD, &h, parents, locals, n, worlds);
+        double t_topo = bench(TOPOLOGICAL, &h, parents, locals, n, worlds);
+        threadSetCount(1);
+        double t_one = bench(EVALUATE, &h, parents, locals, n, worlds);
+        threadSetCount(threads);
+        double t_all = bench(EVALUATE, &h, parents, locals, n, worlds);
+        printf("%10zu %14.4g %14.4g %14.4g %14.4g\n", n, n / t_fold, n / t_topo,
+               n / t_one, n / t_all);
+        mat4HierarchyFree(&h);
+    }
+
+    benchChain();
+
+    free(parents);
+    free(locals);
+    free(worlds);
+    return EXIT_SUCCESS;
+}
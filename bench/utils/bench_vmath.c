@@ -0,0 +1,165 @@
+#include "utils/cpu.h"
+#include "utils/vmath.h"
+#include "bench_timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// arrays stay in L2 across the REPS runs
+#define REPS 25
+#define N 16384
+
+static nml_t x[N], y[N], out[N], out2[N];
+
+#if defined(USE_DOUBLE_PRECISION)
+#    define LIBM(fn) fn
+#else
+#    define LIBM(fn) fn##f
+#endif
+
+typedef nml_t (*UnaryFn)(nml_t);
+typedef nml_t (*BinaryFn)(nml_t, nml_t);
+
+/*
+ * three ways to fill out[]: libm one call per value (through a volatile
+ * pointer so the loop stays scalar), the same loop left to the compiler
+ * (glibc with -ffast-math maps it to its own vector functions) and the
+ * batch api
+ */
+
+#define UNARY_CASE(name, fn, src)                      \
+    static UnaryFn volatile name##Ref = LIBM(fn);      \
+    static void name##Scalar(void) {                   \
+        for (size_t i = 0; i < N; i++)                 \
+            out[i] = name##Ref(src[i]);                \
+    }                                                  \
+    static void name##Loop(void) {                     \
+        for (size_t i = 0; i < N; i++)                 \
+            out[i] = LIBM(fn)(src[i]);                 \
+    }
+
+#define BINARY_CASE(name, fn, a, b)                    \
+    static BinaryFn volatile name##Ref = LIBM(fn);     \
+    static void name##Scalar(void) {                   \
+        for (size_t i = 0; i < N; i++)                 \
+            out[i] = name##Ref(a[i], b[i]);            \
+    }                                                  \
+    static void name##Loop(void) {                     \
+        for (size_t i = 0; i < N; i++)                 \
+            out[i] = LIBM(fn)(a[i], b[i]);             \
+    }
+
+UNARY_CASE(sin, sin, x)
+UNARY_CASE(cos, cos, x)
+UNARY_CASE(tan, tan, x)
+UNARY_CASE(exp, exp, x)
+UNARY_CASE(log, log, y)
+UNARY_CASE(sqrt, sqrt, y)
+
+static void rsqrtScalar(void) {
+    for (size_t i = 0; i < N; i++)
+        out[i] = 1.0f / sqrtRef(y[i]);
+}
+static void rsqrtLoop(void) {
+    for (size_t i = 0; i < N; i++)
+        out[i] = 1.0f / LIBM(sqrt)(y[i]);
+}
+BINARY_CASE(atan2, atan2, y, x)
+BINARY_CASE(pow, pow, y, x)
+
+static void sincosScalar(void) {
+    for (size_t i = 0; i < N; i++) {
+        out[i] = sinRef(x[i]);
+        out2[i] = cosRef(x[i]);
+    }
+}
+static void sincosLoop(void) {
+    for (size_t i = 0; i < N; i++) {
+        out[i] = LIBM(sin)(x[i]);
+        out2[i] = LIBM(cos)(x[i]);
+    }
+}
+
+static void sinBatch(void) {
+    SinBatch(x, out, N);
+}
+static void cosBatch(void) {
+    CosBatch(x, out, N);
+}
+static void sincosBatch(void) {
+    SinCosBatch(x, out, out2, N);
+}
+static void tanBatch(void) {
+    TanBatch(x, out, N);
+}
+static void atan2Batch(void) {
+    Atan2Batch(y, x, out, N);
+}
+static void expBatch(void) {
+    ExpBatch(x, out, N);
+}
+static void logBatch(void) {
+    LogBatch(y, out, N);
+}
+static void powBatch(void) {
+    PowBatch(y, x, out, N);
+}
+static void sqrtBatch(void) {
+    SqrtBatch(y, out, N, NML_SQRT_PRECISE);
+}
+static void rsqrtFastBatch(void) {
+    RSqrtBatch(y, out, N, NML_SQRT_FAST);
+}
+static void rsqrtRefinedBatch(void) {
+    RSqrtBatch(y, out, N, NML_SQRT_REFINED);
+}
+static void rsqrtPreciseBatch(void) {
+    RSqrtBatch(y, out, N, NML_SQRT_PRECISE);
+}
+
+// nanoseconds per value
+static double bench(void (*fn)(void)) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        fn();
+    }
+    return run.best / N * 1e9;
+}
+
+static void row(const char *name,
+                void (*scalar)(void),
+                void (*loop)(void),
+                void (*batch)(void)) {
+    double tScalar = bench(scalar), tLoop = bench(loop), tBatch = bench(batch);
+    printf("  %-8s %8.2f ns %8.2f ns %8.2f ns %8.1f M/s %6.1fx %6.1fx\n", name,
+           tScalar, tLoop, tBatch, 1e3 / tBatch, tScalar / tBatch,
+           tLoop / tBatch);
+}
+
+int main(void) {
+    // x in [-10, 10] (also the exponent of pow), y in (0, 100]
+    srand(1);
+    for (size_t i = 0; i < N; i++) {
+        x[i] = (nml_t)rand() / RAND_MAX * 20.0 - 10.0;
+        y[i] = (nml_t)(rand() + 1) / RAND_MAX * 100.0;
+    }
+
+    printf("elementary functions over %d values, %s build, backend %s\n", N,
+           sizeof(nml_t) == 8 ? "double" : "float", cpuBackendName());
+    printf("  %-8s %11s %11s %11s %12s %14s\n", "", "libm call", "libm loop",
+           "batch", "batch", "speedup");
+    row("sin", sinScalar, sinLoop, sinBatch);
+    row("cos", cosScalar, cosLoop, cosBatch);
+    row("sincos", sincosScalar, sincosLoop, sincosBatch);
+    row("tan", tanScalar, tanLoop, tanBatch);
+    row("atan2", atan2Scalar, atan2Loop, atan2Batch);
+    row("exp", expScalar, expLoop, expBatch);
+    row("log", logScalar, logLoop, logBatch);
+    row("pow", powScalar, powLoop, powBatch);
+    // 1 / sqrt against the three accuracy tiers
+    row("sqrt", sqrtScalar, sqrtLoop, sqrtBatch);
+    row("rsqrt0", rsqrtScalar, rsqrtLoop, rsqrtFastBatch);
+    row("rsqrt1", rsqrtScalar, rsqrtLoop, rsqrtRefinedBatch);
+    row("rsqrt2", rsqrtScalar, rsqrtLoop, rsqrtPreciseBatch);
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "utils/cpu.h"
+#include "vector/vec4d.h"
+#include "bench_timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPS 7
+#define COUNT (1u << 16)
+#define PASSES 64
+
+/*
+ * the scalar code the simd vec4 functions replaced, on the old unaligned
+ * layout. both sides are called through a function table so the call
+ * overhead is the same and only the bodies are compared
+ */
+
+typedef union ScalarVec4 {
+    struct {
+        nml_t x, y, z, w;
+    };
+    nml_t elems[4];
+} ScalarVec4;
+
+static int scalarAdd(ScalarVec4 *a, ScalarVec4 *b, ScalarVec4 *out) {
+    out->x = a->x + b->x;
+    out->y = a->y + b->y;
+    out->z = a->z + b->z;
+    out->w = a->w + b->w;
+    return 0;
+}
+
+static int scalarScale(ScalarVec4 *a, nml_t s, ScalarVec4 *out) {
+    out->x = a->x * s;
+    out->y = a->y * s;
+    out->z = a->z * s;
+    out->w = a->w * s;
+    return 0;
+}
+
+static nml_t scalarDot(ScalarVec4 *a, ScalarVec4 *b) {
+    return a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
+}
+
+static int scalarNormalize(ScalarVec4 *a, ScalarVec4 *out) {
+    nml_t l = sqrt(a->x * a->x + a->y * a->y + a->z * a->z + a->w * a->w);
+    out->x = a->x / l;
+    out->y = a->y / l;
+    out->z = a->z / l;
+    out->w = a->w / l;
+    return 0;
+}
+
+static int scalarReflect(ScalarVec4 *a, ScalarVec4 *b, ScalarVec4 *out) {
+    nml_t lenSqr = scalarDot(b, b);
+    nml_t scaler = 2.0 * scalarDot(a, b) / lenSqr;
+    out->x = a->x - scaler * b->x;
+    out->y = a->y - scaler * b->y;
+    out->z = a->z - scaler * b->z;
+    out->w = a->w - scaler * b->w;
+    return 0;
+}
+
+typedef enum { OP_ADD, OP_SCALE, OP_DOT, OP_NORMALIZE, OP_REFLECT } Op;
+
+static const char *opNames[] = {"add", "scale", "dot", "normalize", "reflect"};
+
+// dot results are summed into a volatile sink so the loop is not dropped
+static volatile nml_t sink;
+
+// one pass of op over all vectors, the table is read back through a
+// volatile so the calls can not be devirtualized and inlined
+#define DEFINE_RUN(name, T, ...)                                               \
+    typedef struct name##Impl {                                                \
+        int (*add)(T *, T *, T *);                                             \
+        int (*scale)(T *, nml_t, T *);                                         \
+        nml_t (*dot)(T *, T *);                                                \
+        int (*normalize)(T *, T *);                                            \
+        int (*reflect)(T *, T *, T *);                                         \
+    } name##Impl;                                                              \
+    static const name##Impl name##Table = {__VA_ARGS__};                      \
+    static void name(Op op, T *a, T *b, T *out) {                              \
+        const name##Impl *volatile table = &name##Table;                       \
+        const name##Impl *impl = table;                                        \
+        nml_t acc = 0.0;                                                       \
+        for (size_t i = 0; i < COUNT; i++) {                                   \
+            switch (op) {                                                      \
+            case OP_ADD:                                                       \
+                impl->add(&a[i], &b[i], &out[i]);                              \
+                break;                                                         \
+            case OP_SCALE:                                                     \
+                impl->scale(&a[i], 0.5, &out[i]);                              \
+                break;                                                         \
+            case OP_DOT:                                                       \
+                acc += impl->dot(&a[i], &b[i]);                                \
+                break;                                                         \
+            case OP_NORMALIZE:                                                 \
+                impl->normalize(&a[i], &out[i]);                               \
+                break;                                                         \
+            case OP_REFLECT:                                                   \
+                impl->reflect(&a[i], &b[i], &out[i]);                          \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+        sink = acc;                                                            \
+    }
+
+DEFINE_RUN(runScalar, ScalarVec4, scalarAdd, scalarScale, scalarDot,
+           scalarNormalize, scalarReflect)
+DEFINE_RUN(runSimd, Vec4, vec4Add, vec4Scale, vec4Dot, vec4Normalize, vec4Reflect)
+
+static double benchScalar(Op op, ScalarVec4 *a, ScalarVec4 *b, ScalarVec4 *out) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (int p = 0; p < PASSES; p++) {
+            runScalar(op, a, b, out);
+        }
+    }
+    return run.best;
+}
+
+// the whole array in one call, zero vectors handled by masks not branches
+static double benchNormalizeBatch(Vec4 *a, Vec4 *out) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (int p = 0; p < PASSES; p++) {
+            vec4NormalizeBatch(a, out, COUNT, NULL, NULL);
+        }
+    }
+    return run.best;
+}
+
+static double benchSimd(Op op, Vec4 *a, Vec4 *b, Vec4 *out) {
+    BenchBest run = benchBestOf(REPS);
+    while (benchNextRun(&run)) {
+        for (int p = 0; p < PASSES; p++) {
+            runSimd(op, a, b, out);
+        }
+    }
+    return run.best;
+}
+
+int main(void) {
+    Vec4 *a = malloc(COUNT * sizeof(Vec4));
+    Vec4 *b = malloc(COUNT * sizeof(Vec4));
+    Vec4 *out = malloc(COUNT * sizeof(Vec4));
+    // offset by one lane so the scalar side really runs on unaligned data
+    nml_t *sa = malloc((COUNT + 1) * sizeof(ScalarVec4));
+    nml_t *sb = malloc((COUNT + 1) * sizeof(ScalarVec4));
+    nml_t *sout = malloc((COUNT + 1) * sizeof(ScalarVec4));
+    if (!a || !b || !out || !sa || !sb || !sout) {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+    ScalarVec4 *scalarA = (ScalarVec4 *)(sa + 1);
+    ScalarVec4 *scalarB = (ScalarVec4 *)(sb + 1);
+    ScalarVec4 *scalarOut = (ScalarVec4 *)(sout + 1);
+    for (size_t i = 0; i < COUNT; i++) {
+        vec4Init((nml_t)(i % 97) + 1.0, (nml_t)(i % 13), (nml_t)(i % 7), 1.0, &a[i]);
+        vec4Init(1.0, (nml_t)(i % 5) + 1.0, 2.0, (nml_t)(i % 3), &b[i]);
+        for (int k = 0; k < 4; k++) {
+            scalarA[i].elems[k] = a[i].elems[k];
+            scalarB[i].elems[k] = b[i].elems[k];
+        }
+    }
+
+    const double ops = (double)COUNT * PASSES;
+    printf("vec4 ops over %u vectors (%s)\n", COUNT, cpuBackendName());
+    printf("%10s %18s %18s %8s\n", "op", "scalar op/s", "simd op/s", "speedup");
+    for (Op op = OP_ADD; op <= OP_REFLECT; op++) {
+        double t_scalar = benchScalar(op, scalarA, scalarB, scalarOut);
+        double t_simd = benchSimd(op, a, b, out);
+        printf("%10s %18.4g %18.4g %7.2fx\n", opNames[op], ops / t_scalar,
+               ops / t_simd, t_scalar / t_simd);
+    }
+    double t_loop = benchSimd(OP_NORMALIZE, a, b, out);
+    double t_batch = benchNormalizeBatch(a, out);
+    printf("%10s %18.4g %18.4g %7.2fx  (vec4Normalize loop vs batch)\n",
+           "nrm batch", ops / t_loop, ops / t_batch, t_loop / t_batch);
+
+    free(a);
+    free(b);
+    free(out);
+    free(sa);
+    free(sb);
+    free(sout);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,11 @@
+function(add_numen_bench bench_name)
+    add_executable(${bench_name} ${ARGN})
+    target_include_directories(${bench_name} PRIVATE ${PROJECT_SOURCE_DIR}/bench)
+    target_link_libraries(${bench_name} PRIVATE numen_interface)
+
+    if(TARGET numen_shared)
+        target_link_libraries(${bench_name} PRIVATE numen_shared)
+    else()
+        target_link_libraries(${bench_name} PRIVATE numen_static)
+    endif()
+endfunction()
@@ -1,16 +1,48 @@
 option(BUILD_SHARED_LIBS "Build shared libraries" ON)
 option(BUILD_STATIC_LIBS "Build static libraries" ON)
+option(NUMEN_DOUBLE_PRECISION "Use double as the library scalar type (nml_t)" OFF)
+option(NUMEN_NATIVE_ARCH "Tune release builds for the build host (-march=native)" OFF)
 
 if(CMAKE_COMPILER_IS_GNUCC OR CMAKE_C_COMPILER_ID MATCHES "Clang")
     add_compile_options(-Wall -Wextra -pedantic -pipe)
     # add_compile_options("$<$<CONFIG:Debug>:-g3;-Og;-fno-omit-pointer;-fsanitize=address,undefined>")
     add_compile_options("$<$<CONFIG:Debug>:-g3;-Og>")
     add_compile_options("$<$<CONFIG:Release>:-D_FORTIFY_SOURCE=2;-fstack-protector-strong;-fPIE;-fPIC>")
-    add_compile_options("$<$<CONFIG:Release>:-O3;-ffast-math;-march=native>")
+    add_compile_options("$<$<CONFIG:Release>:-O3;-ffast-math>")
+    # wider x86 kernels are dispatched at runtime, -march=native only ties
+    # the binary to the build host
+    if(NUMEN_NATIVE_ARCH)
+        add_compile_options("$<$<CONFIG:Release>:-march=native>")
+    endif()
     add_link_options("$<$<CONFIG:Release>:-Wl,-z,relro>")
 endif()
 
 file(GLOB_RECURSE LIB_SOURCES "src/*.c")
+# headers shared between modules of the library, never installed
+set(NUMEN_INTERNAL_INCLUDE ${CMAKE_CURRENT_SOURCE_DIR}/src/internal)
+
+# the elementary function kernels rely on the exact rounding of their range
+# reductions and on nan / inf compares, the ray kernels on the infinities of
+# zero direction components. keep them out of -ffast-math (source properties
+# are per directory, other directories building LIB_SOURCES repeat this with
+# STRICT_FP_SOURCES)
+set(STRICT_FP_SOURCES
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/utils/vmath.c
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/utils/vmath_avx2.c
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/geometry/ray.c
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/geometry/ray_avx2.c
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/geometry/bvh.c
+)
+if(CMAKE_COMPILER_IS_GNUCC OR CMAKE_C_COMPILER_ID MATCHES "Clang")
+    set_source_files_properties(${STRICT_FP_SOURCES}
+        PROPERTIES COMPILE_OPTIONS "-fno-fast-math"
+    )
+endif()
+
+# the batch apis run on a pthread pool (utils/thread.h). linked as the plain
+# flag so the exported targets don't reference Threads::Threads
+set(THREADS_PREFER_PTHREAD_FLAG ON)
+find_package(Threads REQUIRED)
 
 # interface target for includes
 add_library(numen_interface INTERFACE)
@@ -18,11 +50,16 @@ target_include_directories(numen_interface INTERFACE
     $<BUILD_INTERFACE:${CMAKE_CURRENT_SOURCE_DIR}/numen>
     $<INSTALL_INTERFACE:include>
 )
+# nml_t is part of the ABI, consumers must agree with the library on it
+if(NUMEN_DOUBLE_PRECISION)
+    target_compile_definitions(numen_interface INTERFACE USE_DOUBLE_PRECISION)
+endif()
 
 # shared library
 if(BUILD_SHARED_LIBS)
     add_library(numen_shared SHARED ${LIB_SOURCES})
-    target_link_libraries(numen_shared PUBLIC numen_interface m)
+    target_link_libraries(numen_shared PUBLIC numen_interface m ${CMAKE_THREAD_LIBS_INIT})
+    target_include_directories(numen_shared PRIVATE ${NUMEN_INTERNAL_INCLUDE})
     set_target_properties(numen_shared PROPERTIES 
         OUTPUT_NAME "numen" 
         VERSION ${PROJECT_VERSION} 
@@ -33,7 +70,8 @@ endif()
 # static library
 if(BUILD_STATIC_LIBS)
     add_library(numen_static STATIC ${LIB_SOURCES})
-    target_link_libraries(numen_static PUBLIC numen_interface m)
+    target_link_libraries(numen_static PUBLIC numen_interface m ${CMAKE_THREAD_LIBS_INIT})
+    target_include_directories(numen_static PRIVATE ${NUMEN_INTERNAL_INCLUDE})
     set_target_properties(numen_static PROPERTIES OUTPUT_NAME "numen")
     if(WIN32)
         set_target_properties(numen_static PROPERTIES OUTPUT_NAME "numen_s")
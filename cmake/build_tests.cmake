@@ -1,6 +1,7 @@
 function(add_numen_test test_name)
     add_executable(${test_name} ${ARGN})
-    target_include_directories(${test_name} PRIVATE ${PROJECT_SOURCE_DIR}/nutest)
+    target_include_directories(${test_name} PRIVATE
+        ${PROJECT_SOURCE_DIR}/nutest ${PROJECT_SOURCE_DIR}/tests)
     target_link_libraries(${test_name} PRIVATE numen_interface)
 
     if(TARGET numen_shared)
@@ -11,3 +12,32 @@ function(add_numen_test test_name)
 
     add_test(NAME ${test_name} COMMAND ${test_name})
 endfunction()
+
+# same test linked against a library built with the other scalar type, so
+# both the f32 and f64 kernels get exercised from a single configuration
+function(add_numen_test_f64 test_name)
+    add_executable(${test_name}_f64 ${ARGN})
+    target_include_directories(${test_name}_f64 PRIVATE
+        ${PROJECT_SOURCE_DIR}/nutest ${PROJECT_SOURCE_DIR}/tests)
+    target_link_libraries(${test_name}_f64 PRIVATE numen_f64)
+
+    add_test(NAME ${test_name}_f64 COMMAND ${test_name}_f64)
+endfunction()
+
+# same test built with NUMEN_INLINE, the per-value vector and matrix
+# functions come from the headers and only the batch apis from the library
+function(add_numen_test_inline test_name)
+    add_executable(${test_name}_inline ${ARGN})
+    target_include_directories(${test_name}_inline PRIVATE
+        ${PROJECT_SOURCE_DIR}/nutest ${PROJECT_SOURCE_DIR}/tests)
+    target_compile_definitions(${test_name}_inline PRIVATE NUMEN_INLINE)
+    target_link_libraries(${test_name}_inline PRIVATE numen_interface)
+
+    if(TARGET numen_shared)
+        target_link_libraries(${test_name}_inline PRIVATE numen_shared)
+    else()
+        target_link_libraries(${test_name}_inline PRIVATE numen_static)
+    endif()
+
+    add_test(NAME ${test_name}_inline COMMAND ${test_name}_inline)
+endfunction()
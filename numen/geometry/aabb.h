@@ -0,0 +1,70 @@
+#ifndef __GEOMETRY_AABB_H__
+#define __GEOMETRY_AABB_H__
+
+#include "utils/consts.h"
+#include "vector/vec3d.h"
+#include "vector/vecstream.h"
+#include <float.h>
+#include <stdbool.h>
+
+/*
+ * axis aligned bounding boxes
+ *
+ * an empty box has min = +NML_AABB_HUGE and max = -NML_AABB_HUGE in every
+ * component, so extending it by a point or a union with another box gives
+ * the other operand back
+ */
+
+// largest finite nml_t
+#if defined(USE_DOUBLE_PRECISION)
+#    define NML_AABB_HUGE DBL_MAX
+#else
+#    define NML_AABB_HUGE FLT_MAX
+#endif
+
+typedef struct AABB {
+    Vec3 min, max;
+} AABB;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+int aabbInitEmpty(AABB *bOut);
+// bounds of a point stream, empty for no points
+int aabbFromPoints(const Vec3Stream *points, AABB *bOut);
+// box grown to contain point
+int aabbExtend(const AABB *box, const Vec3 *point, AABB *bOut);
+int aabbUnion(const AABB *box1, const AABB *box2, AABB *bOut);
+int aabbCenter(const AABB *box, Vec3 *vOut);
+
+// total area of the six faces, 0 for an empty box
+nml_t aabbSurfaceArea(const AABB *box);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+/*
+ * box utilities
+ */
+
+static inline bool aabbIsEmpty(const AABB *box) {
+    return box->min.x > box->max.x || box->min.y > box->max.y ||
+           box->min.z > box->max.z;
+}
+
+// boxes sharing a face or corner overlap
+static inline bool aabbOverlaps(const AABB *box1, const AABB *box2) {
+    return box1->min.x <= box2->max.x && box2->min.x <= box1->max.x &&
+           box1->min.y <= box2->max.y && box2->min.y <= box1->max.y &&
+           box1->min.z <= box2->max.z && box2->min.z <= box1->max.z;
+}
+
+static inline bool aabbContains(const AABB *box, const Vec3 *point) {
+    return point->x >= box->min.x && point->x <= box->max.x &&
+           point->y >= box->min.y && point->y <= box->max.y &&
+           point->z >= box->min.z && point->z <= box->max.z;
+}
+
+#endif // !__GEOMETRY_AABB_H__
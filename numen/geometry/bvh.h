@@ -0,0 +1,105 @@
+#ifndef __GEOMETRY_BVH_H__
+#define __GEOMETRY_BVH_H__
+
+#include "geometry/aabb.h"
+#include "geometry/ray.h"
+#include "utils/consts.h"
+#include "vector/vecstream.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * bounding volume hierarchies over triangles or points
+ *
+ * built top down with a binned surface area heuristic, the upper levels
+ * bin in parallel and the subtrees below them are built on separate
+ * threads. nodes are 4 wide, the bounds of the four children are stored
+ * component by component so one ray or box is tested against all four with
+ * one vector compare
+ *
+ * the hierarchy keeps its own copy of the primitives in leaf order, queries
+ * report the primitive's index in the arrays it was built from. when the
+ * vertices move but the primitives stay the same, a refit recomputes the
+ * bounds in O(n) without rebuilding. the tree quality degrades as the
+ * geometry drifts from the one it was built for
+ */
+
+// children per node
+#define NML_BVH_WIDTH 4
+// most primitives per leaf
+#define NML_BVH_MAX_LEAF 16
+// child slot of a node with fewer than NML_BVH_WIDTH children
+#define NML_BVH_EMPTY UINT32_MAX
+
+// primitive kind
+enum {
+    NML_BVH_TRIANGLES = 0,
+    NML_BVH_POINTS = 1,
+};
+
+/*
+ * child c is a leaf when count[c] > 0, holding the primitives
+ * [child[c], child[c] + count[c]) of the leaf order, and an inner node
+ * (index child[c]) when count[c] == 0. unused slots hold NML_BVH_EMPTY.
+ * children have higher indices than their parents, node 0 is the root
+ */
+typedef struct BVHNode {
+    nml_t minX[NML_BVH_WIDTH], minY[NML_BVH_WIDTH], minZ[NML_BVH_WIDTH];
+    nml_t maxX[NML_BVH_WIDTH], maxY[NML_BVH_WIDTH], maxZ[NML_BVH_WIDTH];
+    uint32_t child[NML_BVH_WIDTH];
+    uint32_t count[NML_BVH_WIDTH];
+} BVHNode;
+
+typedef struct BVH {
+    BVHNode *nodes;
+    size_t nodeCount;
+    // index in the build input of each primitive in leaf order
+    uint32_t *prims;
+    size_t primCount;
+    int kind;
+    // the primitives in leaf order, tris for NML_BVH_TRIANGLES and points
+    // for NML_BVH_POINTS
+    TriangleStream tris;
+    Vec3Stream points;
+    AABB bounds;
+} BVH;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/*
+ * leafSize is the most primitives per leaf, 0 picks the default of 4, more
+ * than NML_BVH_MAX_LEAF is NML_EINVAL. so are more than UINT32_MAX
+ * primitives. release with bvhFree
+ */
+
+int bvhBuildTriangles(const TriangleStream *tris, size_t leafSize, BVH *bvhOut);
+int bvhBuildPoints(const Vec3Stream *points, size_t leafSize, BVH *bvhOut);
+void bvhFree(BVH *bvh);
+
+// new vertex positions for the primitives bvh was built from, same count
+// and order. NML_EINVAL for a count or kind mismatch
+int bvhRefitTriangles(BVH *bvh, const TriangleStream *tris);
+int bvhRefitPoints(BVH *bvh, const Vec3Stream *points);
+
+// closest triangle hit by ray, as rayClosestTriangle of geometry/ray.h but
+// without the lowest index guarantee on ties
+int bvhIntersectRay(const BVH *bvh, const Ray *ray, RayHit *hit);
+// closest triangle of every ray of the packet, recorded in the packet as
+// rayPacketIntersectTriangle does
+int bvhIntersectPacket(const BVH *bvh, RayPacket *packet);
+
+// primitives whose bounds overlap box, in no particular order. the first
+// capacity of them are written to indices, *found is the number there are
+int bvhQueryBox(const BVH *bvh,
+                const AABB *box,
+                uint32_t *indices,
+                size_t capacity,
+                size_t *found);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__GEOMETRY_BVH_H__
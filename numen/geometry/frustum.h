@@ -0,0 +1,82 @@
+#ifndef __GEOMETRY_FRUSTUM_H__
+#define __GEOMETRY_FRUSTUM_H__
+
+#include "matrix/mat4d.h"
+#include "utils/consts.h"
+#include "vector/vec4d.h"
+#include "vector/vecstream.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * view frustum culling
+ *
+ * the six planes of a view-projection matrix, each (a, b, c, d) with a unit
+ * normal pointing into the frustum, so a * x + b * y + c * z + d is the
+ * signed distance of a point. bounds are passed as streams (one array per
+ * component) and tested 4 objects at a time, 8 on avx2 hosts
+ *
+ * the tests are conservative: a box or sphere outside the frustum but not
+ * fully behind any single plane (next to an edge or corner) counts as
+ * visible. nothing visible is ever culled
+ */
+
+typedef struct Frustum {
+    Vec4 planes[6]; // left, right, bottom, top, near, far
+} Frustum;
+
+// options for frustumFromMat4
+enum {
+    // clip space depth is [0, w] (direct3d, vulkan, metal) instead of the
+    // opengl [-w, w]
+    NML_FRUSTUM_DEPTH_ZERO_ONE = 1 << 0,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// planes of viewProj (column vectors, clip = viewProj * v). a plane with no
+// normal, like the far plane of an infinite projection, is kept as is and
+// never culls anything
+int frustumFromMat4(const Mat4 *viewProj, unsigned int options, Frustum *fOut);
+
+/*
+ * bitmask form: bit i % 32 of bits[i / 32] is set when object i may be
+ * visible. bits needs (count + 31) / 32 words, the unused high bits of the
+ * last one are cleared
+ */
+
+// spheres centers[i] with radius radii[i]
+int frustumTestSpheres(const Frustum *frustum,
+                       const Vec3Stream *centers,
+                       const nml_t *radii,
+                       uint32_t *bits);
+// axis aligned boxes [mins[i], maxs[i]], NML_EINVAL if the counts differ
+int frustumTestBoxes(const Frustum *frustum,
+                     const Vec3Stream *mins,
+                     const Vec3Stream *maxs,
+                     uint32_t *bits);
+
+/*
+ * index form: the indices of the objects that may be visible, in increasing
+ * order, *visibleCount of them. indices needs room for count entries, more
+ * than UINT32_MAX objects are NML_EINVAL
+ */
+
+int frustumCullSpheres(const Frustum *frustum,
+                       const Vec3Stream *centers,
+                       const nml_t *radii,
+                       uint32_t *indices,
+                       size_t *visibleCount);
+int frustumCullBoxes(const Frustum *frustum,
+                     const Vec3Stream *mins,
+                     const Vec3Stream *maxs,
+                     uint32_t *indices,
+                     size_t *visibleCount);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__GEOMETRY_FRUSTUM_H__
@@ -0,0 +1,116 @@
+#ifndef __GEOMETRY_RAY_H__
+#define __GEOMETRY_RAY_H__
+
+#include "utils/consts.h"
+#include "vector/vec3d.h"
+#include "vector/vecstream.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * ray intersection kernels
+ *
+ * slab tests against axis aligned boxes and moller-trumbore tests against
+ * triangles, in two shapes: one ray against a stream of primitives, and a
+ * packet of up to NML_RAY_PACKET rays against one primitive. both run 4
+ * lanes per step, 8 on avx2 hosts
+ *
+ * a ray hits at distance t when 0 <= t <= tMax, t is measured in units of
+ * dir, which need not be normalized. triangles are hit from both sides. a
+ * ray whose direction has a zero component and whose origin lies exactly on
+ * a box face parallel to it may be reported either way
+ */
+
+// rays per packet
+#define NML_RAY_PACKET 8
+
+// RayHit.index and RayPacket.index of a ray that has hit nothing
+#define NML_RAY_MISS UINT32_MAX
+
+typedef struct Ray {
+    Vec3 origin;
+    Vec3 dir;
+    nml_t tMax;
+} Ray;
+
+// triangle i has the corners (v0[i], v1[i], v2[i]), the counts must match
+typedef struct TriangleStream {
+    Vec3Stream v0, v1, v2;
+} TriangleStream;
+
+// hit point origin + t * dir = (1 - u - v) * v0 + u * v1 + v * v2
+typedef struct RayHit {
+    nml_t t, u, v;
+    uint32_t index;
+} RayHit;
+
+/*
+ * up to NML_RAY_PACKET rays in structure-of-arrays form. t starts at each
+ * ray's tMax and shrinks as closer triangles are found, so box tests only
+ * accept boxes in front of the closest hit so far. unused lanes have t < 0
+ * and never hit anything
+ */
+typedef struct RayPacket {
+    nml_t ox[NML_RAY_PACKET], oy[NML_RAY_PACKET], oz[NML_RAY_PACKET];
+    nml_t dx[NML_RAY_PACKET], dy[NML_RAY_PACKET], dz[NML_RAY_PACKET];
+    // reciprocal directions for the slab tests
+    nml_t invX[NML_RAY_PACKET], invY[NML_RAY_PACKET], invZ[NML_RAY_PACKET];
+    // closest hit so far
+    nml_t t[NML_RAY_PACKET], u[NML_RAY_PACKET], v[NML_RAY_PACKET];
+    uint32_t index[NML_RAY_PACKET];
+} RayPacket;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/*
+ * one ray against a stream. bit i % 32 of bits[i / 32] is set when
+ * primitive i is hit, bits needs (count + 31) / 32 words and the unused high
+ * bits of the last one are cleared. tOut (unless NULL) receives count
+ * distances, the entry distance for a box (0 when the origin is inside) and
+ * the hit distance for a triangle, INFINITY for a miss
+ */
+
+// boxes [mins[i], maxs[i]], NML_EINVAL if the counts differ
+int rayTestBoxes(const Ray *ray,
+                 const Vec3Stream *mins,
+                 const Vec3Stream *maxs,
+                 nml_t *tOut,
+                 uint32_t *bits);
+// NML_EINVAL if the counts differ
+int rayTestTriangles(const Ray *ray,
+                     const TriangleStream *tris,
+                     nml_t *tOut,
+                     uint32_t *bits);
+// closest triangle hit by ray, the lowest index on ties. hit->index is
+// NML_RAY_MISS (and the rest of *hit unset) when there is none
+int rayClosestTriangle(const Ray *ray, const TriangleStream *tris, RayHit *hit);
+
+/*
+ * packets, bit k of *mask stands for ray k
+ */
+
+// pack rays[0 .. n), 1 <= n <= NML_RAY_PACKET, with no hits yet
+int rayPacketInit(const Ray *rays, size_t n, RayPacket *pOut);
+// rays of the packet that enter the box [min, max] before their closest hit
+int rayPacketTestBox(const RayPacket *packet,
+                     const Vec3 *min,
+                     const Vec3 *max,
+                     uint32_t *mask);
+// record triangle (v0, v1, v2) as hit number index for every ray that hits
+// it closer than its previous hit. mask (unless NULL) receives those rays
+int rayPacketIntersectTriangle(RayPacket *packet,
+                               const Vec3 *v0,
+                               const Vec3 *v1,
+                               const Vec3 *v2,
+                               uint32_t index,
+                               uint32_t *mask);
+// closest hit of ray k of the packet, hit->index is NML_RAY_MISS if none
+int rayPacketGetHit(const RayPacket *packet, size_t k, RayHit *hit);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__GEOMETRY_RAY_H__
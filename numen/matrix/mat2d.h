@@ -2,6 +2,7 @@
 #define __MAT2D_H__
 
 #include "utils/consts.h"
+#include "utils/inline.h"
 #include "vector/vec2d.h"
 
 typedef union Mat2 {
@@ -9,23 +10,30 @@ typedef union Mat2 {
     Vec2 cols[2];
 } Mat2;
 
-int mat2Init(const nml_t arr[4], Mat2 *mOut);
-int mat2InitZero(Mat2 *mOut);
+NML_API int mat2Init(const nml_t arr[4], Mat2 *mOut);
+NML_API int mat2InitZero(Mat2 *mOut);
 // initialize a diagonal matrix
-int mat2Diagonal(nml_t val, Mat2 *mOut);
+NML_API int mat2Diagonal(nml_t val, Mat2 *mOut);
 // initialize a identity matrix
-int mat2Identity(Mat2 *mOut);
+NML_API int mat2Identity(Mat2 *mOut);
 
-int mat2Add(Mat2 *mat1, Mat2 *mat2, Mat2 *mOut);
+NML_API int mat2Add(Mat2 *mat1, Mat2 *mat2, Mat2 *mOut);
 // subtract mat2 form mat1
-int mat2Sub(Mat2 *mat1, Mat2 *mat2, Mat2 *mOut);
+NML_API int mat2Sub(Mat2 *mat1, Mat2 *mat2, Mat2 *mOut);
 
-int mat2Scale(Mat2 *mat, nml_t s, Mat2 *mOut);
-int mat2Negate(Mat2 *mat, Mat2 *mOut);
+NML_API int mat2Scale(Mat2 *mat, nml_t s, Mat2 *mOut);
+NML_API int mat2Negate(Mat2 *mat, Mat2 *mOut);
 
 // matrix multiplication
-int mat2Hadamard(Mat2 *mat1, Mat2 *mat2, Mat2 *mOut);
-int mat2MulVec2(Mat2 *mat, Vec2 *vec, Vec2 *vOut);
-int mat2MulMat2(Mat2 *mat1, Mat2 *mat2, Mat2 *mOut);
+NML_API int mat2Hadamard(Mat2 *mat1, Mat2 *mat2, Mat2 *mOut);
+NML_API int mat2MulVec2(Mat2 *mat, Vec2 *vec, Vec2 *vOut);
+NML_API int mat2MulMat2(Mat2 *mat1, Mat2 *mat2, Mat2 *mOut);
+
+// mOut may be the same matrix as mat
+NML_API int mat2Transpose(Mat2 *mat, Mat2 *mOut);
+
+#if defined(NUMEN_INLINE)
+#    include "matrix/mat2d_inline.h"
+#endif
 
 #endif // !__MAT2D_H__
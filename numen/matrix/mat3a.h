@@ -0,0 +1,40 @@
+#ifndef __MAT3A_H__
+#define __MAT3A_H__
+
+#include "matrix/mat3d.h"
+#include "utils/consts.h"
+#include "utils/inline.h"
+#include "utils/simd.h"
+#include "vector/vec3a.h"
+
+// Mat3 with every column padded to a Vec3A (pad lanes kept at zero)
+typedef union Mat3A {
+    nml_t elems[12];
+    Vec3A cols[3];
+} Mat3A ALIGN_16;
+
+NML_API int mat3AFromMat3(Mat3 *mat, Mat3A *mOut);
+NML_API int mat3AToMat3(Mat3A *mat, Mat3 *mOut);
+NML_API int mat3AInitZero(Mat3A *mOut);
+NML_API int mat3ADiagonal(nml_t val, Mat3A *mOut);
+NML_API int mat3AIdentity(Mat3A *mOut);
+
+NML_API int mat3AAdd(Mat3A *mat1, Mat3A *mat2, Mat3A *mOut);
+// subtract mat2 form mat1
+NML_API int mat3ASub(Mat3A *mat1, Mat3A *mat2, Mat3A *mOut);
+
+NML_API int mat3AScale(Mat3A *mat, nml_t s, Mat3A *mOut);
+NML_API int mat3ANegate(Mat3A *mat, Mat3A *mOut);
+// mOut may be the same matrix as mat
+NML_API int mat3ATranspose(Mat3A *mat, Mat3A *mOut);
+
+// matrix multiplication, mOut may alias either operand
+NML_API int mat3AHadamard(Mat3A *mat1, Mat3A *mat2, Mat3A *mOut);
+NML_API int mat3AMulVec3A(Mat3A *mat, Vec3A *vec, Vec3A *vOut);
+NML_API int mat3AMulMat3A(Mat3A *mat1, Mat3A *mat2, Mat3A *mOut);
+
+#if defined(NUMEN_INLINE)
+#    include "matrix/mat3a_inline.h"
+#endif
+
+#endif // !__MAT3A_H__
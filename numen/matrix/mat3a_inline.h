@@ -0,0 +1,145 @@
+#ifndef __MAT3A_INLINE_H__
+#define __MAT3A_INLINE_H__
+
+#include "matrix/mat3a.h"
+#include "utils/errors.h"
+#include "utils/inline.h"
+#include "utils/simd.h"
+#include <stddef.h>
+#include <string.h>
+
+// definitions of mat3a.h, static inline with NUMEN_INLINE (utils/inline.h)
+// and compiled into the library otherwise
+
+NML_API int mat3AFromMat3(Mat3 *mat, Mat3A *mOut) {
+    is_null(mat, mOut);
+    Mat3 m = *mat;
+    for (int i = 0; i < 3; i++) {
+        vec3AFromVec3(&m.cols[i], &mOut->cols[i]);
+    }
+    return NML_SUCCESS;
+}
+
+NML_API int mat3AToMat3(Mat3A *mat, Mat3 *mOut) {
+    is_null(mat, mOut);
+    for (int i = 0; i < 3; i++) {
+        vec3AToVec3(&mat->cols[i], &mOut->cols[i]);
+    }
+    return NML_SUCCESS;
+}
+
+NML_API int mat3AInitZero(Mat3A *mOut) {
+    is_null(mOut);
+    memset(mOut, 0, sizeof(Mat3A));
+    return NML_SUCCESS;
+}
+
+NML_API int mat3ADiagonal(nml_t val, Mat3A *mOut) {
+    is_null(mOut);
+    memset(mOut, 0, sizeof(Mat3A));
+    for (int i = 0; i < 3; i++) {
+        mOut->elems[i * 4 + i] = val;
+    }
+    return NML_SUCCESS;
+}
+
+NML_API int mat3AIdentity(Mat3A *mOut) {
+    return mat3ADiagonal(1.0, mOut);
+}
+
+NML_API int mat3AAdd(Mat3A *mat1, Mat3A *mat2, Mat3A *mOut) {
+    is_null(mat1, mat2, mOut);
+    for (int i = 0; i < 12; i += 4) {
+        simd_store_nml4(&mOut->elems[i],
+                        simd_add_nml4(simd_load_nml4(&mat1->elems[i]),
+                                      simd_load_nml4(&mat2->elems[i])));
+    }
+    return NML_SUCCESS;
+}
+
+NML_API int mat3ASub(Mat3A *mat1, Mat3A *mat2, Mat3A *mOut) {
+    is_null(mat1, mat2, mOut);
+    for (int i = 0; i < 12; i += 4) {
+        simd_store_nml4(&mOut->elems[i],
+                        simd_sub_nml4(simd_load_nml4(&mat1->elems[i]),
+                                      simd_load_nml4(&mat2->elems[i])));
+    }
+    return NML_SUCCESS;
+}
+
+NML_API int mat3AHadamard(Mat3A *mat1, Mat3A *mat2, Mat3A *mOut) {
+    is_null(mat1, mat2, mOut);
+    for (int i = 0; i < 12; i += 4) {
+        simd_store_nml4(&mOut->elems[i],
+                        simd_mul_nml4(simd_load_nml4(&mat1->elems[i]),
+                                      simd_load_nml4(&mat2->elems[i])));
+    }
+    return NML_SUCCESS;
+}
+
+NML_API int mat3AScale(Mat3A *mat, nml_t s, Mat3A *mOut) {
+    is_null(mat, mOut);
+    simd_nml4_t scaler = simd_set1_nml4(s);
+    for (int i = 0; i < 12; i += 4) {
+        simd_store_nml4(&mOut->elems[i],
+                        simd_mul_nml4(simd_load_nml4(&mat->elems[i]), scaler));
+    }
+    return NML_SUCCESS;
+}
+
+NML_API int mat3ANegate(Mat3A *mat, Mat3A *mOut) {
+    is_null(mat, mOut);
+    for (int i = 0; i < 12; i += 4) {
+        simd_store_nml4(&mOut->elems[i],
+                        simd_negate_nml4(simd_load_nml4(&mat->elems[i])));
+    }
+    return NML_SUCCESS;
+}
+
+NML_API int mat3ATranspose(Mat3A *mat, Mat3A *mOut) {
+    is_null(mat, mOut);
+    simd_nml4_t c0 = simd_load_nml4(&mat->elems[0]);
+    simd_nml4_t c1 = simd_load_nml4(&mat->elems[4]);
+    simd_nml4_t c2 = simd_load_nml4(&mat->elems[8]);
+    // the zero pad row becomes the pad lane of every column
+    simd_nml4_t c3 = simd_set1_nml4(0.0);
+
+    simd_transpose4_nml4(c0, c1, c2, c3);
+
+    simd_store_nml4(&mOut->elems[0], c0);
+    simd_store_nml4(&mOut->elems[4], c1);
+    simd_store_nml4(&mOut->elems[8], c2);
+    return NML_SUCCESS;
+}
+
+NML_API int mat3AMulVec3A(Mat3A *mat, Vec3A *vec, Vec3A *vOut) {
+    is_null(mat, vec, vOut);
+    simd_nml4_t res =
+        simd_mul_nml4(simd_load_nml4(&mat->elems[0]), simd_set1_nml4(vec->x));
+    res = simd_fmadd_nml4(simd_load_nml4(&mat->elems[4]),
+                          simd_set1_nml4(vec->y), res);
+    res = simd_fmadd_nml4(simd_load_nml4(&mat->elems[8]),
+                          simd_set1_nml4(vec->z), res);
+    simd_store_nml4(vOut->elems, res);
+    return NML_SUCCESS;
+}
+
+NML_API int mat3AMulMat3A(Mat3A *mat1, Mat3A *mat2, Mat3A *mOut) {
+    is_null(mat1, mat2, mOut);
+    // a stays in registers, each column of b is read before the matching
+    // output column is written
+    simd_nml4_t a0 = simd_load_nml4(&mat1->elems[0]);
+    simd_nml4_t a1 = simd_load_nml4(&mat1->elems[4]);
+    simd_nml4_t a2 = simd_load_nml4(&mat1->elems[8]);
+
+    for (int i = 0; i < 3; i++) {
+        const Vec3A *b = &mat2->cols[i];
+        simd_nml4_t res = simd_mul_nml4(a0, simd_set1_nml4(b->x));
+        res = simd_fmadd_nml4(a1, simd_set1_nml4(b->y), res);
+        res = simd_fmadd_nml4(a2, simd_set1_nml4(b->z), res);
+        simd_store_nml4(mOut->cols[i].elems, res);
+    }
+    return NML_SUCCESS;
+}
+
+#endif // !__MAT3A_INLINE_H__
@@ -2,6 +2,7 @@
 #define __MAT3D_H__
 
 #include "utils/consts.h"
+#include "utils/inline.h"
 #include "vector/vec3d.h"
 
 typedef union Mat3 {
@@ -9,21 +10,28 @@ typedef union Mat3 {
     Vec3 cols[3];
 } Mat3;
 
-int mat3Init(const nml_t arr[9], Mat3 *mOut);
-int mat3InitZero(Mat3 *mOut);
-int mat3Diagonal(nml_t val, Mat3 *mOut);
-int mat3Identity(Mat3 *mOut);
+NML_API int mat3Init(const nml_t arr[9], Mat3 *mOut);
+NML_API int mat3InitZero(Mat3 *mOut);
+NML_API int mat3Diagonal(nml_t val, Mat3 *mOut);
+NML_API int mat3Identity(Mat3 *mOut);
 
-int mat3Add(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut);
+NML_API int mat3Add(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut);
 // subtract mat2 form mat1
-int mat3Sub(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut);
+NML_API int mat3Sub(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut);
 
-int mat3Scale(Mat3 *mat, nml_t s, Mat3 *mOut);
-int mat3Negate(Mat3 *mat, Mat3 *mOut);
+NML_API int mat3Scale(Mat3 *mat, nml_t s, Mat3 *mOut);
+NML_API int mat3Negate(Mat3 *mat, Mat3 *mOut);
 
 // matrix multiplication
-int mat3Hadamard(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut);
-int mat3MulVec3(Mat3 *mat, Vec3 *vec, Vec3 *vOut);
-int mat3MulMat3(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut);
+NML_API int mat3Hadamard(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut);
+NML_API int mat3MulVec3(Mat3 *mat, Vec3 *vec, Vec3 *vOut);
+NML_API int mat3MulMat3(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut);
+
+// mOut may be the same matrix as mat
+NML_API int mat3Transpose(Mat3 *mat, Mat3 *mOut);
+
+#if defined(NUMEN_INLINE)
+#    include "matrix/mat3d_inline.h"
+#endif
 
 #endif // !__MAT3D_H__
@@ -0,0 +1,207 @@
+#ifndef __MAT3D_INLINE_H__
+#define __MAT3D_INLINE_H__
+
+#include "matrix/mat3d.h"
+#include "utils/errors.h"
+#include "utils/inline.h"
+#include "utils/simd.h"
+#include <stddef.h>
+#include <string.h>
+
+// definitions of mat3d.h, static inline with NUMEN_INLINE (utils/inline.h)
+// and compiled into the library otherwise
+
+/*
+ * the nine elements are two unaligned 4-wide blocks plus the last element.
+ * the products load each column as a register, see simd_load3x3_f32 for how
+ * the last column avoids reading past the matrix
+ */
+
+NML_API int mat3Init(const nml_t arr[9], Mat3 *mOut) {
+    is_null(mOut);
+    memcpy(mOut->elems, arr, sizeof(nml_t) * 9);
+    return NML_SUCCESS;
+}
+
+NML_API int mat3InitZero(Mat3 *mOut) {
+    is_null(mOut);
+    memset(mOut, 0, sizeof(Mat3));
+    return NML_SUCCESS;
+}
+
+NML_API int mat3Diagonal(nml_t val, Mat3 *mOut) {
+    is_null(mOut);
+    memset(mOut->elems, 0, sizeof(Mat3));
+    for (int i = 0; i < 3; i++) {
+        mOut->elems[i * 3 + i] = val;
+    }
+
+    return NML_SUCCESS;
+}
+
+NML_API int mat3Identity(Mat3 *mOut) {
+    is_null(mOut);
+    memset(mOut->elems, 0, sizeof(Mat3));
+    for (int i = 0; i < 3; i++) {
+        mOut->elems[i * 3 + i] = 1.0;
+    }
+
+    return NML_SUCCESS;
+}
+
+NML_API int mat3Add(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut) {
+    is_null(mat1, mat2, mOut);
+    for (int i = 0; i < 8; i += 4) {
+        simd_storeu_nml4(&mOut->elems[i],
+                         simd_add_nml4(simd_loadu_nml4(&mat1->elems[i]),
+                                       simd_loadu_nml4(&mat2->elems[i])));
+    }
+    mOut->elems[8] = mat1->elems[8] + mat2->elems[8];
+
+    return NML_SUCCESS;
+}
+
+NML_API int mat3Sub(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut) {
+    is_null(mat1, mat2, mOut);
+    for (int i = 0; i < 8; i += 4) {
+        simd_storeu_nml4(&mOut->elems[i],
+                         simd_sub_nml4(simd_loadu_nml4(&mat1->elems[i]),
+                                       simd_loadu_nml4(&mat2->elems[i])));
+    }
+    mOut->elems[8] = mat1->elems[8] - mat2->elems[8];
+
+    return NML_SUCCESS;
+}
+
+NML_API int mat3Hadamard(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut) {
+    is_null(mat1, mat2, mOut);
+    for (int i = 0; i < 8; i += 4) {
+        simd_storeu_nml4(&mOut->elems[i],
+                         simd_mul_nml4(simd_loadu_nml4(&mat1->elems[i]),
+                                       simd_loadu_nml4(&mat2->elems[i])));
+    }
+    mOut->elems[8] = mat1->elems[8] * mat2->elems[8];
+
+    return NML_SUCCESS;
+}
+
+NML_API int mat3Scale(Mat3 *mat, nml_t s, Mat3 *mOut) {
+    is_null(mat, mOut);
+    simd_nml4_t scaler = simd_set1_nml4(s);
+    for (int i = 0; i < 8; i += 4) {
+        simd_storeu_nml4(&mOut->elems[i],
+                         simd_mul_nml4(simd_loadu_nml4(&mat->elems[i]), scaler));
+    }
+    mOut->elems[8] = mat->elems[8] * s;
+
+    return NML_SUCCESS;
+}
+
+NML_API int mat3Negate(Mat3 *mat, Mat3 *mOut) {
+    is_null(mat, mOut);
+    for (int i = 0; i < 8; i += 4) {
+        simd_storeu_nml4(&mOut->elems[i],
+                         simd_negate_nml4(simd_loadu_nml4(&mat->elems[i])));
+    }
+    mOut->elems[8] = -mat->elems[8];
+
+    return NML_SUCCESS;
+}
+
+NML_API int mat3MulVec3(Mat3 *mat, Vec3 *vec, Vec3 *vOut) {
+    is_null(mat, vec, vOut);
+#if defined(NML_SIMD_F32)
+    simd_f32x4_t c0, c1, c2;
+    simd_load3x3_f32(mat->elems, &c0, &c1, &c2);
+    simd_f32x4_t res = simd_mul_f32(c0, simd_set1_f32(vec->x));
+    res = simd_fmadd_f32(c1, simd_set1_f32(vec->y), res);
+    res = simd_fmadd_f32(c2, simd_set1_f32(vec->z), res);
+
+    float r[4] ALIGN_16;
+    simd_store_f32(r, res);
+    vOut->x = r[0];
+    vOut->y = r[1];
+    vOut->z = r[2];
+#else
+    Vec3 v = *vec;
+    vOut->x = mat->cols[0].x * v.x + mat->cols[1].x * v.y + mat->cols[2].x * v.z;
+    vOut->y = mat->cols[0].y * v.x + mat->cols[1].y * v.y + mat->cols[2].y * v.z;
+    vOut->z = mat->cols[0].z * v.x + mat->cols[1].z * v.y + mat->cols[2].z * v.z;
+#endif
+
+    return NML_SUCCESS;
+}
+
+NML_API int mat3MulMat3(Mat3 *mat1, Mat3 *mat2, Mat3 *mOut) {
+    is_null(mat1, mat2, mOut);
+#if defined(NML_SIMD_F32)
+    // every product is formed before anything is stored, so mOut may alias
+    // either operand
+    simd_f32x4_t a0, a1, a2;
+    simd_load3x3_f32(mat1->elems, &a0, &a1, &a2);
+
+    simd_f32x4_t res[3];
+    for (int i = 0; i < 3; i++) {
+        const float *col = &mat2->elems[i * 3];
+        res[i] = simd_mul_f32(a0, simd_set1_f32(col[0]));
+        res[i] = simd_fmadd_f32(a1, simd_set1_f32(col[1]), res[i]);
+        res[i] = simd_fmadd_f32(a2, simd_set1_f32(col[2]), res[i]);
+    }
+    simd_store3x3_f32(mOut->elems, res[0], res[1], res[2]);
+#else
+    Mat3 a = *mat1;
+    Mat3 b = *mat2;
+    for (int i = 0; i < 3; i++) {
+        for (int r = 0; r < 3; r++) {
+            mOut->elems[i * 3 + r] = a.elems[r] * b.elems[i * 3] +
+                                     a.elems[3 + r] * b.elems[i * 3 + 1] +
+                                     a.elems[6 + r] * b.elems[i * 3 + 2];
+        }
+    }
+#endif
+
+    return NML_SUCCESS;
+}
+
+NML_API int mat3Transpose(Mat3 *mat, Mat3 *mOut) {
+    is_null(mat, mOut);
+    // the diagonal element e8 stays in place, the other eight move within the
+    // two 4-wide blocks: (e0 e3 e6 e1) (e4 e7 e2 e5)
+#if defined(NML_SIMD_F32) && defined(DEFINE_SIMD__SSE)
+    __m128 a = _mm_loadu_ps(&mat->elems[0]);
+    __m128 b = _mm_loadu_ps(&mat->elems[4]);
+    __m128 t = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 2, 1, 1)); // a1 a1 b2 b2
+    __m128 u = _mm_shuffle_ps(b, a, _MM_SHUFFLE(2, 2, 1, 1)); // b1 b1 a2 a2
+    _mm_storeu_ps(&mOut->elems[0], _mm_shuffle_ps(a, t, _MM_SHUFFLE(0, 2, 3, 0)));
+    _mm_storeu_ps(&mOut->elems[4], _mm_shuffle_ps(b, u, _MM_SHUFFLE(0, 2, 3, 0)));
+    mOut->elems[8] = mat->elems[8];
+#elif defined(NML_SIMD_F32) && defined(DEFINE_SIMD__NEON)
+    float32x4_t a = vld1q_f32(&mat->elems[0]);
+    float32x4_t b = vld1q_f32(&mat->elems[4]);
+    float32x4_t c0 = vsetq_lane_f32(vgetq_lane_f32(a, 3), a, 1);
+    c0 = vsetq_lane_f32(vgetq_lane_f32(b, 2), c0, 2);
+    c0 = vsetq_lane_f32(vgetq_lane_f32(a, 1), c0, 3);
+    float32x4_t c1 = vsetq_lane_f32(vgetq_lane_f32(b, 3), b, 1);
+    c1 = vsetq_lane_f32(vgetq_lane_f32(a, 2), c1, 2);
+    c1 = vsetq_lane_f32(vgetq_lane_f32(b, 1), c1, 3);
+    vst1q_f32(&mOut->elems[0], c0);
+    vst1q_f32(&mOut->elems[4], c1);
+    mOut->elems[8] = mat->elems[8];
+#else
+    // three swaps
+    nml_t *e = mOut->elems;
+    if (mat != mOut)
+        memcpy(e, mat->elems, sizeof(Mat3));
+    for (int c = 0; c < 3; c++) {
+        for (int r = c + 1; r < 3; r++) {
+            nml_t t = e[c * 3 + r];
+            e[c * 3 + r] = e[r * 3 + c];
+            e[r * 3 + c] = t;
+        }
+    }
+#endif
+
+    return NML_SUCCESS;
+}
+
+#endif // !__MAT3D_INLINE_H__
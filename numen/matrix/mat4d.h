@@ -2,29 +2,65 @@
 #define __MAT4D_H__
 
 #include "utils/consts.h"
+#include "utils/inline.h"
 #include "utils/simd.h"
 #include "vector/vec4d.h"
+#include <stddef.h>
 
 typedef union Mat4 {
     nml_t elems[16];
     Vec4 cols[4];
 } Mat4 ALIGN_16;
 
-int mat4Init(const nml_t arr[16], Mat4 *mOut);
-int mat4InitZero(Mat4 *mOut);
-int mat4Diagonal(nml_t val, Mat4 *mOut);
-int mat4Identity(Mat4 *mOut);
+NML_API int mat4Init(const nml_t arr[16], Mat4 *mOut);
+NML_API int mat4InitZero(Mat4 *mOut);
+NML_API int mat4Diagonal(nml_t val, Mat4 *mOut);
+NML_API int mat4Identity(Mat4 *mOut);
 
-int mat4Add(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut);
+NML_API int mat4Add(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut);
 // subtract mat2 form mat1
-int mat4Sub(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut);
+NML_API int mat4Sub(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut);
 
-int mat4Scale(Mat4 *mat, nml_t s, Mat4 *mOut);
-int mat4Negate(Mat4 *mat, Mat4 *mOut);
+NML_API int mat4Scale(Mat4 *mat, nml_t s, Mat4 *mOut);
+NML_API int mat4Negate(Mat4 *mat, Mat4 *mOut);
 
 // matrix multiplication
-int mat4Hadamard(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut);
-int mat4MulVec4(Mat4 *mat, Vec4 *vec, Vec4 *vOut);
-int mat4MulMat4(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut);
+NML_API int mat4Hadamard(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut);
+NML_API int mat4MulVec4(Mat4 *mat, Vec4 *vec, Vec4 *vOut);
+NML_API int mat4MulMat4(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut);
+// transform n vectors by the same matrix, in and out may be the same array
+// large outputs are written with non-temporal stores
+int mat4MulVec4Batch(const Mat4 *mat, const Vec4 *in, Vec4 *out, size_t n);
+// mOut[i] = mat * mats[i], mOut may be the same array as mats
+int mat4MulMat4Batch(const Mat4 *mat, const Mat4 *mats, Mat4 *mOut, size_t n);
+// mats[0] * mats[1] * ... * mats[n - 1], the identity for n == 0. evaluated as
+// a few interleaved partial products, so the last bits can differ from
+// folding mat4MulMat4 left to right
+int mat4MulChain(const Mat4 *mats, size_t n, Mat4 *mOut);
+
+// mOut may be the same matrix as mat
+NML_API int mat4Transpose(Mat4 *mat, Mat4 *mOut);
+// transpose n matrices, mOut may be the same array as mats
+int mat4TransposeBatch(const Mat4 *mats, Mat4 *mOut, size_t n);
+
+NML_API nml_t mat4Determinant(Mat4 *mat);
+// general inverse, NML_EZERODIV if the determinant is exactly zero
+// (nearly singular input is not detected, the result is just inaccurate)
+NML_API int mat4Inverse(Mat4 *mat, Mat4 *mOut);
+// inverse of an affine transform without shear (rotation, per-axis scale and
+// translation), transposes the 3x3 part instead of expanding cofactors.
+// NML_EZERODIV if any axis has zero scale
+NML_API int mat4InverseAffine(Mat4 *mat, Mat4 *mOut);
+
+// the above over arrays of n matrices, mOut may be the same array as mats.
+// singular matrices come out as zero and make the call return NML_EZERODIV,
+// every other matrix is still inverted
+int mat4DeterminantBatch(const Mat4 *mats, nml_t *out, size_t n);
+int mat4InverseBatch(const Mat4 *mats, Mat4 *mOut, size_t n);
+int mat4InverseAffineBatch(const Mat4 *mats, Mat4 *mOut, size_t n);
+
+#if defined(NUMEN_INLINE)
+#    include "matrix/mat4d_inline.h"
+#endif
 
 #endif // !__MAT4D_H__
@@ -0,0 +1,582 @@
+#ifndef __MAT4D_INLINE_H__
+#define __MAT4D_INLINE_H__
+
+#include "matrix/mat4d.h"
+#include "utils/errors.h"
+#include "utils/inline.h"
+#include "utils/simd.h"
+#include <stddef.h>
+#include <string.h>
+
+// definitions of mat4d.h, static inline with NUMEN_INLINE (utils/inline.h)
+// and compiled into the library otherwise. the functions the library
+// dispatches at load time are defined here for the inline mode only
+
+NML_API int mat4Init(const nml_t arr[16], Mat4 *mOut) {
+    is_null(mOut);
+    memcpy(mOut->elems, arr, sizeof(nml_t) * 16);
+    return NML_SUCCESS;
+}
+
+NML_API int mat4InitZero(Mat4 *mOut) {
+    is_null(mOut);
+    memset(mOut, 0, sizeof(Mat4));
+    return NML_SUCCESS;
+}
+
+NML_API int mat4Diagonal(nml_t val, Mat4 *mOut) {
+    is_null(mOut);
+    memset(mOut->elems, 0, sizeof(Mat4));
+    for (int i = 0; i < 4; i++) {
+        mOut->elems[i * 4 + i] = val;
+    }
+    return NML_SUCCESS;
+}
+
+NML_API int mat4Identity(Mat4 *mOut) {
+    is_null(mOut);
+    memset(mOut->elems, 0, sizeof(Mat4));
+    for (int i = 0; i < 4; i++) {
+        mOut->elems[i * 4 + i] = 1.0;
+    }
+    return NML_SUCCESS;
+}
+
+/*
+ * baseline kernels (sse2/neon/scalar, picked at compile time)
+ *
+ * the element-wise ones use the nml4 ops and work in either precision, the
+ * products have hand scheduled f32 paths and a generic nml4 one
+ */
+
+static inline void mat4AddBaseline(const nml_t *a, const nml_t *b, nml_t *out) {
+    simd_nml4_t col0 =
+        simd_add_nml4(simd_load_nml4(&a[0]), simd_load_nml4(&b[0]));
+    simd_nml4_t col1 =
+        simd_add_nml4(simd_load_nml4(&a[4]), simd_load_nml4(&b[4]));
+    simd_nml4_t col2 =
+        simd_add_nml4(simd_load_nml4(&a[8]), simd_load_nml4(&b[8]));
+    simd_nml4_t col3 =
+        simd_add_nml4(simd_load_nml4(&a[12]), simd_load_nml4(&b[12]));
+
+    simd_store_nml4(&out[0], col0);
+    simd_store_nml4(&out[4], col1);
+    simd_store_nml4(&out[8], col2);
+    simd_store_nml4(&out[12], col3);
+}
+
+static inline void mat4SubBaseline(const nml_t *a, const nml_t *b, nml_t *out) {
+    simd_nml4_t col0 =
+        simd_sub_nml4(simd_load_nml4(&a[0]), simd_load_nml4(&b[0]));
+    simd_nml4_t col1 =
+        simd_sub_nml4(simd_load_nml4(&a[4]), simd_load_nml4(&b[4]));
+    simd_nml4_t col2 =
+        simd_sub_nml4(simd_load_nml4(&a[8]), simd_load_nml4(&b[8]));
+    simd_nml4_t col3 =
+        simd_sub_nml4(simd_load_nml4(&a[12]), simd_load_nml4(&b[12]));
+
+    simd_store_nml4(&out[0], col0);
+    simd_store_nml4(&out[4], col1);
+    simd_store_nml4(&out[8], col2);
+    simd_store_nml4(&out[12], col3);
+}
+
+static inline void mat4ScaleBaseline(const nml_t *a, nml_t s, nml_t *out) {
+    simd_nml4_t scaler = simd_set1_nml4(s);
+
+    simd_nml4_t col0 = simd_mul_nml4(simd_load_nml4(&a[0]), scaler);
+    simd_nml4_t col1 = simd_mul_nml4(simd_load_nml4(&a[4]), scaler);
+    simd_nml4_t col2 = simd_mul_nml4(simd_load_nml4(&a[8]), scaler);
+    simd_nml4_t col3 = simd_mul_nml4(simd_load_nml4(&a[12]), scaler);
+
+    simd_store_nml4(&out[0], col0);
+    simd_store_nml4(&out[4], col1);
+    simd_store_nml4(&out[8], col2);
+    simd_store_nml4(&out[12], col3);
+}
+
+static inline void mat4NegateBaseline(const nml_t *a, nml_t *out) {
+    simd_nml4_t col0 = simd_negate_nml4(simd_load_nml4(&a[0]));
+    simd_nml4_t col1 = simd_negate_nml4(simd_load_nml4(&a[4]));
+    simd_nml4_t col2 = simd_negate_nml4(simd_load_nml4(&a[8]));
+    simd_nml4_t col3 = simd_negate_nml4(simd_load_nml4(&a[12]));
+
+    simd_store_nml4(&out[0], col0);
+    simd_store_nml4(&out[4], col1);
+    simd_store_nml4(&out[8], col2);
+    simd_store_nml4(&out[12], col3);
+}
+
+static inline void mat4HadamardBaseline(const nml_t *a,
+                                        const nml_t *b,
+                                        nml_t *out) {
+    simd_nml4_t col0 =
+        simd_mul_nml4(simd_load_nml4(&a[0]), simd_load_nml4(&b[0]));
+    simd_nml4_t col1 =
+        simd_mul_nml4(simd_load_nml4(&a[4]), simd_load_nml4(&b[4]));
+    simd_nml4_t col2 =
+        simd_mul_nml4(simd_load_nml4(&a[8]), simd_load_nml4(&b[8]));
+    simd_nml4_t col3 =
+        simd_mul_nml4(simd_load_nml4(&a[12]), simd_load_nml4(&b[12]));
+
+    simd_store_nml4(&out[0], col0);
+    simd_store_nml4(&out[4], col1);
+    simd_store_nml4(&out[8], col2);
+    simd_store_nml4(&out[12], col3);
+}
+
+static inline void mat4MulVec4Baseline(const nml_t *m,
+                                       const nml_t *vec,
+                                       nml_t *out) {
+#if defined(NML_SIMD_F32) && defined(DEFINE_SIMD__SSE)
+    // Vec4 carries no alignment guarantee of its own
+    simd_f32x4_t v = simd_loadu_f32(vec);
+
+    simd_f32x4_t res = simd_mul_f32(
+        simd_load_f32(&m[0]), simd_shuffle_f32(v, SIMD_SHUFFLE(0, 0, 0, 0)));
+    res = simd_add_f32(
+        res,
+        simd_mul_f32(simd_load_f32(&m[4]),
+                     simd_shuffle_f32(v, SIMD_SHUFFLE(1, 1, 1, 1))));
+    res = simd_add_f32(
+        res,
+        simd_mul_f32(simd_load_f32(&m[8]),
+                     simd_shuffle_f32(v, SIMD_SHUFFLE(2, 2, 2, 2))));
+    res = simd_add_f32(
+        res,
+        simd_mul_f32(simd_load_f32(&m[12]),
+                     simd_shuffle_f32(v, SIMD_SHUFFLE(3, 3, 3, 3))));
+
+    simd_storeu_f32(out, res);
+
+#elif defined(NML_SIMD_F32) && defined(DEFINE_SIMD__NEON)
+    simd_f32x4_t v = simd_loadu_f32(vec);
+
+    float32x4_t res =
+        simd_mul_lane_f32(simd_load_f32(&m[0]), simd_get_low_f32(v), 0);
+    res = simd_mla_lane_f32(res, simd_load_f32(&m[4]), simd_get_low_f32(v), 1);
+    res = simd_mla_lane_f32(res, simd_load_f32(&m[8]), simd_get_high_f32(v), 0);
+    res =
+        simd_mla_lane_f32(res, simd_load_f32(&m[12]), simd_get_high_f32(v), 1);
+
+    simd_storeu_f32(out, res);
+
+#else
+    simd_nml4_t res =
+        simd_mul_nml4(simd_load_nml4(&m[0]), simd_set1_nml4(vec[0]));
+    res = simd_fmadd_nml4(simd_load_nml4(&m[4]), simd_set1_nml4(vec[1]), res);
+    res = simd_fmadd_nml4(simd_load_nml4(&m[8]), simd_set1_nml4(vec[2]), res);
+    res = simd_fmadd_nml4(simd_load_nml4(&m[12]), simd_set1_nml4(vec[3]), res);
+
+    simd_storeu_nml4(out, res);
+#endif
+}
+
+static inline void mat4MulMat4Baseline(const nml_t *a,
+                                       const nml_t *b,
+                                       nml_t *out) {
+#if defined(NML_SIMD_F32) && defined(DEFINE_SIMD__SSE)
+    simd_f32x4_t mat1_col0 = simd_load_f32(&a[0]);
+    simd_f32x4_t mat1_col1 = simd_load_f32(&a[4]);
+    simd_f32x4_t mat1_col2 = simd_load_f32(&a[8]);
+    simd_f32x4_t mat1_col3 = simd_load_f32(&a[12]);
+
+    for (int i = 0; i < 4; i++) {
+        simd_f32x4_t mat2_col = simd_load_f32(&b[i * 4]);
+
+        simd_f32x4_t bc0 = simd_set1_f32(simd_extract0_f32(mat2_col));
+        simd_f32x4_t bc1 = simd_set1_f32(simd_extract1_f32(mat2_col));
+        simd_f32x4_t bc2 = simd_set1_f32(simd_extract2_f32(mat2_col));
+        simd_f32x4_t bc3 = simd_set1_f32(simd_extract3_f32(mat2_col));
+
+        simd_f32x4_t result = simd_mul_f32(mat1_col0, bc0);
+        result = simd_add_f32(result, simd_mul_f32(mat1_col1, bc1));
+        result = simd_add_f32(result, simd_mul_f32(mat1_col2, bc2));
+        result = simd_add_f32(result, simd_mul_f32(mat1_col3, bc3));
+
+        simd_store_f32(&out[i * 4], result);
+    }
+
+#elif defined(NML_SIMD_F32) && defined(DEFINE_SIMD__NEON)
+    simd_f32x4_t mat1_col0 = simd_load_f32(&a[0]);
+    simd_f32x4_t mat1_col1 = simd_load_f32(&a[4]);
+    simd_f32x4_t mat1_col2 = simd_load_f32(&a[8]);
+    simd_f32x4_t mat1_col3 = simd_load_f32(&a[12]);
+
+    for (int i = 0; i < 4; i++) {
+        simd_f32x4_t mat2_col = simd_load_f32(&b[i * 4]);
+
+        simd_f32x4_t bc0 = simd_dup_lane_f32(mat2_col, 0);
+        simd_f32x4_t bc1 = simd_dup_lane_f32(mat2_col, 1);
+        simd_f32x4_t bc2 = simd_dup_lane_f32(mat2_col, 2);
+        simd_f32x4_t bc3 = simd_dup_lane_f32(mat2_col, 3);
+
+        simd_f32x4_t result = simd_mul_f32(mat1_col0, bc0);
+        result = simd_fmadd_f32(mat1_col1, bc1, result);
+        result = simd_fmadd_f32(mat1_col2, bc2, result);
+        result = simd_fmadd_f32(mat1_col3, bc3, result);
+
+        simd_store_f32(&out[i * 4], result);
+    }
+
+#else
+    // out may alias either operand: a stays in registers and each column of
+    // b is read before the matching output column is written
+    simd_nml4_t mat1_col0 = simd_load_nml4(&a[0]);
+    simd_nml4_t mat1_col1 = simd_load_nml4(&a[4]);
+    simd_nml4_t mat1_col2 = simd_load_nml4(&a[8]);
+    simd_nml4_t mat1_col3 = simd_load_nml4(&a[12]);
+
+    for (int i = 0; i < 4; i++) {
+        const nml_t *mat2_col = &b[i * 4];
+
+        simd_nml4_t result =
+            simd_mul_nml4(mat1_col0, simd_set1_nml4(mat2_col[0]));
+        result = simd_fmadd_nml4(mat1_col1, simd_set1_nml4(mat2_col[1]), result);
+        result = simd_fmadd_nml4(mat1_col2, simd_set1_nml4(mat2_col[2]), result);
+        result = simd_fmadd_nml4(mat1_col3, simd_set1_nml4(mat2_col[3]), result);
+
+        simd_store_nml4(&out[i * 4], result);
+    }
+#endif
+}
+
+/*
+ * determinant and inverse
+ *
+ * the kernels return non-zero for singular input. the f32 sse path inverts
+ * with 2x2 sub-blocks kept in registers, everything else expands cofactors
+ * from the 12 2x2 minors. both work on the transpose just as well, so the
+ * layout never has to be flipped on the way in or out
+ */
+
+#if defined(NML_SIMD_F32) && defined(DEFINE_SIMD__SSE)
+// lane order shuffles, MAT4_SHUF(0, 1, 2, 3) is the identity
+#    define MAT4_SHUF(x, y, z, w) _MM_SHUFFLE(w, z, y, x)
+#    define MAT4_SWIZZLE(v, x, y, z, w)                                        \
+        _mm_shuffle_ps(v, v, MAT4_SHUF(x, y, z, w))
+
+// 2x2 blocks as (m00 m01 m10 m11)
+// A * B
+static inline __m128 mat4BlockMul(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, MAT4_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(MAT4_SWIZZLE(a, 1, 0, 3, 2),
+                                 MAT4_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adj(A) * B
+static inline __m128 mat4BlockAdjMul(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(MAT4_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(MAT4_SWIZZLE(a, 1, 1, 2, 2),
+                                 MAT4_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// A * adj(B)
+static inline __m128 mat4BlockMulAdj(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, MAT4_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(MAT4_SWIZZLE(a, 1, 0, 3, 2),
+                                 MAT4_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+static inline __m128 mat4BlockHSum(__m128 v) {
+    v = _mm_add_ps(v, MAT4_SWIZZLE(v, 1, 0, 3, 2));
+    return _mm_add_ps(v, MAT4_SWIZZLE(v, 2, 3, 0, 1));
+}
+
+/*
+ * block decomposition M = | A B |  with the determinant
+ *                         | C D |
+ * |M| = |A||D| + |B||C| - tr(adj(A) B adj(D) C)
+ */
+typedef struct Mat4Blocks {
+    __m128 a, b, c, d;
+    __m128 detA, detB, detC, detD;
+    __m128 adjAB, adjDC;
+    __m128 det; // broadcast to every lane
+} Mat4Blocks;
+
+static inline void mat4Blocks(const nml_t *m, Mat4Blocks *blk) {
+    __m128 c0 = _mm_load_ps(&m[0]);
+    __m128 c1 = _mm_load_ps(&m[4]);
+    __m128 c2 = _mm_load_ps(&m[8]);
+    __m128 c3 = _mm_load_ps(&m[12]);
+
+    blk->a = _mm_movelh_ps(c0, c1);
+    blk->b = _mm_movehl_ps(c1, c0);
+    blk->c = _mm_movelh_ps(c2, c3);
+    blk->d = _mm_movehl_ps(c3, c2);
+
+    // (|A| |B| |C| |D|)
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(c0, c2, MAT4_SHUF(0, 2, 0, 2)),
+                   _mm_shuffle_ps(c1, c3, MAT4_SHUF(1, 3, 1, 3))),
+        _mm_mul_ps(_mm_shuffle_ps(c0, c2, MAT4_SHUF(1, 3, 1, 3)),
+                   _mm_shuffle_ps(c1, c3, MAT4_SHUF(0, 2, 0, 2))));
+    blk->detA = MAT4_SWIZZLE(detSub, 0, 0, 0, 0);
+    blk->detB = MAT4_SWIZZLE(detSub, 1, 1, 1, 1);
+    blk->detC = MAT4_SWIZZLE(detSub, 2, 2, 2, 2);
+    blk->detD = MAT4_SWIZZLE(detSub, 3, 3, 3, 3);
+
+    blk->adjDC = mat4BlockAdjMul(blk->d, blk->c);
+    blk->adjAB = mat4BlockAdjMul(blk->a, blk->b);
+
+    __m128 tr = mat4BlockHSum(
+        _mm_mul_ps(blk->adjAB, MAT4_SWIZZLE(blk->adjDC, 0, 2, 1, 3)));
+    blk->det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(blk->detA, blk->detD),
+                                     _mm_mul_ps(blk->detB, blk->detC)),
+                          tr);
+}
+
+static inline nml_t mat4DeterminantKernel(const nml_t *m) {
+    Mat4Blocks blk;
+    mat4Blocks(m, &blk);
+    return _mm_cvtss_f32(blk.det);
+}
+
+static inline int mat4InverseKernel(const nml_t *m, nml_t *out) {
+    Mat4Blocks blk;
+    mat4Blocks(m, &blk);
+    if (_mm_cvtss_f32(blk.det) == 0.0f)
+        return 1;
+
+    // adjugates of the inverse blocks, iM = 1/|M| | X Y |
+    //                                             | Z W |
+    __m128 x =
+        _mm_sub_ps(_mm_mul_ps(blk.detD, blk.a), mat4BlockMul(blk.b, blk.adjDC));
+    __m128 w =
+        _mm_sub_ps(_mm_mul_ps(blk.detA, blk.d), mat4BlockMul(blk.c, blk.adjAB));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(blk.detB, blk.c),
+                          mat4BlockMulAdj(blk.d, blk.adjAB));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(blk.detC, blk.b),
+                          mat4BlockMulAdj(blk.a, blk.adjDC));
+
+    // the adjugate sign pattern folded into the reciprocal
+    __m128 rdet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), blk.det);
+    x = _mm_mul_ps(x, rdet);
+    y = _mm_mul_ps(y, rdet);
+    z = _mm_mul_ps(z, rdet);
+    w = _mm_mul_ps(w, rdet);
+
+    // undo the adjugate swizzle and the block split in one shuffle per column
+    _mm_store_ps(&out[0], _mm_shuffle_ps(x, y, MAT4_SHUF(3, 1, 3, 1)));
+    _mm_store_ps(&out[4], _mm_shuffle_ps(x, y, MAT4_SHUF(2, 0, 2, 0)));
+    _mm_store_ps(&out[8], _mm_shuffle_ps(z, w, MAT4_SHUF(3, 1, 3, 1)));
+    _mm_store_ps(&out[12], _mm_shuffle_ps(z, w, MAT4_SHUF(2, 0, 2, 0)));
+    return 0;
+}
+
+static inline int mat4InverseAffineKernel(const nml_t *m, nml_t *out) {
+    __m128 c0 = _mm_load_ps(&m[0]);
+    __m128 c1 = _mm_load_ps(&m[4]);
+    __m128 c2 = _mm_load_ps(&m[8]);
+    __m128 t = _mm_load_ps(&m[12]);
+    __m128 r3 = _mm_setzero_ps();
+
+    // rows of the upper 3x3 become columns, w lanes end up 0
+    simd_transpose4_f32(c0, c1, c2, r3);
+
+    // squared scale of every basis vector, one per lane
+    __m128 sizeSqr = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(c0, c0), _mm_mul_ps(c1, c1)), _mm_mul_ps(c2, c2));
+    if ((_mm_movemask_ps(_mm_cmpeq_ps(sizeSqr, _mm_setzero_ps())) & 7) != 0)
+        return 1;
+
+    // w lane of sizeSqr is 0, keep it away from the division
+    __m128 one = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+    __m128 rsize = _mm_div_ps(_mm_set1_ps(1.0f), _mm_or_ps(sizeSqr, one));
+    rsize = _mm_sub_ps(rsize, one);
+
+    c0 = _mm_mul_ps(c0, rsize);
+    c1 = _mm_mul_ps(c1, rsize);
+    c2 = _mm_mul_ps(c2, rsize);
+
+    // -(R^-1 t) with w = 1
+    __m128 rt = _mm_mul_ps(c0, MAT4_SWIZZLE(t, 0, 0, 0, 0));
+    rt = _mm_add_ps(rt, _mm_mul_ps(c1, MAT4_SWIZZLE(t, 1, 1, 1, 1)));
+    rt = _mm_add_ps(rt, _mm_mul_ps(c2, MAT4_SWIZZLE(t, 2, 2, 2, 2)));
+    rt = _mm_sub_ps(one, rt);
+
+    _mm_store_ps(&out[0], c0);
+    _mm_store_ps(&out[4], c1);
+    _mm_store_ps(&out[8], c2);
+    _mm_store_ps(&out[12], rt);
+    return 0;
+}
+
+#    undef MAT4_SWIZZLE
+#    undef MAT4_SHUF
+
+#else
+// the 2x2 minors of the top two and bottom two rows
+typedef struct Mat4Minors {
+    nml_t s[6], c[6];
+} Mat4Minors;
+
+static inline nml_t mat4Minors(const nml_t *m, Mat4Minors *mn) {
+    mn->s[0] = m[0] * m[5] - m[4] * m[1];
+    mn->s[1] = m[0] * m[6] - m[4] * m[2];
+    mn->s[2] = m[0] * m[7] - m[4] * m[3];
+    mn->s[3] = m[1] * m[6] - m[5] * m[2];
+    mn->s[4] = m[1] * m[7] - m[5] * m[3];
+    mn->s[5] = m[2] * m[7] - m[6] * m[3];
+
+    mn->c[5] = m[10] * m[15] - m[14] * m[11];
+    mn->c[4] = m[9] * m[15] - m[13] * m[11];
+    mn->c[3] = m[9] * m[14] - m[13] * m[10];
+    mn->c[2] = m[8] * m[15] - m[12] * m[11];
+    mn->c[1] = m[8] * m[14] - m[12] * m[10];
+    mn->c[0] = m[8] * m[13] - m[12] * m[9];
+
+    return mn->s[0] * mn->c[5] - mn->s[1] * mn->c[4] + mn->s[2] * mn->c[3] +
+           mn->s[3] * mn->c[2] - mn->s[4] * mn->c[1] + mn->s[5] * mn->c[0];
+}
+
+static inline nml_t mat4DeterminantKernel(const nml_t *m) {
+    Mat4Minors mn;
+    return mat4Minors(m, &mn);
+}
+
+static inline int mat4InverseKernel(const nml_t *m, nml_t *out) {
+    Mat4Minors mn;
+    nml_t det = mat4Minors(m, &mn);
+    if (det == 0.0)
+        return 1;
+
+    const nml_t *s = mn.s, *c = mn.c;
+    nml_t r = 1.0 / det;
+    nml_t inv[16] = {
+        (m[5] * c[5] - m[6] * c[4] + m[7] * c[3]) * r,
+        (-m[1] * c[5] + m[2] * c[4] - m[3] * c[3]) * r,
+        (m[13] * s[5] - m[14] * s[4] + m[15] * s[3]) * r,
+        (-m[9] * s[5] + m[10] * s[4] - m[11] * s[3]) * r,
+
+        (-m[4] * c[5] + m[6] * c[2] - m[7] * c[1]) * r,
+        (m[0] * c[5] - m[2] * c[2] + m[3] * c[1]) * r,
+        (-m[12] * s[5] + m[14] * s[2] - m[15] * s[1]) * r,
+        (m[8] * s[5] - m[10] * s[2] + m[11] * s[1]) * r,
+
+        (m[4] * c[4] - m[5] * c[2] + m[7] * c[0]) * r,
+        (-m[0] * c[4] + m[1] * c[2] - m[3] * c[0]) * r,
+        (m[12] * s[4] - m[13] * s[2] + m[15] * s[0]) * r,
+        (-m[8] * s[4] + m[9] * s[2] - m[11] * s[0]) * r,
+
+        (-m[4] * c[3] + m[5] * c[1] - m[6] * c[0]) * r,
+        (m[0] * c[3] - m[1] * c[1] + m[2] * c[0]) * r,
+        (-m[12] * s[3] + m[13] * s[1] - m[14] * s[0]) * r,
+        (m[8] * s[3] - m[9] * s[1] + m[10] * s[0]) * r,
+    };
+    memcpy(out, inv, sizeof(inv));
+    return 0;
+}
+
+static inline int mat4InverseAffineKernel(const nml_t *m, nml_t *out) {
+    nml_t rsize[3];
+    for (int i = 0; i < 3; i++) {
+        const nml_t *col = &m[i * 4];
+        nml_t sizeSqr = col[0] * col[0] + col[1] * col[1] + col[2] * col[2];
+        if (sizeSqr == 0.0)
+            return 1;
+        rsize[i] = 1.0 / sizeSqr;
+    }
+
+    // out may alias m, build the result aside
+    nml_t inv[16];
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 3; i++) {
+            inv[j * 4 + i] = m[i * 4 + j] * rsize[i];
+        }
+        inv[j * 4 + 3] = 0.0;
+    }
+    for (int i = 0; i < 3; i++) {
+        inv[12 + i] = -(inv[i] * m[12] + inv[4 + i] * m[13] + inv[8 + i] * m[14]);
+    }
+    inv[15] = 1.0;
+    memcpy(out, inv, sizeof(inv));
+    return 0;
+}
+#endif
+
+static inline void mat4TransposeKernel(const nml_t *m, nml_t *out) {
+    simd_nml4_t c0 = simd_load_nml4(&m[0]);
+    simd_nml4_t c1 = simd_load_nml4(&m[4]);
+    simd_nml4_t c2 = simd_load_nml4(&m[8]);
+    simd_nml4_t c3 = simd_load_nml4(&m[12]);
+
+    simd_transpose4_nml4(c0, c1, c2, c3);
+
+    simd_store_nml4(&out[0], c0);
+    simd_store_nml4(&out[4], c1);
+    simd_store_nml4(&out[8], c2);
+    simd_store_nml4(&out[12], c3);
+}
+
+NML_API int mat4Transpose(Mat4 *mat, Mat4 *mOut) {
+    is_null(mat, mOut);
+    mat4TransposeKernel(mat->elems, mOut->elems);
+    return NML_SUCCESS;
+}
+
+NML_API nml_t mat4Determinant(Mat4 *mat) {
+    return mat4DeterminantKernel(mat->elems);
+}
+
+NML_API int mat4Inverse(Mat4 *mat, Mat4 *mOut) {
+    is_null(mat, mOut);
+    return mat4InverseKernel(mat->elems, mOut->elems) ? NML_EZERODIV
+                                                      : NML_SUCCESS;
+}
+
+NML_API int mat4InverseAffine(Mat4 *mat, Mat4 *mOut) {
+    is_null(mat, mOut);
+    return mat4InverseAffineKernel(mat->elems, mOut->elems) ? NML_EZERODIV
+                                                            : NML_SUCCESS;
+}
+
+#if defined(NUMEN_INLINE)
+// the library dispatches these to the widest kernels of the host, inline
+// they run the baseline kernels as compiled for the including file
+
+NML_API int mat4Add(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut) {
+    is_null(mat1, mat2, mOut);
+    mat4AddBaseline(mat1->elems, mat2->elems, mOut->elems);
+    return NML_SUCCESS;
+}
+
+NML_API int mat4Sub(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut) {
+    is_null(mat1, mat2, mOut);
+    mat4SubBaseline(mat1->elems, mat2->elems, mOut->elems);
+    return NML_SUCCESS;
+}
+
+NML_API int mat4Scale(Mat4 *mat, nml_t s, Mat4 *mOut) {
+    is_null(mat, mOut);
+    mat4ScaleBaseline(mat->elems, s, mOut->elems);
+    return NML_SUCCESS;
+}
+
+NML_API int mat4Negate(Mat4 *mat, Mat4 *mOut) {
+    is_null(mat, mOut);
+    mat4NegateBaseline(mat->elems, mOut->elems);
+    return NML_SUCCESS;
+}
+
+NML_API int mat4Hadamard(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut) {
+    is_null(mat1, mat2, mOut);
+    mat4HadamardBaseline(mat1->elems, mat2->elems, mOut->elems);
+    return NML_SUCCESS;
+}
+
+NML_API int mat4MulVec4(Mat4 *mat, Vec4 *vec, Vec4 *vOut) {
+    is_null(mat, vec, vOut);
+    mat4MulVec4Baseline(mat->elems, vec->elems, vOut->elems);
+    return NML_SUCCESS;
+}
+
+NML_API int mat4MulMat4(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut) {
+    is_null(mat1, mat2, mOut);
+    mat4MulMat4Baseline(mat1->elems, mat2->elems, mOut->elems);
+    return NML_SUCCESS;
+}
+#endif
+
+#endif // !__MAT4D_INLINE_H__
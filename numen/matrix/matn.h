@@ -0,0 +1,52 @@
+#ifndef __MATN_H__
+#define __MATN_H__
+
+#include "utils/consts.h"
+#include <stddef.h>
+
+/*
+ * dynamically sized dense matrices
+ *
+ * column major like the fixed size types: element (row, col) lives at
+ * data[col * ld + row]. ld is rows rounded up so every column starts on an
+ * NML_ALIGNMENT boundary, padding rows are kept at zero. matrices allocated
+ * with matNInit own their storage, the fields are public so callers can also
+ * describe buffers they manage themselves
+ */
+
+typedef struct MatN {
+    nml_t *data;
+    size_t rows;
+    size_t cols;
+    size_t ld; // distance between columns, at least rows
+} MatN;
+
+// element access, no bounds checks
+#define MATN_AT(mat, row, col) ((mat)->data[(col) * (mat)->ld + (row)])
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// allocate a zero initialized rows x cols matrix
+int matNInit(size_t rows, size_t cols, MatN *mOut);
+// release storage allocated by matNInit
+void matNFree(MatN *mat);
+
+// ones on the main diagonal, zero elsewhere (mat need not be square)
+int matNIdentity(MatN *mat);
+// copy src into mOut, both must have the same shape
+int matNCopy(const MatN *src, MatN *mOut);
+
+// c = alpha * a * b + beta * c. a is m x k, b is k x n and c is m x n,
+// NML_EINVAL if the shapes don't match or c shares storage with a or b.
+// beta == 0 overwrites c without reading it
+int matNGemm(nml_t alpha, const MatN *a, const MatN *b, nml_t beta, MatN *c);
+// mOut = mat1 * mat2
+int matNMul(const MatN *mat1, const MatN *mat2, MatN *mOut);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__MATN_H__
@@ -0,0 +1,79 @@
+#ifndef __QUAT_H__
+#define __QUAT_H__
+
+#include "matrix/mat3d.h"
+#include "matrix/mat4d.h"
+#include "utils/consts.h"
+#include "utils/simd.h"
+#include "vector/vec3d.h"
+#include "vector/vec4d.h"
+#include <stddef.h>
+
+/*
+ * rotation quaternions, x y z is the vector part and w the scalar part so a
+ * Quat can be reinterpreted as a Vec4. rotations assume unit quaternions,
+ * nothing renormalizes behind your back
+ */
+
+typedef union Quat {
+    struct {
+        nml_t x, y, z, w;
+    };
+    nml_t elems[4];
+    Vec4 vec;
+} Quat ALIGN_16;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+int quatInit(nml_t x, nml_t y, nml_t z, nml_t w, Quat *qOut);
+int quatIdentity(Quat *qOut);
+// rotation of angle radians about axis, the axis doesn't have to be unit
+// length but must not be zero
+int quatFromAxisAngle(Vec3 *axis, nml_t angle, Quat *qOut);
+
+nml_t quatLength(Quat *quat);
+nml_t quatDot(Quat *quat1, Quat *quat2);
+int quatNormalize(Quat *quat, Quat *qOut);
+int quatConjugate(Quat *quat, Quat *qOut);
+// conjugate over the squared length, for unit quaternions use quatConjugate
+int quatInverse(Quat *quat, Quat *qOut);
+
+// hamilton product, rotating by the result applies quat2 first then quat1
+int quatMul(Quat *quat1, Quat *quat2, Quat *qOut);
+int quatRotateVec3(Quat *quat, Vec3 *vec, Vec3 *vOut);
+
+int quatToMat3(Quat *quat, Mat3 *mOut);
+int quatToMat4(Quat *quat, Mat4 *mOut);
+// the matrix must be a pure rotation (orthonormal, determinant 1)
+int quatFromMat3(Mat3 *mat, Quat *qOut);
+// uses the upper 3x3 part, translation is ignored
+int quatFromMat4(Mat4 *mat, Quat *qOut);
+
+// both interpolate along the shorter arc and return a unit quaternion
+int quatNlerp(Quat *quat1, Quat *quat2, nml_t t, Quat *qOut);
+int quatSlerp(Quat *quat1, Quat *quat2, nml_t t, Quat *qOut);
+
+/*
+ * batch versions, n quaternions per array, outputs may alias inputs
+ */
+
+int quatMulBatch(const Quat *q1, const Quat *q2, Quat *qOut, size_t n);
+// zero quaternions come out as identity and make the call return
+// NML_EZERODIV, every other quaternion is still normalized
+int quatNormalizeBatch(const Quat *quats, Quat *qOut, size_t n);
+// blend two poses with the same factor for every element. single precision
+// builds with sse or neon take four quaternions per step, slerp then uses
+// the vmath.h atan2 and sin and can differ from quatSlerp by a few ulp
+int quatNlerpBatch(const Quat *q1, const Quat *q2, nml_t t, Quat *qOut, size_t n);
+int quatSlerpBatch(const Quat *q1, const Quat *q2, nml_t t, Quat *qOut, size_t n);
+int quatToMat4Batch(const Quat *quats, Mat4 *mOut, size_t n);
+// rotate n vectors by the same quaternion
+int quatRotateVec3Batch(const Quat *quat, const Vec3 *in, Vec3 *out, size_t n);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__QUAT_H__
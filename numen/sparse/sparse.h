@@ -0,0 +1,82 @@
+#ifndef __SPARSE_H__
+#define __SPARSE_H__
+
+#include "matrix/matn.h"
+#include "utils/consts.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * compressed sparse matrices
+ *
+ * CSR stores the nonzeros row by row: row i owns values[rowPtr[i] ..
+ * rowPtr[i + 1]) with their column indices in colIdx. CSC is the same with
+ * rows and columns swapped. indices within a row (column) are sorted and
+ * unique. matrices built by the functions below own their arrays
+ */
+
+typedef struct SparseCSR {
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    size_t *rowPtr;   // rows + 1 offsets into colIdx / values
+    uint32_t *colIdx; // column of every nonzero
+    nml_t *values;
+} SparseCSR;
+
+typedef struct SparseCSC {
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    size_t *colPtr;   // cols + 1 offsets into rowIdx / values
+    uint32_t *rowIdx; // row of every nonzero
+    nml_t *values;
+} SparseCSC;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// build from nnz (row, column, value) triplets in any order, duplicates are
+// summed. NML_EINVAL if an index is out of range or a dimension does not fit
+// in 32 bits
+int sparseCSRFromCOO(size_t rows,
+                     size_t cols,
+                     const uint32_t *rowIdx,
+                     const uint32_t *colIdx,
+                     const nml_t *values,
+                     size_t nnz,
+                     SparseCSR *mOut);
+int sparseCSCFromCOO(size_t rows,
+                     size_t cols,
+                     const uint32_t *rowIdx,
+                     const uint32_t *colIdx,
+                     const nml_t *values,
+                     size_t nnz,
+                     SparseCSC *mOut);
+// release storage allocated by the functions above
+void sparseCSRFree(SparseCSR *mat);
+void sparseCSCFree(SparseCSC *mat);
+
+// convert between the two layouts, the source is left untouched
+int sparseCSRToCSC(const SparseCSR *mat, SparseCSC *mOut);
+int sparseCSCToCSR(const SparseCSC *mat, SparseCSR *mOut);
+
+// y = mat * x, x has cols elements and y rows, they must not overlap. the
+// CSR version splits rows across the thread pool, the CSC one splits the
+// columns and sums per thread copies of y, falling back to the calling
+// thread when the copies can't be allocated
+int sparseCSRMulVec(const SparseCSR *mat, const nml_t *x, nml_t *y);
+int sparseCSCMulVec(const SparseCSC *mat, const nml_t *x, nml_t *y);
+
+// mOut = mat * dense, a dense block of right hand sides at once. dense must
+// be mat->cols x n and mOut mat->rows x n, NML_EINVAL otherwise or if they
+// share storage. 8 columns of dense at a time are packed row major into
+// mat->cols x 8 scratch, NML_ENOMEM if it can't be allocated
+int sparseCSRMulMatN(const SparseCSR *mat, const MatN *dense, MatN *mOut);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__SPARSE_H__
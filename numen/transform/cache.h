@@ -0,0 +1,66 @@
+#ifndef __TRANSFORM_CACHE_H__
+#define __TRANSFORM_CACHE_H__
+
+#include "matrix/mat4d.h"
+#include "transform/hierarchy.h"
+#include "utils/consts.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * incremental world transforms
+ *
+ * the cache owns the local and world matrices of a transform tree. setting a
+ * local matrix marks the node dirty, transformCacheUpdate then recomputes
+ * the worlds (and inverses, if enabled) of dirty nodes and everything below
+ * them, nothing else. the nodes it touched are listed in the changed list
+ * until the next update
+ */
+
+// options for transformCacheInit
+enum {
+    NML_TCACHE_INVERSES = 1 << 0, // keep the inverse of every world matrix
+};
+
+typedef struct TransformCache {
+    Mat4Hierarchy hierarchy;
+    Mat4 *locals;
+    Mat4 *worlds;
+    Mat4 *inverses; // NULL without NML_TCACHE_INVERSES
+    uint8_t *flags; // per node dirty / changed bits
+    uint32_t *changed;
+    size_t changedCount;
+    size_t dirtyCount;
+} TransformCache;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// every local matrix starts as the identity and every node dirty.
+// NML_EINVAL if a parent index is out of range or the parents form a cycle
+int transformCacheInit(const int32_t *parents,
+                       size_t count,
+                       unsigned int options,
+                       TransformCache *cOut);
+// release storage allocated by transformCacheInit
+void transformCacheFree(TransformCache *cache);
+
+// replace the local matrix of node and mark it dirty, NML_EINVAL if node is
+// out of range
+int transformCacheSetLocal(TransformCache *cache, size_t node, const Mat4 *local);
+// mark a node dirty after writing cache->locals[node] directly
+int transformCacheMarkDirty(TransformCache *cache, size_t node);
+
+// recompute the dirty subtrees. NML_EZERODIV if any recomputed world matrix
+// is singular, its inverse is zero and everything else is still updated
+int transformCacheUpdate(TransformCache *cache);
+
+// nodes recomputed by the last update, parents before children
+const uint32_t *transformCacheChanged(const TransformCache *cache, size_t *count);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__TRANSFORM_CACHE_H__
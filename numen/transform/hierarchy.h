@@ -0,0 +1,46 @@
+#ifndef __HIERARCHY_H__
+#define __HIERARCHY_H__
+
+#include "matrix/mat4d.h"
+#include "utils/consts.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * world matrices of a transform tree
+ *
+ * world[i] = world[parents[i]] * local[i], roots (parent -1) take their local
+ * matrix as is. the tree is sorted into levels once by mat4HierarchyInit:
+ * every node of a level only depends on the level above, so evaluation splits
+ * each level across threads and feeds siblings to the batch kernel with
+ * their parent's matrix kept in registers
+ */
+
+typedef struct Mat4Hierarchy {
+    size_t count;
+    size_t levelCount;
+    int32_t *parents; // copy of the parent array
+    uint32_t *order;  // node indices level by level, siblings adjacent
+    size_t *levels;   // levelCount + 1 offsets into order
+} Mat4Hierarchy;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// NML_EINVAL if a parent index is out of range or the parents form a cycle
+int mat4HierarchyInit(const int32_t *parents, size_t count, Mat4Hierarchy *hOut);
+// release storage allocated by mat4HierarchyInit
+void mat4HierarchyFree(Mat4Hierarchy *hierarchy);
+
+// count world matrices from count local matrices, worlds must not overlap
+// locals
+int mat4HierarchyEvaluate(const Mat4Hierarchy *hierarchy,
+                          const Mat4 *locals,
+                          Mat4 *worlds);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__HIERARCHY_H__
@@ -0,0 +1,54 @@
+#ifndef __CPU_H__
+#define __CPU_H__
+
+#include "utils/simd.h"
+
+// x86 kernels for wider ISAs are compiled with per-function target attributes
+// and picked at load time, so a portable build still runs AVX2 where present
+//
+// a module taking part defines its NML_AVX2_FN kernels in a *_avx2.c file,
+// compiled for avx2/fma regardless of the global -m flags. they are only ever
+// reached through the module's kernel table, which a load time constructor
+// fills once cpuHasAVX2FMA() confirmed support, and NUMEN_ISA=baseline keeps
+// the baseline table
+#if defined(ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#    define NML_DISPATCH_AVX2
+#    define NML_AVX2_FN __attribute__((target("avx2,fma")))
+#endif
+
+// internal kernel tables stay out of the exported symbol set
+#if defined(__GNUC__) || defined(__clang__)
+#    define NML_HIDDEN __attribute__((visibility("hidden")))
+#else
+#    define NML_HIDDEN
+#endif
+
+// cpu feature bits reported by cpuFeatures()
+enum {
+    NML_CPU_SSE2 = 1 << 0,
+    NML_CPU_SSE41 = 1 << 1,
+    NML_CPU_AVX = 1 << 2,
+    NML_CPU_AVX2 = 1 << 3,
+    NML_CPU_FMA = 1 << 4,
+    NML_CPU_NEON = 1 << 5,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// features usable on this host (cpuid + os support), detected once and cached
+// setting NUMEN_ISA=baseline in the environment masks out everything above
+// the compile time baseline (SSE2/NEON)
+unsigned int cpuFeatures(void);
+// name of the kernel set selected by the dispatcher ("avx2+fma", "sse2", ...)
+const char *cpuBackendName(void);
+// non-zero when cpuFeatures() reports both avx2 and fma, the set every
+// NML_AVX2_FN kernel is compiled for
+int cpuHasAVX2FMA(void);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__CPU_H__
@@ -0,0 +1,26 @@
+#ifndef __INLINE_H__
+#define __INLINE_H__
+
+/*
+ * header-only mode of the small vector and matrix api
+ *
+ * by default every vec2/vec3/vec3a/vec4 and mat2/mat3/mat3a/mat4 function is
+ * an exported symbol of the library. defining NUMEN_INLINE before including
+ * any numen header (or on the command line) turns the per-value functions
+ * into static inline definitions pulled in from the *_inline.h headers, so
+ * the compiler sees through the output pointers and keeps short chains of
+ * operations in registers without link time optimization.
+ *
+ * the array and batch functions (vec3NormalizeBatch, mat4MulVec4Batch, ...)
+ * stay in the library in both modes, they are too large to inline and mat4
+ * picks their kernels at load time. inline mat4 functions always run the
+ * baseline kernels, built for whatever isa the including file targets
+ */
+
+#if defined(NUMEN_INLINE)
+#    define NML_API static inline
+#else
+#    define NML_API
+#endif
+
+#endif // !__INLINE_H__
@@ -26,13 +26,14 @@ static const uint64_t LUT_FACTORIAL[21] = {
 extern "C" {
 #endif // __cplusplus
 
-nml_t DegreesToRads(nml_t n);
-nml_t RadstoDegs(nml_t n);
+nml_t DegsToRads(nml_t n);
+nml_t RadsToDegs(nml_t n);
 nml_t PowInt(nml_t x, int32_t n);
 nml_t PowUInt(nml_t x, uint32_t n);
-// warning: these sqrt and rsqrt functions are approximation not exact 
-nml_t Q_Sqrt(nml_t n);  // same as RSqrt but adjusted for sqrt
-nml_t Q_RSqrt_a(nml_t n); // Quake III fast inverse square root algorithm
+// warning: these sqrt and rsqrt functions are approximation not exact
+// (within 2 ulp in float builds, see SqrtBatch / RSqrtBatch for arrays)
+nml_t Q_Sqrt(nml_t n);
+nml_t Q_RSqrt(nml_t n);
 nml_t Factorial(nml_t n); // lookup table for n <= 20
                           // stirlings approximation for n > 20
                           // for non integer factorials uses gamma function
@@ -0,0 +1,23 @@
+#ifndef __MEMORY_H__
+#define __MEMORY_H__
+
+#include <stddef.h>
+
+// alignment used for every buffer numen allocates, wide enough for 256 bit
+// vector loads and a multiple of the 16 bytes Mat4 needs
+#define NML_ALIGNMENT 32
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// aligned heap allocation, size is rounded up to a multiple of alignment
+// returns NULL on failure, release with alignedFree
+void *alignedAlloc(size_t alignment, size_t size);
+void alignedFree(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__MEMORY_H__
@@ -32,6 +32,11 @@ typedef __m128 simd_f32x4_t;
 
 #    define simd_load_f32(ptr) _mm_load_ps(ptr)
 #    define simd_store_f32(ptr, val) _mm_store_ps(ptr, val)
+#    define simd_loadu_f32(ptr) _mm_loadu_ps(ptr)
+#    define simd_storeu_f32(ptr, val) _mm_storeu_ps(ptr, val)
+// non-temporal store (16 byte aligned ptr), call simd_stream_fence() after
+#    define simd_stream_f32(ptr, val) _mm_stream_ps(ptr, val)
+#    define simd_stream_fence() _mm_sfence()
 #    define simd_set1_f32(val) _mm_set1_ps(val)
 #    define simd_add_f32(a, b) _mm_add_ps(a, b)
 #    define simd_sub_f32(a, b) _mm_sub_ps(a, b)
@@ -59,11 +64,156 @@ typedef __m128 simd_f32x4_t;
 // Fused multiply-add (emulated for SSE)
 #    define simd_fmadd_f32(a, b, c) _mm_add_ps(_mm_mul_ps(a, b), c)
 
+// Square root, min/max
+#    define simd_sqrt_f32(a) _mm_sqrt_ps(a)
+#    define simd_min_f32(a, b) _mm_min_ps(a, b)
+#    define simd_max_f32(a, b) _mm_max_ps(a, b)
+
+// Reciprocal square root estimate (relative error <= 1.5 * 2^-12) and one
+// Newton step y + y/2 * (1 - a*y*y) on it, which roughly doubles the bits
+#    define simd_rsqrt_f32(a) _mm_rsqrt_ps(a)
+static inline __m128 simd_rsqrt_step_f32(__m128 a, __m128 y) {
+    __m128 r = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_mul_ps(a, y), y));
+    return _mm_add_ps(y, _mm_mul_ps(_mm_mul_ps(y, _mm_set1_ps(0.5f)), r));
+}
+
+// Comparisons produce all-ones/all-zero lane masks
+#    define simd_cmplt_f32(a, b) _mm_cmplt_ps(a, b)
+#    define simd_cmple_f32(a, b) _mm_cmple_ps(a, b)
+#    define simd_cmpgt_f32(a, b) _mm_cmpgt_ps(a, b)
+#    define simd_cmpge_f32(a, b) _mm_cmpge_ps(a, b)
+// mask ? a : b
+#    define simd_select_f32(mask, a, b) \
+        _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b))
+// one bit per lane, lane 0 in bit 0
+#    define simd_movemask_f32(mask) _mm_movemask_ps(mask)
+
+// Horizontal sum of all four lanes
+static inline float simd_hsum_f32(simd_f32x4_t v) {
+    __m128 t = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    t = _mm_add_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(t);
+}
+
+// Cross product of the xyz lanes, a x b = (a * b.yzx - a.yzx * b).yzx
+// lane 3 comes out as a.w * b.w - a.w * b.w
+static inline simd_f32x4_t simd_cross3_f32(simd_f32x4_t a, simd_f32x4_t b) {
+    __m128 aYzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 bYzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYzx), _mm_mul_ps(aYzx, b));
+    return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+// In-register 4x4 transpose, rows (or columns) passed as lvalues
+#    define simd_transpose4_f32(r0, r1, r2, r3) _MM_TRANSPOSE4_PS(r0, r1, r2, r3)
+
+// Interleaved xy/xyz/xyzw <-> planar lanes (4 vectors, 8/12/16 floats)
+static inline void simd_load2_f32(const float *ptr,
+                                  simd_f32x4_t *x,
+                                  simd_f32x4_t *y) {
+    __m128 a = _mm_loadu_ps(ptr);     // x0 y0 x1 y1
+    __m128 b = _mm_loadu_ps(ptr + 4); // x2 y2 x3 y3
+    *x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    *y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+static inline void simd_store2_f32(float *ptr, simd_f32x4_t x, simd_f32x4_t y) {
+    _mm_storeu_ps(ptr, _mm_unpacklo_ps(x, y));
+    _mm_storeu_ps(ptr + 4, _mm_unpackhi_ps(x, y));
+}
+
+static inline void simd_load3_f32(const float *ptr,
+                                  simd_f32x4_t *x,
+                                  simd_f32x4_t *y,
+                                  simd_f32x4_t *z) {
+    __m128 a = _mm_loadu_ps(ptr);     // x0 y0 z0 x1
+    __m128 b = _mm_loadu_ps(ptr + 4); // y1 z1 x2 y2
+    __m128 c = _mm_loadu_ps(ptr + 8); // z2 x3 y3 z3
+
+    __m128 t = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+    *x = _mm_shuffle_ps(a, t, _MM_SHUFFLE(2, 0, 3, 0));
+    t = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+    __m128 u = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+    *y = _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0));
+    t = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+    *z = _mm_shuffle_ps(t, c, _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+static inline void simd_store3_f32(float *ptr,
+                                   simd_f32x4_t x,
+                                   simd_f32x4_t y,
+                                   simd_f32x4_t z) {
+    __m128 t = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 u = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+    _mm_storeu_ps(ptr, _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0)));
+    t = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+    u = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+    _mm_storeu_ps(ptr + 4, _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0)));
+    t = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+    u = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+    _mm_storeu_ps(ptr + 8, _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+// Packed 3x3 column block (9 floats), lane 3 of each column is undefined on
+// load and ignored on store. nothing past ptr[8] is read or written
+static inline void simd_load3x3_f32(const float *ptr,
+                                    simd_f32x4_t *c0,
+                                    simd_f32x4_t *c1,
+                                    simd_f32x4_t *c2) {
+    *c0 = _mm_loadu_ps(ptr);
+    *c1 = _mm_loadu_ps(ptr + 3);
+    __m128 t = _mm_loadu_ps(ptr + 5); // e5 e6 e7 e8
+    *c2 = _mm_shuffle_ps(t, t, _MM_SHUFFLE(3, 3, 2, 1));
+}
+
+static inline void simd_store3x3_f32(float *ptr,
+                                     simd_f32x4_t c0,
+                                     simd_f32x4_t c1,
+                                     simd_f32x4_t c2) {
+    _mm_storeu_ps(ptr, c0);
+    _mm_storeu_ps(ptr + 3, c1);
+    // (c1.z c2.x c2.y c2.z) so the last store ends at ptr[8]
+    __m128 t = _mm_shuffle_ps(c1, c2, _MM_SHUFFLE(0, 0, 2, 2));
+    _mm_storeu_ps(ptr + 5, _mm_shuffle_ps(t, c2, _MM_SHUFFLE(2, 1, 2, 0)));
+}
+
+static inline void simd_load4_f32(const float *ptr,
+                                  simd_f32x4_t *x,
+                                  simd_f32x4_t *y,
+                                  simd_f32x4_t *z,
+                                  simd_f32x4_t *w) {
+    __m128 r0 = _mm_loadu_ps(ptr);
+    __m128 r1 = _mm_loadu_ps(ptr + 4);
+    __m128 r2 = _mm_loadu_ps(ptr + 8);
+    __m128 r3 = _mm_loadu_ps(ptr + 12);
+    simd_transpose4_f32(r0, r1, r2, r3);
+    *x = r0;
+    *y = r1;
+    *z = r2;
+    *w = r3;
+}
+
+static inline void simd_store4_f32(float *ptr,
+                                   simd_f32x4_t x,
+                                   simd_f32x4_t y,
+                                   simd_f32x4_t z,
+                                   simd_f32x4_t w) {
+    simd_transpose4_f32(x, y, z, w);
+    _mm_storeu_ps(ptr, x);
+    _mm_storeu_ps(ptr + 4, y);
+    _mm_storeu_ps(ptr + 8, z);
+    _mm_storeu_ps(ptr + 12, w);
+}
+
 #elif defined(DEFINE_SIMD__NEON)
 typedef float32x4_t simd_f32x4_t;
 
 #    define simd_load_f32(ptr) vld1q_f32(ptr)
 #    define simd_store_f32(ptr, val) vst1q_f32(ptr, val)
+#    define simd_loadu_f32(ptr) vld1q_f32(ptr)
+#    define simd_storeu_f32(ptr, val) vst1q_f32(ptr, val)
+#    define simd_stream_f32(ptr, val) vst1q_f32(ptr, val)
+#    define simd_stream_fence() ((void)0)
 #    define simd_set1_f32(val) vdupq_n_f32(val)
 #    define simd_add_f32(a, b) vaddq_f32(a, b)
 #    define simd_sub_f32(a, b) vsubq_f32(a, b)
@@ -95,6 +245,147 @@ typedef float32x4_t simd_f32x4_t;
 // Fused multiply-add (native in NEON)
 #    define simd_fmadd_f32(a, b, c) vmlaq_f32(c, a, b)
 
+// Square root, min/max
+#    define simd_sqrt_f32(a) vsqrtq_f32(a)
+#    define simd_min_f32(a, b) vminq_f32(a, b)
+#    define simd_max_f32(a, b) vmaxq_f32(a, b)
+
+// Reciprocal square root estimate (about 8 bits) and one Newton step on it,
+// vrsqrtsq computes (3 - a*y*y) / 2
+#    define simd_rsqrt_f32(a) vrsqrteq_f32(a)
+#    define simd_rsqrt_step_f32(a, y) \
+        vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(a, y), y))
+
+// Comparisons produce all-ones/all-zero lane masks
+#    define simd_cmplt_f32(a, b) vreinterpretq_f32_u32(vcltq_f32(a, b))
+#    define simd_cmple_f32(a, b) vreinterpretq_f32_u32(vcleq_f32(a, b))
+#    define simd_cmpgt_f32(a, b) vreinterpretq_f32_u32(vcgtq_f32(a, b))
+#    define simd_cmpge_f32(a, b) vreinterpretq_f32_u32(vcgeq_f32(a, b))
+// mask ? a : b
+#    define simd_select_f32(mask, a, b) \
+        vbslq_f32(vreinterpretq_u32_f32(mask), a, b)
+// one bit per lane, lane 0 in bit 0
+static inline int simd_movemask_f32(simd_f32x4_t mask) {
+    static const int32_t shifts[4] = {0, 1, 2, 3};
+    uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(mask), 31);
+    return (int)vaddvq_u32(vshlq_u32(bits, vld1q_s32(shifts)));
+}
+
+// Horizontal sum of all four lanes
+static inline float simd_hsum_f32(simd_f32x4_t v) {
+#    if defined(__aarch64__)
+    return vaddvq_f32(v);
+#    else
+    float32x2_t t = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(t, t), 0);
+#    endif
+}
+
+// Cross product of the xyz lanes, lane 3 is zero. (y z x y) is built from
+// the 64 bit halves, the stray last lane is patched at the end
+static inline simd_f32x4_t simd_cross3_f32(simd_f32x4_t a, simd_f32x4_t b) {
+    float32x4_t aYzx = vcombine_f32(
+        vext_f32(vget_low_f32(a), vget_high_f32(a), 1), vget_low_f32(a));
+    float32x4_t bYzx = vcombine_f32(
+        vext_f32(vget_low_f32(b), vget_high_f32(b), 1), vget_low_f32(b));
+    float32x4_t c = vsubq_f32(vmulq_f32(a, bYzx), vmulq_f32(aYzx, b));
+    c = vcombine_f32(vext_f32(vget_low_f32(c), vget_high_f32(c), 1),
+                     vget_low_f32(c));
+    return vsetq_lane_f32(0.0f, c, 3);
+}
+
+// In-register 4x4 transpose: vtrn swaps the odd/even lanes of each row pair,
+// recombining the 64 bit halves finishes the job
+#    define simd_transpose4_f32(r0, r1, r2, r3)                              \
+        do {                                                                 \
+            float32x4x2_t _t01 = vtrnq_f32(r0, r1);                          \
+            float32x4x2_t _t23 = vtrnq_f32(r2, r3);                          \
+            (r0) = vcombine_f32(vget_low_f32(_t01.val[0]),                   \
+                                vget_low_f32(_t23.val[0]));                  \
+            (r1) = vcombine_f32(vget_low_f32(_t01.val[1]),                   \
+                                vget_low_f32(_t23.val[1]));                  \
+            (r2) = vcombine_f32(vget_high_f32(_t01.val[0]),                  \
+                                vget_high_f32(_t23.val[0]));                 \
+            (r3) = vcombine_f32(vget_high_f32(_t01.val[1]),                  \
+                                vget_high_f32(_t23.val[1]));                 \
+        } while (0)
+
+// Interleaved xy/xyz/xyzw <-> planar lanes (4 vectors, 8/12/16 floats)
+static inline void simd_load2_f32(const float *ptr,
+                                  simd_f32x4_t *x,
+                                  simd_f32x4_t *y) {
+    float32x4x2_t v = vld2q_f32(ptr);
+    *x = v.val[0];
+    *y = v.val[1];
+}
+
+static inline void simd_store2_f32(float *ptr, simd_f32x4_t x, simd_f32x4_t y) {
+    float32x4x2_t v = {{x, y}};
+    vst2q_f32(ptr, v);
+}
+
+static inline void simd_load3_f32(const float *ptr,
+                                  simd_f32x4_t *x,
+                                  simd_f32x4_t *y,
+                                  simd_f32x4_t *z) {
+    float32x4x3_t v = vld3q_f32(ptr);
+    *x = v.val[0];
+    *y = v.val[1];
+    *z = v.val[2];
+}
+
+static inline void simd_store3_f32(float *ptr,
+                                   simd_f32x4_t x,
+                                   simd_f32x4_t y,
+                                   simd_f32x4_t z) {
+    float32x4x3_t v = {{x, y, z}};
+    vst3q_f32(ptr, v);
+}
+
+// Packed 3x3 column block (9 floats), lane 3 of each column is undefined on
+// load and ignored on store. nothing past ptr[8] is read or written
+static inline void simd_load3x3_f32(const float *ptr,
+                                    simd_f32x4_t *c0,
+                                    simd_f32x4_t *c1,
+                                    simd_f32x4_t *c2) {
+    *c0 = vld1q_f32(ptr);
+    *c1 = vld1q_f32(ptr + 3);
+    float32x4_t t = vld1q_f32(ptr + 5); // e5 e6 e7 e8
+    *c2 = vextq_f32(t, t, 1);
+}
+
+static inline void simd_store3x3_f32(float *ptr,
+                                     simd_f32x4_t c0,
+                                     simd_f32x4_t c1,
+                                     simd_f32x4_t c2) {
+    vst1q_f32(ptr, c0);
+    vst1q_f32(ptr + 3, c1);
+    // (c1.z c2.x c2.y c2.z) so the last store ends at ptr[8]
+    float32x4_t t = vextq_f32(c2, c2, 3);
+    vst1q_f32(ptr + 5, vsetq_lane_f32(vgetq_lane_f32(c1, 2), t, 0));
+}
+
+static inline void simd_load4_f32(const float *ptr,
+                                  simd_f32x4_t *x,
+                                  simd_f32x4_t *y,
+                                  simd_f32x4_t *z,
+                                  simd_f32x4_t *w) {
+    float32x4x4_t v = vld4q_f32(ptr);
+    *x = v.val[0];
+    *y = v.val[1];
+    *z = v.val[2];
+    *w = v.val[3];
+}
+
+static inline void simd_store4_f32(float *ptr,
+                                   simd_f32x4_t x,
+                                   simd_f32x4_t y,
+                                   simd_f32x4_t z,
+                                   simd_f32x4_t w) {
+    float32x4x4_t v = {{x, y, z, w}};
+    vst4q_f32(ptr, v);
+}
+
 // Shuffle equivalent for NEON (limited)
 #    define SIMD_SHUFFLE(z, y, x, w) ((z) << 6 | (y) << 4 | (x) << 2 | (w))
 
@@ -104,62 +395,420 @@ typedef struct {
     float f[4];
 } simd_f32x4_t;
 
-#    define simd_load_f32(ptr)                         \
-        (simd_f32x4_t) {                               \
-            {                                          \
-                (ptr)[0], (ptr)[1], (ptr)[2], (ptr)[3] \
-            }                                          \
+// functions rather than compound literal macros so wrappers like the nml4
+// ops below can forward already expanded arguments
+#    define SIMD_F32_LANEWISE(name, expr)                                  \
+        static inline simd_f32x4_t name(simd_f32x4_t a, simd_f32x4_t b) { \
+            simd_f32x4_t r;                                                \
+            for (int i = 0; i < 4; i++)                                    \
+                r.f[i] = (expr);                                           \
+            return r;                                                      \
         }
-#    define simd_store_f32(ptr, val) \
-        do {                         \
-            (ptr)[0] = (val).f[0];   \
-            (ptr)[1] = (val).f[1];   \
-            (ptr)[2] = (val).f[2];   \
-            (ptr)[3] = (val).f[3];   \
+
+static inline simd_f32x4_t simd_load_f32(const float *ptr) {
+    simd_f32x4_t r = {{ptr[0], ptr[1], ptr[2], ptr[3]}};
+    return r;
+}
+
+static inline void simd_store_f32(float *ptr, simd_f32x4_t val) {
+    for (int i = 0; i < 4; i++)
+        ptr[i] = val.f[i];
+}
+
+#    define simd_loadu_f32(ptr) simd_load_f32(ptr)
+#    define simd_storeu_f32(ptr, val) simd_store_f32(ptr, val)
+#    define simd_stream_f32(ptr, val) simd_store_f32(ptr, val)
+#    define simd_stream_fence() ((void)0)
+
+static inline simd_f32x4_t simd_set1_f32(float val) {
+    simd_f32x4_t r = {{val, val, val, val}};
+    return r;
+}
+
+SIMD_F32_LANEWISE(simd_add_f32, a.f[i] + b.f[i])
+SIMD_F32_LANEWISE(simd_sub_f32, a.f[i] - b.f[i])
+SIMD_F32_LANEWISE(simd_mul_f32, a.f[i] * b.f[i])
+SIMD_F32_LANEWISE(simd_div_f32, a.f[i] / b.f[i])
+#    undef SIMD_F32_LANEWISE
+
+static inline simd_f32x4_t simd_negate_f32(simd_f32x4_t a) {
+    for (int i = 0; i < 4; i++)
+        a.f[i] = -a.f[i];
+    return a;
+}
+
+static inline simd_f32x4_t simd_fmadd_f32(simd_f32x4_t a,
+                                          simd_f32x4_t b,
+                                          simd_f32x4_t c) {
+    for (int i = 0; i < 4; i++)
+        c.f[i] += a.f[i] * b.f[i];
+    return c;
+}
+
+static inline float simd_hsum_f32(simd_f32x4_t v) {
+    return v.f[0] + v.f[1] + v.f[2] + v.f[3];
+}
+
+static inline void simd_load3x3_f32(const float *ptr,
+                                    simd_f32x4_t *c0,
+                                    simd_f32x4_t *c1,
+                                    simd_f32x4_t *c2) {
+    simd_f32x4_t *c[3] = {c0, c1, c2};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            c[i]->f[j] = ptr[i * 3 + j];
+        c[i]->f[3] = 0.0f;
+    }
+}
+
+static inline void simd_store3x3_f32(float *ptr,
+                                     simd_f32x4_t c0,
+                                     simd_f32x4_t c1,
+                                     simd_f32x4_t c2) {
+    const simd_f32x4_t *c[3] = {&c0, &c1, &c2};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            ptr[i * 3 + j] = c[i]->f[j];
+    }
+}
+
+static inline simd_f32x4_t simd_cross3_f32(simd_f32x4_t a, simd_f32x4_t b) {
+    simd_f32x4_t r = {{a.f[1] * b.f[2] - a.f[2] * b.f[1],
+                       a.f[2] * b.f[0] - a.f[0] * b.f[2],
+                       a.f[0] * b.f[1] - a.f[1] * b.f[0], 0.0f}};
+    return r;
+}
+
+#    define simd_transpose4_f32(r0, r1, r2, r3)                        \
+        do {                                                           \
+            simd_f32x4_t *_r[4] = {&(r0), &(r1), &(r2), &(r3)};        \
+            for (int _i = 0; _i < 4; _i++) {                           \
+                for (int _j = _i + 1; _j < 4; _j++) {                  \
+                    float _t = _r[_i]->f[_j];                          \
+                    _r[_i]->f[_j] = _r[_j]->f[_i];                     \
+                    _r[_j]->f[_i] = _t;                                \
+                }                                                      \
+            }                                                          \
         } while (0)
-#    define simd_set1_f32(val)             \
-        (simd_f32x4_t) {                   \
-            {                              \
-                (val), (val), (val), (val) \
-            }                              \
-        }
-#    define simd_add_f32(a, b)                                                 \
-        (simd_f32x4_t) {                                                       \
-            {                                                                  \
-                (a).f[0] + (b).f[0], (a).f[1] + (b).f[1], (a).f[2] + (b).f[2], \
-                    (a).f[3] + (b).f[3]                                        \
-            }                                                                  \
-        }
-#    define simd_sub_f32(a, b)                                                 \
-        (simd_f32x4_t) {                                                       \
-            {                                                                  \
-                (a).f[0] - (b).f[0], (a).f[1] - (b).f[1], (a).f[2] - (b).f[2], \
-                    (a).f[3] - (b).f[3]                                        \
-            }                                                                  \
-        }
-#    define simd_mul_f32(a, b)                                                 \
-        (simd_f32x4_t) {                                                       \
-            {                                                                  \
-                (a).f[0] * (b).f[0], (a).f[1] * (b).f[1], (a).f[2] * (b).f[2], \
-                    (a).f[3] * (b).f[3]                                        \
-            }                                                                  \
-        }
-#    define simd_negate_f32(a)                             \
-        (simd_f32x4_t) {                                   \
-            {                                              \
-                -(a).f[0], -(a).f[1], -(a).f[2], -(a).f[3] \
-            }                                              \
-        }
-#    define simd_fmadd_f32(a, b, c)                 \
-        (simd_f32x4_t) {                            \
-            {                                       \
-                (a).f[0] * (b).f[0] + (c).f[0],     \
-                    (a).f[1] * (b).f[1] + (c).f[1], \
-                    (a).f[2] * (b).f[2] + (c).f[2], \
-                    (a).f[3] * (b).f[3] + (c).f[3]  \
-            }                                       \
-        }
 
 #endif
 
+// == double precision ==
+// f64x2 is the native 128 bit register, f64x4 holds one Mat4 column and maps
+// to __m256d when the compiler targets AVX, otherwise to a pair of f64x2
+#if defined(DEFINE_SIMD__SSE)
+typedef __m128d simd_f64x2_t;
+
+#    define simd_load_f64(ptr) _mm_load_pd(ptr)
+#    define simd_store_f64(ptr, val) _mm_store_pd(ptr, val)
+#    define simd_loadu_f64(ptr) _mm_loadu_pd(ptr)
+#    define simd_storeu_f64(ptr, val) _mm_storeu_pd(ptr, val)
+#    define simd_stream_f64(ptr, val) _mm_stream_pd(ptr, val)
+#    define simd_set1_f64(val) _mm_set1_pd(val)
+#    define simd_add_f64(a, b) _mm_add_pd(a, b)
+#    define simd_sub_f64(a, b) _mm_sub_pd(a, b)
+#    define simd_mul_f64(a, b) _mm_mul_pd(a, b)
+#    define simd_div_f64(a, b) _mm_div_pd(a, b)
+#    define simd_sqrt_f64(a) _mm_sqrt_pd(a)
+#    define simd_min_f64(a, b) _mm_min_pd(a, b)
+#    define simd_max_f64(a, b) _mm_max_pd(a, b)
+#    define simd_negate_f64(a) _mm_xor_pd(a, _mm_set1_pd(-0.0))
+// Fused multiply-add (emulated for SSE)
+#    define simd_fmadd_f64(a, b, c) _mm_add_pd(_mm_mul_pd(a, b), c)
+// Broadcast lane 0/1
+#    define simd_dup0_f64(a) _mm_unpacklo_pd(a, a)
+#    define simd_dup1_f64(a) _mm_unpackhi_pd(a, a)
+// (a0 b0), (a1 b1)
+#    define simd_unpacklo_f64(a, b) _mm_unpacklo_pd(a, b)
+#    define simd_unpackhi_f64(a, b) _mm_unpackhi_pd(a, b)
+#    define simd_extract0_f64(a) _mm_cvtsd_f64(a)
+#    define simd_extract1_f64(a) _mm_cvtsd_f64(_mm_unpackhi_pd(a, a))
+
+#elif defined(DEFINE_SIMD__NEON) && defined(__aarch64__)
+typedef float64x2_t simd_f64x2_t;
+
+#    define simd_load_f64(ptr) vld1q_f64(ptr)
+#    define simd_store_f64(ptr, val) vst1q_f64(ptr, val)
+#    define simd_loadu_f64(ptr) vld1q_f64(ptr)
+#    define simd_storeu_f64(ptr, val) vst1q_f64(ptr, val)
+#    define simd_stream_f64(ptr, val) vst1q_f64(ptr, val)
+#    define simd_set1_f64(val) vdupq_n_f64(val)
+#    define simd_add_f64(a, b) vaddq_f64(a, b)
+#    define simd_sub_f64(a, b) vsubq_f64(a, b)
+#    define simd_mul_f64(a, b) vmulq_f64(a, b)
+#    define simd_div_f64(a, b) vdivq_f64(a, b)
+#    define simd_sqrt_f64(a) vsqrtq_f64(a)
+#    define simd_min_f64(a, b) vminq_f64(a, b)
+#    define simd_max_f64(a, b) vmaxq_f64(a, b)
+#    define simd_negate_f64(a) vnegq_f64(a)
+#    define simd_fmadd_f64(a, b, c) vfmaq_f64(c, a, b)
+#    define simd_dup0_f64(a) vdupq_laneq_f64(a, 0)
+#    define simd_dup1_f64(a) vdupq_laneq_f64(a, 1)
+#    define simd_unpacklo_f64(a, b) vzip1q_f64(a, b)
+#    define simd_unpackhi_f64(a, b) vzip2q_f64(a, b)
+#    define simd_extract0_f64(a) vgetq_lane_f64(a, 0)
+#    define simd_extract1_f64(a) vgetq_lane_f64(a, 1)
+
+#else
+// Scalar fallback (also armv7, whose NEON has no double lanes)
+typedef struct {
+    double f[2];
+} simd_f64x2_t;
+
+static inline simd_f64x2_t simd_load_f64(const double *ptr) {
+    simd_f64x2_t r = {{ptr[0], ptr[1]}};
+    return r;
+}
+
+static inline void simd_store_f64(double *ptr, simd_f64x2_t val) {
+    ptr[0] = val.f[0];
+    ptr[1] = val.f[1];
+}
+
+#    define simd_loadu_f64(ptr) simd_load_f64(ptr)
+#    define simd_storeu_f64(ptr, val) simd_store_f64(ptr, val)
+#    define simd_stream_f64(ptr, val) simd_store_f64(ptr, val)
+
+static inline simd_f64x2_t simd_set1_f64(double val) {
+    simd_f64x2_t r = {{val, val}};
+    return r;
+}
+
+static inline simd_f64x2_t simd_add_f64(simd_f64x2_t a, simd_f64x2_t b) {
+    simd_f64x2_t r = {{a.f[0] + b.f[0], a.f[1] + b.f[1]}};
+    return r;
+}
+
+static inline simd_f64x2_t simd_sub_f64(simd_f64x2_t a, simd_f64x2_t b) {
+    simd_f64x2_t r = {{a.f[0] - b.f[0], a.f[1] - b.f[1]}};
+    return r;
+}
+
+static inline simd_f64x2_t simd_mul_f64(simd_f64x2_t a, simd_f64x2_t b) {
+    simd_f64x2_t r = {{a.f[0] * b.f[0], a.f[1] * b.f[1]}};
+    return r;
+}
+
+static inline simd_f64x2_t simd_div_f64(simd_f64x2_t a, simd_f64x2_t b) {
+    simd_f64x2_t r = {{a.f[0] / b.f[0], a.f[1] / b.f[1]}};
+    return r;
+}
+
+static inline simd_f64x2_t simd_negate_f64(simd_f64x2_t a) {
+    simd_f64x2_t r = {{-a.f[0], -a.f[1]}};
+    return r;
+}
+
+static inline simd_f64x2_t simd_fmadd_f64(simd_f64x2_t a,
+                                          simd_f64x2_t b,
+                                          simd_f64x2_t c) {
+    simd_f64x2_t r = {{a.f[0] * b.f[0] + c.f[0], a.f[1] * b.f[1] + c.f[1]}};
+    return r;
+}
+
+static inline simd_f64x2_t simd_unpacklo_f64(simd_f64x2_t a, simd_f64x2_t b) {
+    simd_f64x2_t r = {{a.f[0], b.f[0]}};
+    return r;
+}
+
+static inline simd_f64x2_t simd_unpackhi_f64(simd_f64x2_t a, simd_f64x2_t b) {
+    simd_f64x2_t r = {{a.f[1], b.f[1]}};
+    return r;
+}
+
+#    define simd_dup0_f64(a) simd_set1_f64((a).f[0])
+#    define simd_dup1_f64(a) simd_set1_f64((a).f[1])
+#    define simd_extract0_f64(a) ((a).f[0])
+#    define simd_extract1_f64(a) ((a).f[1])
+#endif
+
+#if defined(DEFINE_SIMD__SSE) && defined(__AVX__)
+#    include <immintrin.h>
+typedef __m256d simd_f64x4_t;
+
+// Mat4 only guarantees 16 byte alignment, so even "aligned" loads are loadu
+#    define simd_load_f64x4(ptr) _mm256_loadu_pd(ptr)
+#    define simd_store_f64x4(ptr, val) _mm256_storeu_pd(ptr, val)
+#    define simd_loadu_f64x4(ptr) _mm256_loadu_pd(ptr)
+#    define simd_storeu_f64x4(ptr, val) _mm256_storeu_pd(ptr, val)
+#    define simd_stream_f64x4(ptr, val) _mm256_storeu_pd(ptr, val)
+#    define simd_set1_f64x4(val) _mm256_set1_pd(val)
+#    define simd_add_f64x4(a, b) _mm256_add_pd(a, b)
+#    define simd_sub_f64x4(a, b) _mm256_sub_pd(a, b)
+#    define simd_mul_f64x4(a, b) _mm256_mul_pd(a, b)
+#    define simd_div_f64x4(a, b) _mm256_div_pd(a, b)
+#    define simd_negate_f64x4(a) _mm256_xor_pd(a, _mm256_set1_pd(-0.0))
+#    if defined(__FMA__)
+#        define simd_fmadd_f64x4(a, b, c) _mm256_fmadd_pd(a, b, c)
+#    else
+#        define simd_fmadd_f64x4(a, b, c) _mm256_add_pd(_mm256_mul_pd(a, b), c)
+#    endif
+static inline double simd_hsum_f64x4(simd_f64x4_t v) {
+    __m128d t =
+        _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(t, _mm_unpackhi_pd(t, t)));
+}
+#    define simd_transpose4_f64x4(r0, r1, r2, r3)                 \
+        do {                                                      \
+            __m256d _t0 = _mm256_unpacklo_pd(r0, r1);             \
+            __m256d _t1 = _mm256_unpackhi_pd(r0, r1);             \
+            __m256d _t2 = _mm256_unpacklo_pd(r2, r3);             \
+            __m256d _t3 = _mm256_unpackhi_pd(r2, r3);             \
+            (r0) = _mm256_permute2f128_pd(_t0, _t2, 0x20);        \
+            (r1) = _mm256_permute2f128_pd(_t1, _t3, 0x20);        \
+            (r2) = _mm256_permute2f128_pd(_t0, _t2, 0x31);        \
+            (r3) = _mm256_permute2f128_pd(_t1, _t3, 0x31);        \
+        } while (0)
+
+#else
+typedef struct {
+    simd_f64x2_t lo, hi;
+} simd_f64x4_t;
+
+static inline simd_f64x4_t simd_load_f64x4(const double *ptr) {
+    simd_f64x4_t r = {simd_load_f64(ptr), simd_load_f64(ptr + 2)};
+    return r;
+}
+
+static inline simd_f64x4_t simd_loadu_f64x4(const double *ptr) {
+    simd_f64x4_t r = {simd_loadu_f64(ptr), simd_loadu_f64(ptr + 2)};
+    return r;
+}
+
+static inline void simd_store_f64x4(double *ptr, simd_f64x4_t val) {
+    simd_store_f64(ptr, val.lo);
+    simd_store_f64(ptr + 2, val.hi);
+}
+
+static inline void simd_storeu_f64x4(double *ptr, simd_f64x4_t val) {
+    simd_storeu_f64(ptr, val.lo);
+    simd_storeu_f64(ptr + 2, val.hi);
+}
+
+static inline void simd_stream_f64x4(double *ptr, simd_f64x4_t val) {
+    simd_stream_f64(ptr, val.lo);
+    simd_stream_f64(ptr + 2, val.hi);
+}
+
+static inline simd_f64x4_t simd_set1_f64x4(double val) {
+    simd_f64x4_t r = {simd_set1_f64(val), simd_set1_f64(val)};
+    return r;
+}
+
+static inline simd_f64x4_t simd_add_f64x4(simd_f64x4_t a, simd_f64x4_t b) {
+    simd_f64x4_t r = {simd_add_f64(a.lo, b.lo), simd_add_f64(a.hi, b.hi)};
+    return r;
+}
+
+static inline simd_f64x4_t simd_sub_f64x4(simd_f64x4_t a, simd_f64x4_t b) {
+    simd_f64x4_t r = {simd_sub_f64(a.lo, b.lo), simd_sub_f64(a.hi, b.hi)};
+    return r;
+}
+
+static inline simd_f64x4_t simd_mul_f64x4(simd_f64x4_t a, simd_f64x4_t b) {
+    simd_f64x4_t r = {simd_mul_f64(a.lo, b.lo), simd_mul_f64(a.hi, b.hi)};
+    return r;
+}
+
+static inline simd_f64x4_t simd_div_f64x4(simd_f64x4_t a, simd_f64x4_t b) {
+    simd_f64x4_t r = {simd_div_f64(a.lo, b.lo), simd_div_f64(a.hi, b.hi)};
+    return r;
+}
+
+static inline simd_f64x4_t simd_negate_f64x4(simd_f64x4_t a) {
+    simd_f64x4_t r = {simd_negate_f64(a.lo), simd_negate_f64(a.hi)};
+    return r;
+}
+
+static inline simd_f64x4_t simd_fmadd_f64x4(simd_f64x4_t a,
+                                            simd_f64x4_t b,
+                                            simd_f64x4_t c) {
+    simd_f64x4_t r = {simd_fmadd_f64(a.lo, b.lo, c.lo),
+                      simd_fmadd_f64(a.hi, b.hi, c.hi)};
+    return r;
+}
+
+static inline double simd_hsum_f64x4(simd_f64x4_t v) {
+    simd_f64x2_t t = simd_add_f64(v.lo, v.hi);
+    return simd_extract0_f64(t) + simd_extract1_f64(t);
+}
+
+// 2x2 blocks of 2x2 transposes
+static inline void simd_transpose4p_f64x4(simd_f64x4_t *r0,
+                                          simd_f64x4_t *r1,
+                                          simd_f64x4_t *r2,
+                                          simd_f64x4_t *r3) {
+    simd_f64x4_t o0 = {simd_unpacklo_f64(r0->lo, r1->lo),
+                       simd_unpacklo_f64(r2->lo, r3->lo)};
+    simd_f64x4_t o1 = {simd_unpackhi_f64(r0->lo, r1->lo),
+                       simd_unpackhi_f64(r2->lo, r3->lo)};
+    simd_f64x4_t o2 = {simd_unpacklo_f64(r0->hi, r1->hi),
+                       simd_unpacklo_f64(r2->hi, r3->hi)};
+    simd_f64x4_t o3 = {simd_unpackhi_f64(r0->hi, r1->hi),
+                       simd_unpackhi_f64(r2->hi, r3->hi)};
+    *r0 = o0;
+    *r1 = o1;
+    *r2 = o2;
+    *r3 = o3;
+}
+#    define simd_transpose4_f64x4(r0, r1, r2, r3) \
+        simd_transpose4p_f64x4(&(r0), &(r1), &(r2), &(r3))
+#endif
+
+// == nml_t wide ops ==
+// four lanes of nml_t in either precision (one Vec4 / Mat4 column), so
+// kernels that only need lane-wise arithmetic are written once
+#if defined(USE_DOUBLE_PRECISION)
+typedef simd_f64x4_t simd_nml4_t;
+
+#    define simd_load_nml4(ptr) simd_load_f64x4(ptr)
+#    define simd_loadu_nml4(ptr) simd_loadu_f64x4(ptr)
+#    define simd_store_nml4(ptr, val) simd_store_f64x4(ptr, val)
+#    define simd_storeu_nml4(ptr, val) simd_storeu_f64x4(ptr, val)
+#    define simd_stream_nml4(ptr, val) simd_stream_f64x4(ptr, val)
+#    define simd_set1_nml4(val) simd_set1_f64x4(val)
+#    define simd_add_nml4(a, b) simd_add_f64x4(a, b)
+#    define simd_sub_nml4(a, b) simd_sub_f64x4(a, b)
+#    define simd_mul_nml4(a, b) simd_mul_f64x4(a, b)
+#    define simd_div_nml4(a, b) simd_div_f64x4(a, b)
+#    define simd_negate_nml4(a) simd_negate_f64x4(a)
+#    define simd_fmadd_nml4(a, b, c) simd_fmadd_f64x4(a, b, c)
+#    define simd_transpose4_nml4(r0, r1, r2, r3) \
+        simd_transpose4_f64x4(r0, r1, r2, r3)
+#    define simd_hsum_nml4(v) simd_hsum_f64x4(v)
+#else
+typedef simd_f32x4_t simd_nml4_t;
+
+#    define simd_load_nml4(ptr) simd_load_f32(ptr)
+#    define simd_loadu_nml4(ptr) simd_loadu_f32(ptr)
+#    define simd_store_nml4(ptr, val) simd_store_f32(ptr, val)
+#    define simd_storeu_nml4(ptr, val) simd_storeu_f32(ptr, val)
+#    define simd_stream_nml4(ptr, val) simd_stream_f32(ptr, val)
+#    define simd_set1_nml4(val) simd_set1_f32(val)
+#    define simd_add_nml4(a, b) simd_add_f32(a, b)
+#    define simd_sub_nml4(a, b) simd_sub_f32(a, b)
+#    define simd_mul_nml4(a, b) simd_mul_f32(a, b)
+#    define simd_div_nml4(a, b) simd_div_f32(a, b)
+#    define simd_negate_nml4(a) simd_negate_f32(a)
+#    define simd_fmadd_nml4(a, b, c) simd_fmadd_f32(a, b, c)
+#    define simd_transpose4_nml4(r0, r1, r2, r3) \
+        simd_transpose4_f32(r0, r1, r2, r3)
+#    define simd_hsum_nml4(v) simd_hsum_f32(v)
+#endif
+
+// nml_t arrays can go straight through the f32x4 kernels (single precision
+// build with a vector unit); the scalar fallback above only covers plain
+// arithmetic, kernels keep their own scalar loops for it
+#if (defined(DEFINE_SIMD__SSE) || defined(DEFINE_SIMD__NEON)) && \
+    !defined(USE_DOUBLE_PRECISION)
+#    define NML_SIMD_F32
+#endif
+
+// same for double precision builds and the f64x2 kernels
+#if (defined(DEFINE_SIMD__SSE) ||                               \
+     (defined(DEFINE_SIMD__NEON) && defined(__aarch64__))) &&   \
+    defined(USE_DOUBLE_PRECISION)
+#    define NML_SIMD_F64
+#endif
+
 #endif // !__SIMD_H__
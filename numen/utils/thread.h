@@ -0,0 +1,36 @@
+#ifndef __THREAD_H__
+#define __THREAD_H__
+
+#include <stddef.h>
+
+/*
+ * minimal fork-join parallelism for the batch apis
+ *
+ * a fixed pool of worker threads is started on first use, the calling thread
+ * takes part in every loop. the pool size comes from NUMEN_THREADS in the
+ * environment or the number of online cpus
+ */
+
+// body of a parallel loop, called with half open ranges [begin, end)
+typedef void (*ParallelFn)(void *ctx, size_t begin, size_t end);
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// threads a parallel loop runs on, including the caller
+int threadCount(void);
+// resize the pool, 1 runs every loop on the calling thread. must not be
+// called while a parallel loop is running
+int threadSetCount(int count);
+
+// run fn over [0, n) split into ranges of at least grain items and wait for
+// all of them. loops started from inside a loop body, or while another
+// thread's loop is running, run on the calling thread
+int parallelFor(size_t n, size_t grain, ParallelFn fn, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__THREAD_H__
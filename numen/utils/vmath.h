@@ -0,0 +1,93 @@
+#ifndef __VMATH_H__
+#define __VMATH_H__
+
+#include "utils/consts.h"
+#include "utils/simd.h"
+#include <stddef.h>
+
+/*
+ * vectorized elementary functions
+ *
+ * polynomial approximations evaluated four lanes at a time (eight on AVX2
+ * hosts for the array versions). errors are in units in the last place of
+ * the float result, measured against the double precision libm:
+ *
+ *   sin, cos, sincos   |x| <= 8192          2.5 ulp
+ *   tan                |x| <= 8192          3.5 ulp
+ *   atan2              all finite inputs    3.5 ulp
+ *   exp                [-87.3, 88.7]        1.5 ulp
+ *   log                (0, inf)             1.5 ulp
+ *   pow                |y * log(x)| <= 88   2 + |y * log(x)| / 5 ulp
+ *
+ * the trig range reduction is exact up to |x| = 8192. past it only the
+ * absolute error stays small, about 1e-6 at |x| = 1e5 (1e-7 with fma), and
+ * results next to a zero of sin or cos lose all their bits. infinities and
+ * nans follow libm for exp, log and atan2, except that exp results below the
+ * smallest normal float flush to zero. pow of a negative x is defined for
+ * integer y only, pow(x, 0) is 1 for every x
+ *
+ * the array functions take nml_t. in double precision builds, or builds
+ * without a vector unit, they call the libm double functions instead and
+ * are exact to libm. out may be the same array as an input
+ *
+ * rsqrt and sqrt start from the hardware reciprocal square root estimate
+ * (rsqrtps, vrsqrteq) and refine it with newton steps, the accuracy tier
+ * picks how many. maximum errors on x86 over all normal floats:
+ *
+ *                      rsqrt (relative)   sqrt
+ *   NML_SQRT_FAST      3.7e-4             4096 ulp
+ *   NML_SQRT_REFINED   2.4e-7             3.5 ulp
+ *   NML_SQRT_PRECISE   1.1e-7             2 ulp
+ *
+ * the neon estimate only has about 8 bits, there NML_SQRT_FAST is good to
+ * 3.9e-3 and NML_SQRT_REFINED to about 2.5e-5. zero and infinite inputs
+ * give the exact result, subnormal ones may be treated as zero. the array
+ * functions of double builds and everything in no-SIMD builds ignore the
+ * tier and are exact
+ */
+
+// accuracy tiers of the rsqrt / sqrt functions, the number of newton steps.
+// any other value, in the lane and the batch functions alike, runs as
+// NML_SQRT_PRECISE
+enum {
+    NML_SQRT_FAST = 0,    // estimate only
+    NML_SQRT_REFINED = 1, // one newton step
+    NML_SQRT_PRECISE = 2, // two newton steps
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// four lanes at once, single precision in every build
+simd_f32x4_t SimdSin(simd_f32x4_t x);
+simd_f32x4_t SimdCos(simd_f32x4_t x);
+void SimdSinCos(simd_f32x4_t x, simd_f32x4_t *sOut, simd_f32x4_t *cOut);
+simd_f32x4_t SimdTan(simd_f32x4_t x);
+simd_f32x4_t SimdAtan2(simd_f32x4_t y, simd_f32x4_t x);
+simd_f32x4_t SimdExp(simd_f32x4_t x);
+simd_f32x4_t SimdLog(simd_f32x4_t x);
+simd_f32x4_t SimdPow(simd_f32x4_t x, simd_f32x4_t y);
+simd_f32x4_t SimdRSqrt(simd_f32x4_t x, int accuracy);
+simd_f32x4_t SimdSqrt(simd_f32x4_t x, int accuracy);
+
+// out[i] = f(in[i]) for i < n
+int SinBatch(const nml_t *in, nml_t *out, size_t n);
+int CosBatch(const nml_t *in, nml_t *out, size_t n);
+int TanBatch(const nml_t *in, nml_t *out, size_t n);
+int ExpBatch(const nml_t *in, nml_t *out, size_t n);
+int LogBatch(const nml_t *in, nml_t *out, size_t n);
+int SinCosBatch(const nml_t *in, nml_t *sOut, nml_t *cOut, size_t n);
+// out[i] = atan2(y[i], x[i])
+int Atan2Batch(const nml_t *y, const nml_t *x, nml_t *out, size_t n);
+// out[i] = pow(x[i], y[i])
+int PowBatch(const nml_t *x, const nml_t *y, nml_t *out, size_t n);
+// out[i] = 1 / sqrt(in[i]) and sqrt(in[i]) to the given NML_SQRT_* tier
+int RSqrtBatch(const nml_t *in, nml_t *out, size_t n, int accuracy);
+int SqrtBatch(const nml_t *in, nml_t *out, size_t n, int accuracy);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__VMATH_H__
@@ -2,7 +2,10 @@
 #define __VEC2D_H__
 
 #include "utils/consts.h"
+#include "utils/inline.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 typedef union Vec2 {
     struct {
@@ -12,32 +15,42 @@ typedef union Vec2 {
 } Vec2;
 
 // initialize a vector with all the elements set to 0.0f
-int vec2InitZero(Vec2 *vOut);
-int vec2Init(nml_t x, nml_t y, Vec2 *vOut);
+NML_API int vec2InitZero(Vec2 *vOut);
+NML_API int vec2Init(nml_t x, nml_t y, Vec2 *vOut);
 
-nml_t vec2Length(Vec2 *vec);
-nml_t vec2LengthSqr(Vec2 *vec);
-int vec2Normalize(Vec2 *vec, Vec2 *vOut);
+NML_API nml_t vec2Length(Vec2 *vec);
+NML_API nml_t vec2LengthSqr(Vec2 *vec);
+NML_API int vec2Normalize(Vec2 *vec, Vec2 *vOut);
+// normalize n vectors, vecs and vOut may be the same array. vectors
+// shorter than kEPSILON come out as *fallback (zero when it is NULL) instead
+// of failing the call, valid[i] (unless NULL) is 1 for a normalized vector
+// and 0 for a replaced one. float builds scale by the rsqrt estimate
+// refined twice (NML_SQRT_PRECISE of vmath.h)
+int vec2NormalizeBatch(const Vec2 *vecs,
+                       Vec2 *vOut,
+                       size_t n,
+                       const Vec2 *fallback,
+                       uint8_t *valid);
 
-int vec2Add(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
+NML_API int vec2Add(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
 // subtract vec2 form vec1
-int vec2Sub(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
-int vec2Mul(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
+NML_API int vec2Sub(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
+NML_API int vec2Mul(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
 // divide vec1 by vec2
-int vec2Div(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
+NML_API int vec2Div(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
 
-nml_t vec2Dot(Vec2 *vec1, Vec2 *vec2);
-nml_t vec2Cross(Vec2 *vec1, Vec2 *vec2);
+NML_API nml_t vec2Dot(Vec2 *vec1, Vec2 *vec2);
+NML_API nml_t vec2Cross(Vec2 *vec1, Vec2 *vec2);
 
-int vec2Scale(Vec2 *vec, nml_t s, Vec2 *vOut);
-int vec2Negate(Vec2 *vec, Vec2 *vOut);
+NML_API int vec2Scale(Vec2 *vec, nml_t s, Vec2 *vOut);
+NML_API int vec2Negate(Vec2 *vec, Vec2 *vOut);
 
 // projection of vec1 on vec2
-int vec2Project(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
+NML_API int vec2Project(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
 // rejection of vec1 from vec2
-int vec2Reject(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
+NML_API int vec2Reject(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
 // reflection of vec1 from vec2
-int vec2Reflect(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
+NML_API int vec2Reflect(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut);
 
 /*
  * vector utilities
@@ -47,4 +60,8 @@ static inline bool vec2IsZero(Vec2 *vec) {
     return (vec->x * vec->x + vec->y * vec->y) < (kEPSILON * kEPSILON);
 }
 
+#if defined(NUMEN_INLINE)
+#    include "vector/vec2d_inline.h"
+#endif
+
 #endif // !__VEC2D_H__
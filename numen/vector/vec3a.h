@@ -0,0 +1,71 @@
+#ifndef __VEC3A_H__
+#define __VEC3A_H__
+
+#include "utils/consts.h"
+#include "utils/inline.h"
+#include "utils/simd.h"
+#include "vector/vec3d.h"
+#include <stddef.h>
+
+/*
+ * Vec3 padded to four lanes and 16 byte aligned, so every operation is a
+ * single simd register op. the pad lane is an invariant, not a don't-care:
+ * every function writes pad = 0 to its outputs, whatever the output held
+ * before, and assumes pad == 0 on its inputs. dot, length, normalize and
+ * project sum all four lanes, so code writing elems[3] directly has to put
+ * a zero back before passing the vector on
+ */
+
+typedef union Vec3A {
+    struct {
+        nml_t x, y, z, pad;
+    };
+    nml_t elems[4];
+} Vec3A ALIGN_16;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+NML_API int vec3AInitZero(Vec3A *vOut);
+NML_API int vec3AInit(nml_t x, nml_t y, nml_t z, Vec3A *vOut);
+
+// conversions from/to the packed Vec3
+NML_API int vec3AFromVec3(Vec3 *vec, Vec3A *vOut);
+NML_API int vec3AToVec3(Vec3A *vec, Vec3 *vOut);
+int vec3AFromVec3Array(const Vec3 *vecs, Vec3A *vOut, size_t n);
+int vec3AToVec3Array(const Vec3A *vecs, Vec3 *vOut, size_t n);
+
+NML_API nml_t vec3ALength(Vec3A *vec);
+NML_API nml_t vec3ALengthSqr(Vec3A *vec);
+NML_API int vec3ANormalize(Vec3A *vec, Vec3A *vOut);
+
+NML_API int vec3AAdd(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut);
+// subtract vec2 form vec1
+NML_API int vec3ASub(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut);
+NML_API int vec3AMul(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut);
+// divide vec1 by vec2
+NML_API int vec3ADiv(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut);
+
+NML_API nml_t vec3ADot(Vec3A *vec1, Vec3A *vec2);
+NML_API int vec3ACross(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut);
+
+NML_API int vec3AScale(Vec3A *vec, nml_t s, Vec3A *vOut);
+NML_API int vec3ANegate(Vec3A *vec, Vec3A *vOut);
+
+// projection of vec1 on vec2
+NML_API int vec3AProject(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut);
+// rejection of vec1 from vec2
+NML_API int vec3AReject(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut);
+// reflection of vec1 from vec2
+NML_API int vec3AReflect(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#if defined(NUMEN_INLINE)
+#    include "vector/vec3a_inline.h"
+#endif
+
+#endif // !__VEC3A_H__
@@ -0,0 +1,145 @@
+#ifndef __VEC3A_INLINE_H__
+#define __VEC3A_INLINE_H__
+
+#include "utils/errors.h"
+#include "utils/inline.h"
+#include "utils/simd.h"
+#include "vector/vec3a.h"
+#include <math.h>
+#include <stddef.h>
+
+// definitions of vec3a.h, static inline with NUMEN_INLINE (utils/inline.h)
+// and compiled into the library otherwise
+
+NML_API int vec3AInit(nml_t x, nml_t y, nml_t z, Vec3A *vOut) {
+    vOut->x = x;
+    vOut->y = y;
+    vOut->z = z;
+    vOut->pad = 0.0;
+    return NML_SUCCESS;
+}
+
+NML_API int vec3AInitZero(Vec3A *vOut) {
+    return vec3AInit(0.0, 0.0, 0.0, vOut);
+}
+
+NML_API int vec3AFromVec3(Vec3 *vec, Vec3A *vOut) {
+    return vec3AInit(vec->x, vec->y, vec->z, vOut);
+}
+
+NML_API int vec3AToVec3(Vec3A *vec, Vec3 *vOut) {
+    vOut->x = vec->x;
+    vOut->y = vec->y;
+    vOut->z = vec->z;
+    return NML_SUCCESS;
+}
+
+NML_API nml_t vec3ALengthSqr(Vec3A *vec) {
+    return vec3ADot(vec, vec);
+}
+
+NML_API nml_t vec3ALength(Vec3A *vec) {
+    return sqrt(vec3ADot(vec, vec));
+}
+
+NML_API int vec3ANormalize(Vec3A *vec, Vec3A *vOut) {
+    nml_t lenSqr = vec3ADot(vec, vec);
+    if (lenSqr < kEPSILON * kEPSILON)
+        return NML_EZERODIV;
+    return vec3AScale(vec, 1.0 / sqrt(lenSqr), vOut);
+}
+
+NML_API int vec3AAdd(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut) {
+    simd_store_nml4(vOut->elems, simd_add_nml4(simd_load_nml4(vec1->elems),
+                                               simd_load_nml4(vec2->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec3ASub(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut) {
+    simd_store_nml4(vOut->elems, simd_sub_nml4(simd_load_nml4(vec1->elems),
+                                               simd_load_nml4(vec2->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec3AMul(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut) {
+    simd_store_nml4(vOut->elems, simd_mul_nml4(simd_load_nml4(vec1->elems),
+                                               simd_load_nml4(vec2->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec3ADiv(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut) {
+    if (fabs(vec2->x) < kEPSILON || fabs(vec2->y) < kEPSILON ||
+        fabs(vec2->z) < kEPSILON) {
+        return NML_EZERODIV;
+    }
+
+    simd_store_nml4(vOut->elems, simd_div_nml4(simd_load_nml4(vec1->elems),
+                                               simd_load_nml4(vec2->elems)));
+    // 0 / 0 in the pad lane
+    vOut->pad = 0.0;
+    return NML_SUCCESS;
+}
+
+NML_API nml_t vec3ADot(Vec3A *vec1, Vec3A *vec2) {
+    return simd_hsum_nml4(
+        simd_mul_nml4(simd_load_nml4(vec1->elems), simd_load_nml4(vec2->elems)));
+}
+
+NML_API int vec3ACross(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut) {
+#if defined(NML_SIMD_F32)
+    // the pad lanes are zero so the pad lane of the result is too
+    simd_store_f32(vOut->elems, simd_cross3_f32(simd_load_f32(vec1->elems),
+                                                simd_load_f32(vec2->elems)));
+#else
+    nml_t x = vec1->y * vec2->z - vec1->z * vec2->y;
+    nml_t y = vec1->z * vec2->x - vec1->x * vec2->z;
+    nml_t z = vec1->x * vec2->y - vec1->y * vec2->x;
+    vec3AInit(x, y, z, vOut);
+#endif
+    return NML_SUCCESS;
+}
+
+NML_API int vec3AScale(Vec3A *vec, nml_t s, Vec3A *vOut) {
+    simd_store_nml4(vOut->elems,
+                    simd_mul_nml4(simd_load_nml4(vec->elems), simd_set1_nml4(s)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec3ANegate(Vec3A *vec, Vec3A *vOut) {
+    simd_store_nml4(vOut->elems, simd_negate_nml4(simd_load_nml4(vec->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec3AProject(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut) {
+    nml_t lenSqr = vec3ADot(vec2, vec2);
+    if (lenSqr < kEPSILON)
+        return NML_EZERODIV;
+
+    return vec3AScale(vec2, vec3ADot(vec1, vec2) / lenSqr, vOut);
+}
+
+NML_API int vec3AReject(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut) {
+    nml_t lenSqr = vec3ADot(vec2, vec2);
+    if (lenSqr < kEPSILON)
+        return NML_EZERODIV;
+
+    nml_t scaler = -vec3ADot(vec1, vec2) / lenSqr;
+    simd_store_nml4(vOut->elems, simd_fmadd_nml4(simd_load_nml4(vec2->elems),
+                                                 simd_set1_nml4(scaler),
+                                                 simd_load_nml4(vec1->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec3AReflect(Vec3A *vec1, Vec3A *vec2, Vec3A *vOut) {
+    nml_t lenSqr = vec3ADot(vec2, vec2);
+    if (lenSqr < kEPSILON)
+        return NML_EZERODIV;
+
+    nml_t scaler = -2.0 * vec3ADot(vec1, vec2) / lenSqr;
+    simd_store_nml4(vOut->elems, simd_fmadd_nml4(simd_load_nml4(vec2->elems),
+                                                 simd_set1_nml4(scaler),
+                                                 simd_load_nml4(vec1->elems)));
+    return NML_SUCCESS;
+}
+
+#endif // !__VEC3A_INLINE_H__
@@ -2,7 +2,10 @@
 #define __VEC3D_H__
 
 #include "utils/consts.h"
+#include "utils/inline.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 typedef union Vec3 {
     struct {
@@ -12,32 +15,42 @@ typedef union Vec3 {
 } Vec3;
 
 // initialize a vector with all the elements set to zero
-int vec3InitZero(Vec3 *vOut);
-int vec3Init(nml_t x, nml_t y, nml_t z, Vec3 *vOut);
+NML_API int vec3InitZero(Vec3 *vOut);
+NML_API int vec3Init(nml_t x, nml_t y, nml_t z, Vec3 *vOut);
 
-nml_t vec3Length(Vec3 *vec);
-nml_t vec3LengthSqr(Vec3 *vec);
-int vec3Normalize(Vec3 *vec, Vec3 *vOut);
+NML_API nml_t vec3Length(Vec3 *vec);
+NML_API nml_t vec3LengthSqr(Vec3 *vec);
+NML_API int vec3Normalize(Vec3 *vec, Vec3 *vOut);
+// normalize n vectors, vecs and vOut may be the same array. vectors
+// shorter than kEPSILON come out as *fallback (zero when it is NULL) instead
+// of failing the call, valid[i] (unless NULL) is 1 for a normalized vector
+// and 0 for a replaced one. float builds scale by the rsqrt estimate
+// refined twice (NML_SQRT_PRECISE of vmath.h)
+int vec3NormalizeBatch(const Vec3 *vecs,
+                       Vec3 *vOut,
+                       size_t n,
+                       const Vec3 *fallback,
+                       uint8_t *valid);
 
-int vec3Add(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
+NML_API int vec3Add(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
 // subtract vec2 form vec1
-int vec3Sub(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
-int vec3Mul(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
+NML_API int vec3Sub(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
+NML_API int vec3Mul(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
 // divide vec1 by vec2
-int vec3Div(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
+NML_API int vec3Div(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
 
-nml_t vec3Dot(Vec3 *vec1, Vec3 *vec2);
-int vec3Cross(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
+NML_API nml_t vec3Dot(Vec3 *vec1, Vec3 *vec2);
+NML_API int vec3Cross(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
 
-int vec3Scale(Vec3 *vec, nml_t s, Vec3 *vOut);
-int vec3Negate(Vec3 *vec, Vec3 *vOut);
+NML_API int vec3Scale(Vec3 *vec, nml_t s, Vec3 *vOut);
+NML_API int vec3Negate(Vec3 *vec, Vec3 *vOut);
 
 // projection of vec1 on vec2
-int vec3Project(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
+NML_API int vec3Project(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
 // rejection of vec1 from vec2
-int vec3Reject(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
+NML_API int vec3Reject(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
 // reflection of vec1 from vec2
-int vec3Reflect(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
+NML_API int vec3Reflect(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut);
 
 /*
  * vector utilities
@@ -48,4 +61,8 @@ static inline bool vec3IsZero(Vec3 *vec) {
            (kEPSILON * kEPSILON);
 }
 
+#if defined(NUMEN_INLINE)
+#    include "vector/vec3d_inline.h"
+#endif
+
 #endif // !__VEC3D_H__
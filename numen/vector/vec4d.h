@@ -2,42 +2,57 @@
 #define __VEC4D_H__
 
 #include "utils/consts.h"
+#include "utils/inline.h"
+#include "utils/simd.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
+// 16 byte aligned so every operation loads the vector as one simd register
 typedef union Vec4 {
     struct {
         nml_t x, y, z, w;
     };
     nml_t elems[4];
-} Vec4;
+} Vec4 ALIGN_16;
 
 // initialize a vector with all the elements set to 0.0f
-int vec4InitZero(Vec4 *vOut);
-int vec4Init(nml_t x, nml_t y, nml_t z, nml_t w, Vec4 *vOut);
+NML_API int vec4InitZero(Vec4 *vOut);
+NML_API int vec4Init(nml_t x, nml_t y, nml_t z, nml_t w, Vec4 *vOut);
 
-nml_t vec4Length(Vec4 *vec);
-nml_t vec4LengthSqr(Vec4 *vec);
-int vec4Normalize(Vec4 *vec, Vec4 *vOut);
+NML_API nml_t vec4Length(Vec4 *vec);
+NML_API nml_t vec4LengthSqr(Vec4 *vec);
+NML_API int vec4Normalize(Vec4 *vec, Vec4 *vOut);
+// normalize n vectors, vecs and vOut may be the same array. vectors
+// shorter than kEPSILON come out as *fallback (zero when it is NULL) instead
+// of failing the call, valid[i] (unless NULL) is 1 for a normalized vector
+// and 0 for a replaced one. float builds scale by the rsqrt estimate
+// refined twice (NML_SQRT_PRECISE of vmath.h)
+int vec4NormalizeBatch(const Vec4 *vecs,
+                       Vec4 *vOut,
+                       size_t n,
+                       const Vec4 *fallback,
+                       uint8_t *valid);
 
-int vec4Add(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
+NML_API int vec4Add(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
 // subtract vec2 form vec1
-int vec4Sub(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
-int vec4Mul(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
+NML_API int vec4Sub(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
+NML_API int vec4Mul(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
 // divide vec1 by vec2
-int vec4Div(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
+NML_API int vec4Div(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
 
-nml_t vec4Dot(Vec4 *vec1, Vec4 *vec2);
-int vec4Cross(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
+NML_API nml_t vec4Dot(Vec4 *vec1, Vec4 *vec2);
+NML_API int vec4Cross(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
 
-int vec4Scale(Vec4 *vec, nml_t s, Vec4 *vOut);
-int vec4Negate(Vec4 *vec, Vec4 *vOut);
+NML_API int vec4Scale(Vec4 *vec, nml_t s, Vec4 *vOut);
+NML_API int vec4Negate(Vec4 *vec, Vec4 *vOut);
 
 // projection of vec1 on vec2
-int vec4Project(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
+NML_API int vec4Project(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
 // rejection of vec1 from vec2
-int vec4Reject(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
+NML_API int vec4Reject(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
 // reflection of vec1 from vec2
-int vec4Reflect(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
+NML_API int vec4Reflect(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut);
 
 /*
  * vector utilities
@@ -48,4 +63,8 @@ static inline bool vec4IsZero(Vec4 *vec) {
            (kEPSILON * kEPSILON);
 }
 
+#if defined(NUMEN_INLINE)
+#    include "vector/vec4d_inline.h"
+#endif
+
 #endif // !__VEC4D_H__
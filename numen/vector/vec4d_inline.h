@@ -0,0 +1,149 @@
+#ifndef __VEC4D_INLINE_H__
+#define __VEC4D_INLINE_H__
+
+#include "utils/errors.h"
+#include "utils/inline.h"
+#include "utils/simd.h"
+#include "vector/vec4d.h"
+#include <math.h>
+#include <stddef.h>
+
+// definitions of vec4d.h, static inline with NUMEN_INLINE (utils/inline.h)
+// and compiled into the library otherwise
+
+// kept static so the functions built on the dot product inline it instead of
+// calling the exported (and interposable) vec4Dot
+static inline nml_t vec4DotLanes(const Vec4 *vec1, const Vec4 *vec2) {
+    return simd_hsum_nml4(
+        simd_mul_nml4(simd_load_nml4(vec1->elems), simd_load_nml4(vec2->elems)));
+}
+
+NML_API int vec4Init(nml_t x, nml_t y, nml_t z, nml_t w, Vec4 *vOut) {
+    vOut->x = x;
+    vOut->y = y;
+    vOut->z = z;
+    vOut->w = w;
+    return NML_SUCCESS;
+}
+
+NML_API int vec4InitZero(Vec4 *vOut) {
+    return vec4Init(0.0, 0.0, 0.0, 0.0, vOut);
+}
+
+NML_API nml_t vec4Length(Vec4 *vec) {
+    return sqrt(vec4DotLanes(vec, vec));
+}
+
+NML_API nml_t vec4LengthSqr(Vec4 *vec) {
+    return vec4DotLanes(vec, vec);
+}
+
+NML_API int vec4Normalize(Vec4 *vec, Vec4 *vOut) {
+    nml_t lenSqr = vec4DotLanes(vec, vec);
+    if (lenSqr < kEPSILON * kEPSILON)
+        return NML_EZERODIV;
+
+    // a true division rather than a reciprocal multiply, so the result is
+    // the correctly rounded x / l in every lane
+    simd_store_nml4(vOut->elems, simd_div_nml4(simd_load_nml4(vec->elems),
+                                               simd_set1_nml4(sqrt(lenSqr))));
+    return NML_SUCCESS;
+}
+
+NML_API nml_t vec4Dot(Vec4 *vec1, Vec4 *vec2) {
+    return vec4DotLanes(vec1, vec2);
+}
+
+NML_API int vec4Cross(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
+#if defined(NML_SIMD_F32)
+    simd_store_f32(vOut->elems, simd_cross3_f32(simd_load_f32(vec1->elems),
+                                                simd_load_f32(vec2->elems)));
+#else
+    nml_t x = (vec1->y * vec2->z) - (vec1->z * vec2->y);
+    nml_t y = (vec1->z * vec2->x) - (vec1->x * vec2->z);
+    nml_t z = (vec1->x * vec2->y) - (vec1->y * vec2->x);
+    vOut->x = x;
+    vOut->y = y;
+    vOut->z = z;
+#endif
+    // the w lanes are not required to be zero, so clear it explicitly
+    vOut->w = 0.0;
+    return NML_SUCCESS;
+}
+
+NML_API int vec4Add(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
+    simd_store_nml4(vOut->elems, simd_add_nml4(simd_load_nml4(vec1->elems),
+                                               simd_load_nml4(vec2->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec4Sub(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
+    simd_store_nml4(vOut->elems, simd_sub_nml4(simd_load_nml4(vec1->elems),
+                                               simd_load_nml4(vec2->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec4Mul(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
+    simd_store_nml4(vOut->elems, simd_mul_nml4(simd_load_nml4(vec1->elems),
+                                               simd_load_nml4(vec2->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec4Div(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
+    if (fabs(vec2->x) < kEPSILON || fabs(vec2->y) < kEPSILON || fabs(vec2->z) < kEPSILON ||
+        fabs(vec2->w) < kEPSILON) {
+        return NML_EZERODIV;
+    }
+
+    simd_store_nml4(vOut->elems, simd_div_nml4(simd_load_nml4(vec1->elems),
+                                               simd_load_nml4(vec2->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec4Scale(Vec4 *vec, nml_t s, Vec4 *vOut) {
+    simd_store_nml4(vOut->elems,
+                    simd_mul_nml4(simd_load_nml4(vec->elems), simd_set1_nml4(s)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec4Negate(Vec4 *vec, Vec4 *vOut) {
+    simd_store_nml4(vOut->elems, simd_negate_nml4(simd_load_nml4(vec->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec4Project(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
+    nml_t lenSqr = vec4DotLanes(vec2, vec2);
+    if (lenSqr < kEPSILON)
+        return NML_EZERODIV;
+
+    nml_t scaler = vec4DotLanes(vec1, vec2) / lenSqr;
+    simd_store_nml4(vOut->elems, simd_mul_nml4(simd_load_nml4(vec2->elems),
+                                               simd_set1_nml4(scaler)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec4Reject(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
+    nml_t lenSqr = vec4DotLanes(vec2, vec2);
+    if (lenSqr < kEPSILON)
+        return NML_EZERODIV;
+
+    nml_t scaler = -vec4DotLanes(vec1, vec2) / lenSqr;
+    simd_store_nml4(vOut->elems, simd_fmadd_nml4(simd_load_nml4(vec2->elems),
+                                                 simd_set1_nml4(scaler),
+                                                 simd_load_nml4(vec1->elems)));
+    return NML_SUCCESS;
+}
+
+NML_API int vec4Reflect(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
+    nml_t lenSqr = vec4DotLanes(vec2, vec2);
+    if (lenSqr < kEPSILON)
+        return NML_EZERODIV;
+
+    nml_t scaler = -2.0 * vec4DotLanes(vec1, vec2) / lenSqr;
+    simd_store_nml4(vOut->elems, simd_fmadd_nml4(simd_load_nml4(vec2->elems),
+                                                 simd_set1_nml4(scaler),
+                                                 simd_load_nml4(vec1->elems)));
+    return NML_SUCCESS;
+}
+
+#endif // !__VEC4D_INLINE_H__
@@ -0,0 +1,80 @@
+#ifndef __VECSTREAM_H__
+#define __VECSTREAM_H__
+
+#include "utils/consts.h"
+#include "vector/vec3d.h"
+#include "vector/vec4d.h"
+#include <stddef.h>
+
+/*
+ * structure-of-arrays vector streams
+ *
+ * every component lives in its own contiguous array so the kernels below can
+ * work on 4 vectors per 128 bit instruction in single precision builds with
+ * sse or neon (scalar loops otherwise). streams allocated with the Init
+ * functions own their storage (aligned to NML_ALIGNMENT), the fields are
+ * public so callers can also point a stream at arrays they manage themselves
+ */
+
+typedef struct Vec3Stream {
+    nml_t *x, *y, *z;
+    size_t count;
+} Vec3Stream;
+
+typedef struct Vec4Stream {
+    nml_t *x, *y, *z, *w;
+    size_t count;
+} Vec4Stream;
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// allocate a zero initialized stream of count vectors
+int vec3StreamInit(size_t count, Vec3Stream *sOut);
+// release storage allocated by vec3StreamInit
+void vec3StreamFree(Vec3Stream *stream);
+
+// array-of-structs <-> stream, copies min(count, stream->count) vectors
+int vec3StreamFromAoS(const Vec3 *vecs, size_t count, Vec3Stream *sOut);
+int vec3StreamToAoS(const Vec3Stream *stream, Vec3 *vecs, size_t count);
+
+// element-wise over whole streams, all operands must have the same count
+// output may alias any input
+int vec3StreamAdd(const Vec3Stream *s1, const Vec3Stream *s2, Vec3Stream *sOut);
+// subtract s2 from s1
+int vec3StreamSub(const Vec3Stream *s1, const Vec3Stream *s2, Vec3Stream *sOut);
+int vec3StreamScale(const Vec3Stream *stream, nml_t s, Vec3Stream *sOut);
+int vec3StreamCross(const Vec3Stream *s1,
+                    const Vec3Stream *s2,
+                    Vec3Stream *sOut);
+// out[i] = dot(s1[i], s2[i])
+int vec3StreamDot(const Vec3Stream *s1, const Vec3Stream *s2, nml_t *out);
+int vec3StreamLength(const Vec3Stream *stream, nml_t *out);
+// zero length vectors come out as zero and make the call return NML_EZERODIV,
+// every other vector is still normalized. float builds scale by the rsqrt
+// estimate refined twice (NML_SQRT_PRECISE), not by an exact 1 / sqrt
+int vec3StreamNormalize(const Vec3Stream *stream, Vec3Stream *sOut);
+
+int vec4StreamInit(size_t count, Vec4Stream *sOut);
+void vec4StreamFree(Vec4Stream *stream);
+
+int vec4StreamFromAoS(const Vec4 *vecs, size_t count, Vec4Stream *sOut);
+int vec4StreamToAoS(const Vec4Stream *stream, Vec4 *vecs, size_t count);
+
+int vec4StreamAdd(const Vec4Stream *s1, const Vec4Stream *s2, Vec4Stream *sOut);
+int vec4StreamSub(const Vec4Stream *s1, const Vec4Stream *s2, Vec4Stream *sOut);
+int vec4StreamScale(const Vec4Stream *stream, nml_t s, Vec4Stream *sOut);
+// cross product of the xyz parts, w is set to 0
+int vec4StreamCross(const Vec4Stream *s1,
+                    const Vec4Stream *s2,
+                    Vec4Stream *sOut);
+int vec4StreamDot(const Vec4Stream *s1, const Vec4Stream *s2, nml_t *out);
+int vec4StreamLength(const Vec4Stream *stream, nml_t *out);
+int vec4StreamNormalize(const Vec4Stream *stream, Vec4Stream *sOut);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !__VECSTREAM_H__
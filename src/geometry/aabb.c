@@ -0,0 +1,66 @@
+#include "geometry/aabb.h"
+#include "utils/errors.h"
+
+int aabbInitEmpty(AABB *bOut) {
+    is_null(bOut);
+    for (int k = 0; k < 3; k++) {
+        bOut->min.elems[k] = NML_AABB_HUGE;
+        bOut->max.elems[k] = -NML_AABB_HUGE;
+    }
+    return NML_SUCCESS;
+}
+
+int aabbFromPoints(const Vec3Stream *points, AABB *bOut) {
+    is_null((void *)points, bOut);
+    AABB box;
+    aabbInitEmpty(&box);
+    const nml_t *c[3] = {points->x, points->y, points->z};
+    for (int k = 0; k < 3; k++) {
+        nml_t lo = box.min.elems[k], hi = box.max.elems[k];
+        for (size_t i = 0; i < points->count; i++) {
+            lo = c[k][i] < lo ? c[k][i] : lo;
+            hi = c[k][i] > hi ? c[k][i] : hi;
+        }
+        box.min.elems[k] = lo;
+        box.max.elems[k] = hi;
+    }
+    *bOut = box;
+    return NML_SUCCESS;
+}
+
+int aabbExtend(const AABB *box, const Vec3 *point, AABB *bOut) {
+    is_null((void *)box, (void *)point, bOut);
+    for (int k = 0; k < 3; k++) {
+        nml_t p = point->elems[k];
+        bOut->min.elems[k] = p < box->min.elems[k] ? p : box->min.elems[k];
+        bOut->max.elems[k] = p > box->max.elems[k] ? p : box->max.elems[k];
+    }
+    return NML_SUCCESS;
+}
+
+int aabbUnion(const AABB *box1, const AABB *box2, AABB *bOut) {
+    is_null((void *)box1, (void *)box2, bOut);
+    for (int k = 0; k < 3; k++) {
+        nml_t lo1 = box1->min.elems[k], lo2 = box2->min.elems[k];
+        nml_t hi1 = box1->max.elems[k], hi2 = box2->max.elems[k];
+        bOut->min.elems[k] = lo1 < lo2 ? lo1 : lo2;
+        bOut->max.elems[k] = hi1 > hi2 ? hi1 : hi2;
+    }
+    return NML_SUCCESS;
+}
+
+int aabbCenter(const AABB *box, Vec3 *vOut) {
+    is_null((void *)box, vOut);
+    for (int k = 0; k < 3; k++)
+        vOut->elems[k] = 0.5 * (box->min.elems[k] + box->max.elems[k]);
+    return NML_SUCCESS;
+}
+
+nml_t aabbSurfaceArea(const AABB *box) {
+    if (aabbIsEmpty(box))
+        return 0.0;
+    nml_t dx = box->max.x - box->min.x;
+    nml_t dy = box->max.y - box->min.y;
+    nml_t dz = box->max.z - box->min.z;
+    return 2.0 * (dx * dy + dy * dz + dz * dx);
+}
@@ -0,0 +1,921 @@
+#include "geometry/bvh.h"
+#include "ray_kernels.h"
+#include "utils/errors.h"
+#include "utils/memory.h"
+#include "utils/simd.h"
+#include "utils/thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+// centroid bins per axis of the surface area heuristic
+#define BVH_BINS 32
+#define BVH_DEFAULT_LEAF 4
+// ranges of at least this many primitives bin on the thread pool
+#define BVH_PARALLEL_BIN 65536
+// below this node depth ranges are cut in half instead of split by area,
+// which bounds the depth of the tree and so the traversal stacks
+#define BVH_MAX_SAH_DEPTH 48
+#define BVH_STACK 256
+// primitives per parallel range of the per primitive passes
+#define BVH_GRAIN 16384
+
+/*
+ * construction
+ *
+ * ranges of the primitive index array are split in two along the best of
+ * BVH_BINS centroid bins per axis, a node splits its largest range until it
+ * has NML_BVH_WIDTH of them. once the upper levels have cut the input into
+ * ranges of about n / (8 * threads) primitives, those are set aside as
+ * tasks, built into separate node arrays in parallel and appended to the
+ * upper levels
+ */
+
+typedef struct Bounds {
+    nml_t lo[3], hi[3];
+} Bounds;
+
+static inline void boundsEmpty(Bounds *b) {
+    for (int k = 0; k < 3; k++) {
+        b->lo[k] = NML_AABB_HUGE;
+        b->hi[k] = -NML_AABB_HUGE;
+    }
+}
+
+static inline void boundsGrow(Bounds *b, const nml_t *lo, const nml_t *hi) {
+    for (int k = 0; k < 3; k++) {
+        b->lo[k] = lo[k] < b->lo[k] ? lo[k] : b->lo[k];
+        b->hi[k] = hi[k] > b->hi[k] ? hi[k] : b->hi[k];
+    }
+}
+
+// half the surface area, all the heuristic needs
+static inline nml_t boundsHalfArea(const Bounds *b) {
+    if (b->lo[0] > b->hi[0])
+        return 0.0;
+    nml_t dx = b->hi[0] - b->lo[0], dy = b->hi[1] - b->lo[1];
+    nml_t dz = b->hi[2] - b->lo[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+typedef struct Range {
+    size_t begin, end;
+    Bounds box;  // of the primitives
+    Bounds cent; // of their centroids
+} Range;
+
+typedef struct Bin {
+    Bounds box, cent;
+    size_t count;
+} Bin;
+
+typedef struct Task {
+    Range range;
+    int depth;
+    size_t parent; // node and slot of the upper levels referencing the task
+    int slot;
+    BVHNode *nodes;
+    size_t nodeCount;
+    int status;
+} Task;
+
+typedef struct Builder {
+    const Bounds *prims; // bounds of every primitive, in input order
+    uint32_t *idx;
+    size_t leafSize;
+    int parallel;   // bin large ranges on the thread pool
+    size_t taskMax; // ranges up to this size become tasks, 0 for none
+    Task *tasks;
+    size_t taskCount, taskCap;
+} Builder;
+
+typedef struct NodeVec {
+    BVHNode *data;
+    size_t count, cap;
+} NodeVec;
+
+static inline void primCentroid(const Bounds *p, nml_t c[3]) {
+    for (int k = 0; k < 3; k++)
+        c[k] = 0.5 * (p->lo[k] + p->hi[k]);
+}
+
+// bin of a centroid coordinate, the same expression for binning and
+// partitioning so both agree on every primitive
+static inline int binOf(nml_t c, nml_t lo, nml_t scale) {
+    int bin = (int)((c - lo) * scale);
+    return bin < BVH_BINS - 1 ? (bin > 0 ? bin : 0) : BVH_BINS - 1;
+}
+
+static void binScales(const Bounds *cent, nml_t scale[3]) {
+    for (int k = 0; k < 3; k++) {
+        nml_t extent = cent->hi[k] - cent->lo[k];
+        scale[k] = extent > 0.0 ? BVH_BINS / extent : 0.0;
+    }
+}
+
+static void binsEmpty(Bin bins[3][BVH_BINS]) {
+    for (int k = 0; k < 3; k++) {
+        for (int i = 0; i < BVH_BINS; i++) {
+            boundsEmpty(&bins[k][i].box);
+            boundsEmpty(&bins[k][i].cent);
+            bins[k][i].count = 0;
+        }
+    }
+}
+
+static void binPrims(const Builder *b,
+                     const Bounds *cent,
+                     size_t begin,
+                     size_t end,
+                     Bin bins[3][BVH_BINS]) {
+    nml_t scale[3];
+    binScales(cent, scale);
+    binsEmpty(bins);
+    for (size_t i = begin; i < end; i++) {
+        const Bounds *p = &b->prims[b->idx[i]];
+        nml_t c[3];
+        primCentroid(p, c);
+        for (int k = 0; k < 3; k++) {
+            Bin *bin = &bins[k][binOf(c[k], cent->lo[k], scale[k])];
+            boundsGrow(&bin->box, p->lo, p->hi);
+            boundsGrow(&bin->cent, c, c);
+            bin->count++;
+        }
+    }
+}
+
+typedef struct BinJob {
+    const Builder *b;
+    const Range *range;
+    size_t chunks;
+    Bin (*bins)[3][BVH_BINS];
+} BinJob;
+
+static void binChunks(void *ctx, size_t begin, size_t end) {
+    BinJob *job = ctx;
+    size_t n = job->range->end - job->range->begin;
+    for (size_t c = begin; c < end; c++) {
+        size_t lo = job->range->begin + n * c / job->chunks;
+        size_t hi = job->range->begin + n * (c + 1) / job->chunks;
+        binPrims(job->b, &job->range->cent, lo, hi, job->bins[c]);
+    }
+}
+
+static void binRange(const Builder *b, const Range *r, Bin bins[3][BVH_BINS]) {
+    size_t n = r->end - r->begin;
+    size_t chunks = (size_t)threadCount() * 2;
+    chunks = chunks > 64 ? 64 : chunks;
+    Bin(*partial)[3][BVH_BINS] = NULL;
+    if (b->parallel && n >= BVH_PARALLEL_BIN && chunks > 1)
+        partial = malloc(chunks * sizeof(*partial));
+    if (!partial) {
+        binPrims(b, &r->cent, r->begin, r->end, bins);
+        return;
+    }
+
+    BinJob job = {b, r, chunks, partial};
+    parallelFor(chunks, 1, binChunks, &job);
+    binsEmpty(bins);
+    for (size_t c = 0; c < chunks; c++) {
+        for (int k = 0; k < 3; k++) {
+            for (int i = 0; i < BVH_BINS; i++) {
+                Bin *dst = &bins[k][i], *src = &partial[c][k][i];
+                boundsGrow(&dst->box, src->box.lo, src->box.hi);
+                boundsGrow(&dst->cent, src->cent.lo, src->cent.hi);
+                dst->count += src->count;
+            }
+        }
+    }
+    free(partial);
+}
+
+static void rangeBounds(const Builder *b, Range *r) {
+    boundsEmpty(&r->box);
+    boundsEmpty(&r->cent);
+    for (size_t i = r->begin; i < r->end; i++) {
+        const Bounds *p = &b->prims[b->idx[i]];
+        nml_t c[3];
+        primCentroid(p, c);
+        boundsGrow(&r->box, p->lo, p->hi);
+        boundsGrow(&r->cent, c, c);
+    }
+}
+
+// split r into left and right, both non-empty
+static void splitRange(const Builder *b,
+                       const Range *r,
+                       int depth,
+                       Range *left,
+                       Range *right) {
+    int axis = -1, split = 0;
+    if (depth < BVH_MAX_SAH_DEPTH) {
+        Bin bins[3][BVH_BINS];
+        binRange(b, r, bins);
+
+        nml_t bestCost = 0.0;
+        for (int k = 0; k < 3; k++) {
+            if (!(r->cent.hi[k] > r->cent.lo[k]))
+                continue;
+            // cost of the right side of every split position
+            nml_t rightCost[BVH_BINS];
+            Bounds acc;
+            size_t count = 0;
+            boundsEmpty(&acc);
+            for (int i = BVH_BINS - 1; i > 0; i--) {
+                boundsGrow(&acc, bins[k][i].box.lo, bins[k][i].box.hi);
+                count += bins[k][i].count;
+                rightCost[i] = count ? boundsHalfArea(&acc) * count : -1.0;
+            }
+            boundsEmpty(&acc);
+            count = 0;
+            for (int i = 1; i < BVH_BINS; i++) {
+                boundsGrow(&acc, bins[k][i - 1].box.lo, bins[k][i - 1].box.hi);
+                count += bins[k][i - 1].count;
+                if (!count || rightCost[i] < 0.0)
+                    continue;
+                nml_t cost = boundsHalfArea(&acc) * count + rightCost[i];
+                if (axis < 0 || cost < bestCost) {
+                    bestCost = cost;
+                    axis = k;
+                    split = i;
+                }
+            }
+        }
+
+        if (axis >= 0) {
+            // bounds of both sides straight from the bins
+            Range lr = {.begin = r->begin, .end = r->begin};
+            Range rr = {.begin = r->begin, .end = r->end};
+            boundsEmpty(&lr.box);
+            boundsEmpty(&lr.cent);
+            boundsEmpty(&rr.box);
+            boundsEmpty(&rr.cent);
+            for (int i = 0; i < BVH_BINS; i++) {
+                Range *side = i < split ? &lr : &rr;
+                const Bin *bin = &bins[axis][i];
+                boundsGrow(&side->box, bin->box.lo, bin->box.hi);
+                boundsGrow(&side->cent, bin->cent.lo, bin->cent.hi);
+            }
+
+            nml_t scale[3];
+            binScales(&r->cent, scale);
+            size_t i = r->begin, j = r->end;
+            while (i < j) {
+                nml_t c[3];
+                primCentroid(&b->prims[b->idx[i]], c);
+                if (binOf(c[axis], r->cent.lo[axis], scale[axis]) < split) {
+                    i++;
+                } else {
+                    uint32_t t = b->idx[i];
+                    b->idx[i] = b->idx[--j];
+                    b->idx[j] = t;
+                }
+            }
+            lr.end = rr.begin = i;
+            *left = lr;
+            *right = rr;
+            return;
+        }
+    }
+
+    // every centroid in one spot, or too deep: cut the range in half
+    left->begin = r->begin;
+    left->end = right->begin = r->begin + (r->end - r->begin) / 2;
+    right->end = r->end;
+    rangeBounds(b, left);
+    rangeBounds(b, right);
+}
+
+static int nodesPush(NodeVec *v, size_t *index) {
+    if (v->count == v->cap) {
+        size_t cap = v->cap ? v->cap * 2 : 64;
+        BVHNode *data = realloc(v->data, cap * sizeof(BVHNode));
+        if (!data)
+            return NML_ENOMEM;
+        v->data = data;
+        v->cap = cap;
+    }
+    BVHNode *node = &v->data[v->count];
+    for (int c = 0; c < NML_BVH_WIDTH; c++) {
+        node->minX[c] = node->minY[c] = node->minZ[c] = NML_AABB_HUGE;
+        node->maxX[c] = node->maxY[c] = node->maxZ[c] = -NML_AABB_HUGE;
+        node->child[c] = NML_BVH_EMPTY;
+        node->count[c] = 0;
+    }
+    *index = v->count++;
+    return NML_SUCCESS;
+}
+
+static int taskPush(Builder *b, const Range *r, int depth, size_t parent,
+                    int slot) {
+    if (b->taskCount == b->taskCap) {
+        size_t cap = b->taskCap ? b->taskCap * 2 : 64;
+        Task *tasks = realloc(b->tasks, cap * sizeof(Task));
+        if (!tasks)
+            return NML_ENOMEM;
+        b->tasks = tasks;
+        b->taskCap = cap;
+    }
+    Task *t = &b->tasks[b->taskCount++];
+    memset(t, 0, sizeof(*t));
+    t->range = *r;
+    t->depth = depth;
+    t->parent = parent;
+    t->slot = slot;
+    return NML_SUCCESS;
+}
+
+static int buildNode(Builder *b,
+                     NodeVec *nodes,
+                     const Range *r,
+                     int depth,
+                     size_t *index) {
+    size_t self;
+    int status = nodesPush(nodes, &self);
+    if (status != NML_SUCCESS)
+        return status;
+
+    // split the largest range until there are NML_BVH_WIDTH of them
+    Range kids[NML_BVH_WIDTH];
+    int n = 1;
+    kids[0] = *r;
+    while (n < NML_BVH_WIDTH) {
+        int largest = -1;
+        size_t most = b->leafSize;
+        for (int c = 0; c < n; c++) {
+            size_t count = kids[c].end - kids[c].begin;
+            if (count > most) {
+                most = count;
+                largest = c;
+            }
+        }
+        if (largest < 0)
+            break;
+        Range whole = kids[largest];
+        splitRange(b, &whole, depth, &kids[largest], &kids[n++]);
+    }
+
+    for (int c = 0; c < n; c++) {
+        size_t count = kids[c].end - kids[c].begin;
+        uint32_t child = (uint32_t)kids[c].begin;
+        uint32_t leafCount = (uint32_t)count;
+        if (count > b->leafSize) {
+            leafCount = 0;
+            if (count <= b->taskMax) {
+                status = taskPush(b, &kids[c], depth + 1, self, c);
+            } else {
+                size_t sub = 0;
+                status = buildNode(b, nodes, &kids[c], depth + 1, &sub);
+                child = (uint32_t)sub;
+            }
+            if (status != NML_SUCCESS)
+                return status;
+        }
+        // nodes may have moved while the subtree was built
+        BVHNode *node = &nodes->data[self];
+        node->minX[c] = kids[c].box.lo[0];
+        node->minY[c] = kids[c].box.lo[1];
+        node->minZ[c] = kids[c].box.lo[2];
+        node->maxX[c] = kids[c].box.hi[0];
+        node->maxY[c] = kids[c].box.hi[1];
+        node->maxZ[c] = kids[c].box.hi[2];
+        node->child[c] = child;
+        node->count[c] = leafCount;
+    }
+    *index = self;
+    return NML_SUCCESS;
+}
+
+typedef struct TaskJob {
+    const Builder *b;
+} TaskJob;
+
+static void runTasks(void *ctx, size_t begin, size_t end) {
+    const Builder *top = ((TaskJob *)ctx)->b;
+    for (size_t i = begin; i < end; i++) {
+        Task *t = &top->tasks[i];
+        Builder b = *top;
+        b.parallel = 0;
+        b.taskMax = 0;
+        NodeVec nodes = {NULL, 0, 0};
+        size_t root;
+        t->status = buildNode(&b, &nodes, &t->range, t->depth, &root);
+        t->nodes = nodes.data;
+        t->nodeCount = nodes.count;
+    }
+}
+
+static int compareTasks(const void *a, const void *b) {
+    size_t na = ((const Task *)a)->range.end - ((const Task *)a)->range.begin;
+    size_t nb = ((const Task *)b)->range.end - ((const Task *)b)->range.begin;
+    return na < nb ? 1 : (na > nb ? -1 : 0);
+}
+
+// the upper levels followed by every task's nodes, with the task's child
+// links moved by its offset
+static int mergeTasks(Builder *b, NodeVec *top, BVH *bvh) {
+    size_t total = top->count;
+    for (size_t i = 0; i < b->taskCount; i++) {
+        if (b->tasks[i].status != NML_SUCCESS)
+            return b->tasks[i].status;
+        total += b->tasks[i].nodeCount;
+    }
+    bvh->nodes = alignedAlloc(NML_ALIGNMENT, total * sizeof(BVHNode));
+    if (!bvh->nodes)
+        return NML_ENOMEM;
+    memcpy(bvh->nodes, top->data, top->count * sizeof(BVHNode));
+
+    size_t offset = top->count;
+    for (size_t i = 0; i < b->taskCount; i++) {
+        Task *t = &b->tasks[i];
+        BVHNode *dst = bvh->nodes + offset;
+        memcpy(dst, t->nodes, t->nodeCount * sizeof(BVHNode));
+        for (size_t k = 0; k < t->nodeCount; k++) {
+            for (int c = 0; c < NML_BVH_WIDTH; c++) {
+                if (dst[k].count[c] == 0 && dst[k].child[c] != NML_BVH_EMPTY)
+                    dst[k].child[c] += (uint32_t)offset;
+            }
+        }
+        bvh->nodes[t->parent].child[t->slot] = (uint32_t)offset;
+        offset += t->nodeCount;
+    }
+    bvh->nodeCount = total;
+    return NML_SUCCESS;
+}
+
+/*
+ * per primitive passes
+ */
+
+typedef struct PrimJob {
+    const TriangleStream *tris;
+    const Vec3Stream *points;
+    Bounds *prims;
+    BVH *bvh;
+} PrimJob;
+
+static void triangleBounds(void *ctx, size_t begin, size_t end) {
+    PrimJob *job = ctx;
+    const Vec3Stream *v[3] = {&job->tris->v0, &job->tris->v1, &job->tris->v2};
+    for (size_t i = begin; i < end; i++) {
+        Bounds *p = &job->prims[i];
+        boundsEmpty(p);
+        for (int j = 0; j < 3; j++) {
+            nml_t c[3] = {v[j]->x[i], v[j]->y[i], v[j]->z[i]};
+            boundsGrow(p, c, c);
+        }
+    }
+}
+
+static void pointBounds(void *ctx, size_t begin, size_t end) {
+    PrimJob *job = ctx;
+    for (size_t i = begin; i < end; i++) {
+        nml_t c[3] = {job->points->x[i], job->points->y[i], job->points->z[i]};
+        job->prims[i] = (Bounds){{c[0], c[1], c[2]}, {c[0], c[1], c[2]}};
+    }
+}
+
+static inline void gatherStream(const Vec3Stream *src,
+                                Vec3Stream *dst,
+                                const uint32_t *prims,
+                                size_t begin,
+                                size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        dst->x[i] = src->x[prims[i]];
+        dst->y[i] = src->y[prims[i]];
+        dst->z[i] = src->z[prims[i]];
+    }
+}
+
+// the build input copied into leaf order
+static void gatherPrims(void *ctx, size_t begin, size_t end) {
+    PrimJob *job = ctx;
+    BVH *bvh = job->bvh;
+    if (job->tris) {
+        gatherStream(&job->tris->v0, &bvh->tris.v0, bvh->prims, begin, end);
+        gatherStream(&job->tris->v1, &bvh->tris.v1, bvh->prims, begin, end);
+        gatherStream(&job->tris->v2, &bvh->tris.v2, bvh->prims, begin, end);
+    } else {
+        gatherStream(job->points, &bvh->points, bvh->prims, begin, end);
+    }
+}
+
+// bounds of the leaf order primitives [first, first + count)
+static void leafBounds(const BVH *bvh, size_t first, size_t count, Bounds *out) {
+    boundsEmpty(out);
+    const Vec3Stream *v[3] = {&bvh->tris.v0, &bvh->tris.v1, &bvh->tris.v2};
+    int corners = bvh->kind == NML_BVH_TRIANGLES ? 3 : 1;
+    if (corners == 1)
+        v[0] = &bvh->points;
+    for (size_t i = first; i < first + count; i++) {
+        for (int j = 0; j < corners; j++) {
+            nml_t c[3] = {v[j]->x[i], v[j]->y[i], v[j]->z[i]};
+            boundsGrow(out, c, c);
+        }
+    }
+}
+
+static inline void slotBounds(BVHNode *node, int c, const Bounds *b) {
+    node->minX[c] = b->lo[0];
+    node->minY[c] = b->lo[1];
+    node->minZ[c] = b->lo[2];
+    node->maxX[c] = b->hi[0];
+    node->maxY[c] = b->hi[1];
+    node->maxZ[c] = b->hi[2];
+}
+
+static void refitLeaves(void *ctx, size_t begin, size_t end) {
+    BVH *bvh = ((PrimJob *)ctx)->bvh;
+    for (size_t k = begin; k < end; k++) {
+        BVHNode *node = &bvh->nodes[k];
+        for (int c = 0; c < NML_BVH_WIDTH; c++) {
+            if (node->count[c] == 0)
+                continue;
+            Bounds b;
+            leafBounds(bvh, node->child[c], node->count[c], &b);
+            slotBounds(node, c, &b);
+        }
+    }
+}
+
+static void nodeBounds(const BVHNode *node, Bounds *out) {
+    boundsEmpty(out);
+    for (int c = 0; c < NML_BVH_WIDTH; c++) {
+        if (node->child[c] == NML_BVH_EMPTY)
+            continue;
+        nml_t lo[3] = {node->minX[c], node->minY[c], node->minZ[c]};
+        nml_t hi[3] = {node->maxX[c], node->maxY[c], node->maxZ[c]};
+        boundsGrow(out, lo, hi);
+    }
+}
+
+static void setRootBounds(BVH *bvh) {
+    Bounds b;
+    boundsEmpty(&b);
+    if (bvh->nodeCount)
+        nodeBounds(&bvh->nodes[0], &b);
+    for (int k = 0; k < 3; k++) {
+        bvh->bounds.min.elems[k] = b.lo[k];
+        bvh->bounds.max.elems[k] = b.hi[k];
+    }
+}
+
+static int build(const TriangleStream *tris,
+                 const Vec3Stream *points,
+                 size_t n,
+                 size_t leafSize,
+                 BVH *bvhOut) {
+    memset(bvhOut, 0, sizeof(*bvhOut));
+    bvhOut->kind = tris ? NML_BVH_TRIANGLES : NML_BVH_POINTS;
+    aabbInitEmpty(&bvhOut->bounds);
+    if (leafSize == 0)
+        leafSize = BVH_DEFAULT_LEAF;
+    if (leafSize > NML_BVH_MAX_LEAF || n > UINT32_MAX)
+        return NML_EINVAL;
+    if (n == 0)
+        return NML_SUCCESS;
+
+    Builder b = {0};
+    Bounds *prims = malloc(n * sizeof(Bounds));
+    b.idx = malloc(n * sizeof(uint32_t));
+    int status = NML_ENOMEM;
+    if (!prims || !b.idx)
+        goto done;
+    PrimJob job = {tris, points, prims, bvhOut};
+    parallelFor(n, BVH_GRAIN, tris ? triangleBounds : pointBounds, &job);
+    for (size_t i = 0; i < n; i++)
+        b.idx[i] = (uint32_t)i;
+
+    int threads = threadCount();
+    b.prims = prims;
+    b.leafSize = leafSize;
+    b.parallel = threads > 1;
+    if (threads > 1) {
+        b.taskMax = n / ((size_t)threads * 8);
+        b.taskMax = b.taskMax < 4096 ? 4096 : b.taskMax;
+    }
+
+    Range root = {.begin = 0, .end = n};
+    rangeBounds(&b, &root);
+    NodeVec top = {NULL, 0, 0};
+    size_t rootIndex;
+    if (n <= b.taskMax)
+        b.taskMax = 0;
+    status = buildNode(&b, &top, &root, 0, &rootIndex);
+    if (status == NML_SUCCESS) {
+        qsort(b.tasks, b.taskCount, sizeof(Task), compareTasks);
+        TaskJob tj = {&b};
+        parallelFor(b.taskCount, 1, runTasks, &tj);
+        status = mergeTasks(&b, &top, bvhOut);
+    }
+    free(top.data);
+    for (size_t i = 0; i < b.taskCount; i++)
+        free(b.tasks[i].nodes);
+    free(b.tasks);
+    if (status != NML_SUCCESS)
+        goto done;
+
+    // the primitives in leaf order
+    bvhOut->prims = b.idx;
+    b.idx = NULL;
+    bvhOut->primCount = n;
+    status = NML_ENOMEM;
+    if (tris) {
+        if (vec3StreamInit(n, &bvhOut->tris.v0) != NML_SUCCESS ||
+            vec3StreamInit(n, &bvhOut->tris.v1) != NML_SUCCESS ||
+            vec3StreamInit(n, &bvhOut->tris.v2) != NML_SUCCESS)
+            goto done;
+    } else if (vec3StreamInit(n, &bvhOut->points) != NML_SUCCESS) {
+        goto done;
+    }
+    parallelFor(n, BVH_GRAIN, gatherPrims, &job);
+    setRootBounds(bvhOut);
+    status = NML_SUCCESS;
+
+done:
+    free(prims);
+    free(b.idx);
+    if (status != NML_SUCCESS)
+        bvhFree(bvhOut);
+    return status;
+}
+
+int bvhBuildTriangles(const TriangleStream *tris, size_t leafSize, BVH *bvhOut) {
+    is_null((void *)tris, bvhOut);
+    size_t n = tris->v0.count;
+    if (n != tris->v1.count || n != tris->v2.count)
+        return NML_EINVAL;
+    return build(tris, NULL, n, leafSize, bvhOut);
+}
+
+int bvhBuildPoints(const Vec3Stream *points, size_t leafSize, BVH *bvhOut) {
+    is_null((void *)points, bvhOut);
+    return build(NULL, points, points->count, leafSize, bvhOut);
+}
+
+void bvhFree(BVH *bvh) {
+    if (!bvh)
+        return;
+    alignedFree(bvh->nodes);
+    free(bvh->prims);
+    vec3StreamFree(&bvh->tris.v0);
+    vec3StreamFree(&bvh->tris.v1);
+    vec3StreamFree(&bvh->tris.v2);
+    vec3StreamFree(&bvh->points);
+    memset(bvh, 0, sizeof(*bvh));
+}
+
+/*
+ * refit
+ *
+ * leaf slots are independent and recomputed in parallel. children always
+ * follow their parents in the node array, so one backwards pass then
+ * rebuilds every inner slot from finished children
+ */
+
+static int refit(BVH *bvh, const TriangleStream *tris, const Vec3Stream *points) {
+    PrimJob job = {tris, points, NULL, bvh};
+    parallelFor(bvh->primCount, BVH_GRAIN, gatherPrims, &job);
+    // leaves are at most NML_BVH_WIDTH * NML_BVH_MAX_LEAF primitives a node
+    parallelFor(bvh->nodeCount, BVH_GRAIN / 64, refitLeaves, &job);
+    for (size_t k = bvh->nodeCount; k-- > 0;) {
+        BVHNode *node = &bvh->nodes[k];
+        for (int c = 0; c < NML_BVH_WIDTH; c++) {
+            if (node->count[c] != 0 || node->child[c] == NML_BVH_EMPTY)
+                continue;
+            Bounds b;
+            nodeBounds(&bvh->nodes[node->child[c]], &b);
+            slotBounds(node, c, &b);
+        }
+    }
+    setRootBounds(bvh);
+    return NML_SUCCESS;
+}
+
+int bvhRefitTriangles(BVH *bvh, const TriangleStream *tris) {
+    is_null(bvh, (void *)tris);
+    size_t n = bvh->primCount;
+    if (bvh->kind != NML_BVH_TRIANGLES || tris->v0.count != n ||
+        tris->v1.count != n || tris->v2.count != n)
+        return NML_EINVAL;
+    return refit(bvh, tris, NULL);
+}
+
+int bvhRefitPoints(BVH *bvh, const Vec3Stream *points) {
+    is_null(bvh, (void *)points);
+    if (bvh->kind != NML_BVH_POINTS || points->count != bvh->primCount)
+        return NML_EINVAL;
+    return refit(bvh, NULL, points);
+}
+
+/*
+ * traversal
+ */
+
+static inline uint32_t validSlots(const BVHNode *node) {
+    uint32_t mask = 0;
+    for (int c = 0; c < NML_BVH_WIDTH; c++)
+        mask |= (uint32_t)(node->child[c] != NML_BVH_EMPTY) << c;
+    return mask;
+}
+
+// slab test of one ray against the four children, entry distances of the
+// children hit within tFar in tNear
+static inline uint32_t childSlab(const BVHNode *node,
+                                 const nml_t o[3],
+                                 const nml_t inv[3],
+                                 nml_t tFar,
+                                 nml_t tNear[NML_BVH_WIDTH]) {
+#if defined(NML_SIMD_F32)
+    const nml_t *lo[3] = {node->minX, node->minY, node->minZ};
+    const nml_t *hi[3] = {node->maxX, node->maxY, node->maxZ};
+    simd_f32x4_t tn = simd_set1_f32(0.0f), tf = simd_set1_f32(tFar);
+    for (int k = 0; k < 3; k++) {
+        simd_f32x4_t ok = simd_set1_f32(o[k]), iv = simd_set1_f32(inv[k]);
+        simd_f32x4_t t0 =
+            simd_mul_f32(simd_sub_f32(simd_loadu_f32(lo[k]), ok), iv);
+        simd_f32x4_t t1 =
+            simd_mul_f32(simd_sub_f32(simd_loadu_f32(hi[k]), ok), iv);
+        tn = simd_max_f32(simd_min_f32(t0, t1), tn);
+        tf = simd_min_f32(simd_max_f32(t0, t1), tf);
+    }
+    simd_storeu_f32(tNear, tn);
+    return (uint32_t)simd_movemask_f32(simd_cmple_f32(tn, tf)) &
+           validSlots(node);
+#else
+    uint32_t mask = 0;
+    for (int c = 0; c < NML_BVH_WIDTH; c++) {
+        if (node->child[c] == NML_BVH_EMPTY)
+            continue;
+        nml_t lo[3] = {node->minX[c], node->minY[c], node->minZ[c]};
+        nml_t hi[3] = {node->maxX[c], node->maxY[c], node->maxZ[c]};
+        tNear[c] = raySlabLane(o, inv, tFar, lo, hi);
+        mask |= (uint32_t)(tNear[c] != INFINITY) << c;
+    }
+    return mask;
+#endif
+}
+
+static inline TriangleStream leafSlice(const BVH *bvh,
+                                      size_t first,
+                                      size_t count) {
+    const TriangleStream *t = &bvh->tris;
+    TriangleStream s = {
+        {t->v0.x + first, t->v0.y + first, t->v0.z + first, count},
+        {t->v1.x + first, t->v1.y + first, t->v1.z + first, count},
+        {t->v2.x + first, t->v2.y + first, t->v2.z + first, count},
+    };
+    return s;
+}
+
+int bvhIntersectRay(const BVH *bvh, const Ray *ray, RayHit *hit) {
+    is_null((void *)bvh, (void *)ray, hit);
+    if (bvh->kind != NML_BVH_TRIANGLES)
+        return NML_EINVAL;
+    hit->index = NML_RAY_MISS;
+    if (bvh->nodeCount == 0)
+        return NML_SUCCESS;
+
+    Ray r = *ray;
+    const nml_t *o = ray->origin.elems;
+    nml_t inv[3] = {1.0 / ray->dir.x, 1.0 / ray->dir.y, 1.0 / ray->dir.z};
+    size_t best = SIZE_MAX;
+    uint32_t stack[BVH_STACK];
+    size_t sp = 0;
+    stack[sp++] = 0;
+
+    while (sp) {
+        const BVHNode *node = &bvh->nodes[stack[--sp]];
+        nml_t tNear[NML_BVH_WIDTH];
+        uint32_t mask = childSlab(node, o, inv, r.tMax, tNear);
+        if (!mask)
+            continue;
+
+        // children hit, nearest first
+        int order[NML_BVH_WIDTH], n = 0;
+        for (int c = 0; c < NML_BVH_WIDTH; c++) {
+            if (!(mask & (1u << c)))
+                continue;
+            int j = n++;
+            while (j > 0 && tNear[order[j - 1]] > tNear[c]) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = c;
+        }
+
+        // leaves right away so their hits cut the rest short
+        for (int j = 0; j < n; j++) {
+            int c = order[j];
+            if (node->count[c] == 0 || tNear[c] > r.tMax)
+                continue;
+            nml_t t[NML_BVH_MAX_LEAF];
+            uint32_t bits;
+            TriangleStream leaf = leafSlice(bvh, node->child[c], node->count[c]);
+            ray_kernels.triangles(&r, &leaf, t, &bits);
+            for (uint32_t i = 0; bits; i++, bits >>= 1) {
+                if ((bits & 1u) && (best == SIZE_MAX || t[i] < r.tMax)) {
+                    r.tMax = t[i];
+                    best = node->child[c] + i;
+                }
+            }
+        }
+        for (int j = n; j-- > 0;) {
+            int c = order[j];
+            if (node->count[c] == 0 && tNear[c] <= r.tMax)
+                stack[sp++] = node->child[c];
+        }
+    }
+
+    if (best == SIZE_MAX)
+        return NML_SUCCESS;
+    const TriangleStream *s = &bvh->tris;
+    nml_t v0[3] = {s->v0.x[best], s->v0.y[best], s->v0.z[best]};
+    nml_t v1[3] = {s->v1.x[best], s->v1.y[best], s->v1.z[best]};
+    nml_t v2[3] = {s->v2.x[best], s->v2.y[best], s->v2.z[best]};
+    nml_t tHit;
+    rayTriangleLane(o, ray->dir.elems, ray->tMax, v0, v1, v2, &tHit, &hit->u,
+                    &hit->v);
+    hit->t = r.tMax;
+    hit->index = bvh->prims[best];
+    return NML_SUCCESS;
+}
+
+int bvhIntersectPacket(const BVH *bvh, RayPacket *packet) {
+    is_null((void *)bvh, packet);
+    if (bvh->kind != NML_BVH_TRIANGLES)
+        return NML_EINVAL;
+    if (bvh->nodeCount == 0)
+        return NML_SUCCESS;
+
+    const TriangleStream *s = &bvh->tris;
+    uint32_t stack[BVH_STACK];
+    size_t sp = 0;
+    stack[sp++] = 0;
+    while (sp) {
+        const BVHNode *node = &bvh->nodes[stack[--sp]];
+        for (int c = NML_BVH_WIDTH; c-- > 0;) {
+            if (node->child[c] == NML_BVH_EMPTY)
+                continue;
+            nml_t lo[3] = {node->minX[c], node->minY[c], node->minZ[c]};
+            nml_t hi[3] = {node->maxX[c], node->maxY[c], node->maxZ[c]};
+            if (!ray_kernels.packetBox(packet, lo, hi))
+                continue;
+            if (node->count[c] == 0) {
+                stack[sp++] = node->child[c];
+                continue;
+            }
+            size_t first = node->child[c];
+            for (size_t i = first; i < first + node->count[c]; i++) {
+                nml_t v0[3] = {s->v0.x[i], s->v0.y[i], s->v0.z[i]};
+                nml_t v1[3] = {s->v1.x[i], s->v1.y[i], s->v1.z[i]};
+                nml_t v2[3] = {s->v2.x[i], s->v2.y[i], s->v2.z[i]};
+                ray_kernels.packetTriangle(packet, v0, v1, v2, bvh->prims[i]);
+            }
+        }
+    }
+    return NML_SUCCESS;
+}
+
+int bvhQueryBox(const BVH *bvh,
+                const AABB *box,
+                uint32_t *indices,
+                size_t capacity,
+                size_t *found) {
+    is_null((void *)bvh, (void *)box, found);
+    if (capacity > 0)
+        is_null(indices);
+    size_t count = 0;
+    uint32_t stack[BVH_STACK];
+    size_t sp = 0;
+    if (bvh->nodeCount)
+        stack[sp++] = 0;
+
+    const nml_t *qlo = box->min.elems, *qhi = box->max.elems;
+    while (sp) {
+        const BVHNode *node = &bvh->nodes[stack[--sp]];
+        for (int c = 0; c < NML_BVH_WIDTH; c++) {
+            if (node->child[c] == NML_BVH_EMPTY || node->minX[c] > qhi[0] ||
+                node->maxX[c] < qlo[0] || node->minY[c] > qhi[1] ||
+                node->maxY[c] < qlo[1] || node->minZ[c] > qhi[2] ||
+                node->maxZ[c] < qlo[2])
+                continue;
+            if (node->count[c] == 0) {
+                stack[sp++] = node->child[c];
+                continue;
+            }
+            size_t first = node->child[c];
+            for (size_t i = first; i < first + node->count[c]; i++) {
+                Bounds p;
+                leafBounds(bvh, i, 1, &p);
+                if (p.lo[0] > qhi[0] || p.hi[0] < qlo[0] || p.lo[1] > qhi[1] ||
+                    p.hi[1] < qlo[1] || p.lo[2] > qhi[2] || p.hi[2] < qlo[2])
+                    continue;
+                if (count < capacity)
+                    indices[count] = bvh->prims[i];
+                count++;
+            }
+        }
+    }
+    *found = count;
+    return NML_SUCCESS;
+}
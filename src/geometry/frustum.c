@@ -0,0 +1,342 @@
+#include "geometry/frustum.h"
+#include "frustum_kernels.h"
+#include "utils/errors.h"
+#include "utils/simd.h"
+#include <math.h>
+#include <stdint.h>
+
+int frustumFromMat4(const Mat4 *viewProj, unsigned int options, Frustum *fOut) {
+    is_null((void *)viewProj, fOut);
+    const nml_t *m = viewProj->elems;
+
+    // clip coordinate i of a point is dot(row i, (x, y, z, 1)), inside means
+    // -w <= x, y <= w and -w (or 0) <= z <= w. component k of every plane
+    // comes from column k of the matrix
+    for (int k = 0; k < 4; k++) {
+        nml_t r0 = m[4 * k], r1 = m[4 * k + 1], r2 = m[4 * k + 2];
+        nml_t r3 = m[4 * k + 3];
+        fOut->planes[0].elems[k] = r3 + r0;
+        fOut->planes[1].elems[k] = r3 - r0;
+        fOut->planes[2].elems[k] = r3 + r1;
+        fOut->planes[3].elems[k] = r3 - r1;
+        fOut->planes[4].elems[k] =
+            (options & NML_FRUSTUM_DEPTH_ZERO_ONE) ? r2 : r3 + r2;
+        fOut->planes[5].elems[k] = r3 - r2;
+    }
+
+    // unit normals so sphere radii compare against true distances
+    for (int p = 0; p < 6; p++) {
+        nml_t *pl = fOut->planes[p].elems;
+        nml_t len = sqrt(pl[0] * pl[0] + pl[1] * pl[1] + pl[2] * pl[2]);
+        if (len > 0.0) {
+            for (int k = 0; k < 4; k++)
+                pl[k] /= len;
+        }
+    }
+    return NML_SUCCESS;
+}
+
+/*
+ * scalar tests, the whole job in double and no-simd builds and the last
+ * few objects of every word otherwise
+ */
+
+static inline uint32_t sphereVisible(const Frustum *frustum,
+                                     nml_t x,
+                                     nml_t y,
+                                     nml_t z,
+                                     nml_t r) {
+    for (int p = 0; p < 6; p++) {
+        const nml_t *pl = frustum->planes[p].elems;
+        if (pl[0] * x + pl[1] * y + pl[2] * z + pl[3] < -r)
+            return 0;
+    }
+    return 1;
+}
+
+// the box corner furthest along each plane normal decides, so per plane the
+// min or max array of every axis is picked once up front
+typedef struct BoxCorners {
+    const nml_t *x[6], *y[6], *z[6];
+} BoxCorners;
+
+static void boxCorners(const Frustum *frustum,
+                       const Vec3Stream *mins,
+                       const Vec3Stream *maxs,
+                       BoxCorners *cOut) {
+    for (int p = 0; p < 6; p++) {
+        const nml_t *pl = frustum->planes[p].elems;
+        cOut->x[p] = pl[0] >= 0.0 ? maxs->x : mins->x;
+        cOut->y[p] = pl[1] >= 0.0 ? maxs->y : mins->y;
+        cOut->z[p] = pl[2] >= 0.0 ? maxs->z : mins->z;
+    }
+}
+
+static inline uint32_t boxVisible(const Frustum *frustum,
+                                  const BoxCorners *c,
+                                  size_t i) {
+    for (int p = 0; p < 6; p++) {
+        const nml_t *pl = frustum->planes[p].elems;
+        if (pl[0] * c->x[p][i] + pl[1] * c->y[p][i] + pl[2] * c->z[p][i] +
+                pl[3] <
+            0.0)
+            return 0;
+    }
+    return 1;
+}
+
+#if defined(NML_SIMD_F32)
+
+static void frustumSpheres4(const Frustum *frustum,
+                            const Vec3Stream *centers,
+                            const nml_t *radii,
+                            uint32_t *bits) {
+    size_t n = centers->count;
+    simd_f32x4_t a[6], b[6], c[6], d[6];
+    for (int p = 0; p < 6; p++) {
+        a[p] = simd_set1_f32(frustum->planes[p].x);
+        b[p] = simd_set1_f32(frustum->planes[p].y);
+        c[p] = simd_set1_f32(frustum->planes[p].z);
+        d[p] = simd_set1_f32(frustum->planes[p].w);
+    }
+
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        size_t i = base;
+        uint32_t word = 0;
+        for (; i + 4 <= end; i += 4) {
+            simd_f32x4_t x = simd_loadu_f32(&centers->x[i]);
+            simd_f32x4_t y = simd_loadu_f32(&centers->y[i]);
+            simd_f32x4_t z = simd_loadu_f32(&centers->z[i]);
+            simd_f32x4_t r = simd_negate_f32(simd_loadu_f32(&radii[i]));
+            simd_f32x4_t in = simd_cmpge_f32(
+                simd_fmadd_f32(a[0], x,
+                               simd_fmadd_f32(b[0], y,
+                                              simd_fmadd_f32(c[0], z, d[0]))),
+                r);
+            for (int p = 1; p < 6; p++) {
+                simd_f32x4_t dist = simd_fmadd_f32(
+                    a[p], x,
+                    simd_fmadd_f32(b[p], y, simd_fmadd_f32(c[p], z, d[p])));
+                in = simd_and_f32(in, simd_cmpge_f32(dist, r));
+            }
+            word |= (uint32_t)simd_movemask_f32(in) << (i - base);
+        }
+        for (; i < end; i++) {
+            word |= sphereVisible(frustum, centers->x[i], centers->y[i],
+                                  centers->z[i], radii[i])
+                    << (i - base);
+        }
+        bits[base / 32] = word;
+    }
+}
+
+static void frustumBoxes4(const Frustum *frustum,
+                          const Vec3Stream *mins,
+                          const Vec3Stream *maxs,
+                          uint32_t *bits) {
+    size_t n = mins->count;
+    BoxCorners corners;
+    boxCorners(frustum, mins, maxs, &corners);
+    simd_f32x4_t a[6], b[6], c[6], d[6];
+    for (int p = 0; p < 6; p++) {
+        a[p] = simd_set1_f32(frustum->planes[p].x);
+        b[p] = simd_set1_f32(frustum->planes[p].y);
+        c[p] = simd_set1_f32(frustum->planes[p].z);
+        d[p] = simd_set1_f32(frustum->planes[p].w);
+    }
+    simd_f32x4_t zero = simd_set1_f32(0.0f);
+
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        size_t i = base;
+        uint32_t word = 0;
+        for (; i + 4 <= end; i += 4) {
+            simd_f32x4_t in = simd_cmpge_f32(zero, zero);
+            for (int p = 0; p < 6; p++) {
+                simd_f32x4_t x = simd_loadu_f32(&corners.x[p][i]);
+                simd_f32x4_t y = simd_loadu_f32(&corners.y[p][i]);
+                simd_f32x4_t z = simd_loadu_f32(&corners.z[p][i]);
+                simd_f32x4_t dist = simd_fmadd_f32(
+                    a[p], x,
+                    simd_fmadd_f32(b[p], y, simd_fmadd_f32(c[p], z, d[p])));
+                in = simd_and_f32(in, simd_cmpge_f32(dist, zero));
+            }
+            word |= (uint32_t)simd_movemask_f32(in) << (i - base);
+        }
+        for (; i < end; i++) {
+            word |= boxVisible(frustum, &corners, i) << (i - base);
+        }
+        bits[base / 32] = word;
+    }
+}
+
+#else
+
+static void frustumSpheresScalar(const Frustum *frustum,
+                                 const Vec3Stream *centers,
+                                 const nml_t *radii,
+                                 uint32_t *bits) {
+    size_t n = centers->count;
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        uint32_t word = 0;
+        for (size_t i = base; i < end; i++) {
+            word |= sphereVisible(frustum, centers->x[i], centers->y[i],
+                                  centers->z[i], radii[i])
+                    << (i - base);
+        }
+        bits[base / 32] = word;
+    }
+}
+
+static void frustumBoxesScalar(const Frustum *frustum,
+                               const Vec3Stream *mins,
+                               const Vec3Stream *maxs,
+                               uint32_t *bits) {
+    size_t n = mins->count;
+    BoxCorners corners;
+    boxCorners(frustum, mins, maxs, &corners);
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        uint32_t word = 0;
+        for (size_t i = base; i < end; i++) {
+            word |= boxVisible(frustum, &corners, i) << (i - base);
+        }
+        bits[base / 32] = word;
+    }
+}
+
+#endif
+
+FrustumKernels frustum_kernels = {
+#if defined(NML_SIMD_F32)
+    frustumSpheres4,
+    frustumBoxes4,
+#else
+    frustumSpheresScalar,
+    frustumBoxesScalar,
+#endif
+};
+
+#if defined(NML_DISPATCH_AVX2) && !defined(USE_DOUBLE_PRECISION)
+__attribute__((constructor)) static void frustumSelectKernels(void) {
+    if (cpuHasAVX2FMA()) {
+        frustum_kernels = (FrustumKernels){
+            frustumSpheresAVX2,
+            frustumBoxesAVX2,
+        };
+    }
+}
+#endif
+
+/*
+ * public api
+ */
+
+int frustumTestSpheres(const Frustum *frustum,
+                       const Vec3Stream *centers,
+                       const nml_t *radii,
+                       uint32_t *bits) {
+    is_null((void *)frustum, (void *)centers, (void *)radii, bits);
+    frustum_kernels.spheres(frustum, centers, radii, bits);
+    return NML_SUCCESS;
+}
+
+int frustumTestBoxes(const Frustum *frustum,
+                     const Vec3Stream *mins,
+                     const Vec3Stream *maxs,
+                     uint32_t *bits) {
+    is_null((void *)frustum, (void *)mins, (void *)maxs, bits);
+    if (mins->count != maxs->count)
+        return NML_EINVAL;
+    frustum_kernels.boxes(frustum, mins, maxs, bits);
+    return NML_SUCCESS;
+}
+
+// objects per kernel call of the index form, the bits of one chunk stay on
+// the stack
+#define CULL_CHUNK 2048
+
+static inline uint32_t lowestBit(uint32_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(word);
+#else
+    uint32_t k = 0;
+    while (!(word & 1u)) {
+        word >>= 1;
+        k++;
+    }
+    return k;
+#endif
+}
+
+// append base + position of every set bit
+static size_t compactBits(const uint32_t *bits,
+                          size_t words,
+                          uint32_t base,
+                          uint32_t *indices) {
+    size_t k = 0;
+    for (size_t w = 0; w < words; w++) {
+        uint32_t word = bits[w];
+        while (word) {
+            indices[k++] = base + (uint32_t)w * 32 + lowestBit(word);
+            word &= word - 1;
+        }
+    }
+    return k;
+}
+
+static inline Vec3Stream streamSlice(const Vec3Stream *s,
+                                     size_t begin,
+                                     size_t count) {
+    Vec3Stream slice = {s->x + begin, s->y + begin, s->z + begin, count};
+    return slice;
+}
+
+int frustumCullSpheres(const Frustum *frustum,
+                       const Vec3Stream *centers,
+                       const nml_t *radii,
+                       uint32_t *indices,
+                       size_t *visibleCount) {
+    is_null((void *)frustum, (void *)centers, (void *)radii, indices,
+            visibleCount);
+    if (centers->count > UINT32_MAX)
+        return NML_EINVAL;
+
+    uint32_t bits[CULL_CHUNK / 32];
+    size_t n = centers->count, visible = 0;
+    for (size_t begin = 0; begin < n; begin += CULL_CHUNK) {
+        size_t len = n - begin < CULL_CHUNK ? n - begin : CULL_CHUNK;
+        Vec3Stream slice = streamSlice(centers, begin, len);
+        frustum_kernels.spheres(frustum, &slice, radii + begin, bits);
+        visible += compactBits(bits, (len + 31) / 32, (uint32_t)begin,
+                               indices + visible);
+    }
+    *visibleCount = visible;
+    return NML_SUCCESS;
+}
+
+int frustumCullBoxes(const Frustum *frustum,
+                     const Vec3Stream *mins,
+                     const Vec3Stream *maxs,
+                     uint32_t *indices,
+                     size_t *visibleCount) {
+    is_null((void *)frustum, (void *)mins, (void *)maxs, indices,
+            visibleCount);
+    if (mins->count != maxs->count || mins->count > UINT32_MAX)
+        return NML_EINVAL;
+
+    uint32_t bits[CULL_CHUNK / 32];
+    size_t n = mins->count, visible = 0;
+    for (size_t begin = 0; begin < n; begin += CULL_CHUNK) {
+        size_t len = n - begin < CULL_CHUNK ? n - begin : CULL_CHUNK;
+        Vec3Stream lo = streamSlice(mins, begin, len);
+        Vec3Stream hi = streamSlice(maxs, begin, len);
+        frustum_kernels.boxes(frustum, &lo, &hi, bits);
+        visible += compactBits(bits, (len + 31) / 32, (uint32_t)begin,
+                               indices + visible);
+    }
+    *visibleCount = visible;
+    return NML_SUCCESS;
+}
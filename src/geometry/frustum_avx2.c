@@ -0,0 +1,109 @@
+#include "frustum_kernels.h"
+
+#if defined(NML_DISPATCH_AVX2) && !defined(USE_DOUBLE_PRECISION)
+#    include <immintrin.h>
+
+// a * x + b * y + c * z + d, 8 objects against one plane
+NML_AVX2_FN static inline __m256 planeDist8(const __m256 *pl,
+                                            __m256 x,
+                                            __m256 y,
+                                            __m256 z) {
+    return _mm256_fmadd_ps(
+        pl[0], x, _mm256_fmadd_ps(pl[1], y, _mm256_fmadd_ps(pl[2], z, pl[3])));
+}
+
+NML_AVX2_FN static void splatPlanes8(const Frustum *frustum, __m256 pl[6][4]) {
+    for (int p = 0; p < 6; p++) {
+        for (int k = 0; k < 4; k++)
+            pl[p][k] = _mm256_set1_ps(frustum->planes[p].elems[k]);
+    }
+}
+
+NML_AVX2_FN void frustumSpheresAVX2(const Frustum *frustum,
+                                    const Vec3Stream *centers,
+                                    const nml_t *radii,
+                                    uint32_t *bits) {
+    size_t n = centers->count;
+    __m256 pl[6][4];
+    splatPlanes8(frustum, pl);
+
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        size_t i = base;
+        uint32_t word = 0;
+        for (; i + 8 <= end; i += 8) {
+            __m256 x = _mm256_loadu_ps(&centers->x[i]);
+            __m256 y = _mm256_loadu_ps(&centers->y[i]);
+            __m256 z = _mm256_loadu_ps(&centers->z[i]);
+            __m256 r = _mm256_xor_ps(_mm256_loadu_ps(&radii[i]),
+                                     _mm256_set1_ps(-0.0f));
+            __m256 in = _mm256_cmp_ps(planeDist8(pl[0], x, y, z), r,
+                                      _CMP_GE_OQ);
+            for (int p = 1; p < 6; p++) {
+                in = _mm256_and_ps(in, _mm256_cmp_ps(planeDist8(pl[p], x, y, z),
+                                                     r, _CMP_GE_OQ));
+            }
+            word |= (uint32_t)_mm256_movemask_ps(in) << (i - base);
+        }
+        // the rest of the word one at a time
+        for (; i < end; i++) {
+            uint32_t visible = 1;
+            for (int p = 0; p < 6; p++) {
+                const nml_t *e = frustum->planes[p].elems;
+                if (e[0] * centers->x[i] + e[1] * centers->y[i] +
+                        e[2] * centers->z[i] + e[3] <
+                    -radii[i])
+                    visible = 0;
+            }
+            word |= visible << (i - base);
+        }
+        bits[base / 32] = word;
+    }
+}
+
+NML_AVX2_FN void frustumBoxesAVX2(const Frustum *frustum,
+                                  const Vec3Stream *mins,
+                                  const Vec3Stream *maxs,
+                                  uint32_t *bits) {
+    size_t n = mins->count;
+    __m256 pl[6][4];
+    splatPlanes8(frustum, pl);
+    // the box corner furthest along each normal
+    const nml_t *cx[6], *cy[6], *cz[6];
+    for (int p = 0; p < 6; p++) {
+        const nml_t *e = frustum->planes[p].elems;
+        cx[p] = e[0] >= 0.0f ? maxs->x : mins->x;
+        cy[p] = e[1] >= 0.0f ? maxs->y : mins->y;
+        cz[p] = e[2] >= 0.0f ? maxs->z : mins->z;
+    }
+    __m256 zero = _mm256_setzero_ps();
+
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        size_t i = base;
+        uint32_t word = 0;
+        for (; i + 8 <= end; i += 8) {
+            __m256 in = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (int p = 0; p < 6; p++) {
+                __m256 dist = planeDist8(pl[p], _mm256_loadu_ps(&cx[p][i]),
+                                         _mm256_loadu_ps(&cy[p][i]),
+                                         _mm256_loadu_ps(&cz[p][i]));
+                in = _mm256_and_ps(in, _mm256_cmp_ps(dist, zero, _CMP_GE_OQ));
+            }
+            word |= (uint32_t)_mm256_movemask_ps(in) << (i - base);
+        }
+        for (; i < end; i++) {
+            uint32_t visible = 1;
+            for (int p = 0; p < 6; p++) {
+                const nml_t *e = frustum->planes[p].elems;
+                if (e[0] * cx[p][i] + e[1] * cy[p][i] + e[2] * cz[p][i] + e[3] <
+                    0.0f)
+                    visible = 0;
+            }
+            word |= visible << (i - base);
+        }
+        bits[base / 32] = word;
+    }
+}
+
+#endif
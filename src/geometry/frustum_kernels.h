@@ -0,0 +1,45 @@
+#ifndef __FRUSTUM_KERNELS_H__
+#define __FRUSTUM_KERNELS_H__
+
+#include "geometry/frustum.h"
+#include "utils/cpu.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * internal kernel table for the frustum tests
+ *
+ * each kernel writes the visibility bits of the first count objects of its
+ * streams into (count + 31) / 32 whole words. the public functions run them
+ * over chunks that start on a word boundary
+ */
+
+typedef void (*frustum_spheres_fn)(const Frustum *frustum,
+                                   const Vec3Stream *centers,
+                                   const nml_t *radii,
+                                   uint32_t *bits);
+typedef void (*frustum_boxes_fn)(const Frustum *frustum,
+                                 const Vec3Stream *mins,
+                                 const Vec3Stream *maxs,
+                                 uint32_t *bits);
+
+typedef struct FrustumKernels {
+    frustum_spheres_fn spheres;
+    frustum_boxes_fn boxes;
+} FrustumKernels;
+
+// selected once at load time
+NML_HIDDEN extern FrustumKernels frustum_kernels;
+
+#if defined(NML_DISPATCH_AVX2) && !defined(USE_DOUBLE_PRECISION)
+NML_HIDDEN void frustumSpheresAVX2(const Frustum *frustum,
+                                   const Vec3Stream *centers,
+                                   const nml_t *radii,
+                                   uint32_t *bits);
+NML_HIDDEN void frustumBoxesAVX2(const Frustum *frustum,
+                                 const Vec3Stream *mins,
+                                 const Vec3Stream *maxs,
+                                 uint32_t *bits);
+#endif
+
+#endif // !__FRUSTUM_KERNELS_H__
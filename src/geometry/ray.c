@@ -0,0 +1,506 @@
+#include "geometry/ray.h"
+#include "ray_kernels.h"
+#include "utils/errors.h"
+#include "utils/simd.h"
+#include <math.h>
+#include <stdint.h>
+
+/*
+ * scalar kernels, the whole job in double and no-simd builds
+ */
+
+#if !defined(NML_SIMD_F32)
+
+static void rayBoxesScalar(const Ray *ray,
+                           const Vec3Stream *mins,
+                           const Vec3Stream *maxs,
+                           nml_t *tOut,
+                           uint32_t *bits) {
+    const nml_t *o = ray->origin.elems;
+    nml_t inv[3] = {1.0 / ray->dir.x, 1.0 / ray->dir.y, 1.0 / ray->dir.z};
+    size_t n = mins->count;
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        uint32_t word = 0;
+        for (size_t i = base; i < end; i++) {
+            nml_t lo[3] = {mins->x[i], mins->y[i], mins->z[i]};
+            nml_t hi[3] = {maxs->x[i], maxs->y[i], maxs->z[i]};
+            nml_t t = raySlabLane(o, inv, ray->tMax, lo, hi);
+            word |= (uint32_t)(t != INFINITY) << (i - base);
+            if (tOut)
+                tOut[i] = t;
+        }
+        bits[base / 32] = word;
+    }
+}
+
+static void rayTrianglesScalar(const Ray *ray,
+                               const TriangleStream *tris,
+                               nml_t *tOut,
+                               uint32_t *bits) {
+    const Vec3Stream *a = &tris->v0, *b = &tris->v1, *c = &tris->v2;
+    size_t n = a->count;
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        uint32_t word = 0;
+        for (size_t i = base; i < end; i++) {
+            nml_t v0[3] = {a->x[i], a->y[i], a->z[i]};
+            nml_t v1[3] = {b->x[i], b->y[i], b->z[i]};
+            nml_t v2[3] = {c->x[i], c->y[i], c->z[i]};
+            nml_t t, u, v;
+            uint32_t hit = (uint32_t)rayTriangleLane(
+                ray->origin.elems, ray->dir.elems, ray->tMax, v0, v1, v2, &t,
+                &u, &v);
+            word |= hit << (i - base);
+            if (tOut)
+                tOut[i] = hit ? t : (nml_t)INFINITY;
+        }
+        bits[base / 32] = word;
+    }
+}
+
+static uint32_t rayPacketBoxScalar(const RayPacket *packet,
+                                   const nml_t *min,
+                                   const nml_t *max) {
+    uint32_t mask = 0;
+    for (int k = 0; k < NML_RAY_PACKET; k++) {
+        nml_t o[3] = {packet->ox[k], packet->oy[k], packet->oz[k]};
+        nml_t inv[3] = {packet->invX[k], packet->invY[k], packet->invZ[k]};
+        mask |= (uint32_t)(raySlabLane(o, inv, packet->t[k], min, max) !=
+                           INFINITY)
+                << k;
+    }
+    return mask;
+}
+
+static uint32_t rayPacketTriangleScalar(RayPacket *packet,
+                                        const nml_t *v0,
+                                        const nml_t *v1,
+                                        const nml_t *v2,
+                                        uint32_t index) {
+    uint32_t mask = 0;
+    for (int k = 0; k < NML_RAY_PACKET; k++) {
+        nml_t o[3] = {packet->ox[k], packet->oy[k], packet->oz[k]};
+        nml_t d[3] = {packet->dx[k], packet->dy[k], packet->dz[k]};
+        nml_t t, u, v;
+        if (rayTriangleLane(o, d, packet->t[k], v0, v1, v2, &t, &u, &v)) {
+            packet->t[k] = t;
+            packet->u[k] = u;
+            packet->v[k] = v;
+            packet->index[k] = index;
+            mask |= 1u << k;
+        }
+    }
+    return mask;
+}
+
+#else
+
+/*
+ * 4 lanes, one ray against 4 primitives or 4 rays of a packet against one
+ */
+
+static inline simd_f32x4_t dot4(simd_f32x4_t ax,
+                                simd_f32x4_t ay,
+                                simd_f32x4_t az,
+                                simd_f32x4_t bx,
+                                simd_f32x4_t by,
+                                simd_f32x4_t bz) {
+    return simd_fmadd_f32(ax, bx, simd_fmadd_f32(ay, by, simd_mul_f32(az, bz)));
+}
+
+// slab test of 4 lanes, the entry distance where hit is set
+static inline simd_f32x4_t slab4(const simd_f32x4_t o[3],
+                                 const simd_f32x4_t inv[3],
+                                 simd_f32x4_t tFar,
+                                 const simd_f32x4_t lo[3],
+                                 const simd_f32x4_t hi[3],
+                                 simd_f32x4_t *hit) {
+    simd_f32x4_t tNear = simd_set1_f32(0.0f);
+    for (int k = 0; k < 3; k++) {
+        simd_f32x4_t t0 = simd_mul_f32(simd_sub_f32(lo[k], o[k]), inv[k]);
+        simd_f32x4_t t1 = simd_mul_f32(simd_sub_f32(hi[k], o[k]), inv[k]);
+        tNear = simd_max_f32(simd_min_f32(t0, t1), tNear);
+        tFar = simd_min_f32(simd_max_f32(t0, t1), tFar);
+    }
+    *hit = simd_cmple_f32(tNear, tFar);
+    return tNear;
+}
+
+// moller-trumbore on 4 lanes, e1 and e2 are the edges from v0
+static inline simd_f32x4_t triangle4(const simd_f32x4_t o[3],
+                                     const simd_f32x4_t d[3],
+                                     simd_f32x4_t tMax,
+                                     const simd_f32x4_t v0[3],
+                                     const simd_f32x4_t e1[3],
+                                     const simd_f32x4_t e2[3],
+                                     simd_f32x4_t *uOut,
+                                     simd_f32x4_t *vOut,
+                                     simd_f32x4_t *hit) {
+    simd_f32x4_t zero = simd_set1_f32(0.0f), one = simd_set1_f32(1.0f);
+    simd_f32x4_t px = simd_sub_f32(simd_mul_f32(d[1], e2[2]),
+                                   simd_mul_f32(d[2], e2[1]));
+    simd_f32x4_t py = simd_sub_f32(simd_mul_f32(d[2], e2[0]),
+                                   simd_mul_f32(d[0], e2[2]));
+    simd_f32x4_t pz = simd_sub_f32(simd_mul_f32(d[0], e2[1]),
+                                   simd_mul_f32(d[1], e2[0]));
+    simd_f32x4_t sx = simd_sub_f32(o[0], v0[0]);
+    simd_f32x4_t sy = simd_sub_f32(o[1], v0[1]);
+    simd_f32x4_t sz = simd_sub_f32(o[2], v0[2]);
+    simd_f32x4_t qx = simd_sub_f32(simd_mul_f32(sy, e1[2]),
+                                   simd_mul_f32(sz, e1[1]));
+    simd_f32x4_t qy = simd_sub_f32(simd_mul_f32(sz, e1[0]),
+                                   simd_mul_f32(sx, e1[2]));
+    simd_f32x4_t qz = simd_sub_f32(simd_mul_f32(sx, e1[1]),
+                                   simd_mul_f32(sy, e1[0]));
+    simd_f32x4_t inv =
+        simd_div_f32(one, dot4(e1[0], e1[1], e1[2], px, py, pz));
+    simd_f32x4_t u = simd_mul_f32(dot4(sx, sy, sz, px, py, pz), inv);
+    simd_f32x4_t v = simd_mul_f32(dot4(d[0], d[1], d[2], qx, qy, qz), inv);
+    simd_f32x4_t t = simd_mul_f32(dot4(e2[0], e2[1], e2[2], qx, qy, qz), inv);
+    simd_f32x4_t in = simd_and_f32(simd_cmpge_f32(u, zero),
+                                   simd_cmpge_f32(v, zero));
+    in = simd_and_f32(in, simd_cmple_f32(simd_add_f32(u, v), one));
+    in = simd_and_f32(in, simd_cmpge_f32(t, zero));
+    *hit = simd_and_f32(in, simd_cmple_f32(t, tMax));
+    *uOut = u;
+    *vOut = v;
+    return t;
+}
+
+static void rayBoxes4(const Ray *ray,
+                      const Vec3Stream *mins,
+                      const Vec3Stream *maxs,
+                      nml_t *tOut,
+                      uint32_t *bits) {
+    const nml_t *org = ray->origin.elems;
+    nml_t inv[3] = {1.0f / ray->dir.x, 1.0f / ray->dir.y, 1.0f / ray->dir.z};
+    simd_f32x4_t o[3], iv[3];
+    for (int k = 0; k < 3; k++) {
+        o[k] = simd_set1_f32(org[k]);
+        iv[k] = simd_set1_f32(inv[k]);
+    }
+    simd_f32x4_t tMax = simd_set1_f32(ray->tMax);
+    simd_f32x4_t miss = simd_set1_f32(INFINITY);
+    size_t n = mins->count;
+
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        size_t i = base;
+        uint32_t word = 0;
+        for (; i + 4 <= end; i += 4) {
+            simd_f32x4_t lo[3] = {simd_loadu_f32(&mins->x[i]),
+                                  simd_loadu_f32(&mins->y[i]),
+                                  simd_loadu_f32(&mins->z[i])};
+            simd_f32x4_t hi[3] = {simd_loadu_f32(&maxs->x[i]),
+                                  simd_loadu_f32(&maxs->y[i]),
+                                  simd_loadu_f32(&maxs->z[i])};
+            simd_f32x4_t hit;
+            simd_f32x4_t t = slab4(o, iv, tMax, lo, hi, &hit);
+            word |= (uint32_t)simd_movemask_f32(hit) << (i - base);
+            if (tOut)
+                simd_storeu_f32(&tOut[i], simd_select_f32(hit, t, miss));
+        }
+        for (; i < end; i++) {
+            nml_t lo[3] = {mins->x[i], mins->y[i], mins->z[i]};
+            nml_t hi[3] = {maxs->x[i], maxs->y[i], maxs->z[i]};
+            nml_t t = raySlabLane(org, inv, ray->tMax, lo, hi);
+            word |= (uint32_t)(t != INFINITY) << (i - base);
+            if (tOut)
+                tOut[i] = t;
+        }
+        bits[base / 32] = word;
+    }
+}
+
+static void rayTriangles4(const Ray *ray,
+                          const TriangleStream *tris,
+                          nml_t *tOut,
+                          uint32_t *bits) {
+    const Vec3Stream *a = &tris->v0, *b = &tris->v1, *c = &tris->v2;
+    simd_f32x4_t o[3], d[3];
+    for (int k = 0; k < 3; k++) {
+        o[k] = simd_set1_f32(ray->origin.elems[k]);
+        d[k] = simd_set1_f32(ray->dir.elems[k]);
+    }
+    simd_f32x4_t tMax = simd_set1_f32(ray->tMax);
+    simd_f32x4_t miss = simd_set1_f32(INFINITY);
+    size_t n = a->count;
+
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        size_t i = base;
+        uint32_t word = 0;
+        for (; i + 4 <= end; i += 4) {
+            simd_f32x4_t v0[3] = {simd_loadu_f32(&a->x[i]),
+                                  simd_loadu_f32(&a->y[i]),
+                                  simd_loadu_f32(&a->z[i])};
+            simd_f32x4_t e1[3] = {
+                simd_sub_f32(simd_loadu_f32(&b->x[i]), v0[0]),
+                simd_sub_f32(simd_loadu_f32(&b->y[i]), v0[1]),
+                simd_sub_f32(simd_loadu_f32(&b->z[i]), v0[2])};
+            simd_f32x4_t e2[3] = {
+                simd_sub_f32(simd_loadu_f32(&c->x[i]), v0[0]),
+                simd_sub_f32(simd_loadu_f32(&c->y[i]), v0[1]),
+                simd_sub_f32(simd_loadu_f32(&c->z[i]), v0[2])};
+            simd_f32x4_t u, v, hit;
+            simd_f32x4_t t = triangle4(o, d, tMax, v0, e1, e2, &u, &v, &hit);
+            word |= (uint32_t)simd_movemask_f32(hit) << (i - base);
+            if (tOut)
+                simd_storeu_f32(&tOut[i], simd_select_f32(hit, t, miss));
+        }
+        for (; i < end; i++) {
+            nml_t v0[3] = {a->x[i], a->y[i], a->z[i]};
+            nml_t v1[3] = {b->x[i], b->y[i], b->z[i]};
+            nml_t v2[3] = {c->x[i], c->y[i], c->z[i]};
+            nml_t t, u, v;
+            uint32_t hit = (uint32_t)rayTriangleLane(
+                ray->origin.elems, ray->dir.elems, ray->tMax, v0, v1, v2, &t,
+                &u, &v);
+            word |= hit << (i - base);
+            if (tOut)
+                tOut[i] = hit ? t : INFINITY;
+        }
+        bits[base / 32] = word;
+    }
+}
+
+// the 8 lanes of a packet as two halves
+static uint32_t rayPacketBox4(const RayPacket *packet,
+                              const nml_t *min,
+                              const nml_t *max) {
+    simd_f32x4_t lo[3], hi[3];
+    for (int k = 0; k < 3; k++) {
+        lo[k] = simd_set1_f32(min[k]);
+        hi[k] = simd_set1_f32(max[k]);
+    }
+    uint32_t mask = 0;
+    for (int h = 0; h < NML_RAY_PACKET; h += 4) {
+        simd_f32x4_t o[3] = {simd_loadu_f32(&packet->ox[h]),
+                             simd_loadu_f32(&packet->oy[h]),
+                             simd_loadu_f32(&packet->oz[h])};
+        simd_f32x4_t inv[3] = {simd_loadu_f32(&packet->invX[h]),
+                               simd_loadu_f32(&packet->invY[h]),
+                               simd_loadu_f32(&packet->invZ[h])};
+        simd_f32x4_t hit;
+        slab4(o, inv, simd_loadu_f32(&packet->t[h]), lo, hi, &hit);
+        mask |= (uint32_t)simd_movemask_f32(hit) << h;
+    }
+    return mask;
+}
+
+static uint32_t rayPacketTriangle4(RayPacket *packet,
+                                   const nml_t *v0,
+                                   const nml_t *v1,
+                                   const nml_t *v2,
+                                   uint32_t index) {
+    simd_f32x4_t p0[3], e1[3], e2[3];
+    for (int k = 0; k < 3; k++) {
+        p0[k] = simd_set1_f32(v0[k]);
+        e1[k] = simd_set1_f32(v1[k] - v0[k]);
+        e2[k] = simd_set1_f32(v2[k] - v0[k]);
+    }
+    uint32_t mask = 0;
+    for (int h = 0; h < NML_RAY_PACKET; h += 4) {
+        simd_f32x4_t o[3] = {simd_loadu_f32(&packet->ox[h]),
+                             simd_loadu_f32(&packet->oy[h]),
+                             simd_loadu_f32(&packet->oz[h])};
+        simd_f32x4_t d[3] = {simd_loadu_f32(&packet->dx[h]),
+                             simd_loadu_f32(&packet->dy[h]),
+                             simd_loadu_f32(&packet->dz[h])};
+        simd_f32x4_t tOld = simd_loadu_f32(&packet->t[h]);
+        simd_f32x4_t u, v, hit;
+        simd_f32x4_t t = triangle4(o, d, tOld, p0, e1, e2, &u, &v, &hit);
+        uint32_t bits = (uint32_t)simd_movemask_f32(hit);
+        if (!bits)
+            continue;
+        simd_storeu_f32(&packet->t[h], simd_select_f32(hit, t, tOld));
+        simd_storeu_f32(&packet->u[h], simd_select_f32(
+                                           hit, u, simd_loadu_f32(&packet->u[h])));
+        simd_storeu_f32(&packet->v[h], simd_select_f32(
+                                           hit, v, simd_loadu_f32(&packet->v[h])));
+        for (int k = 0; k < 4; k++) {
+            if (bits & (1u << k))
+                packet->index[h + k] = index;
+        }
+        mask |= bits << h;
+    }
+    return mask;
+}
+
+#endif
+
+RayKernels ray_kernels = {
+#if defined(NML_SIMD_F32)
+    rayBoxes4,
+    rayTriangles4,
+    rayPacketBox4,
+    rayPacketTriangle4,
+#else
+    rayBoxesScalar,
+    rayTrianglesScalar,
+    rayPacketBoxScalar,
+    rayPacketTriangleScalar,
+#endif
+};
+
+#if defined(NML_DISPATCH_AVX2) && !defined(USE_DOUBLE_PRECISION)
+__attribute__((constructor)) static void raySelectKernels(void) {
+    if (cpuHasAVX2FMA()) {
+        ray_kernels = (RayKernels){
+            rayBoxesAVX2,
+            rayTrianglesAVX2,
+            rayPacketBoxAVX2,
+            rayPacketTriangleAVX2,
+        };
+    }
+}
+#endif
+
+/*
+ * public api
+ */
+
+int rayTestBoxes(const Ray *ray,
+                 const Vec3Stream *mins,
+                 const Vec3Stream *maxs,
+                 nml_t *tOut,
+                 uint32_t *bits) {
+    is_null((void *)ray, (void *)mins, (void *)maxs, bits);
+    if (mins->count != maxs->count)
+        return NML_EINVAL;
+    ray_kernels.boxes(ray, mins, maxs, tOut, bits);
+    return NML_SUCCESS;
+}
+
+static inline int trianglesValid(const TriangleStream *tris) {
+    return tris->v0.count == tris->v1.count &&
+           tris->v0.count == tris->v2.count;
+}
+
+int rayTestTriangles(const Ray *ray,
+                     const TriangleStream *tris,
+                     nml_t *tOut,
+                     uint32_t *bits) {
+    is_null((void *)ray, (void *)tris, bits);
+    if (!trianglesValid(tris))
+        return NML_EINVAL;
+    ray_kernels.triangles(ray, tris, tOut, bits);
+    return NML_SUCCESS;
+}
+
+// triangles per kernel call of rayClosestTriangle
+#define CLOSEST_CHUNK 1024
+
+static inline Vec3Stream streamSlice(const Vec3Stream *s,
+                                     size_t begin,
+                                     size_t count) {
+    Vec3Stream slice = {s->x + begin, s->y + begin, s->z + begin, count};
+    return slice;
+}
+
+int rayClosestTriangle(const Ray *ray, const TriangleStream *tris, RayHit *hit) {
+    is_null((void *)ray, (void *)tris, hit);
+    if (!trianglesValid(tris))
+        return NML_EINVAL;
+
+    // every chunk searches only in front of the best hit so far
+    Ray r = *ray;
+    nml_t t[CLOSEST_CHUNK];
+    uint32_t bits[CLOSEST_CHUNK / 32];
+    size_t n = tris->v0.count, best = SIZE_MAX;
+    for (size_t begin = 0; begin < n; begin += CLOSEST_CHUNK) {
+        size_t len = n - begin < CLOSEST_CHUNK ? n - begin : CLOSEST_CHUNK;
+        TriangleStream slice = {streamSlice(&tris->v0, begin, len),
+                                streamSlice(&tris->v1, begin, len),
+                                streamSlice(&tris->v2, begin, len)};
+        ray_kernels.triangles(&r, &slice, t, bits);
+        for (size_t w = 0; w < (len + 31) / 32; w++) {
+            uint32_t word = bits[w];
+            for (size_t i = w * 32; word; i++, word >>= 1) {
+                // hits are within r.tMax already, later ties lose
+                if ((word & 1u) && (best == SIZE_MAX || t[i] < r.tMax)) {
+                    r.tMax = t[i];
+                    best = begin + i;
+                }
+            }
+        }
+    }
+
+    hit->index = NML_RAY_MISS;
+    if (best == SIZE_MAX)
+        return NML_SUCCESS;
+    // the barycentrics of the winner only
+    const TriangleStream *s = tris;
+    nml_t v0[3] = {s->v0.x[best], s->v0.y[best], s->v0.z[best]};
+    nml_t v1[3] = {s->v1.x[best], s->v1.y[best], s->v1.z[best]};
+    nml_t v2[3] = {s->v2.x[best], s->v2.y[best], s->v2.z[best]};
+    nml_t tHit, u, v;
+    rayTriangleLane(ray->origin.elems, ray->dir.elems, ray->tMax, v0, v1, v2,
+                    &tHit, &u, &v);
+    hit->t = r.tMax;
+    hit->u = u;
+    hit->v = v;
+    hit->index = (uint32_t)best;
+    return NML_SUCCESS;
+}
+
+int rayPacketInit(const Ray *rays, size_t n, RayPacket *pOut) {
+    is_null((void *)rays, pOut);
+    if (n == 0 || n > NML_RAY_PACKET)
+        return NML_EINVAL;
+
+    for (size_t k = 0; k < NML_RAY_PACKET; k++) {
+        // unused lanes repeat the first ray with a negative reach
+        const Ray *r = k < n ? &rays[k] : &rays[0];
+        pOut->ox[k] = r->origin.x;
+        pOut->oy[k] = r->origin.y;
+        pOut->oz[k] = r->origin.z;
+        pOut->dx[k] = r->dir.x;
+        pOut->dy[k] = r->dir.y;
+        pOut->dz[k] = r->dir.z;
+        pOut->invX[k] = 1.0 / r->dir.x;
+        pOut->invY[k] = 1.0 / r->dir.y;
+        pOut->invZ[k] = 1.0 / r->dir.z;
+        pOut->t[k] = k < n ? r->tMax : -1.0;
+        pOut->u[k] = 0.0;
+        pOut->v[k] = 0.0;
+        pOut->index[k] = NML_RAY_MISS;
+    }
+    return NML_SUCCESS;
+}
+
+int rayPacketTestBox(const RayPacket *packet,
+                     const Vec3 *min,
+                     const Vec3 *max,
+                     uint32_t *mask) {
+    is_null((void *)packet, (void *)min, (void *)max, mask);
+    *mask = ray_kernels.packetBox(packet, min->elems, max->elems);
+    return NML_SUCCESS;
+}
+
+int rayPacketIntersectTriangle(RayPacket *packet,
+                               const Vec3 *v0,
+                               const Vec3 *v1,
+                               const Vec3 *v2,
+                               uint32_t index,
+                               uint32_t *mask) {
+    is_null(packet, (void *)v0, (void *)v1, (void *)v2);
+    uint32_t hits =
+        ray_kernels.packetTriangle(packet, v0->elems, v1->elems, v2->elems,
+                                   index);
+    if (mask)
+        *mask = hits;
+    return NML_SUCCESS;
+}
+
+int rayPacketGetHit(const RayPacket *packet, size_t k, RayHit *hit) {
+    is_null((void *)packet, hit);
+    if (k >= NML_RAY_PACKET)
+        return NML_EINVAL;
+    hit->t = packet->t[k];
+    hit->u = packet->u[k];
+    hit->v = packet->v[k];
+    hit->index = packet->index[k];
+    return NML_SUCCESS;
+}
@@ -0,0 +1,223 @@
+#include "ray_kernels.h"
+
+#if defined(NML_DISPATCH_AVX2) && !defined(USE_DOUBLE_PRECISION)
+#    include <immintrin.h>
+
+NML_AVX2_FN static inline __m256 dot8(__m256 ax,
+                                      __m256 ay,
+                                      __m256 az,
+                                      __m256 bx,
+                                      __m256 by,
+                                      __m256 bz) {
+    return _mm256_fmadd_ps(ax, bx,
+                           _mm256_fmadd_ps(ay, by, _mm256_mul_ps(az, bz)));
+}
+
+// a * b - c * d
+NML_AVX2_FN static inline __m256 diffOfProducts8(__m256 a,
+                                                 __m256 b,
+                                                 __m256 c,
+                                                 __m256 d) {
+    return _mm256_fmsub_ps(a, b, _mm256_mul_ps(c, d));
+}
+
+// slab test of 8 lanes, the entry distance where hit is set
+NML_AVX2_FN static inline __m256 slab8(const __m256 o[3],
+                                       const __m256 inv[3],
+                                       __m256 tFar,
+                                       const __m256 lo[3],
+                                       const __m256 hi[3],
+                                       __m256 *hit) {
+    __m256 tNear = _mm256_setzero_ps();
+    for (int k = 0; k < 3; k++) {
+        __m256 t0 = _mm256_mul_ps(_mm256_sub_ps(lo[k], o[k]), inv[k]);
+        __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(hi[k], o[k]), inv[k]);
+        tNear = _mm256_max_ps(_mm256_min_ps(t0, t1), tNear);
+        tFar = _mm256_min_ps(_mm256_max_ps(t0, t1), tFar);
+    }
+    *hit = _mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ);
+    return tNear;
+}
+
+// moller-trumbore on 8 lanes, e1 and e2 are the edges from v0
+NML_AVX2_FN static inline __m256 triangle8(const __m256 o[3],
+                                           const __m256 d[3],
+                                           __m256 tMax,
+                                           const __m256 v0[3],
+                                           const __m256 e1[3],
+                                           const __m256 e2[3],
+                                           __m256 *uOut,
+                                           __m256 *vOut,
+                                           __m256 *hit) {
+    __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    __m256 px = diffOfProducts8(d[1], e2[2], d[2], e2[1]);
+    __m256 py = diffOfProducts8(d[2], e2[0], d[0], e2[2]);
+    __m256 pz = diffOfProducts8(d[0], e2[1], d[1], e2[0]);
+    __m256 sx = _mm256_sub_ps(o[0], v0[0]);
+    __m256 sy = _mm256_sub_ps(o[1], v0[1]);
+    __m256 sz = _mm256_sub_ps(o[2], v0[2]);
+    __m256 qx = diffOfProducts8(sy, e1[2], sz, e1[1]);
+    __m256 qy = diffOfProducts8(sz, e1[0], sx, e1[2]);
+    __m256 qz = diffOfProducts8(sx, e1[1], sy, e1[0]);
+    __m256 inv = _mm256_div_ps(one, dot8(e1[0], e1[1], e1[2], px, py, pz));
+    __m256 u = _mm256_mul_ps(dot8(sx, sy, sz, px, py, pz), inv);
+    __m256 v = _mm256_mul_ps(dot8(d[0], d[1], d[2], qx, qy, qz), inv);
+    __m256 t = _mm256_mul_ps(dot8(e2[0], e2[1], e2[2], qx, qy, qz), inv);
+    __m256 in = _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ),
+                              _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+    in = _mm256_and_ps(
+        in, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+    in = _mm256_and_ps(in, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+    *hit = _mm256_and_ps(in, _mm256_cmp_ps(t, tMax, _CMP_LE_OQ));
+    *uOut = u;
+    *vOut = v;
+    return t;
+}
+
+NML_AVX2_FN void rayBoxesAVX2(const Ray *ray,
+                              const Vec3Stream *mins,
+                              const Vec3Stream *maxs,
+                              nml_t *tOut,
+                              uint32_t *bits) {
+    const nml_t *org = ray->origin.elems;
+    nml_t inv[3] = {1.0f / ray->dir.x, 1.0f / ray->dir.y, 1.0f / ray->dir.z};
+    __m256 o[3], iv[3];
+    for (int k = 0; k < 3; k++) {
+        o[k] = _mm256_set1_ps(org[k]);
+        iv[k] = _mm256_set1_ps(inv[k]);
+    }
+    __m256 tMax = _mm256_set1_ps(ray->tMax);
+    __m256 miss = _mm256_set1_ps(INFINITY);
+    size_t n = mins->count;
+
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        size_t i = base;
+        uint32_t word = 0;
+        for (; i + 8 <= end; i += 8) {
+            __m256 lo[3] = {_mm256_loadu_ps(&mins->x[i]),
+                            _mm256_loadu_ps(&mins->y[i]),
+                            _mm256_loadu_ps(&mins->z[i])};
+            __m256 hi[3] = {_mm256_loadu_ps(&maxs->x[i]),
+                            _mm256_loadu_ps(&maxs->y[i]),
+                            _mm256_loadu_ps(&maxs->z[i])};
+            __m256 hit;
+            __m256 t = slab8(o, iv, tMax, lo, hi, &hit);
+            word |= (uint32_t)_mm256_movemask_ps(hit) << (i - base);
+            if (tOut)
+                _mm256_storeu_ps(&tOut[i], _mm256_blendv_ps(miss, t, hit));
+        }
+        for (; i < end; i++) {
+            nml_t lo[3] = {mins->x[i], mins->y[i], mins->z[i]};
+            nml_t hi[3] = {maxs->x[i], maxs->y[i], maxs->z[i]};
+            nml_t t = raySlabLane(org, inv, ray->tMax, lo, hi);
+            word |= (uint32_t)(t != INFINITY) << (i - base);
+            if (tOut)
+                tOut[i] = t;
+        }
+        bits[base / 32] = word;
+    }
+}
+
+NML_AVX2_FN void rayTrianglesAVX2(const Ray *ray,
+                                  const TriangleStream *tris,
+                                  nml_t *tOut,
+                                  uint32_t *bits) {
+    const Vec3Stream *a = &tris->v0, *b = &tris->v1, *c = &tris->v2;
+    __m256 o[3], d[3];
+    for (int k = 0; k < 3; k++) {
+        o[k] = _mm256_set1_ps(ray->origin.elems[k]);
+        d[k] = _mm256_set1_ps(ray->dir.elems[k]);
+    }
+    __m256 tMax = _mm256_set1_ps(ray->tMax);
+    __m256 miss = _mm256_set1_ps(INFINITY);
+    size_t n = a->count;
+
+    for (size_t base = 0; base < n; base += 32) {
+        size_t end = base + 32 < n ? base + 32 : n;
+        size_t i = base;
+        uint32_t word = 0;
+        for (; i + 8 <= end; i += 8) {
+            __m256 v0[3] = {_mm256_loadu_ps(&a->x[i]),
+                            _mm256_loadu_ps(&a->y[i]),
+                            _mm256_loadu_ps(&a->z[i])};
+            __m256 e1[3] = {_mm256_sub_ps(_mm256_loadu_ps(&b->x[i]), v0[0]),
+                            _mm256_sub_ps(_mm256_loadu_ps(&b->y[i]), v0[1]),
+                            _mm256_sub_ps(_mm256_loadu_ps(&b->z[i]), v0[2])};
+            __m256 e2[3] = {_mm256_sub_ps(_mm256_loadu_ps(&c->x[i]), v0[0]),
+                            _mm256_sub_ps(_mm256_loadu_ps(&c->y[i]), v0[1]),
+                            _mm256_sub_ps(_mm256_loadu_ps(&c->z[i]), v0[2])};
+            __m256 u, v, hit;
+            __m256 t = triangle8(o, d, tMax, v0, e1, e2, &u, &v, &hit);
+            word |= (uint32_t)_mm256_movemask_ps(hit) << (i - base);
+            if (tOut)
+                _mm256_storeu_ps(&tOut[i], _mm256_blendv_ps(miss, t, hit));
+        }
+        for (; i < end; i++) {
+            nml_t v0[3] = {a->x[i], a->y[i], a->z[i]};
+            nml_t v1[3] = {b->x[i], b->y[i], b->z[i]};
+            nml_t v2[3] = {c->x[i], c->y[i], c->z[i]};
+            nml_t t, u, v;
+            uint32_t hit = (uint32_t)rayTriangleLane(
+                ray->origin.elems, ray->dir.elems, ray->tMax, v0, v1, v2, &t,
+                &u, &v);
+            word |= hit << (i - base);
+            if (tOut)
+                tOut[i] = hit ? t : INFINITY;
+        }
+        bits[base / 32] = word;
+    }
+}
+
+NML_AVX2_FN uint32_t rayPacketBoxAVX2(const RayPacket *packet,
+                                      const nml_t *min,
+                                      const nml_t *max) {
+    __m256 lo[3], hi[3];
+    for (int k = 0; k < 3; k++) {
+        lo[k] = _mm256_set1_ps(min[k]);
+        hi[k] = _mm256_set1_ps(max[k]);
+    }
+    __m256 o[3] = {_mm256_loadu_ps(packet->ox), _mm256_loadu_ps(packet->oy),
+                   _mm256_loadu_ps(packet->oz)};
+    __m256 inv[3] = {_mm256_loadu_ps(packet->invX),
+                     _mm256_loadu_ps(packet->invY),
+                     _mm256_loadu_ps(packet->invZ)};
+    __m256 hit;
+    slab8(o, inv, _mm256_loadu_ps(packet->t), lo, hi, &hit);
+    return (uint32_t)_mm256_movemask_ps(hit);
+}
+
+NML_AVX2_FN uint32_t rayPacketTriangleAVX2(RayPacket *packet,
+                                           const nml_t *v0,
+                                           const nml_t *v1,
+                                           const nml_t *v2,
+                                           uint32_t index) {
+    __m256 p0[3], e1[3], e2[3];
+    for (int k = 0; k < 3; k++) {
+        p0[k] = _mm256_set1_ps(v0[k]);
+        e1[k] = _mm256_set1_ps(v1[k] - v0[k]);
+        e2[k] = _mm256_set1_ps(v2[k] - v0[k]);
+    }
+    __m256 o[3] = {_mm256_loadu_ps(packet->ox), _mm256_loadu_ps(packet->oy),
+                   _mm256_loadu_ps(packet->oz)};
+    __m256 d[3] = {_mm256_loadu_ps(packet->dx), _mm256_loadu_ps(packet->dy),
+                   _mm256_loadu_ps(packet->dz)};
+    __m256 tOld = _mm256_loadu_ps(packet->t);
+    __m256 u, v, hit;
+    __m256 t = triangle8(o, d, tOld, p0, e1, e2, &u, &v, &hit);
+    uint32_t mask = (uint32_t)_mm256_movemask_ps(hit);
+    if (!mask)
+        return 0;
+    _mm256_storeu_ps(packet->t, _mm256_blendv_ps(tOld, t, hit));
+    _mm256_storeu_ps(packet->u,
+                     _mm256_blendv_ps(_mm256_loadu_ps(packet->u), u, hit));
+    _mm256_storeu_ps(packet->v,
+                     _mm256_blendv_ps(_mm256_loadu_ps(packet->v), v, hit));
+    __m256i idx = _mm256_loadu_si256((const __m256i *)packet->index);
+    idx = _mm256_blendv_epi8(idx, _mm256_set1_epi32((int)index),
+                             _mm256_castps_si256(hit));
+    _mm256_storeu_si256((__m256i *)packet->index, idx);
+    return mask;
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef __RAY_KERNELS_H__
+#define __RAY_KERNELS_H__
+
+#include "geometry/ray.h"
+#include "utils/cpu.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * internal kernel table for the ray tests
+ *
+ * the stream kernels write (count + 31) / 32 whole words of bits and, when
+ * tOut is not NULL, count distances. the packet kernels cover all
+ * NML_RAY_PACKET lanes
+ */
+
+typedef void (*ray_boxes_fn)(const Ray *ray,
+                             const Vec3Stream *mins,
+                             const Vec3Stream *maxs,
+                             nml_t *tOut,
+                             uint32_t *bits);
+typedef void (*ray_triangles_fn)(const Ray *ray,
+                                 const TriangleStream *tris,
+                                 nml_t *tOut,
+                                 uint32_t *bits);
+typedef uint32_t (*packet_box_fn)(const RayPacket *packet,
+                                  const nml_t *min,
+                                  const nml_t *max);
+typedef uint32_t (*packet_triangle_fn)(RayPacket *packet,
+                                       const nml_t *v0,
+                                       const nml_t *v1,
+                                       const nml_t *v2,
+                                       uint32_t index);
+
+typedef struct RayKernels {
+    ray_boxes_fn boxes;
+    ray_triangles_fn triangles;
+    packet_box_fn packetBox;
+    packet_triangle_fn packetTriangle;
+} RayKernels;
+
+// selected once at load time
+NML_HIDDEN extern RayKernels ray_kernels;
+
+#if defined(NML_DISPATCH_AVX2) && !defined(USE_DOUBLE_PRECISION)
+NML_HIDDEN void rayBoxesAVX2(const Ray *ray,
+                             const Vec3Stream *mins,
+                             const Vec3Stream *maxs,
+                             nml_t *tOut,
+                             uint32_t *bits);
+NML_HIDDEN void rayTrianglesAVX2(const Ray *ray,
+                                 const TriangleStream *tris,
+                                 nml_t *tOut,
+                                 uint32_t *bits);
+NML_HIDDEN uint32_t rayPacketBoxAVX2(const RayPacket *packet,
+                                     const nml_t *min,
+                                     const nml_t *max);
+NML_HIDDEN uint32_t rayPacketTriangleAVX2(RayPacket *packet,
+                                          const nml_t *v0,
+                                          const nml_t *v1,
+                                          const nml_t *v2,
+                                          uint32_t index);
+#endif
+
+/*
+ * one lane of the kernels, for the tails of the vector loops. min and max
+ * are spelled out as compares in the operand order of minps / maxps, so the
+ * nan cases of a zero direction component come out the same in every lane
+ */
+
+static inline nml_t rayLaneMin(nml_t a, nml_t b) {
+    return a < b ? a : b;
+}
+
+static inline nml_t rayLaneMax(nml_t a, nml_t b) {
+    return a > b ? a : b;
+}
+
+// entry distance of the ray o + t * d (inv = 1 / d) into [lo, hi], or
+// INFINITY when it misses within [0, tMax]
+static inline nml_t raySlabLane(const nml_t o[3],
+                                const nml_t inv[3],
+                                nml_t tMax,
+                                const nml_t lo[3],
+                                const nml_t hi[3]) {
+    nml_t tNear = 0.0, tFar = tMax;
+    for (int k = 0; k < 3; k++) {
+        nml_t t0 = (lo[k] - o[k]) * inv[k];
+        nml_t t1 = (hi[k] - o[k]) * inv[k];
+        tNear = rayLaneMax(rayLaneMin(t0, t1), tNear);
+        tFar = rayLaneMin(rayLaneMax(t0, t1), tFar);
+    }
+    return tNear <= tFar ? tNear : (nml_t)INFINITY;
+}
+
+// moller-trumbore, nonzero on a hit within [0, tMax]. a degenerate triangle
+// or a ray in its plane divides by zero and fails every compare
+static inline int rayTriangleLane(const nml_t o[3],
+                                  const nml_t d[3],
+                                  nml_t tMax,
+                                  const nml_t v0[3],
+                                  const nml_t v1[3],
+                                  const nml_t v2[3],
+                                  nml_t *tOut,
+                                  nml_t *uOut,
+                                  nml_t *vOut) {
+    nml_t e1[3] = {v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2]};
+    nml_t e2[3] = {v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2]};
+    nml_t s[3] = {o[0] - v0[0], o[1] - v0[1], o[2] - v0[2]};
+    nml_t p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2],
+                  d[0] * e2[1] - d[1] * e2[0]};
+    nml_t q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2],
+                  s[0] * e1[1] - s[1] * e1[0]};
+    nml_t inv = 1.0 / (e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2]);
+    nml_t u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv;
+    nml_t v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv;
+    nml_t t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv;
+    *tOut = t;
+    *uOut = u;
+    *vOut = v;
+    return u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= 0.0 && t <= tMax;
+}
+
+#endif // !__RAY_KERNELS_H__
@@ -0,0 +1,26 @@
+#ifndef __MAT4D_INTERNAL_H__
+#define __MAT4D_INTERNAL_H__
+
+#include "matrix/mat4d.h"
+#include "utils/cpu.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Mat4 entry points for other modules of the library
+ *
+ * src/internal is only on the private include path of the library targets,
+ * nothing in here is installed or exported. the kernel table itself stays
+ * private to src/matrix
+ */
+
+// mOut[idx[j]] = mat * mats[idx[j]] for j < n, on the dispatched batch
+// kernel. mat is kept in registers for the whole batch and must not overlap
+// any of the outputs
+NML_HIDDEN void mat4MulMat4Indexed(const Mat4 *mat,
+                                   const Mat4 *mats,
+                                   Mat4 *mOut,
+                                   const uint32_t *idx,
+                                   size_t n);
+
+#endif // !__MAT4D_INTERNAL_H__
@@ -0,0 +1,2 @@
+// the exported definitions, every function of mat3a.h lives in mat3a_inline.h
+#include "matrix/mat3a_inline.h"
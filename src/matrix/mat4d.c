@@ -1,237 +1,334 @@
 #include "matrix/mat4d.h"
+#include "matrix/mat4d_inline.h"
+#include "mat4d_internal.h"
+#include "mat4d_kernels.h"
+#include "utils/cpu.h"
 #include "utils/errors.h"
 #include "utils/simd.h"
+#include <stdint.h>
 #include <string.h>
 
-int mat4Init(const nml_t arr[16], Mat4 *mOut) {
-    is_null(mOut);
-    memcpy(mOut->elems, arr, sizeof(nml_t) * 16);
-    return NML_SUCCESS;
+// batch baseline kernels, the single matrix ones are in mat4d_inline.h
+
+static void mat4MulMat4BatchBaseline(const nml_t *a,
+                                     const nml_t *b,
+                                     nml_t *out,
+                                     const uint32_t *idx,
+                                     size_t n) {
+    simd_nml4_t a0 = simd_load_nml4(&a[0]);
+    simd_nml4_t a1 = simd_load_nml4(&a[4]);
+    simd_nml4_t a2 = simd_load_nml4(&a[8]);
+    simd_nml4_t a3 = simd_load_nml4(&a[12]);
+
+    for (size_t k = 0; k < n; k++) {
+        size_t j = (idx ? idx[k] : k) * 16;
+        // each column of b is read before the matching output column is
+        // written, so out[j] may be b[j]
+        for (int i = 0; i < 4; i++) {
+            const nml_t *col = &b[j + i * 4];
+            simd_nml4_t res = simd_mul_nml4(a0, simd_set1_nml4(col[0]));
+            res = simd_fmadd_nml4(a1, simd_set1_nml4(col[1]), res);
+            res = simd_fmadd_nml4(a2, simd_set1_nml4(col[2]), res);
+            res = simd_fmadd_nml4(a3, simd_set1_nml4(col[3]), res);
+            simd_store_nml4(&out[j + i * 4], res);
+        }
+    }
 }
 
-int mat4InitZero(Mat4 *mOut) {
-    is_null(mOut);
-    memset(mOut, 0, sizeof(Mat4));
-    return NML_SUCCESS;
-}
+static void mat4MulVec4BatchBaseline(const nml_t *m,
+                                     const nml_t *in,
+                                     nml_t *out,
+                                     size_t n) {
+    size_t i = 0;
+
+#if defined(NML_SIMD_F32)
+    // columns stay in registers for the whole batch
+    simd_f32x4_t c0 = simd_load_f32(&m[0]);
+    simd_f32x4_t c1 = simd_load_f32(&m[4]);
+    simd_f32x4_t c2 = simd_load_f32(&m[8]);
+    simd_f32x4_t c3 = simd_load_f32(&m[12]);
+
+#    if defined(DEFINE_SIMD__SSE)
+#        define MUL_VEC4(v)                                                 \
+            simd_fmadd_f32(                                                 \
+                c3,                                                         \
+                simd_shuffle_f32(v, SIMD_SHUFFLE(3, 3, 3, 3)),              \
+                simd_fmadd_f32(                                             \
+                    c2,                                                     \
+                    simd_shuffle_f32(v, SIMD_SHUFFLE(2, 2, 2, 2)),          \
+                    simd_fmadd_f32(                                         \
+                        c1,                                                 \
+                        simd_shuffle_f32(v, SIMD_SHUFFLE(1, 1, 1, 1)),      \
+                        simd_mul_f32(                                       \
+                            c0, simd_shuffle_f32(v, SIMD_SHUFFLE(0, 0, 0, 0))))))
+#    else
+#        define MUL_VEC4(v)                                                 \
+            simd_mla_lane_f32(                                              \
+                simd_mla_lane_f32(                                          \
+                    simd_mla_lane_f32(                                      \
+                        simd_mul_lane_f32(c0, simd_get_low_f32(v), 0),      \
+                        c1,                                                 \
+                        simd_get_low_f32(v),                                \
+                        1),                                                 \
+                    c2,                                                     \
+                    simd_get_high_f32(v),                                   \
+                    0),                                                     \
+                c3,                                                         \
+                simd_get_high_f32(v),                                       \
+                1)
+#    endif
+
+    int stream = n * 4 * sizeof(nml_t) >= MAT4_STREAM_BYTES &&
+                 ((uintptr_t)out & 15) == 0;
+
+    // four independent vectors per iteration to hide the multiply latency
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t v0 = simd_loadu_f32(&in[i * 4]);
+        simd_f32x4_t v1 = simd_loadu_f32(&in[i * 4 + 4]);
+        simd_f32x4_t v2 = simd_loadu_f32(&in[i * 4 + 8]);
+        simd_f32x4_t v3 = simd_loadu_f32(&in[i * 4 + 12]);
+
+        simd_f32x4_t r0 = MUL_VEC4(v0);
+        simd_f32x4_t r1 = MUL_VEC4(v1);
+        simd_f32x4_t r2 = MUL_VEC4(v2);
+        simd_f32x4_t r3 = MUL_VEC4(v3);
+
+        if (stream) {
+            simd_stream_f32(&out[i * 4], r0);
+            simd_stream_f32(&out[i * 4 + 4], r1);
+            simd_stream_f32(&out[i * 4 + 8], r2);
+            simd_stream_f32(&out[i * 4 + 12], r3);
+        } else {
+            simd_storeu_f32(&out[i * 4], r0);
+            simd_storeu_f32(&out[i * 4 + 4], r1);
+            simd_storeu_f32(&out[i * 4 + 8], r2);
+            simd_storeu_f32(&out[i * 4 + 12], r3);
+        }
+    }
+    if (stream)
+        simd_stream_fence();
 
-int mat4Diagonal(nml_t val, Mat4 *mOut) {
-    is_null(mOut);
-    memset(mOut->elems, 0, sizeof(Mat4));
-    for (int i = 0; i < 4; i++) {
-        mOut->elems[i * 4 + i] = val;
+#    undef MUL_VEC4
+
+#else
+    simd_nml4_t c0 = simd_load_nml4(&m[0]);
+    simd_nml4_t c1 = simd_load_nml4(&m[4]);
+    simd_nml4_t c2 = simd_load_nml4(&m[8]);
+    simd_nml4_t c3 = simd_load_nml4(&m[12]);
+
+    for (; i + 2 <= n; i += 2) {
+        const nml_t *v0 = &in[i * 4];
+        const nml_t *v1 = &in[i * 4 + 4];
+
+        simd_nml4_t r0 = simd_mul_nml4(c0, simd_set1_nml4(v0[0]));
+        simd_nml4_t r1 = simd_mul_nml4(c0, simd_set1_nml4(v1[0]));
+        r0 = simd_fmadd_nml4(c1, simd_set1_nml4(v0[1]), r0);
+        r1 = simd_fmadd_nml4(c1, simd_set1_nml4(v1[1]), r1);
+        r0 = simd_fmadd_nml4(c2, simd_set1_nml4(v0[2]), r0);
+        r1 = simd_fmadd_nml4(c2, simd_set1_nml4(v1[2]), r1);
+        r0 = simd_fmadd_nml4(c3, simd_set1_nml4(v0[3]), r0);
+        r1 = simd_fmadd_nml4(c3, simd_set1_nml4(v1[3]), r1);
+
+        simd_storeu_nml4(&out[i * 4], r0);
+        simd_storeu_nml4(&out[i * 4 + 4], r1);
     }
-    return NML_SUCCESS;
-}
+#endif
 
-int mat4Identity(Mat4 *mOut) {
-    is_null(mOut);
-    memset(mOut->elems, 0, sizeof(Mat4));
-    for (int i = 0; i < 4; i++) {
-        mOut->elems[i * 4 + i] = 1.0;
+    for (; i < n; i++) {
+        mat4MulVec4Baseline(m, &in[i * 4], &out[i * 4]);
+    }
+}
+/*
+ * kernel dispatch
+ */
+
+Mat4Kernels mat4_kernels = {
+    mat4AddBaseline,
+    mat4SubBaseline,
+    mat4HadamardBaseline,
+    mat4ScaleBaseline,
+    mat4NegateBaseline,
+    mat4MulVec4Baseline,
+    mat4MulMat4Baseline,
+    mat4MulVec4BatchBaseline,
+    mat4MulMat4BatchBaseline,
+};
+
+#if defined(NML_DISPATCH_AVX2)
+__attribute__((constructor)) static void mat4SelectKernels(void) {
+    if (cpuHasAVX2FMA()) {
+        mat4_kernels = (Mat4Kernels){
+            mat4AddAVX2,
+            mat4SubAVX2,
+            mat4HadamardAVX2,
+            mat4ScaleAVX2,
+            mat4NegateAVX2,
+            mat4MulVec4AVX2,
+            mat4MulMat4AVX2,
+            mat4MulVec4BatchAVX2,
+            mat4MulMat4BatchAVX2,
+        };
     }
-    return NML_SUCCESS;
 }
+#endif
+
+/*
+ * public api
+ */
 
 int mat4Add(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut) {
     is_null(mat1, mat2, mOut);
-
-    simd_f32x4_t col0 = simd_add_f32(simd_load_f32(&mat1->elems[0]),
-                                     simd_load_f32(&mat2->elems[0]));
-    simd_f32x4_t col1 = simd_add_f32(simd_load_f32(&mat1->elems[4]),
-                                     simd_load_f32(&mat2->elems[4]));
-    simd_f32x4_t col2 = simd_add_f32(simd_load_f32(&mat1->elems[8]),
-                                     simd_load_f32(&mat2->elems[8]));
-    simd_f32x4_t col3 = simd_add_f32(simd_load_f32(&mat1->elems[12]),
-                                     simd_load_f32(&mat2->elems[12]));
-
-    simd_store_f32(&mOut->elems[0], col0);
-    simd_store_f32(&mOut->elems[4], col1);
-    simd_store_f32(&mOut->elems[8], col2);
-    simd_store_f32(&mOut->elems[12], col3);
-
+    mat4_kernels.add(mat1->elems, mat2->elems, mOut->elems);
     return NML_SUCCESS;
 }
 
 int mat4Sub(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut) {
     is_null(mat1, mat2, mOut);
-
-    simd_f32x4_t col0 = simd_sub_f32(simd_load_f32(&mat1->elems[0]),
-                                     simd_load_f32(&mat2->elems[0]));
-    simd_f32x4_t col1 = simd_sub_f32(simd_load_f32(&mat1->elems[4]),
-                                     simd_load_f32(&mat2->elems[4]));
-    simd_f32x4_t col2 = simd_sub_f32(simd_load_f32(&mat1->elems[8]),
-                                     simd_load_f32(&mat2->elems[8]));
-    simd_f32x4_t col3 = simd_sub_f32(simd_load_f32(&mat1->elems[12]),
-                                     simd_load_f32(&mat2->elems[12]));
-
-    simd_store_f32(&mOut->elems[0], col0);
-    simd_store_f32(&mOut->elems[4], col1);
-    simd_store_f32(&mOut->elems[8], col2);
-    simd_store_f32(&mOut->elems[12], col3);
-
+    mat4_kernels.sub(mat1->elems, mat2->elems, mOut->elems);
     return NML_SUCCESS;
 }
 
 int mat4Scale(Mat4 *mat, nml_t s, Mat4 *mOut) {
     is_null(mat, mOut);
-
-    simd_f32x4_t scaler = simd_set1_f32(s);
-
-    simd_f32x4_t col0 = simd_mul_f32(simd_load_f32(&mat->elems[0]), scaler);
-    simd_f32x4_t col1 = simd_mul_f32(simd_load_f32(&mat->elems[4]), scaler);
-    simd_f32x4_t col2 = simd_mul_f32(simd_load_f32(&mat->elems[8]), scaler);
-    simd_f32x4_t col3 = simd_mul_f32(simd_load_f32(&mat->elems[12]), scaler);
-
-    simd_store_f32(&mOut->elems[0], col0);
-    simd_store_f32(&mOut->elems[4], col1);
-    simd_store_f32(&mOut->elems[8], col2);
-    simd_store_f32(&mOut->elems[12], col3);
-
+    mat4_kernels.scale(mat->elems, s, mOut->elems);
     return NML_SUCCESS;
 }
 
 int mat4Negate(Mat4 *mat, Mat4 *mOut) {
     is_null(mat, mOut);
-
-    simd_f32x4_t col0 = simd_negate_f32(simd_load_f32(&mat->elems[0]));
-    simd_f32x4_t col1 = simd_negate_f32(simd_load_f32(&mat->elems[4]));
-    simd_f32x4_t col2 = simd_negate_f32(simd_load_f32(&mat->elems[8]));
-    simd_f32x4_t col3 = simd_negate_f32(simd_load_f32(&mat->elems[12]));
-
-    simd_store_f32(&mOut->elems[0], col0);
-    simd_store_f32(&mOut->elems[4], col1);
-    simd_store_f32(&mOut->elems[8], col2);
-    simd_store_f32(&mOut->elems[12], col3);
-
+    mat4_kernels.negate(mat->elems, mOut->elems);
     return NML_SUCCESS;
 }
 
 int mat4Hadamard(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut) {
     is_null(mat1, mat2, mOut);
-
-    simd_f32x4_t col0 = simd_mul_f32(simd_load_f32(&mat1->elems[0]),
-                                     simd_load_f32(&mat2->elems[0]));
-    simd_f32x4_t col1 = simd_mul_f32(simd_load_f32(&mat1->elems[4]),
-                                     simd_load_f32(&mat2->elems[4]));
-    simd_f32x4_t col2 = simd_mul_f32(simd_load_f32(&mat1->elems[8]),
-                                     simd_load_f32(&mat2->elems[8]));
-    simd_f32x4_t col3 = simd_mul_f32(simd_load_f32(&mat1->elems[12]),
-                                     simd_load_f32(&mat2->elems[12]));
-
-    simd_store_f32(&mOut->elems[0], col0);
-    simd_store_f32(&mOut->elems[4], col1);
-    simd_store_f32(&mOut->elems[8], col2);
-    simd_store_f32(&mOut->elems[12], col3);
-
+    mat4_kernels.hadamard(mat1->elems, mat2->elems, mOut->elems);
     return NML_SUCCESS;
 }
 
 int mat4MulVec4(Mat4 *mat, Vec4 *vec, Vec4 *vOut) {
     is_null(mat, vec, vOut);
-
-#if defined(DEFINE_SIMD__SSE)
-    simd_f32x4_t v = simd_load_f32(vec->elems);
-
-    simd_f32x4_t res =
-        simd_mul_f32(simd_load_f32(mat->cols[0].elems),
-                     simd_shuffle_f32(v, SIMD_SHUFFLE(0, 0, 0, 0)));
-    res = simd_add_f32(
-        res,
-        simd_mul_f32(simd_load_f32(mat->cols[1].elems),
-                     simd_shuffle_f32(v, SIMD_SHUFFLE(1, 1, 1, 1))));
-    res = simd_add_f32(
-        res,
-        simd_mul_f32(simd_load_f32(mat->cols[2].elems),
-                     simd_shuffle_f32(v, SIMD_SHUFFLE(2, 2, 2, 2))));
-    res = simd_add_f32(
-        res,
-        simd_mul_f32(simd_load_f32(mat->cols[3].elems),
-                     simd_shuffle_f32(v, SIMD_SHUFFLE(3, 3, 3, 3))));
-
-    simd_store_f32(vOut->elems, res);
-
-#elif defined(DEFINE_SIMD__NEON)
-    simd_f32x4_t v = simd_load_f32(vec->elems);
-
-    float32x4_t res = simd_mul_lane_f32(
-        simd_load_f32(mat->cols[0].elems), simd_get_low_f32(v), 0);
-    res = simd_mla_lane_f32(
-        res, simd_load_f32(mat->cols[1].elems), simd_get_low_f32(v), 1);
-    res = simd_mla_lane_f32(
-        res, simd_load_f32(mat->cols[2].elems), simd_get_high_f32(v), 0);
-    res = simd_mla_lane_f32(
-        res, simd_load_f32(mat->cols[3].elems), simd_get_high_f32(v), 1);
-
-    simd_store_f32(vOut->elems, res);
-
-#else
-    vOut->x = vec->elems[0] * mat->cols[0].x + vec->elems[1] * mat->cols[1].x +
-              vec->elems[2] * mat->cols[2].x + vec->elems[3] * mat->cols[3].x;
-    vOut->y = vec->elems[0] * mat->cols[0].y + vec->elems[1] * mat->cols[1].y +
-              vec->elems[2] * mat->cols[2].y + vec->elems[3] * mat->cols[3].y;
-    vOut->z = vec->elems[0] * mat->cols[0].z + vec->elems[1] * mat->cols[1].z +
-              vec->elems[2] * mat->cols[2].z + vec->elems[3] * mat->cols[3].z;
-    vOut->w = vec->elems[0] * mat->cols[0].w + vec->elems[1] * mat->cols[1].w +
-              vec->elems[2] * mat->cols[2].w + vec->elems[3] * mat->cols[3].w;
-#endif
-
+    mat4_kernels.mulVec4(mat->elems, vec->elems, vOut->elems);
     return NML_SUCCESS;
 }
 
 int mat4MulMat4(Mat4 *mat1, Mat4 *mat2, Mat4 *mOut) {
     is_null(mat1, mat2, mOut);
+    mat4_kernels.mulMat4(mat1->elems, mat2->elems, mOut->elems);
+    return NML_SUCCESS;
+}
 
-#if defined(DEFINE_SIMD__SSE)
-    simd_f32x4_t mat1_col0 = simd_load_f32(&mat1->cols[0].x);
-    simd_f32x4_t mat1_col1 = simd_load_f32(&mat1->cols[1].x);
-    simd_f32x4_t mat1_col2 = simd_load_f32(&mat1->cols[2].x);
-    simd_f32x4_t mat1_col3 = simd_load_f32(&mat1->cols[3].x);
-
-    for (int i = 0; i < 4; i++) {
-        simd_f32x4_t mat2_col = simd_load_f32(&mat2->cols[i].x);
+int mat4MulVec4Batch(const Mat4 *mat, const Vec4 *in, Vec4 *out, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)mat, (void *)in, out);
+    mat4_kernels.mulVec4Batch(mat->elems, in->elems, out->elems, n);
+    return NML_SUCCESS;
+}
 
-        simd_f32x4_t bc0 = simd_set1_f32(simd_extract0_f32(mat2_col));
-        simd_f32x4_t bc1 = simd_set1_f32(simd_extract1_f32(mat2_col));
-        simd_f32x4_t bc2 = simd_set1_f32(simd_extract2_f32(mat2_col));
-        simd_f32x4_t bc3 = simd_set1_f32(simd_extract3_f32(mat2_col));
+int mat4MulMat4Batch(const Mat4 *mat, const Mat4 *mats, Mat4 *mOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)mat, (void *)mats, mOut);
+    // the kernel keeps mat in registers, so it must not be overwritten
+    Mat4 a = *mat;
+    mat4_kernels.mulMat4Batch(a.elems, mats->elems, mOut->elems, NULL, n);
+    return NML_SUCCESS;
+}
 
-        simd_f32x4_t result = simd_mul_f32(mat1_col0, bc0);
-        result = simd_add_f32(result, simd_mul_f32(mat1_col1, bc1));
-        result = simd_add_f32(result, simd_mul_f32(mat1_col2, bc2));
-        result = simd_add_f32(result, simd_mul_f32(mat1_col3, bc3));
+void mat4MulMat4Indexed(const Mat4 *mat,
+                        const Mat4 *mats,
+                        Mat4 *mOut,
+                        const uint32_t *idx,
+                        size_t n) {
+    mat4_kernels.mulMat4Batch(mat->elems, mats->elems, mOut->elems, idx, n);
+}
 
-        simd_store_f32(&mOut->cols[i].x, result);
+int mat4MulChain(const Mat4 *mats, size_t n, Mat4 *mOut) {
+    is_null(mOut);
+    if (n == 0)
+        return mat4Identity(mOut);
+    is_null((void *)mats);
+
+    // four independent partial products over consecutive runs, so the cpu
+    // can overlap them instead of waiting on a single dependency chain
+    enum { CHAINS = 4 };
+    size_t run = n / CHAINS;
+    if (run < 2) {
+        Mat4 acc = mats[0];
+        for (size_t i = 1; i < n; i++) {
+            mat4_kernels.mulMat4(acc.elems, mats[i].elems, acc.elems);
+        }
+        *mOut = acc;
+        return NML_SUCCESS;
     }
 
-#elif defined(DEFINE_SIMD__NEON)
-    simd_f32x4_t mat1_col0 = simd_load_f32(&mat1->cols[0].x);
-    simd_f32x4_t mat1_col1 = simd_load_f32(&mat1->cols[1].x);
-    simd_f32x4_t mat1_col2 = simd_load_f32(&mat1->cols[2].x);
-    simd_f32x4_t mat1_col3 = simd_load_f32(&mat1->cols[3].x);
-
-    for (int i = 0; i < 4; i++) {
-        simd_f32x4_t mat2_col = simd_load_f32(&mat2->cols[i].x);
-
-        simd_f32x4_t bc0 = simd_dup_lane_f32(mat2_col, 0);
-        simd_f32x4_t bc1 = simd_dup_lane_f32(mat2_col, 1);
-        simd_f32x4_t bc2 = simd_dup_lane_f32(mat2_col, 2);
-        simd_f32x4_t bc3 = simd_dup_lane_f32(mat2_col, 3);
+    Mat4 acc[CHAINS];
+    for (int c = 0; c < CHAINS; c++) {
+        acc[c] = mats[c * run];
+    }
+    for (size_t k = 1; k < run; k++) {
+        for (int c = 0; c < CHAINS; c++) {
+            mat4_kernels.mulMat4(acc[c].elems, mats[c * run + k].elems,
+                                 acc[c].elems);
+        }
+    }
+    // the last run also takes the remainder
+    for (size_t k = CHAINS * run; k < n; k++) {
+        mat4_kernels.mulMat4(acc[CHAINS - 1].elems, mats[k].elems,
+                             acc[CHAINS - 1].elems);
+    }
 
-        simd_f32x4_t result = simd_mul_f32(mat1_col0, bc0);
-        result = simd_fmadd_f32(mat1_col1, bc1, result);
-        result = simd_fmadd_f32(mat1_col2, bc2, result);
-        result = simd_fmadd_f32(mat1_col3, bc3, result);
+    for (int c = 1; c < CHAINS; c++) {
+        mat4_kernels.mulMat4(acc[0].elems, acc[c].elems, acc[0].elems);
+    }
+    *mOut = acc[0];
+    return NML_SUCCESS;
+}
+int mat4TransposeBatch(const Mat4 *mats, Mat4 *mOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)mats, mOut);
+    for (size_t i = 0; i < n; i++) {
+        mat4TransposeKernel(mats[i].elems, mOut[i].elems);
+    }
+    return NML_SUCCESS;
+}
 
-        simd_store_f32(&mOut->cols[i].x, result);
+int mat4DeterminantBatch(const Mat4 *mats, nml_t *out, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)mats, out);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = mat4DeterminantKernel(mats[i].elems);
     }
+    return NML_SUCCESS;
+}
 
-#else
-    mat4MulVec4(mat1, &mat2->cols[0], &mOut->cols[0]);
-    mat4MulVec4(mat1, &mat2->cols[1], &mOut->cols[1]);
-    mat4MulVec4(mat1, &mat2->cols[2], &mOut->cols[2]);
-    mat4MulVec4(mat1, &mat2->cols[3], &mOut->cols[3]);
-#endif
+int mat4InverseBatch(const Mat4 *mats, Mat4 *mOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)mats, mOut);
+    int err = NML_SUCCESS;
+    for (size_t i = 0; i < n; i++) {
+        if (mat4InverseKernel(mats[i].elems, mOut[i].elems)) {
+            memset(&mOut[i], 0, sizeof(Mat4));
+            err = NML_EZERODIV;
+        }
+    }
+    return err;
+}
 
-    return NML_SUCCESS;
+int mat4InverseAffineBatch(const Mat4 *mats, Mat4 *mOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)mats, mOut);
+    int err = NML_SUCCESS;
+    for (size_t i = 0; i < n; i++) {
+        if (mat4InverseAffineKernel(mats[i].elems, mOut[i].elems)) {
+            memset(&mOut[i], 0, sizeof(Mat4));
+            err = NML_EZERODIV;
+        }
+    }
+    return err;
 }
@@ -0,0 +1,281 @@
+#include "mat4d_kernels.h"
+
+#if defined(NML_DISPATCH_AVX2)
+#    include <immintrin.h>
+#    include <stdint.h>
+
+#    if !defined(USE_DOUBLE_PRECISION)
+
+// Mat4 is only 16 byte aligned, unaligned 256 bit loads cost nothing extra on
+// anything that has avx2 as long as they don't split a cache line
+NML_AVX2_FN void mat4AddAVX2(const nml_t *a, const nml_t *b, nml_t *out) {
+    _mm256_storeu_ps(
+        &out[0], _mm256_add_ps(_mm256_loadu_ps(&a[0]), _mm256_loadu_ps(&b[0])));
+    _mm256_storeu_ps(
+        &out[8], _mm256_add_ps(_mm256_loadu_ps(&a[8]), _mm256_loadu_ps(&b[8])));
+}
+
+NML_AVX2_FN void mat4SubAVX2(const nml_t *a, const nml_t *b, nml_t *out) {
+    _mm256_storeu_ps(
+        &out[0], _mm256_sub_ps(_mm256_loadu_ps(&a[0]), _mm256_loadu_ps(&b[0])));
+    _mm256_storeu_ps(
+        &out[8], _mm256_sub_ps(_mm256_loadu_ps(&a[8]), _mm256_loadu_ps(&b[8])));
+}
+
+NML_AVX2_FN void mat4HadamardAVX2(const nml_t *a, const nml_t *b, nml_t *out) {
+    _mm256_storeu_ps(
+        &out[0], _mm256_mul_ps(_mm256_loadu_ps(&a[0]), _mm256_loadu_ps(&b[0])));
+    _mm256_storeu_ps(
+        &out[8], _mm256_mul_ps(_mm256_loadu_ps(&a[8]), _mm256_loadu_ps(&b[8])));
+}
+
+NML_AVX2_FN void mat4ScaleAVX2(const nml_t *a, nml_t s, nml_t *out) {
+    __m256 scaler = _mm256_set1_ps(s);
+    _mm256_storeu_ps(&out[0], _mm256_mul_ps(_mm256_loadu_ps(&a[0]), scaler));
+    _mm256_storeu_ps(&out[8], _mm256_mul_ps(_mm256_loadu_ps(&a[8]), scaler));
+}
+
+NML_AVX2_FN void mat4NegateAVX2(const nml_t *a, nml_t *out) {
+    __m256 sign = _mm256_set1_ps(-0.0f);
+    _mm256_storeu_ps(&out[0], _mm256_xor_ps(_mm256_loadu_ps(&a[0]), sign));
+    _mm256_storeu_ps(&out[8], _mm256_xor_ps(_mm256_loadu_ps(&a[8]), sign));
+}
+
+NML_AVX2_FN void mat4MulVec4AVX2(const nml_t *m, const nml_t *v, nml_t *out) {
+    __m128 res = _mm_mul_ps(_mm_loadu_ps(&m[0]), _mm_broadcast_ss(&v[0]));
+    res = _mm_fmadd_ps(_mm_loadu_ps(&m[4]), _mm_broadcast_ss(&v[1]), res);
+    res = _mm_fmadd_ps(_mm_loadu_ps(&m[8]), _mm_broadcast_ss(&v[2]), res);
+    res = _mm_fmadd_ps(_mm_loadu_ps(&m[12]), _mm_broadcast_ss(&v[3]), res);
+    _mm_storeu_ps(out, res);
+}
+
+NML_AVX2_FN void mat4MulMat4AVX2(const nml_t *a, const nml_t *b, nml_t *out) {
+    // every column of a duplicated into both 128 bit halves so one pass
+    // produces two output columns
+    __m256 a0 = _mm256_broadcast_ps((const __m128 *)&a[0]);
+    __m256 a1 = _mm256_broadcast_ps((const __m128 *)&a[4]);
+    __m256 a2 = _mm256_broadcast_ps((const __m128 *)&a[8]);
+    __m256 a3 = _mm256_broadcast_ps((const __m128 *)&a[12]);
+
+    for (int i = 0; i < 16; i += 8) {
+        // columns i/4 and i/4 + 1 of b
+        __m256 bc = _mm256_loadu_ps(&b[i]);
+
+        __m256 res = _mm256_mul_ps(a0, _mm256_shuffle_ps(bc, bc, 0x00));
+        res = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(bc, bc, 0x55), res);
+        res = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(bc, bc, 0xAA), res);
+        res = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(bc, bc, 0xFF), res);
+
+        _mm256_storeu_ps(&out[i], res);
+    }
+}
+
+// two vectors per ymm register: columns broadcast to both halves, every lane
+// of the pair splatted within its own half
+NML_AVX2_FN static inline __m256 mulVec4x2(
+    __m256 c0, __m256 c1, __m256 c2, __m256 c3, __m256 v) {
+    __m256 res = _mm256_mul_ps(c0, _mm256_shuffle_ps(v, v, 0x00));
+    res = _mm256_fmadd_ps(c1, _mm256_shuffle_ps(v, v, 0x55), res);
+    res = _mm256_fmadd_ps(c2, _mm256_shuffle_ps(v, v, 0xAA), res);
+    return _mm256_fmadd_ps(c3, _mm256_shuffle_ps(v, v, 0xFF), res);
+}
+
+NML_AVX2_FN void mat4MulVec4BatchAVX2(const nml_t *m,
+                                      const nml_t *in,
+                                      nml_t *out,
+                                      size_t n) {
+    __m256 c0 = _mm256_broadcast_ps((const __m128 *)&m[0]);
+    __m256 c1 = _mm256_broadcast_ps((const __m128 *)&m[4]);
+    __m256 c2 = _mm256_broadcast_ps((const __m128 *)&m[8]);
+    __m256 c3 = _mm256_broadcast_ps((const __m128 *)&m[12]);
+
+    size_t i = 0;
+    int stream = n * 4 * sizeof(nml_t) >= MAT4_STREAM_BYTES &&
+                 ((uintptr_t)out & 15) == 0;
+
+    // streaming stores want 32 byte alignment, peel one vector if needed
+    if (stream && ((uintptr_t)out & 31) != 0) {
+        mat4MulVec4AVX2(m, in, out);
+        i = 1;
+    }
+
+    if (stream) {
+        for (; i + 4 <= n; i += 4) {
+            __m256 v01 = _mm256_loadu_ps(&in[i * 4]);
+            __m256 v23 = _mm256_loadu_ps(&in[i * 4 + 8]);
+            _mm256_stream_ps(&out[i * 4], mulVec4x2(c0, c1, c2, c3, v01));
+            _mm256_stream_ps(&out[i * 4 + 8], mulVec4x2(c0, c1, c2, c3, v23));
+        }
+        _mm_sfence();
+    } else {
+        for (; i + 4 <= n; i += 4) {
+            __m256 v01 = _mm256_loadu_ps(&in[i * 4]);
+            __m256 v23 = _mm256_loadu_ps(&in[i * 4 + 8]);
+            _mm256_storeu_ps(&out[i * 4], mulVec4x2(c0, c1, c2, c3, v01));
+            _mm256_storeu_ps(&out[i * 4 + 8], mulVec4x2(c0, c1, c2, c3, v23));
+        }
+    }
+
+    for (; i < n; i++) {
+        mat4MulVec4AVX2(m, &in[i * 4], &out[i * 4]);
+    }
+}
+
+// each pair of b columns is two Vec4s, so a product is two mulVec4x2 steps
+NML_AVX2_FN void mat4MulMat4BatchAVX2(const nml_t *a,
+                                      const nml_t *b,
+                                      nml_t *out,
+                                      const uint32_t *idx,
+                                      size_t n) {
+    __m256 a0 = _mm256_broadcast_ps((const __m128 *)&a[0]);
+    __m256 a1 = _mm256_broadcast_ps((const __m128 *)&a[4]);
+    __m256 a2 = _mm256_broadcast_ps((const __m128 *)&a[8]);
+    __m256 a3 = _mm256_broadcast_ps((const __m128 *)&a[12]);
+
+    for (size_t k = 0; k < n; k++) {
+        size_t j = (idx ? idx[k] : k) * 16;
+        __m256 b01 = _mm256_loadu_ps(&b[j]);
+        __m256 b23 = _mm256_loadu_ps(&b[j + 8]);
+        _mm256_storeu_ps(&out[j], mulVec4x2(a0, a1, a2, a3, b01));
+        _mm256_storeu_ps(&out[j + 8], mulVec4x2(a0, a1, a2, a3, b23));
+    }
+}
+
+#    else
+// double precision: one Mat4 column per ymm register
+
+NML_AVX2_FN void mat4AddAVX2(const nml_t *a, const nml_t *b, nml_t *out) {
+    for (int i = 0; i < 16; i += 4) {
+        _mm256_storeu_pd(
+            &out[i], _mm256_add_pd(_mm256_loadu_pd(&a[i]), _mm256_loadu_pd(&b[i])));
+    }
+}
+
+NML_AVX2_FN void mat4SubAVX2(const nml_t *a, const nml_t *b, nml_t *out) {
+    for (int i = 0; i < 16; i += 4) {
+        _mm256_storeu_pd(
+            &out[i], _mm256_sub_pd(_mm256_loadu_pd(&a[i]), _mm256_loadu_pd(&b[i])));
+    }
+}
+
+NML_AVX2_FN void mat4HadamardAVX2(const nml_t *a, const nml_t *b, nml_t *out) {
+    for (int i = 0; i < 16; i += 4) {
+        _mm256_storeu_pd(
+            &out[i], _mm256_mul_pd(_mm256_loadu_pd(&a[i]), _mm256_loadu_pd(&b[i])));
+    }
+}
+
+NML_AVX2_FN void mat4ScaleAVX2(const nml_t *a, nml_t s, nml_t *out) {
+    __m256d scaler = _mm256_set1_pd(s);
+    for (int i = 0; i < 16; i += 4) {
+        _mm256_storeu_pd(&out[i], _mm256_mul_pd(_mm256_loadu_pd(&a[i]), scaler));
+    }
+}
+
+NML_AVX2_FN void mat4NegateAVX2(const nml_t *a, nml_t *out) {
+    __m256d sign = _mm256_set1_pd(-0.0);
+    for (int i = 0; i < 16; i += 4) {
+        _mm256_storeu_pd(&out[i], _mm256_xor_pd(_mm256_loadu_pd(&a[i]), sign));
+    }
+}
+
+NML_AVX2_FN void mat4MulVec4AVX2(const nml_t *m, const nml_t *v, nml_t *out) {
+    __m256d res = _mm256_mul_pd(_mm256_loadu_pd(&m[0]), _mm256_broadcast_sd(&v[0]));
+    res = _mm256_fmadd_pd(_mm256_loadu_pd(&m[4]), _mm256_broadcast_sd(&v[1]), res);
+    res = _mm256_fmadd_pd(_mm256_loadu_pd(&m[8]), _mm256_broadcast_sd(&v[2]), res);
+    res = _mm256_fmadd_pd(_mm256_loadu_pd(&m[12]), _mm256_broadcast_sd(&v[3]), res);
+    _mm256_storeu_pd(out, res);
+}
+
+NML_AVX2_FN void mat4MulMat4AVX2(const nml_t *a, const nml_t *b, nml_t *out) {
+    __m256d a0 = _mm256_loadu_pd(&a[0]);
+    __m256d a1 = _mm256_loadu_pd(&a[4]);
+    __m256d a2 = _mm256_loadu_pd(&a[8]);
+    __m256d a3 = _mm256_loadu_pd(&a[12]);
+
+    for (int i = 0; i < 16; i += 4) {
+        __m256d res = _mm256_mul_pd(a0, _mm256_broadcast_sd(&b[i]));
+        res = _mm256_fmadd_pd(a1, _mm256_broadcast_sd(&b[i + 1]), res);
+        res = _mm256_fmadd_pd(a2, _mm256_broadcast_sd(&b[i + 2]), res);
+        res = _mm256_fmadd_pd(a3, _mm256_broadcast_sd(&b[i + 3]), res);
+        _mm256_storeu_pd(&out[i], res);
+    }
+}
+
+NML_AVX2_FN void mat4MulVec4BatchAVX2(const nml_t *m,
+                                      const nml_t *in,
+                                      nml_t *out,
+                                      size_t n) {
+    __m256d c0 = _mm256_loadu_pd(&m[0]);
+    __m256d c1 = _mm256_loadu_pd(&m[4]);
+    __m256d c2 = _mm256_loadu_pd(&m[8]);
+    __m256d c3 = _mm256_loadu_pd(&m[12]);
+
+    // a double Vec4 fills a whole ymm register, so streaming only needs the
+    // output itself to be 32 byte aligned
+    int stream = n * 4 * sizeof(nml_t) >= MAT4_STREAM_BYTES &&
+                 ((uintptr_t)out & 31) == 0;
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const nml_t *v0 = &in[i * 4];
+        const nml_t *v1 = &in[i * 4 + 4];
+
+        __m256d r0 = _mm256_mul_pd(c0, _mm256_broadcast_sd(&v0[0]));
+        __m256d r1 = _mm256_mul_pd(c0, _mm256_broadcast_sd(&v1[0]));
+        r0 = _mm256_fmadd_pd(c1, _mm256_broadcast_sd(&v0[1]), r0);
+        r1 = _mm256_fmadd_pd(c1, _mm256_broadcast_sd(&v1[1]), r1);
+        r0 = _mm256_fmadd_pd(c2, _mm256_broadcast_sd(&v0[2]), r0);
+        r1 = _mm256_fmadd_pd(c2, _mm256_broadcast_sd(&v1[2]), r1);
+        r0 = _mm256_fmadd_pd(c3, _mm256_broadcast_sd(&v0[3]), r0);
+        r1 = _mm256_fmadd_pd(c3, _mm256_broadcast_sd(&v1[3]), r1);
+
+        if (stream) {
+            _mm256_stream_pd(&out[i * 4], r0);
+            _mm256_stream_pd(&out[i * 4 + 4], r1);
+        } else {
+            _mm256_storeu_pd(&out[i * 4], r0);
+            _mm256_storeu_pd(&out[i * 4 + 4], r1);
+        }
+    }
+    if (stream)
+        _mm_sfence();
+
+    for (; i < n; i++) {
+        mat4MulVec4AVX2(m, &in[i * 4], &out[i * 4]);
+    }
+}
+
+NML_AVX2_FN void mat4MulMat4BatchAVX2(const nml_t *a,
+                                      const nml_t *b,
+                                      nml_t *out,
+                                      const uint32_t *idx,
+                                      size_t n) {
+    __m256d a0 = _mm256_loadu_pd(&a[0]);
+    __m256d a1 = _mm256_loadu_pd(&a[4]);
+    __m256d a2 = _mm256_loadu_pd(&a[8]);
+    __m256d a3 = _mm256_loadu_pd(&a[12]);
+
+    for (size_t k = 0; k < n; k++) {
+        size_t j = (idx ? idx[k] : k) * 16;
+        const nml_t *bm = &b[j];
+        __m256d res[4];
+        // all four columns before any store, out[j] may be b[j]
+        for (int i = 0; i < 4; i++) {
+            res[i] = _mm256_mul_pd(a0, _mm256_broadcast_sd(&bm[i * 4]));
+            res[i] = _mm256_fmadd_pd(a1, _mm256_broadcast_sd(&bm[i * 4 + 1]), res[i]);
+            res[i] = _mm256_fmadd_pd(a2, _mm256_broadcast_sd(&bm[i * 4 + 2]), res[i]);
+            res[i] = _mm256_fmadd_pd(a3, _mm256_broadcast_sd(&bm[i * 4 + 3]), res[i]);
+        }
+        for (int i = 0; i < 4; i++) {
+            _mm256_storeu_pd(&out[j + i * 4], res[i]);
+        }
+    }
+}
+
+#    endif
+
+#else
+// keep the translation unit non-empty for -pedantic
+typedef int mat4d_avx2_unused;
+#endif
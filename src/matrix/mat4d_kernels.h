@@ -0,0 +1,69 @@
+#ifndef __MAT4D_KERNELS_H__
+#define __MAT4D_KERNELS_H__
+
+#include "utils/consts.h"
+#include "utils/cpu.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * internal kernel table for the Mat4 api
+ *
+ * kernels work on raw column-major elements, the public functions do the
+ * argument checks and forward to whatever set mat4_kernels points at
+ */
+
+typedef void (*mat4_binary_fn)(const nml_t *a, const nml_t *b, nml_t *out);
+typedef void (*mat4_scale_fn)(const nml_t *a, nml_t s, nml_t *out);
+typedef void (*mat4_unary_fn)(const nml_t *a, nml_t *out);
+typedef void (*mat4_batch_fn)(const nml_t *m,
+                              const nml_t *in,
+                              nml_t *out,
+                              size_t n);
+// out[j] = a * b[j] for j in idx[0..n), or 0..n when idx is NULL. a is kept
+// in registers for the whole batch and must not overlap any out[j]
+typedef void (*mat4_mul_batch_fn)(const nml_t *a,
+                                  const nml_t *b,
+                                  nml_t *out,
+                                  const uint32_t *idx,
+                                  size_t n);
+
+// batches writing at least this many bytes bypass the cache with streaming
+// stores, the output would be evicted before anyone reads it anyway
+#define MAT4_STREAM_BYTES (8u << 20)
+
+typedef struct Mat4Kernels {
+    mat4_binary_fn add;
+    mat4_binary_fn sub;
+    mat4_binary_fn hadamard;
+    mat4_scale_fn scale;
+    mat4_unary_fn negate;
+    mat4_binary_fn mulVec4; // (mat, vec, vOut)
+    mat4_binary_fn mulMat4;
+    mat4_batch_fn mulVec4Batch; // (mat, in, out, n)
+    mat4_mul_batch_fn mulMat4Batch;
+} Mat4Kernels;
+
+// selected once at load time
+NML_HIDDEN extern Mat4Kernels mat4_kernels;
+
+#if defined(NML_DISPATCH_AVX2)
+NML_HIDDEN void mat4AddAVX2(const nml_t *a, const nml_t *b, nml_t *out);
+NML_HIDDEN void mat4SubAVX2(const nml_t *a, const nml_t *b, nml_t *out);
+NML_HIDDEN void mat4HadamardAVX2(const nml_t *a, const nml_t *b, nml_t *out);
+NML_HIDDEN void mat4ScaleAVX2(const nml_t *a, nml_t s, nml_t *out);
+NML_HIDDEN void mat4NegateAVX2(const nml_t *a, nml_t *out);
+NML_HIDDEN void mat4MulVec4AVX2(const nml_t *m, const nml_t *v, nml_t *out);
+NML_HIDDEN void mat4MulMat4AVX2(const nml_t *a, const nml_t *b, nml_t *out);
+NML_HIDDEN void mat4MulVec4BatchAVX2(const nml_t *m,
+                                     const nml_t *in,
+                                     nml_t *out,
+                                     size_t n);
+NML_HIDDEN void mat4MulMat4BatchAVX2(const nml_t *a,
+                                     const nml_t *b,
+                                     nml_t *out,
+                                     const uint32_t *idx,
+                                     size_t n);
+#endif
+
+#endif // !__MAT4D_KERNELS_H__
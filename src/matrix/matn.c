@@ -0,0 +1,350 @@
+#include "matrix/matn.h"
+#include "utils/errors.h"
+#include "utils/memory.h"
+#include "utils/simd.h"
+#include "utils/thread.h"
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * gemm blocking
+ *
+ * the usual three level scheme: a KC x NC panel of b is packed once and
+ * stays in L3, MC x KC blocks of a are packed against it and stay in L2, and
+ * the micro kernel keeps an MR x NR tile of c in registers while streaming
+ * KC steps of both packed panels out of L1
+ */
+
+#define GEMM_MR 8 // two nml4 vectors of a column
+#define GEMM_NR 4
+#define GEMM_MC 128
+#define GEMM_KC 256
+#define GEMM_NC 1024
+
+// threading: tiles of c handed out to the pool are GEMM_MC x GEMM_NB, a
+// slice of GEMM_SLICE_BLOCKS row blocks is packed between two barriers.
+// products under GEMM_PARALLEL_MIN multiply-adds (about 128^3) stay on the
+// calling thread, waking the pool costs more than they take
+#define GEMM_NB 64
+#define GEMM_SLICE_BLOCKS 16
+#define GEMM_PACK_GRAIN 8
+#define GEMM_PARALLEL_MIN (1 << 21)
+
+/*
+ * allocation
+ */
+
+static size_t leadingDimension(size_t rows) {
+    size_t per = NML_ALIGNMENT / sizeof(nml_t);
+    return (rows + per - 1) / per * per;
+}
+
+int matNInit(size_t rows, size_t cols, MatN *mOut) {
+    is_null(mOut);
+    memset(mOut, 0, sizeof(*mOut));
+    if (rows == 0 || cols == 0)
+        return NML_EINVAL;
+
+    size_t ld = leadingDimension(rows);
+    if (cols > SIZE_MAX / sizeof(nml_t) / ld)
+        return NML_ENOMEM;
+    size_t bytes = ld * cols * sizeof(nml_t);
+    mOut->data = alignedAlloc(NML_ALIGNMENT, bytes);
+    if (!mOut->data)
+        return NML_ENOMEM;
+    memset(mOut->data, 0, bytes);
+    mOut->rows = rows;
+    mOut->cols = cols;
+    mOut->ld = ld;
+    return NML_SUCCESS;
+}
+
+void matNFree(MatN *mat) {
+    if (!mat)
+        return;
+    alignedFree(mat->data);
+    memset(mat, 0, sizeof(*mat));
+}
+
+int matNIdentity(MatN *mat) {
+    is_null(mat, mat->data);
+    for (size_t j = 0; j < mat->cols; j++) {
+        nml_t *col = &mat->data[j * mat->ld];
+        memset(col, 0, mat->rows * sizeof(nml_t));
+        if (j < mat->rows)
+            col[j] = 1.0;
+    }
+    return NML_SUCCESS;
+}
+
+int matNCopy(const MatN *src, MatN *mOut) {
+    is_null((void *)src, mOut);
+    if (src->rows != mOut->rows || src->cols != mOut->cols)
+        return NML_EINVAL;
+    if (src->data == mOut->data)
+        return NML_SUCCESS;
+    for (size_t j = 0; j < src->cols; j++) {
+        memcpy(&mOut->data[j * mOut->ld], &src->data[j * src->ld],
+               src->rows * sizeof(nml_t));
+    }
+    return NML_SUCCESS;
+}
+
+/*
+ * gemm
+ */
+
+static int overlaps(const MatN *a, const MatN *b) {
+    uintptr_t aBegin = (uintptr_t)a->data;
+    uintptr_t aEnd = (uintptr_t)(a->data + a->ld * (a->cols - 1) + a->rows);
+    uintptr_t bBegin = (uintptr_t)b->data;
+    uintptr_t bEnd = (uintptr_t)(b->data + b->ld * (b->cols - 1) + b->rows);
+    return aBegin < bEnd && bBegin < aEnd;
+}
+
+// rows [row, row + mc) x columns [col, col + kc) of a into MR row panels,
+// each panel stores its kc columns back to back, short panels are zero
+// padded so the micro kernel never needs a row mask
+static void packA(const MatN *a, size_t row, size_t col, size_t mc, size_t kc,
+                  nml_t *restrict out) {
+    for (size_t ir = 0; ir < mc; ir += GEMM_MR) {
+        size_t mr = mc - ir < GEMM_MR ? mc - ir : GEMM_MR;
+        const nml_t *src = &MATN_AT(a, row + ir, col);
+        for (size_t p = 0; p < kc; p++) {
+            size_t i = 0;
+            for (; i < mr; i++) {
+                out[i] = src[i];
+            }
+            for (; i < GEMM_MR; i++) {
+                out[i] = 0.0;
+            }
+            src += a->ld;
+            out += GEMM_MR;
+        }
+    }
+}
+
+// rows [row, row + kc) x columns [col, col + nc) of b into NR column panels,
+// step p of a panel holds row p of its NR columns
+static void packB(const MatN *b, size_t row, size_t col, size_t kc, size_t nc,
+                  nml_t *restrict out) {
+    for (size_t jr = 0; jr < nc; jr += GEMM_NR) {
+        size_t nr = nc - jr < GEMM_NR ? nc - jr : GEMM_NR;
+        const nml_t *src[GEMM_NR];
+        for (size_t j = 0; j < GEMM_NR; j++) {
+            src[j] = &MATN_AT(b, row, col + jr + (j < nr ? j : 0));
+        }
+        for (size_t p = 0; p < kc; p++) {
+            for (size_t j = 0; j < GEMM_NR; j++) {
+                out[j] = j < nr ? src[j][p] : 0.0;
+            }
+            out += GEMM_NR;
+        }
+    }
+}
+
+// c[0..mr, 0..nr) += alpha * (packed a panel * packed b panel)
+static void microKernel(size_t kc,
+                        const nml_t *restrict a,
+                        const nml_t *restrict b,
+                        nml_t alpha,
+                        nml_t *c,
+                        size_t ldc,
+                        size_t mr,
+                        size_t nr) {
+    simd_nml4_t zero = simd_set1_nml4(0.0);
+    simd_nml4_t c00 = zero, c01 = zero, c10 = zero, c11 = zero;
+    simd_nml4_t c20 = zero, c21 = zero, c30 = zero, c31 = zero;
+
+    for (size_t p = 0; p < kc; p++) {
+        simd_nml4_t a0 = simd_load_nml4(a);
+        simd_nml4_t a1 = simd_load_nml4(a + 4);
+        simd_nml4_t b0 = simd_set1_nml4(b[0]);
+        simd_nml4_t b1 = simd_set1_nml4(b[1]);
+        c00 = simd_fmadd_nml4(a0, b0, c00);
+        c01 = simd_fmadd_nml4(a1, b0, c01);
+        c10 = simd_fmadd_nml4(a0, b1, c10);
+        c11 = simd_fmadd_nml4(a1, b1, c11);
+        simd_nml4_t b2 = simd_set1_nml4(b[2]);
+        simd_nml4_t b3 = simd_set1_nml4(b[3]);
+        c20 = simd_fmadd_nml4(a0, b2, c20);
+        c21 = simd_fmadd_nml4(a1, b2, c21);
+        c30 = simd_fmadd_nml4(a0, b3, c30);
+        c31 = simd_fmadd_nml4(a1, b3, c31);
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+
+    simd_nml4_t tile[GEMM_NR][2] = {
+        {c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}};
+    if (mr == GEMM_MR && nr == GEMM_NR) {
+        simd_nml4_t s = simd_set1_nml4(alpha);
+        for (size_t j = 0; j < GEMM_NR; j++) {
+            nml_t *col = c + j * ldc;
+            simd_storeu_nml4(col, simd_fmadd_nml4(tile[j][0], s,
+                                                  simd_loadu_nml4(col)));
+            simd_storeu_nml4(col + 4, simd_fmadd_nml4(tile[j][1], s,
+                                                      simd_loadu_nml4(col + 4)));
+        }
+        return;
+    }
+
+    // edge tile, only the valid part of c is touched
+    nml_t buf[GEMM_NR][GEMM_MR];
+    for (size_t j = 0; j < nr; j++) {
+        simd_storeu_nml4(buf[j], tile[j][0]);
+        simd_storeu_nml4(buf[j] + 4, tile[j][1]);
+        for (size_t i = 0; i < mr; i++) {
+            c[j * ldc + i] += alpha * buf[j][i];
+        }
+    }
+}
+
+static void scaleColumns(MatN *c, nml_t beta) {
+    for (size_t j = 0; j < c->cols; j++) {
+        nml_t *col = &c->data[j * c->ld];
+        if (beta == 0.0) {
+            memset(col, 0, c->rows * sizeof(nml_t));
+        } else {
+            for (size_t i = 0; i < c->rows; i++) {
+                col[i] *= beta;
+            }
+        }
+    }
+}
+
+/*
+ * the jc / pc loops stay on the calling thread. inside them the packing and
+ * the grid of MC x GEMM_NB tiles of c are split across the pool, tiles are
+ * disjoint so no two threads ever write the same element
+ */
+
+typedef struct GemmTask {
+    const MatN *a;
+    const MatN *b;
+    MatN *c;
+    nml_t alpha;
+    nml_t *packedA;
+    nml_t *packedB;
+    size_t is, ms; // rows of the current slice of a
+    size_t jc, nc; // columns of the current panel of b
+    size_t pc, kc; // inner dimension of both
+    size_t jBlocks;
+} GemmTask;
+
+static void packARange(void *ctx, size_t begin, size_t end) {
+    GemmTask *t = ctx;
+    size_t row = begin * GEMM_MR;
+    size_t rowEnd = end * GEMM_MR < t->ms ? end * GEMM_MR : t->ms;
+    packA(t->a, t->is + row, t->pc, rowEnd - row, t->kc,
+          &t->packedA[row * t->kc]);
+}
+
+static void packBRange(void *ctx, size_t begin, size_t end) {
+    GemmTask *t = ctx;
+    size_t col = begin * GEMM_NR;
+    size_t colEnd = end * GEMM_NR < t->nc ? end * GEMM_NR : t->nc;
+    packB(t->b, t->pc, t->jc + col, t->kc, colEnd - col,
+          &t->packedB[col * t->kc]);
+}
+
+// tiles are numbered row block major, so neighbouring tiles reuse the same
+// block of packed a from L2
+static void tileRange(void *ctx, size_t begin, size_t end) {
+    GemmTask *t = ctx;
+    for (size_t tile = begin; tile < end; tile++) {
+        size_t ic = tile / t->jBlocks * GEMM_MC;
+        size_t jb = tile % t->jBlocks * GEMM_NB;
+        size_t icEnd = ic + GEMM_MC < t->ms ? ic + GEMM_MC : t->ms;
+        size_t jbEnd = jb + GEMM_NB < t->nc ? jb + GEMM_NB : t->nc;
+
+        for (size_t jr = jb; jr < jbEnd; jr += GEMM_NR) {
+            size_t nr = jbEnd - jr < GEMM_NR ? jbEnd - jr : GEMM_NR;
+            for (size_t ir = ic; ir < icEnd; ir += GEMM_MR) {
+                size_t mr = icEnd - ir < GEMM_MR ? icEnd - ir : GEMM_MR;
+                microKernel(t->kc, &t->packedA[ir * t->kc],
+                            &t->packedB[jr * t->kc], t->alpha,
+                            &MATN_AT(t->c, t->is + ir, t->jc + jr), t->c->ld,
+                            mr, nr);
+            }
+        }
+    }
+}
+
+static void runLoop(int parallel, size_t n, size_t grain, ParallelFn fn,
+                    GemmTask *task) {
+    if (parallel)
+        parallelFor(n, grain, fn, task);
+    else
+        fn(task, 0, n);
+}
+
+int matNGemm(nml_t alpha, const MatN *a, const MatN *b, nml_t beta, MatN *c) {
+    is_null((void *)a, (void *)b, c);
+    is_null(a->data, b->data, c->data);
+    size_t m = c->rows, n = c->cols, k = a->cols;
+    if (a->rows != m || b->rows != k || b->cols != n)
+        return NML_EINVAL;
+    if (m == 0 || n == 0)
+        return NML_SUCCESS;
+    if (k > 0 && (overlaps(a, c) || overlaps(b, c)))
+        return NML_EINVAL;
+
+    if (beta != 1.0)
+        scaleColumns(c, beta);
+    if (alpha == 0.0 || k == 0)
+        return NML_SUCCESS;
+
+    // a single thread packs one MC block of a at a time so it is still in L2
+    // when the micro kernel reads it, the pool packs a whole slice up front
+    int parallel = threadCount() > 1 &&
+                   (double)m * (double)n * (double)k >= GEMM_PARALLEL_MIN;
+    size_t slice = parallel ? GEMM_MC * GEMM_SLICE_BLOCKS : GEMM_MC;
+
+    size_t kcMax = k < GEMM_KC ? k : GEMM_KC;
+    size_t msMax = m < slice ? m : slice;
+    size_t ncMax = n < GEMM_NC ? n : GEMM_NC;
+    size_t msPadded = (msMax + GEMM_MR - 1) / GEMM_MR * GEMM_MR;
+    size_t ncPadded = (ncMax + GEMM_NR - 1) / GEMM_NR * GEMM_NR;
+    nml_t *packedA =
+        alignedAlloc(NML_ALIGNMENT, msPadded * kcMax * sizeof(nml_t));
+    nml_t *packedB =
+        alignedAlloc(NML_ALIGNMENT, ncPadded * kcMax * sizeof(nml_t));
+    if (!packedA || !packedB) {
+        alignedFree(packedA);
+        alignedFree(packedB);
+        return NML_ENOMEM;
+    }
+
+    GemmTask task = {.a = a,
+                     .b = b,
+                     .c = c,
+                     .alpha = alpha,
+                     .packedA = packedA,
+                     .packedB = packedB};
+    for (task.jc = 0; task.jc < n; task.jc += GEMM_NC) {
+        task.nc = n - task.jc < GEMM_NC ? n - task.jc : GEMM_NC;
+        task.jBlocks = (task.nc + GEMM_NB - 1) / GEMM_NB;
+        for (task.pc = 0; task.pc < k; task.pc += GEMM_KC) {
+            task.kc = k - task.pc < GEMM_KC ? k - task.pc : GEMM_KC;
+            runLoop(parallel, (task.nc + GEMM_NR - 1) / GEMM_NR,
+                    GEMM_PACK_GRAIN, packBRange, &task);
+
+            for (task.is = 0; task.is < m; task.is += slice) {
+                task.ms = m - task.is < slice ? m - task.is : slice;
+                runLoop(parallel, (task.ms + GEMM_MR - 1) / GEMM_MR,
+                        GEMM_PACK_GRAIN, packARange, &task);
+                size_t iBlocks = (task.ms + GEMM_MC - 1) / GEMM_MC;
+                runLoop(parallel, iBlocks * task.jBlocks, 1, tileRange, &task);
+            }
+        }
+    }
+
+    alignedFree(packedA);
+    alignedFree(packedB);
+    return NML_SUCCESS;
+}
+
+int matNMul(const MatN *mat1, const MatN *mat2, MatN *mOut) {
+    return matNGemm(1.0, mat1, mat2, 0.0, mOut);
+}
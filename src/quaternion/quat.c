@@ -0,0 +1,559 @@
+#include "quaternion/quat.h"
+#include "utils/errors.h"
+#include "utils/math.h"
+#include "utils/simd.h"
+#include "utils/vmath.h"
+#include <string.h>
+
+// above this cosine slerp degenerates to nlerp, sin(theta) is too small to
+// divide by and the two are indistinguishable anyway
+#define SLERP_NLERP_COS 0.9995
+
+int quatInit(nml_t x, nml_t y, nml_t z, nml_t w, Quat *qOut) {
+    is_null(qOut);
+    qOut->x = x;
+    qOut->y = y;
+    qOut->z = z;
+    qOut->w = w;
+    return NML_SUCCESS;
+}
+
+int quatIdentity(Quat *qOut) {
+    return quatInit(0.0, 0.0, 0.0, 1.0, qOut);
+}
+
+int quatFromAxisAngle(Vec3 *axis, nml_t angle, Quat *qOut) {
+    is_null(axis, qOut);
+    if (vec3IsZero(axis))
+        return NML_EZERODIV;
+
+    nml_t s = sin(angle * 0.5) / vec3Length(axis);
+    return quatInit(axis->x * s, axis->y * s, axis->z * s, cos(angle * 0.5),
+                    qOut);
+}
+
+/*
+ * kernels on raw (x y z w) elements
+ */
+
+#if defined(NML_SIMD_F32) && defined(DEFINE_SIMD__SSE)
+#    define QUAT_SPLAT(v, i) simd_shuffle_f32(v, SIMD_SHUFFLE(i, i, i, i))
+#    define QUAT_WZYX(v) simd_shuffle_f32(v, SIMD_SHUFFLE(0, 1, 2, 3))
+#    define QUAT_ZWXY(v) simd_shuffle_f32(v, SIMD_SHUFFLE(1, 0, 3, 2))
+#    define QUAT_YXWZ(v) simd_shuffle_f32(v, SIMD_SHUFFLE(2, 3, 0, 1))
+#elif defined(NML_SIMD_F32) && defined(DEFINE_SIMD__NEON)
+#    define QUAT_SPLAT(v, i) simd_dup_lane_f32(v, i)
+#    define QUAT_WZYX(v) vrev64q_f32(vextq_f32(v, v, 2))
+#    define QUAT_ZWXY(v) vextq_f32(v, v, 2)
+#    define QUAT_YXWZ(v) vrev64q_f32(v)
+#endif
+
+static inline void quatMulKernel(const nml_t *a, const nml_t *b, nml_t *out) {
+#if defined(QUAT_SPLAT)
+    // a.w * b plus a.x, a.y, a.z times sign flipped permutations of b
+    static const float kSignX[4] = {1.0f, -1.0f, 1.0f, -1.0f};
+    static const float kSignY[4] = {1.0f, 1.0f, -1.0f, -1.0f};
+    static const float kSignZ[4] = {-1.0f, 1.0f, 1.0f, -1.0f};
+
+    simd_f32x4_t qa = simd_loadu_f32(a);
+    simd_f32x4_t qb = simd_loadu_f32(b);
+
+    simd_f32x4_t res = simd_mul_f32(QUAT_SPLAT(qa, 3), qb);
+    res = simd_fmadd_f32(
+        simd_mul_f32(QUAT_SPLAT(qa, 0), QUAT_WZYX(qb)), simd_loadu_f32(kSignX),
+        res);
+    res = simd_fmadd_f32(
+        simd_mul_f32(QUAT_SPLAT(qa, 1), QUAT_ZWXY(qb)), simd_loadu_f32(kSignY),
+        res);
+    res = simd_fmadd_f32(
+        simd_mul_f32(QUAT_SPLAT(qa, 2), QUAT_YXWZ(qb)), simd_loadu_f32(kSignZ),
+        res);
+
+    simd_storeu_f32(out, res);
+#else
+    nml_t x = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+    nml_t y = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+    nml_t z = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+    nml_t w = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+    out[3] = w;
+#endif
+}
+
+#undef QUAT_SPLAT
+#undef QUAT_WZYX
+#undef QUAT_ZWXY
+#undef QUAT_YXWZ
+
+static inline nml_t quatDotKernel(const nml_t *a, const nml_t *b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+}
+
+static inline void quatScaleKernel(const nml_t *q, nml_t s, nml_t *out) {
+    simd_storeu_nml4(out, simd_mul_nml4(simd_loadu_nml4(q), simd_set1_nml4(s)));
+}
+
+// returns non-zero for a zero quaternion
+static inline int quatNormalizeKernel(const nml_t *q, nml_t *out) {
+    nml_t lenSqr = quatDotKernel(q, q);
+    if (lenSqr < kEPSILON * kEPSILON)
+        return 1;
+    quatScaleKernel(q, 1.0 / sqrt(lenSqr), out);
+    return 0;
+}
+
+static inline void quatNlerpKernel(const nml_t *a,
+                                   const nml_t *b,
+                                   nml_t t,
+                                   nml_t *out) {
+    // q and -q are the same rotation, blend towards whichever is closer
+    nml_t tb = quatDotKernel(a, b) < 0.0 ? -t : t;
+    simd_nml4_t r = simd_fmadd_nml4(simd_loadu_nml4(b), simd_set1_nml4(tb),
+                                    simd_mul_nml4(simd_loadu_nml4(a),
+                                                  simd_set1_nml4(1.0 - t)));
+    simd_storeu_nml4(out, r);
+
+    if (quatNormalizeKernel(out, out)) {
+        // opposite rotations blended half way, any axis will do
+        memcpy(out, a, sizeof(nml_t) * 4);
+    }
+}
+
+static inline void quatSlerpKernel(const nml_t *a,
+                                   const nml_t *b,
+                                   nml_t t,
+                                   nml_t *out) {
+    nml_t cosTheta = quatDotKernel(a, b);
+    nml_t sign = 1.0;
+    if (cosTheta < 0.0) {
+        cosTheta = -cosTheta;
+        sign = -1.0;
+    }
+    if (cosTheta > SLERP_NLERP_COS) {
+        quatNlerpKernel(a, b, t, out);
+        return;
+    }
+
+    nml_t theta = acos(cosTheta);
+    nml_t rsin = 1.0 / sin(theta);
+    nml_t wa = sin((1.0 - t) * theta) * rsin;
+    nml_t wb = sin(t * theta) * rsin * sign;
+
+    simd_nml4_t r = simd_fmadd_nml4(
+        simd_loadu_nml4(b), simd_set1_nml4(wb),
+        simd_mul_nml4(simd_loadu_nml4(a), simd_set1_nml4(wa)));
+    simd_storeu_nml4(out, r);
+}
+
+// rotation matrix of a unit quaternion, column-major with the given column
+// stride (3 for Mat3, 4 for Mat4)
+static inline void quatToRotKernel(const nml_t *q, nml_t *m, int stride) {
+    nml_t x = q[0], y = q[1], z = q[2], w = q[3];
+    nml_t xx = x * x, yy = y * y, zz = z * z;
+    nml_t xy = x * y, xz = x * z, yz = y * z;
+    nml_t wx = w * x, wy = w * y, wz = w * z;
+
+    m[0] = 1.0 - 2.0 * (yy + zz);
+    m[1] = 2.0 * (xy + wz);
+    m[2] = 2.0 * (xz - wy);
+
+    m[stride + 0] = 2.0 * (xy - wz);
+    m[stride + 1] = 1.0 - 2.0 * (xx + zz);
+    m[stride + 2] = 2.0 * (yz + wx);
+
+    m[stride * 2 + 0] = 2.0 * (xz + wy);
+    m[stride * 2 + 1] = 2.0 * (yz - wx);
+    m[stride * 2 + 2] = 1.0 - 2.0 * (xx + yy);
+}
+
+static inline void quatToMat4Kernel(const nml_t *q, nml_t *m) {
+    quatToRotKernel(q, m, 4);
+    m[3] = m[7] = m[11] = 0.0;
+    m[12] = m[13] = m[14] = 0.0;
+    m[15] = 1.0;
+}
+
+// Shepperd's method, the branch on the largest diagonal term keeps the
+// square root argument away from zero
+static void quatFromRotKernel(const nml_t *m, int stride, nml_t *q) {
+#define R(r, c) m[(c) * stride + (r)]
+    nml_t trace = R(0, 0) + R(1, 1) + R(2, 2);
+    nml_t s;
+    if (trace > 0.0) {
+        s = sqrt(trace + 1.0) * 2.0;
+        q[0] = (R(2, 1) - R(1, 2)) / s;
+        q[1] = (R(0, 2) - R(2, 0)) / s;
+        q[2] = (R(1, 0) - R(0, 1)) / s;
+        q[3] = 0.25 * s;
+    } else if (R(0, 0) > R(1, 1) && R(0, 0) > R(2, 2)) {
+        s = sqrt(1.0 + R(0, 0) - R(1, 1) - R(2, 2)) * 2.0;
+        q[0] = 0.25 * s;
+        q[1] = (R(0, 1) + R(1, 0)) / s;
+        q[2] = (R(0, 2) + R(2, 0)) / s;
+        q[3] = (R(2, 1) - R(1, 2)) / s;
+    } else if (R(1, 1) > R(2, 2)) {
+        s = sqrt(1.0 + R(1, 1) - R(0, 0) - R(2, 2)) * 2.0;
+        q[0] = (R(0, 1) + R(1, 0)) / s;
+        q[1] = 0.25 * s;
+        q[2] = (R(1, 2) + R(2, 1)) / s;
+        q[3] = (R(0, 2) - R(2, 0)) / s;
+    } else {
+        s = sqrt(1.0 + R(2, 2) - R(0, 0) - R(1, 1)) * 2.0;
+        q[0] = (R(0, 2) + R(2, 0)) / s;
+        q[1] = (R(1, 2) + R(2, 1)) / s;
+        q[2] = 0.25 * s;
+        q[3] = (R(1, 0) - R(0, 1)) / s;
+    }
+#undef R
+}
+
+/*
+ * public api
+ */
+
+nml_t quatLength(Quat *quat) {
+    return sqrt(quatDotKernel(quat->elems, quat->elems));
+}
+
+nml_t quatDot(Quat *quat1, Quat *quat2) {
+    return quatDotKernel(quat1->elems, quat2->elems);
+}
+
+int quatNormalize(Quat *quat, Quat *qOut) {
+    is_null(quat, qOut);
+    return quatNormalizeKernel(quat->elems, qOut->elems) ? NML_EZERODIV
+                                                         : NML_SUCCESS;
+}
+
+int quatConjugate(Quat *quat, Quat *qOut) {
+    is_null(quat, qOut);
+    return quatInit(-quat->x, -quat->y, -quat->z, quat->w, qOut);
+}
+
+int quatInverse(Quat *quat, Quat *qOut) {
+    is_null(quat, qOut);
+    nml_t lenSqr = quatDotKernel(quat->elems, quat->elems);
+    if (lenSqr < kEPSILON * kEPSILON)
+        return NML_EZERODIV;
+
+    nml_t r = 1.0 / lenSqr;
+    return quatInit(-quat->x * r, -quat->y * r, -quat->z * r, quat->w * r,
+                    qOut);
+}
+
+int quatMul(Quat *quat1, Quat *quat2, Quat *qOut) {
+    is_null(quat1, quat2, qOut);
+    quatMulKernel(quat1->elems, quat2->elems, qOut->elems);
+    return NML_SUCCESS;
+}
+
+int quatRotateVec3(Quat *quat, Vec3 *vec, Vec3 *vOut) {
+    is_null(quat, vec, vOut);
+    // v' = v + w t + u x t with t = 2 (u x v), u the vector part
+    nml_t ux = quat->x, uy = quat->y, uz = quat->z, w = quat->w;
+    nml_t vx = vec->x, vy = vec->y, vz = vec->z;
+    nml_t tx = 2.0 * (uy * vz - uz * vy);
+    nml_t ty = 2.0 * (uz * vx - ux * vz);
+    nml_t tz = 2.0 * (ux * vy - uy * vx);
+
+    vOut->x = vx + w * tx + (uy * tz - uz * ty);
+    vOut->y = vy + w * ty + (uz * tx - ux * tz);
+    vOut->z = vz + w * tz + (ux * ty - uy * tx);
+    return NML_SUCCESS;
+}
+
+int quatToMat3(Quat *quat, Mat3 *mOut) {
+    is_null(quat, mOut);
+    quatToRotKernel(quat->elems, mOut->elems, 3);
+    return NML_SUCCESS;
+}
+
+int quatToMat4(Quat *quat, Mat4 *mOut) {
+    is_null(quat, mOut);
+    quatToMat4Kernel(quat->elems, mOut->elems);
+    return NML_SUCCESS;
+}
+
+int quatFromMat3(Mat3 *mat, Quat *qOut) {
+    is_null(mat, qOut);
+    quatFromRotKernel(mat->elems, 3, qOut->elems);
+    return NML_SUCCESS;
+}
+
+int quatFromMat4(Mat4 *mat, Quat *qOut) {
+    is_null(mat, qOut);
+    quatFromRotKernel(mat->elems, 4, qOut->elems);
+    return NML_SUCCESS;
+}
+
+int quatNlerp(Quat *quat1, Quat *quat2, nml_t t, Quat *qOut) {
+    is_null(quat1, quat2, qOut);
+    quatNlerpKernel(quat1->elems, quat2->elems, t, qOut->elems);
+    return NML_SUCCESS;
+}
+
+int quatSlerp(Quat *quat1, Quat *quat2, nml_t t, Quat *qOut) {
+    is_null(quat1, quat2, qOut);
+    quatSlerpKernel(quat1->elems, quat2->elems, t, qOut->elems);
+    return NML_SUCCESS;
+}
+
+/*
+ * batch kernels, four quaternions per step with one register per component
+ */
+
+// quatToMat4Kernel for four quaternions, columns 0 to 2 are built in lanes
+// and transposed back to one column per matrix
+static inline void quatToMat4Lanes(const Quat *q, Mat4 *m) {
+    static const nml_t kLastColumn[4] = {0.0, 0.0, 0.0, 1.0};
+    simd_nml4_t x = simd_loadu_nml4(q[0].elems);
+    simd_nml4_t y = simd_loadu_nml4(q[1].elems);
+    simd_nml4_t z = simd_loadu_nml4(q[2].elems);
+    simd_nml4_t w = simd_loadu_nml4(q[3].elems);
+    simd_transpose4_nml4(x, y, z, w);
+
+    simd_nml4_t x2 = simd_add_nml4(x, x);
+    simd_nml4_t y2 = simd_add_nml4(y, y);
+    simd_nml4_t z2 = simd_add_nml4(z, z);
+    simd_nml4_t xx = simd_mul_nml4(x, x2), yy = simd_mul_nml4(y, y2);
+    simd_nml4_t zz = simd_mul_nml4(z, z2), xy = simd_mul_nml4(x, y2);
+    simd_nml4_t xz = simd_mul_nml4(x, z2), yz = simd_mul_nml4(y, z2);
+    simd_nml4_t wx = simd_mul_nml4(w, x2), wy = simd_mul_nml4(w, y2);
+    simd_nml4_t wz = simd_mul_nml4(w, z2);
+    simd_nml4_t one = simd_set1_nml4(1.0);
+    simd_nml4_t zero = simd_set1_nml4(0.0);
+
+    simd_nml4_t c[3][4] = {
+        {simd_sub_nml4(one, simd_add_nml4(yy, zz)), simd_add_nml4(xy, wz),
+         simd_sub_nml4(xz, wy), zero},
+        {simd_sub_nml4(xy, wz), simd_sub_nml4(one, simd_add_nml4(xx, zz)),
+         simd_add_nml4(yz, wx), zero},
+        {simd_add_nml4(xz, wy), simd_sub_nml4(yz, wx),
+         simd_sub_nml4(one, simd_add_nml4(xx, yy)), zero},
+    };
+    for (int col = 0; col < 3; col++) {
+        simd_transpose4_nml4(c[col][0], c[col][1], c[col][2], c[col][3]);
+        for (int k = 0; k < 4; k++) {
+            simd_storeu_nml4(&m[k].elems[col * 4], c[col][k]);
+        }
+    }
+    simd_nml4_t last = simd_loadu_nml4(kLastColumn);
+    for (int k = 0; k < 4; k++) {
+        simd_storeu_nml4(&m[k].elems[12], last);
+    }
+}
+
+#if defined(NML_SIMD_F32)
+typedef struct QuatLanes {
+    simd_f32x4_t x, y, z, w;
+} QuatLanes;
+
+static inline QuatLanes quatLoadLanes(const Quat *q) {
+    QuatLanes l;
+    simd_load4_f32(q->elems, &l.x, &l.y, &l.z, &l.w);
+    return l;
+}
+
+static inline void quatStoreLanes(Quat *q, QuatLanes l) {
+    simd_store4_f32(q->elems, l.x, l.y, l.z, l.w);
+}
+
+static inline simd_f32x4_t quatDotLanes(QuatLanes a, QuatLanes b) {
+    simd_f32x4_t d = simd_mul_f32(a.x, b.x);
+    d = simd_fmadd_f32(a.y, b.y, d);
+    d = simd_fmadd_f32(a.z, b.z, d);
+    return simd_fmadd_f32(a.w, b.w, d);
+}
+
+// a * wa + b * wb
+static inline QuatLanes quatBlendLanes(QuatLanes a,
+                                       simd_f32x4_t wa,
+                                       QuatLanes b,
+                                       simd_f32x4_t wb) {
+    QuatLanes r = {
+        simd_fmadd_f32(b.x, wb, simd_mul_f32(a.x, wa)),
+        simd_fmadd_f32(b.y, wb, simd_mul_f32(a.y, wa)),
+        simd_fmadd_f32(b.z, wb, simd_mul_f32(a.z, wa)),
+        simd_fmadd_f32(b.w, wb, simd_mul_f32(a.w, wa)),
+    };
+    return r;
+}
+
+static inline QuatLanes quatSelectLanes(simd_f32x4_t mask,
+                                        QuatLanes a,
+                                        QuatLanes b) {
+    QuatLanes r = {
+        simd_select_f32(mask, a.x, b.x),
+        simd_select_f32(mask, a.y, b.y),
+        simd_select_f32(mask, a.z, b.z),
+        simd_select_f32(mask, a.w, b.w),
+    };
+    return r;
+}
+
+// quatNlerpKernel per lane, d is the dot product of a and b
+static inline QuatLanes quatNlerpLanes(QuatLanes a,
+                                       QuatLanes b,
+                                       simd_f32x4_t d,
+                                       nml_t t) {
+    simd_f32x4_t neg = simd_cmplt_f32(d, simd_set1_f32(0.0f));
+    simd_f32x4_t tb = simd_select_f32(neg, simd_set1_f32(-t), simd_set1_f32(t));
+    QuatLanes r = quatBlendLanes(a, simd_set1_f32(1.0 - t), b, tb);
+
+    simd_f32x4_t lenSqr = quatDotLanes(r, r);
+    simd_f32x4_t ok =
+        simd_cmpge_f32(lenSqr, simd_set1_f32(kEPSILON * kEPSILON));
+    simd_f32x4_t inv = simd_rsqrt_f32(lenSqr);
+    inv = simd_rsqrt_step_f32(lenSqr, inv);
+    inv = simd_rsqrt_step_f32(lenSqr, inv);
+    QuatLanes unit = {simd_mul_f32(r.x, inv), simd_mul_f32(r.y, inv),
+                      simd_mul_f32(r.z, inv), simd_mul_f32(r.w, inv)};
+    // opposite rotations blended half way come out as a, like the kernel
+    return quatSelectLanes(ok, unit, a);
+}
+
+// quatSlerpKernel per lane. sin(theta) is sqrt(1 - cos^2) and theta its
+// atan2 against cos, so the only polynomial calls are one atan2 and two sin
+static inline QuatLanes quatSlerpLanes(QuatLanes a, QuatLanes b, nml_t t) {
+    simd_f32x4_t d = quatDotLanes(a, b);
+    simd_f32x4_t neg = simd_cmplt_f32(d, simd_set1_f32(0.0f));
+    simd_f32x4_t cosTheta = simd_select_f32(neg, simd_negate_f32(d), d);
+    simd_f32x4_t smallAngle =
+        simd_cmpgt_f32(cosTheta, simd_set1_f32(SLERP_NLERP_COS));
+
+    simd_f32x4_t one = simd_set1_f32(1.0f);
+    simd_f32x4_t sinTheta = simd_sqrt_f32(simd_max_f32(
+        simd_sub_f32(one, simd_mul_f32(cosTheta, cosTheta)),
+        simd_set1_f32(0.0f)));
+    simd_f32x4_t theta = SimdAtan2(sinTheta, cosTheta);
+    // small angle lanes are replaced below, keep them away from 1 / 0
+    simd_f32x4_t rsin =
+        simd_div_f32(one, simd_select_f32(smallAngle, one, sinTheta));
+    simd_f32x4_t wa = simd_mul_f32(
+        SimdSin(simd_mul_f32(simd_set1_f32(1.0 - t), theta)), rsin);
+    simd_f32x4_t wb =
+        simd_mul_f32(SimdSin(simd_mul_f32(simd_set1_f32(t), theta)), rsin);
+    wb = simd_select_f32(neg, simd_negate_f32(wb), wb);
+    QuatLanes r = quatBlendLanes(a, wa, b, wb);
+
+    if (simd_movemask_f32(smallAngle))
+        r = quatSelectLanes(smallAngle, quatNlerpLanes(a, b, d, t), r);
+    return r;
+}
+#endif
+
+/*
+ * batch api
+ */
+
+int quatMulBatch(const Quat *q1, const Quat *q2, Quat *qOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)q1, (void *)q2, qOut);
+    for (size_t i = 0; i < n; i++) {
+        quatMulKernel(q1[i].elems, q2[i].elems, qOut[i].elems);
+    }
+    return NML_SUCCESS;
+}
+
+int quatNormalizeBatch(const Quat *quats, Quat *qOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)quats, qOut);
+    int err = NML_SUCCESS;
+    for (size_t i = 0; i < n; i++) {
+        if (quatNormalizeKernel(quats[i].elems, qOut[i].elems)) {
+            quatIdentity(&qOut[i]);
+            err = NML_EZERODIV;
+        }
+    }
+    return err;
+}
+
+int quatNlerpBatch(const Quat *q1, const Quat *q2, nml_t t, Quat *qOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)q1, (void *)q2, qOut);
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        QuatLanes a = quatLoadLanes(&q1[i]);
+        QuatLanes b = quatLoadLanes(&q2[i]);
+        quatStoreLanes(&qOut[i], quatNlerpLanes(a, b, quatDotLanes(a, b), t));
+    }
+#endif
+    for (; i < n; i++) {
+        quatNlerpKernel(q1[i].elems, q2[i].elems, t, qOut[i].elems);
+    }
+    return NML_SUCCESS;
+}
+
+int quatSlerpBatch(const Quat *q1, const Quat *q2, nml_t t, Quat *qOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)q1, (void *)q2, qOut);
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        QuatLanes a = quatLoadLanes(&q1[i]);
+        QuatLanes b = quatLoadLanes(&q2[i]);
+        quatStoreLanes(&qOut[i], quatSlerpLanes(a, b, t));
+    }
+#endif
+    for (; i < n; i++) {
+        quatSlerpKernel(q1[i].elems, q2[i].elems, t, qOut[i].elems);
+    }
+    return NML_SUCCESS;
+}
+
+int quatToMat4Batch(const Quat *quats, Mat4 *mOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)quats, mOut);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        quatToMat4Lanes(&quats[i], &mOut[i]);
+    }
+    for (; i < n; i++) {
+        quatToMat4Kernel(quats[i].elems, mOut[i].elems);
+    }
+    return NML_SUCCESS;
+}
+
+int quatRotateVec3Batch(const Quat *quat, const Vec3 *in, Vec3 *out, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)quat, (void *)in, out);
+
+    // one matrix build amortized over the batch is cheaper than the
+    // two cross products per vector
+    Mat3 m;
+    quatToRotKernel(quat->elems, m.elems, 3);
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    simd_f32x4_t r[9];
+    for (int k = 0; k < 9; k++) {
+        r[k] = simd_set1_f32(m.elems[k]);
+    }
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x, y, z;
+        simd_load3_f32(in[i].elems, &x, &y, &z);
+        simd_f32x4_t ox = simd_fmadd_f32(
+            r[6], z, simd_fmadd_f32(r[3], y, simd_mul_f32(r[0], x)));
+        simd_f32x4_t oy = simd_fmadd_f32(
+            r[7], z, simd_fmadd_f32(r[4], y, simd_mul_f32(r[1], x)));
+        simd_f32x4_t oz = simd_fmadd_f32(
+            r[8], z, simd_fmadd_f32(r[5], y, simd_mul_f32(r[2], x)));
+        simd_store3_f32(out[i].elems, ox, oy, oz);
+    }
+#endif
+    for (; i < n; i++) {
+        Vec3 v = in[i];
+        out[i].x = m.elems[0] * v.x + m.elems[3] * v.y + m.elems[6] * v.z;
+        out[i].y = m.elems[1] * v.x + m.elems[4] * v.y + m.elems[7] * v.z;
+        out[i].z = m.elems[2] * v.x + m.elems[5] * v.y + m.elems[8] * v.z;
+    }
+    return NML_SUCCESS;
+}
@@ -0,0 +1,516 @@
+#include "sparse/sparse.h"
+#include "sparse_kernels.h"
+#include "utils/errors.h"
+#include "utils/memory.h"
+#include "utils/simd.h"
+#include "utils/thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+// nonzeros per parallel range, a range of rows is only worth handing to
+// another thread once it is a few tens of microseconds of work
+#define SPARSE_GRAIN_NNZ 16384
+// smallest row range worth a parallel task, however heavy the rows are
+#define SPARSE_MIN_ROWS 16
+// right hand sides the block multiply accumulates per pass over a row, two
+// nml4 vectors
+#define SPMM_NR 8
+#define SPMM_PACK_GRAIN 4096
+
+/*
+ * construction
+ *
+ * CSR and CSC are the same compressed layout with the roles of the two
+ * indices swapped, both go through compress(). a counting sort by inner
+ * index followed by a stable one by outer index leaves every outer slice
+ * sorted, O(nnz + dimensions) whatever the input order
+ */
+
+typedef struct Compressed {
+    size_t *ptr;
+    uint32_t *idx;
+    nml_t *values;
+    size_t nnz;
+} Compressed;
+
+static void freeCompressed(Compressed *c) {
+    free(c->ptr);
+    free(c->idx);
+    free(c->values);
+    memset(c, 0, sizeof(*c));
+}
+
+static int compress(size_t outerDim,
+                    size_t innerDim,
+                    const uint32_t *outer,
+                    const uint32_t *inner,
+                    const nml_t *values,
+                    size_t nnz,
+                    Compressed *out) {
+    memset(out, 0, sizeof(*out));
+    // malloc(0) may return NULL, keep at least one slot
+    size_t slots = nnz > 0 ? nnz : 1;
+    size_t *innerStart = calloc(innerDim + 1, sizeof(size_t));
+    size_t *order = malloc(slots * sizeof(size_t));
+    out->ptr = calloc(outerDim + 1, sizeof(size_t));
+    out->idx = malloc(slots * sizeof(uint32_t));
+    out->values = malloc(slots * sizeof(nml_t));
+    if (!innerStart || !order || !out->ptr || !out->idx || !out->values) {
+        free(innerStart);
+        free(order);
+        freeCompressed(out);
+        return NML_ENOMEM;
+    }
+
+    // order = triplets sorted by inner index
+    for (size_t k = 0; k < nnz; k++) {
+        innerStart[inner[k] + 1]++;
+    }
+    for (size_t i = 0; i < innerDim; i++) {
+        innerStart[i + 1] += innerStart[i];
+    }
+    for (size_t k = 0; k < nnz; k++) {
+        order[innerStart[inner[k]]++] = k;
+    }
+    free(innerStart);
+
+    // stable scatter into outer slices, ptr[o + 1] is the fill position of
+    // slice o until the shift below
+    for (size_t k = 0; k < nnz; k++) {
+        out->ptr[outer[k] + 1]++;
+    }
+    for (size_t o = 1; o < outerDim; o++) {
+        out->ptr[o + 1] += out->ptr[o];
+    }
+    for (size_t k = 0; k < nnz; k++) {
+        size_t t = order[k];
+        size_t pos = out->ptr[outer[t]]++;
+        out->idx[pos] = inner[t];
+        out->values[pos] = values[t];
+    }
+    free(order);
+    memmove(&out->ptr[1], &out->ptr[0], outerDim * sizeof(size_t));
+    out->ptr[0] = 0;
+
+    // sum duplicates, compacting in place
+    size_t filled = 0;
+    for (size_t o = 0; o < outerDim; o++) {
+        size_t p = out->ptr[o], end = out->ptr[o + 1];
+        out->ptr[o] = filled;
+        for (; p < end; p++) {
+            if (filled > out->ptr[o] && out->idx[filled - 1] == out->idx[p]) {
+                out->values[filled - 1] += out->values[p];
+            } else {
+                out->idx[filled] = out->idx[p];
+                out->values[filled] = out->values[p];
+                filled++;
+            }
+        }
+    }
+    out->ptr[outerDim] = filled;
+    out->nnz = filled;
+    return NML_SUCCESS;
+}
+
+// gather indices are signed 32 bit, so are the dimensions
+static int checkTriplets(size_t rows,
+                         size_t cols,
+                         const uint32_t *rowIdx,
+                         const uint32_t *colIdx,
+                         size_t nnz) {
+    if (rows > INT32_MAX || cols > INT32_MAX)
+        return NML_EINVAL;
+    for (size_t k = 0; k < nnz; k++) {
+        if (rowIdx[k] >= rows || colIdx[k] >= cols)
+            return NML_EINVAL;
+    }
+    return NML_SUCCESS;
+}
+
+int sparseCSRFromCOO(size_t rows,
+                     size_t cols,
+                     const uint32_t *rowIdx,
+                     const uint32_t *colIdx,
+                     const nml_t *values,
+                     size_t nnz,
+                     SparseCSR *mOut) {
+    is_null(mOut);
+    memset(mOut, 0, sizeof(*mOut));
+    if (nnz > 0)
+        is_null((void *)rowIdx, (void *)colIdx, (void *)values);
+    int err = checkTriplets(rows, cols, rowIdx, colIdx, nnz);
+    if (err != NML_SUCCESS)
+        return err;
+
+    Compressed c;
+    err = compress(rows, cols, rowIdx, colIdx, values, nnz, &c);
+    if (err != NML_SUCCESS)
+        return err;
+    *mOut = (SparseCSR){rows, cols, c.nnz, c.ptr, c.idx, c.values};
+    return NML_SUCCESS;
+}
+
+int sparseCSCFromCOO(size_t rows,
+                     size_t cols,
+                     const uint32_t *rowIdx,
+                     const uint32_t *colIdx,
+                     const nml_t *values,
+                     size_t nnz,
+                     SparseCSC *mOut) {
+    is_null(mOut);
+    memset(mOut, 0, sizeof(*mOut));
+    if (nnz > 0)
+        is_null((void *)rowIdx, (void *)colIdx, (void *)values);
+    int err = checkTriplets(rows, cols, rowIdx, colIdx, nnz);
+    if (err != NML_SUCCESS)
+        return err;
+
+    Compressed c;
+    err = compress(cols, rows, colIdx, rowIdx, values, nnz, &c);
+    if (err != NML_SUCCESS)
+        return err;
+    *mOut = (SparseCSC){rows, cols, c.nnz, c.ptr, c.idx, c.values};
+    return NML_SUCCESS;
+}
+
+void sparseCSRFree(SparseCSR *mat) {
+    if (!mat)
+        return;
+    free(mat->rowPtr);
+    free(mat->colIdx);
+    free(mat->values);
+    memset(mat, 0, sizeof(*mat));
+}
+
+void sparseCSCFree(SparseCSC *mat) {
+    if (!mat)
+        return;
+    free(mat->colPtr);
+    free(mat->rowIdx);
+    free(mat->values);
+    memset(mat, 0, sizeof(*mat));
+}
+
+// outer index of every nonzero of a compressed matrix, the input compress()
+// needs to re-sort it the other way round
+static uint32_t *expandOuter(const size_t *ptr, size_t outerDim, size_t nnz) {
+    uint32_t *outer = malloc((nnz > 0 ? nnz : 1) * sizeof(uint32_t));
+    if (!outer)
+        return NULL;
+    for (size_t o = 0; o < outerDim; o++) {
+        for (size_t p = ptr[o]; p < ptr[o + 1]; p++) {
+            outer[p] = (uint32_t)o;
+        }
+    }
+    return outer;
+}
+
+int sparseCSRToCSC(const SparseCSR *mat, SparseCSC *mOut) {
+    is_null((void *)mat, mOut);
+    memset(mOut, 0, sizeof(*mOut));
+    uint32_t *rowIdx = expandOuter(mat->rowPtr, mat->rows, mat->nnz);
+    if (!rowIdx)
+        return NML_ENOMEM;
+
+    Compressed c;
+    int err = compress(mat->cols, mat->rows, mat->colIdx, rowIdx, mat->values,
+                       mat->nnz, &c);
+    free(rowIdx);
+    if (err != NML_SUCCESS)
+        return err;
+    *mOut = (SparseCSC){mat->rows, mat->cols, c.nnz, c.ptr, c.idx, c.values};
+    return NML_SUCCESS;
+}
+
+int sparseCSCToCSR(const SparseCSC *mat, SparseCSR *mOut) {
+    is_null((void *)mat, mOut);
+    memset(mOut, 0, sizeof(*mOut));
+    uint32_t *colIdx = expandOuter(mat->colPtr, mat->cols, mat->nnz);
+    if (!colIdx)
+        return NML_ENOMEM;
+
+    Compressed c;
+    int err = compress(mat->rows, mat->cols, mat->rowIdx, colIdx, mat->values,
+                       mat->nnz, &c);
+    free(colIdx);
+    if (err != NML_SUCCESS)
+        return err;
+    *mOut = (SparseCSR){mat->rows, mat->cols, c.nnz, c.ptr, c.idx, c.values};
+    return NML_SUCCESS;
+}
+
+/*
+ * baseline kernels
+ */
+
+// two running sums so consecutive nonzeros don't wait on each other
+static void csrSpmvBaseline(const size_t *rowPtr,
+                            const uint32_t *colIdx,
+                            const nml_t *values,
+                            const nml_t *x,
+                            nml_t *y,
+                            size_t begin,
+                            size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        size_t p = rowPtr[i], rowEnd = rowPtr[i + 1];
+        nml_t s0 = 0.0, s1 = 0.0;
+        for (; p + 2 <= rowEnd; p += 2) {
+            s0 += values[p] * x[colIdx[p]];
+            s1 += values[p + 1] * x[colIdx[p + 1]];
+        }
+        if (p < rowEnd)
+            s0 += values[p] * x[colIdx[p]];
+        y[i] = s0 + s1;
+    }
+}
+
+/*
+ * kernel dispatch
+ */
+
+SparseKernels sparse_kernels = {
+    csrSpmvBaseline,
+};
+
+#if defined(NML_DISPATCH_AVX2)
+__attribute__((constructor)) static void sparseSelectKernels(void) {
+    if (cpuHasAVX2FMA()) {
+        sparse_kernels = (SparseKernels){
+            csrSpmvAVX2,
+        };
+    }
+}
+#endif
+
+/*
+ * products
+ */
+
+typedef struct SpmvTask {
+    const SparseCSR *mat;
+    const nml_t *x;
+    nml_t *y;
+    const MatN *dense;
+    MatN *out;
+    nml_t *packed; // columns [col, col + width) of dense, row major
+    size_t col, width;
+} SpmvTask;
+
+// rows per parallel range, sized so a range holds about SPARSE_GRAIN_NNZ
+// multiply-adds over rhs right hand sides
+static size_t rowGrain(const SparseCSR *mat, size_t rhs) {
+    size_t perRow = mat->nnz / mat->rows;
+    size_t work = (perRow > 0 ? perRow : 1) * rhs;
+    size_t grain = SPARSE_GRAIN_NNZ / work;
+    return grain > SPARSE_MIN_ROWS ? grain : SPARSE_MIN_ROWS;
+}
+
+static void spmvRange(void *ctx, size_t begin, size_t end) {
+    const SpmvTask *task = ctx;
+    sparse_kernels.spmv(task->mat->rowPtr, task->mat->colIdx,
+                        task->mat->values, task->x, task->y, begin, end);
+}
+
+int sparseCSRMulVec(const SparseCSR *mat, const nml_t *x, nml_t *y) {
+    is_null((void *)mat, (void *)x, y);
+    if (mat->rows == 0)
+        return NML_SUCCESS;
+    is_null(mat->rowPtr);
+
+    SpmvTask task = {.mat = mat, .x = x, .y = y};
+    parallelFor(mat->rows, rowGrain(mat, 1), spmvRange, &task);
+    return NML_SUCCESS;
+}
+
+/*
+ * CSC products scatter into y, two columns can hit the same row so every
+ * part of the column range scatters into its own copy of y and the copies
+ * are summed into y afterwards. part 0 uses y itself
+ */
+
+typedef struct CscTask {
+    const SparseCSC *mat;
+    const nml_t *x;
+    nml_t *y;
+    nml_t *partials; // parts - 1 vectors of rows elements
+    size_t parts;
+} CscTask;
+
+static void cscScatter(const SparseCSC *mat, const nml_t *x, nml_t *y,
+                       size_t begin, size_t end) {
+    memset(y, 0, mat->rows * sizeof(nml_t));
+    for (size_t j = begin; j < end; j++) {
+        nml_t xj = x[j];
+        for (size_t p = mat->colPtr[j]; p < mat->colPtr[j + 1]; p++) {
+            y[mat->rowIdx[p]] += mat->values[p] * xj;
+        }
+    }
+}
+
+// first column whose nonzeros start at or after nonzero t
+static size_t columnAt(const SparseCSC *mat, size_t t) {
+    size_t lo = 0, hi = mat->cols;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (mat->colPtr[mid] < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// parts split the nonzeros evenly, not the columns
+static void cscScatterParts(void *ctx, size_t begin, size_t end) {
+    const CscTask *task = ctx;
+    const SparseCSC *mat = task->mat;
+    for (size_t part = begin; part < end; part++) {
+        size_t first = columnAt(mat, part * mat->nnz / task->parts);
+        size_t last = part + 1 == task->parts
+                          ? mat->cols
+                          : columnAt(mat, (part + 1) * mat->nnz / task->parts);
+        nml_t *y = part == 0 ? task->y
+                             : task->partials + (part - 1) * mat->rows;
+        cscScatter(mat, task->x, y, first, last);
+    }
+}
+
+static void cscReduceRange(void *ctx, size_t begin, size_t end) {
+    const CscTask *task = ctx;
+    size_t rows = task->mat->rows;
+    for (size_t part = 1; part < task->parts; part++) {
+        const nml_t *src = task->partials + (part - 1) * rows;
+        for (size_t i = begin; i < end; i++) {
+            task->y[i] += src[i];
+        }
+    }
+}
+
+int sparseCSCMulVec(const SparseCSC *mat, const nml_t *x, nml_t *y) {
+    is_null((void *)mat, (void *)x, y);
+    if (mat->rows == 0)
+        return NML_SUCCESS;
+    is_null(mat->colPtr);
+
+    // a part is only worth a thread and a copy of y once it has about
+    // SPARSE_GRAIN_NNZ nonzeros to scatter
+    size_t parts = mat->nnz / SPARSE_GRAIN_NNZ;
+    size_t threads = (size_t)threadCount();
+    parts = parts < threads ? parts : threads;
+    nml_t *partials = NULL;
+    if (parts > 1)
+        partials = malloc((parts - 1) * mat->rows * sizeof(nml_t));
+    // without scratch the product still works, just on one thread
+    if (!partials) {
+        cscScatter(mat, x, y, 0, mat->cols);
+        return NML_SUCCESS;
+    }
+
+    CscTask task = {
+        .mat = mat, .x = x, .y = y, .partials = partials, .parts = parts};
+    parallelFor(parts, 1, cscScatterParts, &task);
+    parallelFor(mat->rows, SPARSE_GRAIN_NNZ / parts, cscReduceRange, &task);
+    free(partials);
+    return NML_SUCCESS;
+}
+
+/*
+ * CSR times a dense block
+ *
+ * dense is column major, so the SPMM_NR right hand sides a nonzero meets
+ * sit ld apart. each SPMM_NR column slice of dense is packed row major into
+ * a panel first, then every nonzero is one broadcast and two nml4
+ * multiply-adds against a contiguous, aligned panel row
+ */
+
+// columns [col, col + width) of dense into panel rows [begin, end), short
+// slices are zero padded
+static void spmmPackRange(void *ctx, size_t begin, size_t end) {
+    const SpmvTask *task = ctx;
+    const MatN *b = task->dense;
+    const nml_t *src = &MATN_AT(b, 0, task->col);
+    nml_t *out = task->packed + begin * SPMM_NR;
+    size_t k = begin;
+    // full slices go 4 x 4 blocks at a time, a vector load per column
+    // instead of a scalar load per value
+    for (; task->width == SPMM_NR && k + 4 <= end; k += 4) {
+        for (size_t h = 0; h < SPMM_NR; h += 4) {
+            const nml_t *col = src + h * b->ld + k;
+            simd_nml4_t r0 = simd_loadu_nml4(col);
+            simd_nml4_t r1 = simd_loadu_nml4(col + b->ld);
+            simd_nml4_t r2 = simd_loadu_nml4(col + 2 * b->ld);
+            simd_nml4_t r3 = simd_loadu_nml4(col + 3 * b->ld);
+            simd_transpose4_nml4(r0, r1, r2, r3);
+            simd_store_nml4(out + h, r0);
+            simd_store_nml4(out + SPMM_NR + h, r1);
+            simd_store_nml4(out + 2 * SPMM_NR + h, r2);
+            simd_store_nml4(out + 3 * SPMM_NR + h, r3);
+        }
+        out += 4 * SPMM_NR;
+    }
+    for (; k < end; k++) {
+        size_t j = 0;
+        for (; j < task->width; j++) {
+            out[j] = src[j * b->ld + k];
+        }
+        for (; j < SPMM_NR; j++) {
+            out[j] = 0.0;
+        }
+        out += SPMM_NR;
+    }
+}
+
+static void spmmRange(void *ctx, size_t begin, size_t end) {
+    const SpmvTask *task = ctx;
+    const SparseCSR *mat = task->mat;
+    MatN *c = task->out;
+
+    for (size_t i = begin; i < end; i++) {
+        simd_nml4_t s0 = simd_set1_nml4(0.0);
+        simd_nml4_t s1 = s0;
+        for (size_t p = mat->rowPtr[i]; p < mat->rowPtr[i + 1]; p++) {
+            const nml_t *row = task->packed + (size_t)mat->colIdx[p] * SPMM_NR;
+            simd_nml4_t v = simd_set1_nml4(mat->values[p]);
+            s0 = simd_fmadd_nml4(simd_load_nml4(row), v, s0);
+            s1 = simd_fmadd_nml4(simd_load_nml4(row + 4), v, s1);
+        }
+        nml_t sums[SPMM_NR];
+        simd_storeu_nml4(sums, s0);
+        simd_storeu_nml4(sums + 4, s1);
+        for (size_t j = 0; j < task->width; j++) {
+            MATN_AT(c, i, task->col + j) = sums[j];
+        }
+    }
+}
+
+int sparseCSRMulMatN(const SparseCSR *mat, const MatN *dense, MatN *mOut) {
+    is_null((void *)mat, (void *)dense, mOut);
+    is_null(dense->data, mOut->data);
+    if (dense->rows != mat->cols || mOut->rows != mat->rows ||
+        mOut->cols != dense->cols)
+        return NML_EINVAL;
+    const nml_t *denseEnd = dense->data + dense->ld * dense->cols;
+    const nml_t *outEnd = mOut->data + mOut->ld * mOut->cols;
+    if (dense->data < outEnd && mOut->data < denseEnd)
+        return NML_EINVAL;
+    if (mat->rows == 0 || dense->cols == 0)
+        return NML_SUCCESS;
+
+    // an empty dense block still needs a valid panel pointer
+    size_t panelRows = dense->rows > 0 ? dense->rows : 1;
+    nml_t *packed =
+        alignedAlloc(NML_ALIGNMENT, panelRows * SPMM_NR * sizeof(nml_t));
+    if (!packed)
+        return NML_ENOMEM;
+
+    SpmvTask task = {
+        .mat = mat, .dense = dense, .out = mOut, .packed = packed};
+    for (task.col = 0; task.col < dense->cols; task.col += SPMM_NR) {
+        size_t left = dense->cols - task.col;
+        task.width = left < SPMM_NR ? left : SPMM_NR;
+        parallelFor(dense->rows, SPMM_PACK_GRAIN, spmmPackRange, &task);
+        parallelFor(mat->rows, rowGrain(mat, task.width), spmmRange, &task);
+    }
+    alignedFree(packed);
+    return NML_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#include "sparse_kernels.h"
+
+#if defined(NML_DISPATCH_AVX2)
+#    include <immintrin.h>
+
+/*
+ * one gather per 8 (4 in double) nonzeros of a row. the tail of every row
+ * goes through masked loads and a masked gather instead of a scalar loop,
+ * mesh matrices have 5-30 nonzeros per row so the tail is most of the work.
+ * gather indices are signed, the public api keeps dimensions <= INT32_MAX
+ */
+
+#    if !defined(USE_DOUBLE_PRECISION)
+
+NML_AVX2_FN static inline float hsum8(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+NML_AVX2_FN void csrSpmvAVX2(const size_t *rowPtr,
+                             const uint32_t *colIdx,
+                             const nml_t *values,
+                             const nml_t *x,
+                             nml_t *y,
+                             size_t begin,
+                             size_t end) {
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (size_t i = begin; i < end; i++) {
+        size_t p = rowPtr[i], rowEnd = rowPtr[i + 1];
+        __m256 acc = _mm256_setzero_ps();
+        for (; p + 8 <= rowEnd; p += 8) {
+            __m256i idx = _mm256_loadu_si256((const __m256i *)&colIdx[p]);
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(&values[p]),
+                                  _mm256_i32gather_ps(x, idx, 4), acc);
+        }
+        if (p < rowEnd) {
+            __m256i mask =
+                _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(rowEnd - p)), lanes);
+            __m256i idx = _mm256_maskload_epi32((const int *)&colIdx[p], mask);
+            __m256 v = _mm256_maskload_ps(&values[p], mask);
+            __m256 xs = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), x, idx,
+                                                 _mm256_castsi256_ps(mask), 4);
+            acc = _mm256_fmadd_ps(v, xs, acc);
+        }
+        y[i] = hsum8(acc);
+    }
+}
+
+#    else
+
+NML_AVX2_FN static inline double hsum4(__m256d v) {
+    __m128d s =
+        _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+NML_AVX2_FN void csrSpmvAVX2(const size_t *rowPtr,
+                             const uint32_t *colIdx,
+                             const nml_t *values,
+                             const nml_t *x,
+                             nml_t *y,
+                             size_t begin,
+                             size_t end) {
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    for (size_t i = begin; i < end; i++) {
+        size_t p = rowPtr[i], rowEnd = rowPtr[i + 1];
+        // two accumulators, a row of 8 would otherwise be one fma chain
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        for (; p + 8 <= rowEnd; p += 8) {
+            __m128i idx0 = _mm_loadu_si128((const __m128i *)&colIdx[p]);
+            __m128i idx1 = _mm_loadu_si128((const __m128i *)&colIdx[p + 4]);
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(&values[p]),
+                                   _mm256_i32gather_pd(x, idx0, 8), acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(&values[p + 4]),
+                                   _mm256_i32gather_pd(x, idx1, 8), acc1);
+        }
+        for (; p < rowEnd; p += 4) {
+            __m128i mask32 =
+                _mm_cmpgt_epi32(_mm_set1_epi32((int)(rowEnd - p)), lanes);
+            __m256i mask = _mm256_cvtepi32_epi64(mask32);
+            __m128i idx = _mm_maskload_epi32((const int *)&colIdx[p], mask32);
+            __m256d v = _mm256_maskload_pd(&values[p], mask);
+            __m256d xs = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, idx,
+                                                  _mm256_castsi256_pd(mask), 8);
+            acc0 = _mm256_fmadd_pd(v, xs, acc0);
+        }
+        y[i] = hsum4(_mm256_add_pd(acc0, acc1));
+    }
+}
+
+#    endif
+#endif
@@ -0,0 +1,41 @@
+#ifndef __SPARSE_KERNELS_H__
+#define __SPARSE_KERNELS_H__
+
+#include "utils/consts.h"
+#include "utils/cpu.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * internal kernel table for the sparse api
+ *
+ * y[i] = dot(row i, x) for rows [begin, end) of a CSR matrix, the public
+ * functions split the rows across threads and pick the range
+ */
+
+typedef void (*csr_spmv_fn)(const size_t *rowPtr,
+                            const uint32_t *colIdx,
+                            const nml_t *values,
+                            const nml_t *x,
+                            nml_t *y,
+                            size_t begin,
+                            size_t end);
+
+typedef struct SparseKernels {
+    csr_spmv_fn spmv;
+} SparseKernels;
+
+// selected once at load time
+NML_HIDDEN extern SparseKernels sparse_kernels;
+
+#if defined(NML_DISPATCH_AVX2)
+NML_HIDDEN void csrSpmvAVX2(const size_t *rowPtr,
+                            const uint32_t *colIdx,
+                            const nml_t *values,
+                            const nml_t *x,
+                            nml_t *y,
+                            size_t begin,
+                            size_t end);
+#endif
+
+#endif // !__SPARSE_KERNELS_H__
@@ -0,0 +1,184 @@
+#include "transform/cache.h"
+#include "mat4d_internal.h"
+#include "utils/errors.h"
+#include "utils/memory.h"
+#include "utils/thread.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_GRAIN 512
+// inverses cost several products each, so they split into smaller ranges
+#define INVERSE_GRAIN 128
+
+enum {
+    NODE_DIRTY = 1 << 0,   // local matrix changed since the last update
+    NODE_CHANGED = 1 << 1, // world recomputed by the last update
+};
+
+int transformCacheInit(const int32_t *parents,
+                       size_t count,
+                       unsigned int options,
+                       TransformCache *cOut) {
+    is_null(cOut);
+    memset(cOut, 0, sizeof(*cOut));
+    int err = mat4HierarchyInit(parents, count, &cOut->hierarchy);
+    if (err != NML_SUCCESS)
+        return err;
+    if (count == 0)
+        return NML_SUCCESS;
+
+    size_t matBytes = count * sizeof(Mat4);
+    cOut->locals = alignedAlloc(NML_ALIGNMENT, matBytes);
+    cOut->worlds = alignedAlloc(NML_ALIGNMENT, matBytes);
+    if (options & NML_TCACHE_INVERSES)
+        cOut->inverses = alignedAlloc(NML_ALIGNMENT, matBytes);
+    cOut->flags = malloc(count);
+    cOut->changed = malloc(count * sizeof(uint32_t));
+    if (!cOut->locals || !cOut->worlds || !cOut->flags || !cOut->changed ||
+        ((options & NML_TCACHE_INVERSES) && !cOut->inverses)) {
+        transformCacheFree(cOut);
+        return NML_ENOMEM;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        mat4Identity(&cOut->locals[i]);
+    }
+    memset(cOut->flags, NODE_DIRTY, count);
+    cOut->dirtyCount = count;
+    return NML_SUCCESS;
+}
+
+void transformCacheFree(TransformCache *cache) {
+    if (!cache)
+        return;
+    mat4HierarchyFree(&cache->hierarchy);
+    alignedFree(cache->locals);
+    alignedFree(cache->worlds);
+    alignedFree(cache->inverses);
+    free(cache->flags);
+    free(cache->changed);
+    memset(cache, 0, sizeof(*cache));
+}
+
+int transformCacheMarkDirty(TransformCache *cache, size_t node) {
+    is_null(cache);
+    if (node >= cache->hierarchy.count)
+        return NML_EINVAL;
+    if (!(cache->flags[node] & NODE_DIRTY)) {
+        cache->flags[node] |= NODE_DIRTY;
+        cache->dirtyCount++;
+    }
+    return NML_SUCCESS;
+}
+
+int transformCacheSetLocal(TransformCache *cache, size_t node, const Mat4 *local) {
+    is_null(cache, (void *)local);
+    if (node >= cache->hierarchy.count)
+        return NML_EINVAL;
+    cache->locals[node] = *local;
+    return transformCacheMarkDirty(cache, node);
+}
+
+const uint32_t *transformCacheChanged(const TransformCache *cache, size_t *count) {
+    if (!cache || !count)
+        return NULL;
+    *count = cache->changedCount;
+    return cache->changed;
+}
+
+/*
+ * update
+ */
+
+typedef struct UpdateTask {
+    TransformCache *cache;
+    const uint32_t *nodes;
+    atomic_int singular;
+} UpdateTask;
+
+static void worldRange(void *ctx, size_t begin, size_t end) {
+    UpdateTask *task = ctx;
+    const int32_t *parents = task->cache->hierarchy.parents;
+    const uint32_t *nodes = task->nodes;
+
+    // runs of siblings share the parent matrix, same as the full evaluator
+    size_t run = begin;
+    while (run < end) {
+        int32_t parent = parents[nodes[run]];
+        size_t runEnd = run + 1;
+        while (runEnd < end && parents[nodes[runEnd]] == parent) {
+            runEnd++;
+        }
+        mat4MulMat4Indexed(&task->cache->worlds[parent], task->cache->locals,
+                           task->cache->worlds, &nodes[run], runEnd - run);
+        run = runEnd;
+    }
+}
+
+static void inverseRange(void *ctx, size_t begin, size_t end) {
+    UpdateTask *task = ctx;
+    int singular = 0;
+    for (size_t k = begin; k < end; k++) {
+        uint32_t node = task->nodes[k];
+        if (mat4Inverse(&task->cache->worlds[node],
+                        &task->cache->inverses[node]) != NML_SUCCESS) {
+            mat4InitZero(&task->cache->inverses[node]);
+            singular = 1;
+        }
+    }
+    if (singular)
+        atomic_store(&task->singular, 1);
+}
+
+int transformCacheUpdate(TransformCache *cache) {
+    is_null(cache);
+    const Mat4Hierarchy *h = &cache->hierarchy;
+
+    if (cache->dirtyCount == 0) {
+        // the previous changed list is stale once consumers have seen it
+        for (size_t k = 0; k < cache->changedCount; k++) {
+            cache->flags[cache->changed[k]] &= ~NODE_CHANGED;
+        }
+        cache->changedCount = 0;
+        return NML_SUCCESS;
+    }
+
+    UpdateTask task = {cache, NULL, 0};
+    size_t changed = 0;
+    for (size_t level = 0; level < h->levelCount; level++) {
+        // parents sit in earlier levels, so their flags are already final
+        size_t levelStart = changed;
+        for (size_t k = h->levels[level]; k < h->levels[level + 1]; k++) {
+            uint32_t node = h->order[k];
+            int32_t parent = h->parents[node];
+            if ((cache->flags[node] & NODE_DIRTY) ||
+                (parent >= 0 && (cache->flags[parent] & NODE_CHANGED))) {
+                cache->flags[node] = NODE_CHANGED;
+                cache->changed[changed++] = node;
+            } else {
+                cache->flags[node] = 0;
+            }
+        }
+
+        if (level == 0) {
+            for (size_t k = levelStart; k < changed; k++) {
+                uint32_t root = cache->changed[k];
+                cache->worlds[root] = cache->locals[root];
+            }
+        } else {
+            task.nodes = &cache->changed[levelStart];
+            parallelFor(changed - levelStart, CACHE_GRAIN, worldRange, &task);
+        }
+    }
+    cache->changedCount = changed;
+    cache->dirtyCount = 0;
+
+    if (cache->inverses) {
+        task.nodes = cache->changed;
+        parallelFor(changed, INVERSE_GRAIN, inverseRange, &task);
+        if (atomic_load(&task.singular))
+            return NML_EZERODIV;
+    }
+    return NML_SUCCESS;
+}
@@ -0,0 +1,152 @@
+#include "transform/hierarchy.h"
+#include "mat4d_internal.h"
+#include "utils/errors.h"
+#include "utils/thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+// nodes per parallel range, a product is a few ns so smaller ranges spend
+// more time handing out work than doing it
+#define HIERARCHY_GRAIN 512
+
+/*
+ * level sort
+ */
+
+int mat4HierarchyInit(const int32_t *parents, size_t count, Mat4Hierarchy *hOut) {
+    is_null(hOut);
+    memset(hOut, 0, sizeof(*hOut));
+    if (count == 0)
+        return NML_SUCCESS;
+    is_null((void *)parents);
+    if (count > INT32_MAX)
+        return NML_EINVAL;
+
+    for (size_t i = 0; i < count; i++) {
+        if (parents[i] < -1 || parents[i] >= (int32_t)count)
+            return NML_EINVAL;
+    }
+
+    // children of every node as one compressed list, childStart[count] holds
+    // the roots so they come out first
+    size_t *childStart = calloc(count + 2, sizeof(size_t));
+    uint32_t *children = malloc(count * sizeof(uint32_t));
+    hOut->parents = malloc(count * sizeof(int32_t));
+    hOut->order = malloc(count * sizeof(uint32_t));
+    hOut->levels = malloc((count + 1) * sizeof(size_t));
+    if (!childStart || !children || !hOut->parents || !hOut->order ||
+        !hOut->levels) {
+        free(childStart);
+        free(children);
+        mat4HierarchyFree(hOut);
+        return NML_ENOMEM;
+    }
+    memcpy(hOut->parents, parents, count * sizeof(int32_t));
+
+    for (size_t i = 0; i < count; i++) {
+        size_t p = parents[i] < 0 ? count : (size_t)parents[i];
+        childStart[p + 1]++;
+    }
+    for (size_t i = 0; i <= count; i++) {
+        childStart[i + 1] += childStart[i];
+    }
+    for (size_t i = 0; i < count; i++) {
+        size_t p = parents[i] < 0 ? count : (size_t)parents[i];
+        children[childStart[p]++] = (uint32_t)i;
+    }
+    // the fill loop advanced every start to the next one, shift them back
+    memmove(&childStart[1], &childStart[0], count * sizeof(size_t));
+    childStart[0] = 0;
+
+    // breadth first from the roots, each level is the children of the one
+    // above in order, which keeps siblings next to each other
+    size_t filled = 0;
+    for (size_t k = childStart[count]; k < childStart[count + 1]; k++) {
+        hOut->order[filled++] = children[k];
+    }
+    size_t levelStart = 0;
+    hOut->levels[0] = 0;
+    while (levelStart < filled) {
+        size_t levelEnd = filled;
+        hOut->levels[++hOut->levelCount] = levelEnd;
+        for (size_t k = levelStart; k < levelEnd; k++) {
+            uint32_t node = hOut->order[k];
+            for (size_t c = childStart[node]; c < childStart[node + 1]; c++) {
+                hOut->order[filled++] = children[c];
+            }
+        }
+        levelStart = levelEnd;
+    }
+
+    free(childStart);
+    free(children);
+
+    // nodes on a cycle are never reached from a root
+    if (filled != count) {
+        mat4HierarchyFree(hOut);
+        return NML_EINVAL;
+    }
+    hOut->count = count;
+    return NML_SUCCESS;
+}
+
+void mat4HierarchyFree(Mat4Hierarchy *hierarchy) {
+    if (!hierarchy)
+        return;
+    free(hierarchy->parents);
+    free(hierarchy->order);
+    free(hierarchy->levels);
+    memset(hierarchy, 0, sizeof(*hierarchy));
+}
+
+/*
+ * evaluation
+ */
+
+typedef struct LevelTask {
+    const Mat4Hierarchy *hierarchy;
+    const Mat4 *locals;
+    Mat4 *worlds;
+    size_t base; // offset of the level in order
+} LevelTask;
+
+static void evaluateRange(void *ctx, size_t begin, size_t end) {
+    const LevelTask *task = ctx;
+    const uint32_t *order = task->hierarchy->order + task->base;
+    const int32_t *parents = task->hierarchy->parents;
+
+    // one batch per run of siblings, ranges may split a run
+    size_t run = begin;
+    while (run < end) {
+        int32_t parent = parents[order[run]];
+        size_t runEnd = run + 1;
+        while (runEnd < end && parents[order[runEnd]] == parent) {
+            runEnd++;
+        }
+        mat4MulMat4Indexed(&task->worlds[parent], task->locals, task->worlds,
+                           &order[run], runEnd - run);
+        run = runEnd;
+    }
+}
+
+int mat4HierarchyEvaluate(const Mat4Hierarchy *hierarchy,
+                          const Mat4 *locals,
+                          Mat4 *worlds) {
+    is_null((void *)hierarchy);
+    if (hierarchy->count == 0)
+        return NML_SUCCESS;
+    is_null((void *)locals, worlds);
+
+    for (size_t k = hierarchy->levels[0]; k < hierarchy->levels[1]; k++) {
+        uint32_t root = hierarchy->order[k];
+        worlds[root] = locals[root];
+    }
+
+    LevelTask task = {hierarchy, locals, worlds, 0};
+    for (size_t level = 1; level < hierarchy->levelCount; level++) {
+        task.base = hierarchy->levels[level];
+        size_t n = hierarchy->levels[level + 1] - task.base;
+        parallelFor(n, HIERARCHY_GRAIN, evaluateRange, &task);
+    }
+    return NML_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include "utils/cpu.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ARCH_X86)
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+#    elif defined(__GNUC__) || defined(__clang__)
+#        include <cpuid.h>
+#    endif
+#endif
+
+#if defined(ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+static void cpuid(unsigned int leaf, unsigned int sub, unsigned int regs[4]) {
+    __cpuid_count(leaf, sub, regs[0], regs[1], regs[2], regs[3]);
+}
+
+static unsigned long long xgetbv(unsigned int idx) {
+    unsigned int lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(idx));
+    return ((unsigned long long)hi << 32) | lo;
+}
+#elif defined(ARCH_X86) && defined(_MSC_VER)
+static void cpuid(unsigned int leaf, unsigned int sub, unsigned int regs[4]) {
+    __cpuidex((int *)regs, (int)leaf, (int)sub);
+}
+
+static unsigned long long xgetbv(unsigned int idx) {
+    return _xgetbv(idx);
+}
+#endif
+
+static unsigned int detectFeatures(void) {
+    unsigned int features = 0;
+
+#if defined(ARCH_X86)
+    unsigned int regs[4] = {0};
+    cpuid(0, 0, regs);
+    unsigned int max_leaf = regs[0];
+
+    cpuid(1, 0, regs);
+    if (regs[3] & (1u << 26))
+        features |= NML_CPU_SSE2;
+    if (regs[2] & (1u << 19))
+        features |= NML_CPU_SSE41;
+
+    // AVX state (xmm + ymm) has to be enabled by the os, not just the cpu
+    int osxsave = (regs[2] & (1u << 27)) != 0;
+    int ymm_enabled = osxsave && ((xgetbv(0) & 0x6) == 0x6);
+    if (ymm_enabled && (regs[2] & (1u << 28)))
+        features |= NML_CPU_AVX;
+    if (ymm_enabled && (regs[2] & (1u << 12)))
+        features |= NML_CPU_FMA;
+
+    if (ymm_enabled && max_leaf >= 7) {
+        cpuid(7, 0, regs);
+        if (regs[1] & (1u << 5))
+            features |= NML_CPU_AVX2;
+    }
+#elif defined(ARCH_ARM)
+    features |= NML_CPU_NEON;
+#endif
+
+    const char *isa = getenv("NUMEN_ISA");
+    if (isa && strcmp(isa, "baseline") == 0)
+        features &= NML_CPU_SSE2 | NML_CPU_NEON;
+
+    return features;
+}
+
+// set in the cached word once the features were detected, so the flag and
+// the bits are published by the same store
+#define CPU_DETECTED (1u << 31)
+
+unsigned int cpuFeatures(void) {
+    static atomic_uint cached = 0;
+    unsigned int features = atomic_load_explicit(&cached, memory_order_relaxed);
+    if (!(features & CPU_DETECTED)) {
+        features = detectFeatures() | CPU_DETECTED;
+        atomic_store_explicit(&cached, features, memory_order_relaxed);
+    }
+    return features & ~CPU_DETECTED;
+}
+
+int cpuHasAVX2FMA(void) {
+    unsigned int features = cpuFeatures();
+    return (features & NML_CPU_AVX2) && (features & NML_CPU_FMA);
+}
+
+const char *cpuBackendName(void) {
+#if defined(NML_DISPATCH_AVX2)
+    if (cpuHasAVX2FMA())
+        return "avx2+fma";
+#endif
+#if defined(DEFINE_SIMD__SSE)
+    return "sse2";
+#elif defined(DEFINE_SIMD__NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
@@ -1,9 +1,9 @@
 #include "utils/math.h"
 #include "utils/consts.h"
 #include "utils/errors.h"
+#include "utils/vmath.h"
 #include <math.h>
 #include <stdint.h>
-#include <string.h>
 
 nml_t PowInt(nml_t x, int32_t n) {
     // handle negative exponents by reciprocating the base
@@ -36,60 +36,26 @@ nml_t RadsToDegs(nml_t n) {
     return n * k180_PI;
 }
 
+// hardware estimate plus two newton steps (vmath.h), float builds only.
+// there is no double estimate, double builds take the exact libm result
 nml_t Q_Sqrt(nml_t n) {
     if (n < 0)
         return NML_EINVAL;
-    // determine floating-point properties at compile time
-    const uint8_t exponent_bits =
-        (sizeof(nml_t) == 4) ? 8 : 11; // float:8, double:11
-    const uint8_t mantissa_bits =
-        (sizeof(nml_t) == 4) ? 23 : 52; // float:23, double:52
-    const uint64_t exponent_bias =
-        ((1ULL << (exponent_bits - 1)) - 1); // 127 or 1023
-
-    // compute magic number
-    const uint64_t magic = (exponent_bias * (1ULL << mantissa_bits)) * 3 / 2;
-
-    // bit hack for initial guess (avoids strict-aliasing UB)
-    uint64_t i;
-    memcpy(&i, &n, sizeof(n)); // safe type-punning
-    i = magic - (i >> 1);
-    nml_t x;
-    memcpy(&x, &i, sizeof(n)); // convert back to float/double
-
-    // Newton-Raphson refinement (1-2 iterations)
-    x = x * (1.5 - (0.5 * n * x * x));
-    x = x * (1.5 - (0.5 * n * x * x));
-
-    // Multiply by n to get sqrt(n) (since x ≈ 1/sqrt(n))
-    return n * x;
+#if defined(NML_SIMD_F32)
+    return simd_extract0_f32(SimdSqrt(simd_set1_f32(n), NML_SQRT_PRECISE));
+#else
+    return sqrt(n);
+#endif
 }
 
 nml_t Q_RSqrt(nml_t n) {
     if (n < 0)
         return NML_EINVAL;
-    // determine floating-point properties at compile time
-    const uint8_t exponent_bits =
-        (sizeof(nml_t) == 4) ? 8 : 11; // float:8, double:11
-    const uint8_t mantissa_bits =
-        (sizeof(nml_t) == 4) ? 23 : 52; // float:23, double:52
-    const uint64_t exponent_bias =
-        ((1ULL << (exponent_bits - 1)) - 1); // 127 or 1023
-
-    // compute magic number
-    const uint64_t magic = (exponent_bias * (1ULL << mantissa_bits)) * 3 / 2;
-
-    // bit hack for initial guess
-    uint64_t i;
-    memcpy(&i, &n, sizeof(n)); // safe type punnin
-    i = magic - (i >> 1);
-    nml_t x;
-    memcpy(&x, &i, sizeof(n)); // convert back to float/double
-
-    // Newton-Raphson refinement (1-2 iterations)
-    x = x * (1.5 - (0.5 * n * x * x));
-    x = x * (1.5 - (0.5 * n * x * x));
-    return x;
+#if defined(NML_SIMD_F32)
+    return simd_extract0_f32(SimdRSqrt(simd_set1_f32(n), NML_SQRT_PRECISE));
+#else
+    return 1.0 / sqrt(n);
+#endif
 }
 
 nml_t Factorial(nml_t n) {
@@ -0,0 +1,32 @@
+#include "utils/memory.h"
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#    include <malloc.h>
+#endif
+
+void *alignedAlloc(size_t alignment, size_t size) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        return NULL;
+    if (alignment < sizeof(void *))
+        alignment = sizeof(void *);
+
+    // aligned_alloc wants size to be a multiple of alignment
+    size_t rounded = (size + alignment - 1) & ~(alignment - 1);
+    if (rounded == 0)
+        rounded = alignment;
+
+#if defined(_MSC_VER)
+    return _aligned_malloc(rounded, alignment);
+#else
+    return aligned_alloc(alignment, rounded);
+#endif
+}
+
+void alignedFree(void *ptr) {
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
@@ -0,0 +1,236 @@
+#include "utils/thread.h"
+#include "utils/errors.h"
+#include <stdlib.h>
+
+#if defined(_WIN32)
+
+// no pool on windows yet, every loop runs on the caller
+
+int threadCount(void) {
+    return 1;
+}
+
+int threadSetCount(int count) {
+    return count < 1 ? NML_EINVAL : NML_SUCCESS;
+}
+
+int parallelFor(size_t n, size_t grain, ParallelFn fn, void *ctx) {
+    (void)grain;
+    if (n == 0)
+        return NML_SUCCESS;
+    if (!fn)
+        return NML_ENULLMEM;
+    fn(ctx, 0, n);
+    return NML_SUCCESS;
+}
+
+#else
+
+#    include <pthread.h>
+#    include <stdatomic.h>
+#    include <stdint.h>
+#    include <unistd.h>
+
+// upper bound on the pool, NUMEN_THREADS above this is clamped
+#    define MAX_THREADS 256
+
+typedef struct Pool {
+    pthread_mutex_t lock;
+    pthread_cond_t wake; // a new loop was published
+    pthread_cond_t done; // the last worker left the current loop
+    pthread_t *workers;
+    int workerCount; // started workers, the caller is not counted
+    int started;
+    int shutdown;
+    unsigned long generation; // bumped for every published loop
+
+    // the loop being run
+    ParallelFn fn;
+    void *ctx;
+    size_t n;
+    size_t chunk;
+    atomic_size_t next;
+    int active; // workers still inside the loop
+} Pool;
+
+static Pool pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+// held for the duration of a loop, loops that can't take it run serially
+static pthread_mutex_t loopLock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int threadTotal = 0;
+static _Thread_local int inLoop = 0;
+
+static int defaultThreadCount(void) {
+    const char *env = getenv("NUMEN_THREADS");
+    long count = env ? strtol(env, NULL, 10) : 0;
+    if (count < 1)
+        count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (count < 1)
+        count = 1;
+    return count > MAX_THREADS ? MAX_THREADS : (int)count;
+}
+
+static void runChunks(void) {
+    size_t begin;
+    while ((begin = atomic_fetch_add(&pool.next, pool.chunk)) < pool.n) {
+        size_t end = begin + pool.chunk < pool.n ? begin + pool.chunk : pool.n;
+        pool.fn(pool.ctx, begin, end);
+    }
+}
+
+// arg is the generation current when the worker was created, loops
+// published before that are not its business
+static void *workerMain(void *arg) {
+    inLoop = 1;
+    unsigned long seen = (unsigned long)(uintptr_t)arg;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        while (!pool.shutdown && pool.generation == seen) {
+            pthread_cond_wait(&pool.wake, &pool.lock);
+        }
+        if (pool.shutdown)
+            break;
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+
+        runChunks();
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.active == 0)
+            pthread_cond_signal(&pool.done);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+// both called with loopLock held
+static void poolStop(void) {
+    if (!pool.started)
+        return;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = 1;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (int i = 0; i < pool.workerCount; i++) {
+        pthread_join(pool.workers[i], NULL);
+    }
+    free(pool.workers);
+    pool.workers = NULL;
+    pool.workerCount = 0;
+    pool.shutdown = 0;
+    pool.started = 0;
+}
+
+static void poolStart(void) {
+    pool.started = 1;
+    int count = threadCount() - 1;
+    if (count < 1)
+        return;
+
+    pool.workers = malloc(sizeof(pthread_t) * count);
+    if (!pool.workers)
+        return;
+    // a worker that fails to start just leaves a smaller pool
+    while (pool.workerCount < count &&
+           pthread_create(&pool.workers[pool.workerCount], NULL, workerMain,
+                          (void *)(uintptr_t)pool.generation) == 0) {
+        pool.workerCount++;
+    }
+}
+
+#    if defined(__GNUC__) || defined(__clang__)
+__attribute__((destructor)) static void poolShutdown(void) {
+    if (pthread_mutex_trylock(&loopLock) == 0) {
+        poolStop();
+        pthread_mutex_unlock(&loopLock);
+    }
+}
+#    endif
+
+int threadCount(void) {
+    int count = atomic_load(&threadTotal);
+    if (count == 0) {
+        // keep the count another thread or threadSetCount stored first
+        int expected = 0;
+        count = defaultThreadCount();
+        if (!atomic_compare_exchange_strong(&threadTotal, &expected, count))
+            count = expected;
+    }
+    return count;
+}
+
+int threadSetCount(int count) {
+    if (count < 1)
+        return NML_EINVAL;
+    if (count > MAX_THREADS)
+        count = MAX_THREADS;
+
+    pthread_mutex_lock(&loopLock);
+    if (count != threadCount()) {
+        poolStop();
+        atomic_store(&threadTotal, count);
+    }
+    pthread_mutex_unlock(&loopLock);
+    return NML_SUCCESS;
+}
+
+int parallelFor(size_t n, size_t grain, ParallelFn fn, void *ctx) {
+    if (n == 0)
+        return NML_SUCCESS;
+    if (!fn)
+        return NML_ENULLMEM;
+    if (grain == 0)
+        grain = 1;
+
+    if (inLoop || n <= grain || threadCount() == 1 ||
+        pthread_mutex_trylock(&loopLock) != 0) {
+        fn(ctx, 0, n);
+        return NML_SUCCESS;
+    }
+
+    if (!pool.started)
+        poolStart();
+    if (pool.workerCount == 0) {
+        pthread_mutex_unlock(&loopLock);
+        fn(ctx, 0, n);
+        return NML_SUCCESS;
+    }
+
+    // a few chunks per thread so uneven ranges still balance
+    size_t threads = (size_t)pool.workerCount + 1;
+    size_t chunk = (n + threads * 4 - 1) / (threads * 4);
+    chunk = chunk < grain ? grain : chunk;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.n = n;
+    pool.chunk = chunk;
+    atomic_store(&pool.next, 0);
+    pool.active = pool.workerCount;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    inLoop = 1;
+    runChunks();
+    inLoop = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.active > 0) {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&loopLock);
+    return NML_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,325 @@
+#include "utils/vmath.h"
+#include "utils/errors.h"
+#include "vmath_kernels.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * 4 lane instantiation of vmath_impl.h on the simd.h vector types. only
+ * sse2 is assumed on x86, round to nearest goes through the int conversion
+ * (current rounding mode) and keeps lanes that are already integers
+ */
+
+#if defined(DEFINE_SIMD__SSE)
+
+static inline __m128 roundNearest4(__m128 x) {
+    __m128 r = _mm_cvtepi32_ps(_mm_cvtps_epi32(x));
+    __m128 small = _mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), x),
+                                _mm_set1_ps(8388608.0f));
+    return simd_select_f32(small, r, x);
+}
+
+#    define VM_I __m128i
+#    define VM_SET1I(c) _mm_set1_epi32(c)
+#    define VM_CMPEQ(a, b) _mm_cmpeq_ps(a, b)
+#    define VM_ANDNOT(a, b) _mm_andnot_ps(a, b)
+#    define VM_ROUND(x) roundNearest4(x)
+#    define VM_CVTI(x) _mm_cvtps_epi32(x)
+#    define VM_CVTF(i) _mm_cvtepi32_ps(i)
+#    define VM_ASI(x) _mm_castps_si128(x)
+#    define VM_ASF(i) _mm_castsi128_ps(i)
+#    define VM_ADDI(a, b) _mm_add_epi32(a, b)
+#    define VM_SUBI(a, b) _mm_sub_epi32(a, b)
+#    define VM_ANDI(a, b) _mm_and_si128(a, b)
+#    define VM_ORI(a, b) _mm_or_si128(a, b)
+#    define VM_CMPEQI(a, b) _mm_cmpeq_epi32(a, b)
+#    define VM_SLLI(a, n) _mm_slli_epi32(a, n)
+#    define VM_SRLI(a, n) _mm_srli_epi32(a, n)
+#    define VM_SRAI(a, n) _mm_srai_epi32(a, n)
+
+#elif defined(DEFINE_SIMD__NEON)
+
+#    define VM_U(x) vreinterpretq_u32_f32(x)
+#    define VM_I int32x4_t
+#    define VM_SET1I(c) vdupq_n_s32(c)
+#    define VM_CMPEQ(a, b) vreinterpretq_f32_u32(vceqq_f32(a, b))
+#    define VM_ANDNOT(a, b) vreinterpretq_f32_u32(vbicq_u32(VM_U(b), VM_U(a)))
+#    define VM_ROUND(x) vrndnq_f32(x)
+#    define VM_CVTI(x) vcvtnq_s32_f32(x)
+#    define VM_CVTF(i) vcvtq_f32_s32(i)
+#    define VM_ASI(x) vreinterpretq_s32_f32(x)
+#    define VM_ASF(i) vreinterpretq_f32_s32(i)
+#    define VM_ADDI(a, b) vaddq_s32(a, b)
+#    define VM_SUBI(a, b) vsubq_s32(a, b)
+#    define VM_ANDI(a, b) vandq_s32(a, b)
+#    define VM_ORI(a, b) vorrq_s32(a, b)
+#    define VM_CMPEQI(a, b) vreinterpretq_s32_u32(vceqq_s32(a, b))
+#    define VM_SLLI(a, n) vshlq_n_s32(a, n)
+#    define VM_SRLI(a, n) \
+        vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), n))
+#    define VM_SRAI(a, n) vshrq_n_s32(a, n)
+
+#endif
+
+#if !defined(DISABLE_SIMD)
+#    define VM_F simd_f32x4_t
+#    define VM_LANES 4
+#    define VM_FN(name) name##4
+#    define VM_ATTR
+#    define VM_BATCH static
+
+#    define VM_LOADU(p) simd_loadu_f32(p)
+#    define VM_STOREU(p, v) simd_storeu_f32(p, v)
+#    define VM_SET1(c) simd_set1_f32(c)
+#    define VM_ADD(a, b) simd_add_f32(a, b)
+#    define VM_SUB(a, b) simd_sub_f32(a, b)
+#    define VM_MUL(a, b) simd_mul_f32(a, b)
+#    define VM_DIV(a, b) simd_div_f32(a, b)
+#    define VM_FMADD(a, b, c) simd_fmadd_f32(a, b, c)
+#    define VM_MIN(a, b) simd_min_f32(a, b)
+#    define VM_MAX(a, b) simd_max_f32(a, b)
+#    define VM_AND(a, b) simd_and_f32(a, b)
+#    define VM_OR(a, b) simd_or_f32(a, b)
+#    define VM_XOR(a, b) simd_xor_f32(a, b)
+#    define VM_CMPLT(a, b) simd_cmplt_f32(a, b)
+#    define VM_CMPGT(a, b) simd_cmpgt_f32(a, b)
+#    define VM_SELECT(m, a, b) simd_select_f32(m, a, b)
+#    define VM_RSQRT(x) simd_rsqrt_f32(x)
+#    define VM_RSQRT_STEP(a, y) simd_rsqrt_step_f32(a, y)
+// double builds keep the lane functions only, their arrays go to libm
+#    if !defined(NML_SIMD_F32)
+#        define VM_NO_BATCH
+#    endif
+
+#    include "vmath_impl.h"
+
+simd_f32x4_t SimdSin(simd_f32x4_t x) {
+    return sin4(x);
+}
+
+simd_f32x4_t SimdCos(simd_f32x4_t x) {
+    return cos4(x);
+}
+
+void SimdSinCos(simd_f32x4_t x, simd_f32x4_t *sOut, simd_f32x4_t *cOut) {
+    sincos4(x, sOut, cOut);
+}
+
+simd_f32x4_t SimdTan(simd_f32x4_t x) {
+    return tan4(x);
+}
+
+simd_f32x4_t SimdAtan2(simd_f32x4_t y, simd_f32x4_t x) {
+    return atan24(y, x);
+}
+
+simd_f32x4_t SimdExp(simd_f32x4_t x) {
+    return exp4(x);
+}
+
+simd_f32x4_t SimdLog(simd_f32x4_t x) {
+    return log4(x);
+}
+
+simd_f32x4_t SimdPow(simd_f32x4_t x, simd_f32x4_t y) {
+    return pow4(x, y);
+}
+
+simd_f32x4_t SimdRSqrt(simd_f32x4_t x, int accuracy) {
+    switch (accuracy) {
+    case NML_SQRT_FAST:
+        return rsqrtFast4(x);
+    case NML_SQRT_REFINED:
+        return rsqrtRefined4(x);
+    default:
+        return rsqrtPrecise4(x);
+    }
+}
+
+simd_f32x4_t SimdSqrt(simd_f32x4_t x, int accuracy) {
+    switch (accuracy) {
+    case NML_SQRT_FAST:
+        return sqrtFast4(x);
+    case NML_SQRT_REFINED:
+        return sqrtRefined4(x);
+    default:
+        return sqrtPrecise4(x);
+    }
+}
+
+#else
+
+// no vector unit, the lanes go through libm one at a time
+
+#    define VM_LANEWISE1(name, fn)                      \
+        simd_f32x4_t name(simd_f32x4_t x) {             \
+            for (int i = 0; i < 4; i++)                 \
+                x.f[i] = fn(x.f[i]);                    \
+            return x;                                   \
+        }
+#    define VM_LANEWISE2(name, fn)                      \
+        simd_f32x4_t name(simd_f32x4_t a, simd_f32x4_t b) { \
+            for (int i = 0; i < 4; i++)                 \
+                a.f[i] = fn(a.f[i], b.f[i]);            \
+            return a;                                   \
+        }
+
+VM_LANEWISE1(SimdSin, sinf)
+VM_LANEWISE1(SimdCos, cosf)
+VM_LANEWISE1(SimdTan, tanf)
+VM_LANEWISE1(SimdExp, expf)
+VM_LANEWISE1(SimdLog, logf)
+VM_LANEWISE2(SimdAtan2, atan2f)
+VM_LANEWISE2(SimdPow, powf)
+#    undef VM_LANEWISE1
+#    undef VM_LANEWISE2
+
+void SimdSinCos(simd_f32x4_t x, simd_f32x4_t *sOut, simd_f32x4_t *cOut) {
+    for (int i = 0; i < 4; i++) {
+        sOut->f[i] = sinf(x.f[i]);
+        cOut->f[i] = cosf(x.f[i]);
+    }
+}
+
+// no estimate instruction either, every tier is exact
+simd_f32x4_t SimdRSqrt(simd_f32x4_t x, int accuracy) {
+    (void)accuracy;
+    for (int i = 0; i < 4; i++)
+        x.f[i] = 1.0f / sqrtf(x.f[i]);
+    return x;
+}
+
+simd_f32x4_t SimdSqrt(simd_f32x4_t x, int accuracy) {
+    (void)accuracy;
+    for (int i = 0; i < 4; i++)
+        x.f[i] = sqrtf(x.f[i]);
+    return x;
+}
+
+#endif
+
+/*
+ * array functions
+ */
+
+#if defined(NML_SIMD_F32)
+
+VMathKernels vmath_kernels = {
+    .sin = sinBatch4,
+    .cos = cosBatch4,
+    .tan = tanBatch4,
+    .exp = expBatch4,
+    .log = logBatch4,
+    .sincos = sincosBatch4,
+    .atan2 = atan2Batch4,
+    .pow = powBatch4,
+    .rsqrt = {rsqrtFastBatch4, rsqrtRefinedBatch4, rsqrtPreciseBatch4},
+    .sqrt = {sqrtFastBatch4, sqrtRefinedBatch4, sqrtPreciseBatch4},
+};
+
+#    if defined(NML_DISPATCH_AVX2)
+__attribute__((constructor)) static void vmathSelectKernels(void) {
+    if (cpuHasAVX2FMA()) {
+        vmath_kernels = (VMathKernels){
+            .sin = sinBatch8,
+            .cos = cosBatch8,
+            .tan = tanBatch8,
+            .exp = expBatch8,
+            .log = logBatch8,
+            .sincos = sincosBatch8,
+            .atan2 = atan2Batch8,
+            .pow = powBatch8,
+            .rsqrt = {rsqrtFastBatch8, rsqrtRefinedBatch8,
+                      rsqrtPreciseBatch8},
+            .sqrt = {sqrtFastBatch8, sqrtRefinedBatch8, sqrtPreciseBatch8},
+        };
+    }
+}
+#    endif
+
+#    define VM_UNARY_BATCH(name, kernel)               \
+        int name(const nml_t *in, nml_t *out, size_t n) { \
+            is_null((void *)in, out);                  \
+            vmath_kernels.kernel(in, out, n);          \
+            return NML_SUCCESS;                        \
+        }
+#    define VM_BINARY_BATCH(name, kernel)                               \
+        int name(const nml_t *a, const nml_t *b, nml_t *out, size_t n) { \
+            is_null((void *)a, (void *)b, out);                         \
+            vmath_kernels.kernel(a, b, out, n);                         \
+            return NML_SUCCESS;                                         \
+        }
+
+#else
+
+// double precision or no vector unit: libm in nml_t
+
+#    define VM_UNARY_BATCH(name, fn)                   \
+        int name(const nml_t *in, nml_t *out, size_t n) { \
+            is_null((void *)in, out);                  \
+            for (size_t i = 0; i < n; i++)             \
+                out[i] = fn(in[i]);                    \
+            return NML_SUCCESS;                        \
+        }
+#    define VM_BINARY_BATCH(name, fn)                                   \
+        int name(const nml_t *a, const nml_t *b, nml_t *out, size_t n) { \
+            is_null((void *)a, (void *)b, out);                         \
+            for (size_t i = 0; i < n; i++)                              \
+                out[i] = fn(a[i], b[i]);                                \
+            return NML_SUCCESS;                                         \
+        }
+
+#endif
+
+VM_UNARY_BATCH(SinBatch, sin)
+VM_UNARY_BATCH(CosBatch, cos)
+VM_UNARY_BATCH(TanBatch, tan)
+VM_UNARY_BATCH(ExpBatch, exp)
+VM_UNARY_BATCH(LogBatch, log)
+VM_BINARY_BATCH(Atan2Batch, atan2)
+VM_BINARY_BATCH(PowBatch, pow)
+#undef VM_UNARY_BATCH
+#undef VM_BINARY_BATCH
+
+int SinCosBatch(const nml_t *in, nml_t *sOut, nml_t *cOut, size_t n) {
+    is_null((void *)in, sOut, cOut);
+#if defined(NML_SIMD_F32)
+    vmath_kernels.sincos(in, sOut, cOut, n);
+#else
+    // in may alias sOut, read it once per element
+    for (size_t i = 0; i < n; i++) {
+        nml_t x = in[i];
+        sOut[i] = sin(x);
+        cOut[i] = cos(x);
+    }
+#endif
+    return NML_SUCCESS;
+}
+
+int RSqrtBatch(const nml_t *in, nml_t *out, size_t n, int accuracy) {
+    is_null((void *)in, out);
+    // same fallback as the lane functions
+    if (accuracy < NML_SQRT_FAST || accuracy > NML_SQRT_PRECISE)
+        accuracy = NML_SQRT_PRECISE;
+#if defined(NML_SIMD_F32)
+    vmath_kernels.rsqrt[accuracy](in, out, n);
+#else
+    for (size_t i = 0; i < n; i++)
+        out[i] = 1.0 / sqrt(in[i]);
+#endif
+    return NML_SUCCESS;
+}
+
+int SqrtBatch(const nml_t *in, nml_t *out, size_t n, int accuracy) {
+    is_null((void *)in, out);
+    if (accuracy < NML_SQRT_FAST || accuracy > NML_SQRT_PRECISE)
+        accuracy = NML_SQRT_PRECISE;
+#if defined(NML_SIMD_F32)
+    vmath_kernels.sqrt[accuracy](in, out, n);
+#else
+    for (size_t i = 0; i < n; i++)
+        out[i] = sqrt(in[i]);
+#endif
+    return NML_SUCCESS;
+}
@@ -0,0 +1,59 @@
+#include "vmath_kernels.h"
+
+#if defined(NML_DISPATCH_AVX2) && !defined(USE_DOUBLE_PRECISION)
+#    include <immintrin.h>
+#    include <stdint.h>
+#    include <string.h>
+
+#    define VM_F __m256
+#    define VM_I __m256i
+#    define VM_LANES 8
+#    define VM_FN(name) name##8
+#    define VM_ATTR NML_AVX2_FN
+#    define VM_BATCH
+
+#    define VM_LOADU(p) _mm256_loadu_ps(p)
+#    define VM_STOREU(p, v) _mm256_storeu_ps(p, v)
+#    define VM_SET1(c) _mm256_set1_ps(c)
+#    define VM_SET1I(c) _mm256_set1_epi32(c)
+#    define VM_ADD(a, b) _mm256_add_ps(a, b)
+#    define VM_SUB(a, b) _mm256_sub_ps(a, b)
+#    define VM_MUL(a, b) _mm256_mul_ps(a, b)
+#    define VM_DIV(a, b) _mm256_div_ps(a, b)
+#    define VM_FMADD(a, b, c) _mm256_fmadd_ps(a, b, c)
+#    define VM_MIN(a, b) _mm256_min_ps(a, b)
+#    define VM_MAX(a, b) _mm256_max_ps(a, b)
+#    define VM_AND(a, b) _mm256_and_ps(a, b)
+#    define VM_OR(a, b) _mm256_or_ps(a, b)
+#    define VM_XOR(a, b) _mm256_xor_ps(a, b)
+#    define VM_ANDNOT(a, b) _mm256_andnot_ps(a, b)
+#    define VM_CMPLT(a, b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#    define VM_CMPGT(a, b) _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#    define VM_CMPEQ(a, b) _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+#    define VM_SELECT(m, a, b) _mm256_blendv_ps(b, a, m)
+#    define VM_ROUND(x) \
+        _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)
+#    define VM_CVTI(x) _mm256_cvtps_epi32(x)
+#    define VM_CVTF(i) _mm256_cvtepi32_ps(i)
+#    define VM_ASI(x) _mm256_castps_si256(x)
+#    define VM_ASF(i) _mm256_castsi256_ps(i)
+#    define VM_ADDI(a, b) _mm256_add_epi32(a, b)
+#    define VM_SUBI(a, b) _mm256_sub_epi32(a, b)
+#    define VM_ANDI(a, b) _mm256_and_si256(a, b)
+#    define VM_ORI(a, b) _mm256_or_si256(a, b)
+#    define VM_CMPEQI(a, b) _mm256_cmpeq_epi32(a, b)
+#    define VM_SLLI(a, n) _mm256_slli_epi32(a, n)
+#    define VM_SRLI(a, n) _mm256_srli_epi32(a, n)
+#    define VM_SRAI(a, n) _mm256_srai_epi32(a, n)
+#    define VM_RSQRT(x) _mm256_rsqrt_ps(x)
+#    define VM_RSQRT_STEP(a, y) rsqrtStep8(a, y)
+
+// y + y/2 * (1 - a*y*y), the residual in one rounding
+NML_AVX2_FN static inline __m256 rsqrtStep8(__m256 a, __m256 y) {
+    __m256 r = _mm256_fnmadd_ps(_mm256_mul_ps(a, y), y, _mm256_set1_ps(1.0f));
+    return _mm256_fmadd_ps(_mm256_mul_ps(y, _mm256_set1_ps(0.5f)), r, y);
+}
+
+#    include "vmath_impl.h"
+
+#endif
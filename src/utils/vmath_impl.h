@@ -0,0 +1,457 @@
+/*
+ * elementary function kernels, written once against the VM_* operations and
+ * included by vmath.c (4 lanes, simd.h) and vmath_avx2.c (8 lanes). no
+ * include guard on purpose, every includer gets its own static copy
+ *
+ * the includer defines
+ *   VM_F / VM_I                float and int32 vectors of VM_LANES lanes
+ *   VM_FN(name)                lane count suffix for every function here
+ *   VM_ATTR                    attributes on every function (target isa)
+ *   VM_BATCH                   linkage of the batch loops
+ *   VM_LOADU, VM_STOREU, VM_SET1, VM_SET1I
+ *   VM_ADD, VM_SUB, VM_MUL, VM_DIV, VM_FMADD (a * b + c), VM_MIN, VM_MAX
+ *   VM_AND, VM_OR, VM_XOR, VM_ANDNOT (~a & b)
+ *   VM_CMPLT, VM_CMPGT, VM_CMPEQ (all ones lanes), VM_SELECT (m ? a : b)
+ *   VM_ROUND (nearest, as float), VM_CVTI (nearest, as int), VM_CVTF
+ *   VM_ASI, VM_ASF             bit casts between the two vector types
+ *   VM_ADDI, VM_SUBI, VM_ANDI, VM_ORI, VM_CMPEQI, VM_SLLI, VM_SRLI, VM_SRAI
+ *   VM_RSQRT (hardware estimate), VM_RSQRT_STEP(a, y) (one newton step)
+ * and VM_NO_BATCH to leave out the array loops
+ *
+ * coefficients are the single precision minimax fits from cephes. every
+ * reduction step is written out with explicit operations, nothing is left
+ * for the compiler to contract
+ */
+
+#define VM_SIGN VM_ASF(VM_SET1I((int32_t)0x80000000))
+
+/*
+ * sin, cos, tan
+ *
+ * x = q * pi/2 + r with |r| <= pi/4. pi/2 is split into four 11 bit parts
+ * and a float tail (Cody-Waite), q * part is exact for |q| < 2^13 so r keeps
+ * its bits even right next to a zero of sin or cos. past that r loses bits,
+ * see vmath.h
+ */
+
+VM_ATTR static inline VM_F VM_FN(reduceHalfPi)(VM_F x, VM_I *q) {
+    VM_F qf = VM_ROUND(VM_MUL(x, VM_SET1(0.636619772367581343f)));
+    *q = VM_CVTI(qf);
+    VM_F r = VM_FMADD(qf, VM_SET1(-1.5703125f), x);
+    r = VM_FMADD(qf, VM_SET1(-4.837512969970703125e-4f), r);
+    r = VM_FMADD(qf, VM_SET1(-7.54953362047672271728515625e-8f), r);
+    r = VM_FMADD(qf, VM_SET1(-2.5632829192545614205300807952880859375e-12f), r);
+    r = VM_FMADD(qf, VM_SET1(-6.123234262925839272231898e-17f), r);
+    return r;
+}
+
+VM_ATTR static inline VM_F VM_FN(sinPoly)(VM_F r, VM_F z) {
+    VM_F p = VM_FMADD(z, VM_SET1(-1.9515295891e-4f), VM_SET1(8.3321608736e-3f));
+    p = VM_FMADD(p, z, VM_SET1(-1.6666654611e-1f));
+    return VM_FMADD(VM_MUL(p, z), r, r);
+}
+
+VM_ATTR static inline VM_F VM_FN(cosPoly)(VM_F z) {
+    VM_F p = VM_FMADD(z, VM_SET1(2.443315711809948e-5f),
+                      VM_SET1(-1.388731625493765e-3f));
+    p = VM_FMADD(p, z, VM_SET1(4.166664568298827e-2f));
+    VM_F head = VM_FMADD(z, VM_SET1(-0.5f), VM_SET1(1.0f));
+    return VM_FMADD(VM_MUL(p, z), z, head);
+}
+
+VM_ATTR static inline void VM_FN(sincos)(VM_F x, VM_F *sOut, VM_F *cOut) {
+    VM_I q;
+    VM_F r = VM_FN(reduceHalfPi)(x, &q);
+    VM_F z = VM_MUL(r, r);
+    VM_F s = VM_FN(sinPoly)(r, z);
+    VM_F c = VM_FN(cosPoly)(z);
+
+    // odd quadrants swap the two, sin flips sign in quadrants 2 and 3 and
+    // cos in 1 and 2 (bit 1 of q, resp. q + 1, moved to the sign bit)
+    VM_I one = VM_SET1I(1), two = VM_SET1I(2);
+    VM_F swap = VM_ASF(VM_CMPEQI(VM_ANDI(q, one), one));
+    VM_F sinSign = VM_ASF(VM_SLLI(VM_ANDI(q, two), 30));
+    VM_F cosSign = VM_ASF(VM_SLLI(VM_ANDI(VM_ADDI(q, one), two), 30));
+    *sOut = VM_XOR(VM_SELECT(swap, c, s), sinSign);
+    *cOut = VM_XOR(VM_SELECT(swap, s, c), cosSign);
+}
+
+VM_ATTR static inline VM_F VM_FN(sin)(VM_F x) {
+    VM_F s, c;
+    VM_FN(sincos)(x, &s, &c);
+    return s;
+}
+
+VM_ATTR static inline VM_F VM_FN(cos)(VM_F x) {
+    VM_F s, c;
+    VM_FN(sincos)(x, &s, &c);
+    return c;
+}
+
+// tan(q * pi/2 + r) is tan(r) for even q and -1 / tan(r) for odd q
+VM_ATTR static inline VM_F VM_FN(tan)(VM_F x) {
+    VM_I q;
+    VM_F r = VM_FN(reduceHalfPi)(x, &q);
+    VM_F z = VM_MUL(r, r);
+    VM_F p =
+        VM_FMADD(z, VM_SET1(9.38540185543e-3f), VM_SET1(3.11992232697e-3f));
+    p = VM_FMADD(p, z, VM_SET1(2.44301354525e-2f));
+    p = VM_FMADD(p, z, VM_SET1(5.34112807005e-2f));
+    p = VM_FMADD(p, z, VM_SET1(1.33387994085e-1f));
+    p = VM_FMADD(p, z, VM_SET1(3.33331568548e-1f));
+    VM_F t = VM_FMADD(VM_MUL(p, z), r, r);
+
+    VM_I one = VM_SET1I(1);
+    VM_F odd = VM_ASF(VM_CMPEQI(VM_ANDI(q, one), one));
+    VM_F inverse = VM_DIV(VM_SET1(-1.0f), t);
+    return VM_SELECT(odd, inverse, t);
+}
+
+/*
+ * atan2
+ *
+ * the ratio of the smaller to the larger magnitude is in [0, 1], above
+ * tan(pi/8) it is moved next to zero with atan(a) = pi/4 + atan((a-1)/(a+1)).
+ * the octant is put back from which magnitude was larger and the signs
+ */
+
+VM_ATTR static inline VM_F VM_FN(atanUnit)(VM_F a) {
+    VM_F upper = VM_CMPGT(a, VM_SET1(0.414213562373095f));
+    VM_F shifted =
+        VM_DIV(VM_SUB(a, VM_SET1(1.0f)), VM_ADD(a, VM_SET1(1.0f)));
+    VM_F t = VM_SELECT(upper, shifted, a);
+    VM_F base = VM_AND(upper, VM_SET1(0.785398163397448f));
+
+    VM_F z = VM_MUL(t, t);
+    VM_F p =
+        VM_FMADD(z, VM_SET1(8.05374449538e-2f), VM_SET1(-1.38776856032e-1f));
+    p = VM_FMADD(p, z, VM_SET1(1.99777106478e-1f));
+    p = VM_FMADD(p, z, VM_SET1(-3.33329491539e-1f));
+    return VM_ADD(VM_FMADD(VM_MUL(p, z), t, t), base);
+}
+
+VM_ATTR static inline VM_F VM_FN(atan2)(VM_F y, VM_F x) {
+    VM_F ax = VM_ANDNOT(VM_SIGN, x);
+    VM_F ay = VM_ANDNOT(VM_SIGN, y);
+    VM_F lo = VM_MIN(ax, ay), hi = VM_MAX(ax, ay);
+    // 0 / 0 when both are zero, those lanes take atan(0)
+    VM_F zero = VM_CMPEQ(hi, VM_SET1(0.0f));
+    VM_F a = VM_ANDNOT(zero, VM_DIV(lo, hi));
+
+    VM_F r = VM_FN(atanUnit)(a);
+    VM_F complement = VM_SUB(VM_SET1(1.57079632679489662f), r);
+    r = VM_SELECT(VM_CMPGT(ay, ax), complement, r);
+    // the sign bit of x rather than x < 0, so atan2(0, -0) is pi like libm
+    VM_F xNegative = VM_ASF(VM_SRAI(VM_ASI(x), 31));
+    r = VM_SELECT(xNegative, VM_SUB(VM_SET1(3.14159265358979324f), r), r);
+    return VM_OR(r, VM_AND(y, VM_SIGN));
+}
+
+/*
+ * exact float arithmetic for pow: the rounding error of a sum (Knuth) and of
+ * a product (Dekker, the operands split in 12 bit halves so no fma is
+ * needed). splitting overflows past 2^115, callers drop the error term then
+ */
+
+VM_ATTR static inline VM_F VM_FN(twoSum)(VM_F a, VM_F b, VM_F *err) {
+    VM_F s = VM_ADD(a, b);
+    VM_F bb = VM_SUB(s, a);
+    *err = VM_ADD(VM_SUB(a, VM_SUB(s, bb)), VM_SUB(b, bb));
+    return s;
+}
+
+VM_ATTR static inline void VM_FN(split)(VM_F a, VM_F *hi, VM_F *lo) {
+    VM_F c = VM_MUL(a, VM_SET1(4097.0f));
+    *hi = VM_SUB(c, VM_SUB(c, a));
+    *lo = VM_SUB(a, *hi);
+}
+
+VM_ATTR static inline VM_F VM_FN(twoProd)(VM_F a, VM_F b, VM_F *err) {
+    VM_F p = VM_MUL(a, b);
+    VM_F ah, al, bh, bl;
+    VM_FN(split)(a, &ah, &al);
+    VM_FN(split)(b, &bh, &bl);
+    VM_F e = VM_FMADD(ah, bh, VM_SUB(VM_SET1(0.0f), p));
+    e = VM_FMADD(ah, bl, e);
+    e = VM_FMADD(al, bh, e);
+    *err = VM_FMADD(al, bl, e);
+    return p;
+}
+
+/*
+ * exp
+ *
+ * x = n * ln2 + r with |r| <= ln2 / 2, e^r from a degree 7 polynomial and
+ * 2^n built in the exponent field. n reaches 128 just below the overflow
+ * threshold, so the scale is applied as two halves
+ */
+
+VM_ATTR static inline VM_F VM_FN(expReduce)(VM_F x, VM_F *nf) {
+    *nf = VM_ROUND(VM_MUL(x, VM_SET1(1.44269504088896341f)));
+    VM_F r = VM_FMADD(*nf, VM_SET1(-0.693359375f), x);
+    return VM_FMADD(*nf, VM_SET1(2.12194440e-4f), r);
+}
+
+// e^x from the reduced argument, x only picks the special cases
+VM_ATTR static inline VM_F VM_FN(expFinish)(VM_F x, VM_F r, VM_F nf) {
+    VM_F p = VM_FMADD(r, VM_SET1(1.9875691500e-4f), VM_SET1(1.3981999507e-3f));
+    p = VM_FMADD(p, r, VM_SET1(8.3334519073e-3f));
+    p = VM_FMADD(p, r, VM_SET1(4.1665795894e-2f));
+    p = VM_FMADD(p, r, VM_SET1(1.6666665459e-1f));
+    p = VM_FMADD(p, r, VM_SET1(5.0000001201e-1f));
+    VM_F e = VM_ADD(VM_FMADD(p, VM_MUL(r, r), r), VM_SET1(1.0f));
+
+    VM_I n = VM_CVTI(nf);
+    VM_I half = VM_SRAI(n, 1);
+    VM_I bias = VM_SET1I(127);
+    VM_F scale0 = VM_ASF(VM_SLLI(VM_ADDI(half, bias), 23));
+    VM_F scale1 = VM_ASF(VM_SLLI(VM_ADDI(VM_SUBI(n, half), bias), 23));
+    e = VM_MUL(VM_MUL(e, scale0), scale1);
+
+    // results below the smallest normal flush to zero, nan stays nan
+    e = VM_SELECT(VM_CMPGT(x, VM_SET1(88.7228391116729996f)),
+                  VM_ASF(VM_SET1I(0x7f800000)), e);
+    e = VM_ANDNOT(VM_CMPLT(x, VM_SET1(-87.3365447505531f)), e);
+    return VM_SELECT(VM_CMPEQ(x, x), e, x);
+}
+
+VM_ATTR static inline VM_F VM_FN(exp)(VM_F x) {
+    VM_F nf;
+    VM_F r = VM_FN(expReduce)(x, &nf);
+    return VM_FN(expFinish)(x, r, nf);
+}
+
+/*
+ * log
+ *
+ * x = 2^e * (1 + m) with 1 + m in [sqrt(1/2), sqrt(2)), log(1 + m) from a
+ * degree 9 polynomial in m and e * ln2 added in two parts. subnormal inputs
+ * are scaled into the normal range first
+ */
+
+VM_ATTR static inline VM_F VM_FN(logReduce)(VM_F x, VM_F *e) {
+    VM_F tiny = VM_CMPLT(x, VM_SET1(1.17549435e-38f));
+    VM_F scaled = VM_SELECT(tiny, VM_MUL(x, VM_SET1(8388608.0f)), x);
+    VM_I bits = VM_ASI(scaled);
+
+    VM_I exponent = VM_SUBI(VM_SRLI(bits, 23), VM_SET1I(126));
+    *e = VM_SUB(VM_CVTF(exponent), VM_AND(tiny, VM_SET1(23.0f)));
+    VM_F m = VM_ASF(VM_ORI(VM_ANDI(bits, VM_SET1I(0x807fffff)),
+                           VM_SET1I(0x3f000000)));
+
+    // m in [0.5, 1): below sqrt(1/2) use 2m - 1 and one less exponent
+    VM_F low = VM_CMPLT(m, VM_SET1(0.707106781186547524f));
+    *e = VM_SUB(*e, VM_AND(low, VM_SET1(1.0f)));
+    return VM_ADD(VM_SUB(m, VM_SET1(1.0f)), VM_AND(low, m));
+}
+
+// log(1 + m) - m + m^2 / 2, z = m^2
+VM_ATTR static inline VM_F VM_FN(logTail)(VM_F m, VM_F z) {
+    VM_F p = VM_FMADD(m, VM_SET1(7.0376836292e-2f), VM_SET1(-1.1514610310e-1f));
+    p = VM_FMADD(p, m, VM_SET1(1.1676998740e-1f));
+    p = VM_FMADD(p, m, VM_SET1(-1.2420140846e-1f));
+    p = VM_FMADD(p, m, VM_SET1(1.4249322787e-1f));
+    p = VM_FMADD(p, m, VM_SET1(-1.6668057665e-1f));
+    p = VM_FMADD(p, m, VM_SET1(2.0000714765e-1f));
+    p = VM_FMADD(p, m, VM_SET1(-2.4999993993e-1f));
+    p = VM_FMADD(p, m, VM_SET1(3.3333331174e-1f));
+    return VM_MUL(VM_MUL(p, m), z);
+}
+
+// log(0) = -inf, log(inf) = inf, negative and nan inputs give nan
+VM_ATTR static inline VM_F VM_FN(logSpecial)(VM_F x, VM_F result) {
+    VM_F inf = VM_ASF(VM_SET1I(0x7f800000));
+    VM_F zero = VM_CMPEQ(x, VM_SET1(0.0f));
+    result = VM_SELECT(zero, VM_XOR(inf, VM_SIGN), result);
+    result = VM_SELECT(VM_CMPEQ(x, inf), inf, result);
+    VM_F invalid = VM_OR(VM_CMPLT(x, VM_SET1(0.0f)),
+                         VM_ANDNOT(VM_CMPEQ(x, x), VM_ASF(VM_SET1I(-1))));
+    return VM_OR(result, invalid);
+}
+
+VM_ATTR static inline VM_F VM_FN(log)(VM_F x) {
+    VM_F e;
+    VM_F m = VM_FN(logReduce)(x, &e);
+    VM_F z = VM_MUL(m, m);
+    VM_F y = VM_FN(logTail)(m, z);
+    y = VM_FMADD(e, VM_SET1(-2.12194440e-4f), y);
+    y = VM_FMADD(z, VM_SET1(-0.5f), y);
+    VM_F result = VM_FMADD(e, VM_SET1(0.693359375f), VM_ADD(m, y));
+    return VM_FN(logSpecial)(x, result);
+}
+
+/*
+ * pow
+ *
+ * exp(y * log|x|). a float log is off by up to 2^-24 relative and y scales
+ * that into the exponent, so the log and the product are carried as hi + lo
+ * pairs and the low part goes into the reduced exp argument. negative x is
+ * defined for integer y only, y == 0 gives 1 for every x
+ */
+
+// log(x) = hi + lo, x >= 0
+VM_ATTR static inline VM_F VM_FN(logExt)(VM_F x, VM_F *lo) {
+    VM_F e;
+    VM_F m = VM_FN(logReduce)(x, &e);
+    VM_F zErr;
+    VM_F z = VM_FN(twoProd)(m, m, &zErr);
+    VM_F small = VM_FN(logTail)(m, z);
+    small = VM_FMADD(e, VM_SET1(-2.12194440e-4f), small);
+    small = VM_FMADD(zErr, VM_SET1(-0.5f), small);
+
+    // e * ln2_hi and z / 2 are exact. |m| >= z / 2 so the first sum can
+    // skip ordering its operands, the later ones can't
+    VM_F halfZ = VM_MUL(z, VM_SET1(-0.5f));
+    VM_F s = VM_ADD(m, halfZ);
+    VM_F err1 = VM_SUB(halfZ, VM_SUB(s, m));
+    VM_F err2, err3;
+    s = VM_FN(twoSum)(s, small, &err2);
+    VM_F hi = VM_FN(twoSum)(VM_MUL(e, VM_SET1(0.693359375f)), s, &err3);
+    *lo = VM_ADD(VM_ADD(err1, err2), err3);
+    return VM_FN(logSpecial)(x, hi);
+}
+
+VM_ATTR static inline VM_F VM_FN(pow)(VM_F x, VM_F y) {
+    VM_F ax = VM_ANDNOT(VM_SIGN, x);
+    VM_F logLo, prodErr;
+    VM_F logHi = VM_FN(logExt)(ax, &logLo);
+    VM_F t = VM_FN(twoProd)(y, logHi, &prodErr);
+    VM_F tLo = VM_FMADD(y, logLo, prodErr);
+    // no correction for infinite products or overflowed splits
+    VM_F finite = VM_AND(VM_CMPLT(VM_ANDNOT(VM_SIGN, t),
+                                  VM_ASF(VM_SET1I(0x7f800000))),
+                         VM_CMPEQ(tLo, tLo));
+    tLo = VM_AND(finite, tLo);
+
+    VM_F nf;
+    VM_F red = VM_ADD(VM_FN(expReduce)(t, &nf), tLo);
+    VM_F r = VM_FN(expFinish)(t, red, nf);
+
+    VM_F integer = VM_CMPEQ(VM_ROUND(y), y);
+    // integers past 2^24 are all even, the int conversion may saturate there
+    VM_I one = VM_SET1I(1);
+    VM_F odd = VM_AND(VM_ASF(VM_CMPEQI(VM_ANDI(VM_CVTI(y), one), one)),
+                      VM_CMPLT(VM_ANDNOT(VM_SIGN, y), VM_SET1(16777216.0f)));
+    VM_F negative = VM_CMPLT(x, VM_SET1(0.0f));
+    r = VM_XOR(r, VM_AND(VM_AND(negative, odd), VM_SIGN));
+    r = VM_OR(r, VM_ANDNOT(integer, negative));
+    return VM_SELECT(VM_CMPEQ(y, VM_SET1(0.0f)), VM_SET1(1.0f), r);
+}
+
+/*
+ * rsqrt, sqrt
+ *
+ * the hardware estimate followed by steps newton steps. a step needs
+ * x * estimate to be finite, zero and infinite inputs (and subnormal ones
+ * where the estimate flushes them) keep the estimate instead, inf or 0.
+ * sqrt is x * rsqrt(x) and returns zero and infinite inputs unchanged
+ */
+
+VM_ATTR static inline VM_F VM_FN(rsqrtSteps)(VM_F x, VM_F y0, int steps,
+                                             VM_F *ok) {
+    *ok = VM_CMPLT(VM_ANDNOT(VM_SIGN, VM_MUL(x, y0)),
+                   VM_ASF(VM_SET1I(0x7f800000)));
+    VM_F y = y0;
+    for (int k = 0; k < steps; k++) {
+        y = VM_RSQRT_STEP(x, y);
+    }
+    return y;
+}
+
+#define VM_DEFINE_RSQRT(suffix, steps)                                       \
+    VM_ATTR static inline VM_F VM_FN(rsqrt##suffix)(VM_F x) {                \
+        VM_F ok, y0 = VM_RSQRT(x);                                           \
+        if (steps == 0)                                                      \
+            return y0;                                                       \
+        VM_F y = VM_FN(rsqrtSteps)(x, y0, steps, &ok);                       \
+        return VM_SELECT(ok, y, y0);                                         \
+    }                                                                        \
+    VM_ATTR static inline VM_F VM_FN(sqrt##suffix)(VM_F x) {                 \
+        VM_F ok, y0 = VM_RSQRT(x);                                           \
+        VM_F s = VM_MUL(x, VM_FN(rsqrtSteps)(x, y0, steps, &ok));            \
+        /* negative inputs keep the nan of the estimate */                   \
+        return VM_SELECT(ok, s, VM_SELECT(VM_CMPEQ(y0, y0), x, y0));         \
+    }
+
+VM_DEFINE_RSQRT(Fast, 0)
+VM_DEFINE_RSQRT(Refined, 1)
+VM_DEFINE_RSQRT(Precise, 2)
+#undef VM_DEFINE_RSQRT
+
+#if !defined(VM_NO_BATCH)
+
+/*
+ * array loops, the tail goes through a zero padded buffer so it runs the
+ * same lane code as the body
+ */
+
+#define VM_DEFINE_UNARY_BATCH(name)                                          \
+    VM_BATCH VM_ATTR void VM_FN(name##Batch)(const float *in, float *out,    \
+                                             size_t n) {                     \
+        size_t i = 0;                                                        \
+        for (; i + VM_LANES <= n; i += VM_LANES) {                           \
+            VM_STOREU(&out[i], VM_FN(name)(VM_LOADU(&in[i])));               \
+        }                                                                    \
+        if (i < n) {                                                         \
+            float buf[VM_LANES] = {0};                                       \
+            memcpy(buf, &in[i], (n - i) * sizeof(float));                    \
+            VM_STOREU(buf, VM_FN(name)(VM_LOADU(buf)));                      \
+            memcpy(&out[i], buf, (n - i) * sizeof(float));                   \
+        }                                                                    \
+    }
+
+#define VM_DEFINE_BINARY_BATCH(name)                                         \
+    VM_BATCH VM_ATTR void VM_FN(name##Batch)(const float *a, const float *b, \
+                                             float *out, size_t n) {         \
+        size_t i = 0;                                                        \
+        for (; i + VM_LANES <= n; i += VM_LANES) {                           \
+            VM_STOREU(&out[i],                                               \
+                      VM_FN(name)(VM_LOADU(&a[i]), VM_LOADU(&b[i])));        \
+        }                                                                    \
+        if (i < n) {                                                         \
+            float bufA[VM_LANES] = {0}, bufB[VM_LANES] = {0};                \
+            memcpy(bufA, &a[i], (n - i) * sizeof(float));                    \
+            memcpy(bufB, &b[i], (n - i) * sizeof(float));                    \
+            VM_STOREU(bufA, VM_FN(name)(VM_LOADU(bufA), VM_LOADU(bufB)));    \
+            memcpy(&out[i], bufA, (n - i) * sizeof(float));                  \
+        }                                                                    \
+    }
+
+VM_DEFINE_UNARY_BATCH(sin)
+VM_DEFINE_UNARY_BATCH(cos)
+VM_DEFINE_UNARY_BATCH(tan)
+VM_DEFINE_UNARY_BATCH(exp)
+VM_DEFINE_UNARY_BATCH(log)
+VM_DEFINE_BINARY_BATCH(atan2)
+VM_DEFINE_BINARY_BATCH(pow)
+VM_DEFINE_UNARY_BATCH(rsqrtFast)
+VM_DEFINE_UNARY_BATCH(rsqrtRefined)
+VM_DEFINE_UNARY_BATCH(rsqrtPrecise)
+VM_DEFINE_UNARY_BATCH(sqrtFast)
+VM_DEFINE_UNARY_BATCH(sqrtRefined)
+VM_DEFINE_UNARY_BATCH(sqrtPrecise)
+
+VM_BATCH VM_ATTR void VM_FN(sincosBatch)(const float *in, float *sOut,
+                                         float *cOut, size_t n) {
+    size_t i = 0;
+    VM_F s, c;
+    for (; i + VM_LANES <= n; i += VM_LANES) {
+        VM_FN(sincos)(VM_LOADU(&in[i]), &s, &c);
+        VM_STOREU(&sOut[i], s);
+        VM_STOREU(&cOut[i], c);
+    }
+    if (i < n) {
+        float bufS[VM_LANES] = {0}, bufC[VM_LANES];
+        memcpy(bufS, &in[i], (n - i) * sizeof(float));
+        VM_FN(sincos)(VM_LOADU(bufS), &s, &c);
+        VM_STOREU(bufS, s);
+        VM_STOREU(bufC, c);
+        memcpy(&sOut[i], bufS, (n - i) * sizeof(float));
+        memcpy(&cOut[i], bufC, (n - i) * sizeof(float));
+    }
+}
+
+#    undef VM_DEFINE_UNARY_BATCH
+#    undef VM_DEFINE_BINARY_BATCH
+#endif
+#undef VM_SIGN
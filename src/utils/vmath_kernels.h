@@ -0,0 +1,55 @@
+#ifndef __VMATH_KERNELS_H__
+#define __VMATH_KERNELS_H__
+
+#include "utils/cpu.h"
+#include <stddef.h>
+
+/*
+ * internal kernel table for the float array functions of vmath.h, the
+ * same lane code instantiated 4 wide (sse2/neon) and 8 wide (avx2)
+ */
+
+typedef void (*vm_unary_fn)(const float *in, float *out, size_t n);
+typedef void (*vm_binary_fn)(const float *a, const float *b, float *out,
+                             size_t n);
+typedef void (*vm_sincos_fn)(const float *in, float *sOut, float *cOut,
+                             size_t n);
+
+typedef struct VMathKernels {
+    vm_unary_fn sin;
+    vm_unary_fn cos;
+    vm_unary_fn tan;
+    vm_unary_fn exp;
+    vm_unary_fn log;
+    vm_sincos_fn sincos;
+    vm_binary_fn atan2;
+    vm_binary_fn pow;
+    // indexed by the NML_SQRT_* accuracy tier
+    vm_unary_fn rsqrt[3];
+    vm_unary_fn sqrt[3];
+} VMathKernels;
+
+// selected once at load time
+NML_HIDDEN extern VMathKernels vmath_kernels;
+
+#if defined(NML_DISPATCH_AVX2)
+NML_HIDDEN void sinBatch8(const float *in, float *out, size_t n);
+NML_HIDDEN void cosBatch8(const float *in, float *out, size_t n);
+NML_HIDDEN void tanBatch8(const float *in, float *out, size_t n);
+NML_HIDDEN void expBatch8(const float *in, float *out, size_t n);
+NML_HIDDEN void logBatch8(const float *in, float *out, size_t n);
+NML_HIDDEN void sincosBatch8(const float *in, float *sOut, float *cOut,
+                             size_t n);
+NML_HIDDEN void atan2Batch8(const float *y, const float *x, float *out,
+                            size_t n);
+NML_HIDDEN void powBatch8(const float *x, const float *y, float *out,
+                          size_t n);
+NML_HIDDEN void rsqrtFastBatch8(const float *in, float *out, size_t n);
+NML_HIDDEN void rsqrtRefinedBatch8(const float *in, float *out, size_t n);
+NML_HIDDEN void rsqrtPreciseBatch8(const float *in, float *out, size_t n);
+NML_HIDDEN void sqrtFastBatch8(const float *in, float *out, size_t n);
+NML_HIDDEN void sqrtRefinedBatch8(const float *in, float *out, size_t n);
+NML_HIDDEN void sqrtPreciseBatch8(const float *in, float *out, size_t n);
+#endif
+
+#endif // !__VMATH_KERNELS_H__
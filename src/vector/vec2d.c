@@ -1,115 +1,61 @@
 #include "vector/vec2d.h"
+#include "vector/vec2d_inline.h"
 #include "utils/math.h"
 #include "utils/errors.h"
-
-int vec2Init(nml_t x, nml_t y, Vec2 *vOut) {
-    vOut->x = x;
-    vOut->y = y;
-    return NML_SUCCESS;
-}
-
-int vec2InitZero(Vec2 *vOut) {
-    return vec2Init(0, 0, vOut);
-}
-
-nml_t vec2Length(Vec2 *vec) {
-    return sqrt(Sqr(vec->x) + Sqr(vec->y));
-}
-
-nml_t vec2LengthSqr(Vec2 *vec) {
-    return Sqr(vec->x) + Sqr(vec->y);
-}
-
-int vec2Normalize(Vec2 *vec, Vec2 *vOut) {
-    if (vec2IsZero(vec))
-        return NML_EZERODIV;
-    nml_t l = 1.0 / vec2Length(vec);
-    vOut->x = vec->x * l;
-    vOut->y = vec->y * l;
-    return NML_SUCCESS;
-}
-
-nml_t vec2Dot(Vec2 *vec1, Vec2 *vec2) {
-    return (vec1->x * vec2->x + vec1->y * vec2->y);
-}
-
-nml_t vec2Cross(Vec2 *vec1, Vec2 *vec2) {
-    return (vec1->x * vec2->y - vec1->y * vec2->x);
-}
-
-int vec2Add(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut) {
-    vOut->x = vec1->x + vec2->x;
-    vOut->y = vec1->y + vec2->y;
-    return NML_SUCCESS;
-}
-
-int vec2Sub(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut) {
-    vOut->x = vec1->x - vec2->x;
-    vOut->y = vec1->y - vec2->y;
-    return NML_SUCCESS;
-}
-
-int vec2Mul(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut) {
-    if (fabs(vec2->x) < kEPSILON || fabs(vec2->y) < kEPSILON)
-        return NML_EZERODIV;
-
-    vOut->x = vec1->x * vec2->x;
-    vOut->y = vec1->y * vec2->y;
-    return NML_SUCCESS;
-}
-
-int vec2Div(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut) {
-    if (fabs(vec2->x) < kEPSILON || fabs(vec2->y) < kEPSILON)
-        return NML_EZERODIV;
-
-    vOut->x = vec1->x / vec2->x;
-    vOut->y = vec1->y / vec2->y;
-    return NML_SUCCESS;
-}
-
-int vec2Scale(Vec2 *vec, nml_t s, Vec2 *vOut) {
-    vOut->x = vec->x * s;
-    vOut->y = vec->y * s;
-    return NML_SUCCESS;
-}
-
-int vec2Negate(Vec2 *vec, Vec2 *vOut) {
-    vOut->x = -vec->x;
-    vOut->y = -vec->y;
-    return NML_SUCCESS;
-}
-
-int vec2Project(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut) {
-    nml_t lenSqr = vec2LengthSqr(vec2);
-    if (lenSqr < kEPSILON)
-        return NML_EZERODIV;
-
-    nml_t scaler = vec2Dot(vec1, vec2) / lenSqr;
-    vOut->x = vec2->x * scaler;
-    vOut->y = vec2->y * scaler;
-    return NML_SUCCESS;
-}
-
-int vec2Reject(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut) {
-    nml_t lenSqr = vec2LengthSqr(vec2);
-    if (lenSqr < kEPSILON)
-        return NML_EZERODIV;
-
-    nml_t dot = vec2Dot(vec1, vec2);
-    nml_t scaler = dot / lenSqr;
-
-    vOut->x = vec1->x - (scaler * vec2->x);
-    vOut->y = vec1->y - (scaler * vec2->y);
-    return NML_SUCCESS;
-}
-
-int vec2Reflect(Vec2 *vec1, Vec2 *vec2, Vec2 *vOut) {
-    nml_t lenSqr = vec2LengthSqr(vec2);
-    if (lenSqr < kEPSILON)
-        return NML_EZERODIV;
-
-    nml_t scaler = 2.0 * vec2Dot(vec1, vec2) / lenSqr;
-    vOut->x = vec1->x - scaler * vec2->x;
-    vOut->y = vec1->y - scaler * vec2->y;
+#include "utils/simd.h"
+
+int vec2NormalizeBatch(const Vec2 *vecs,
+                       Vec2 *vOut,
+                       size_t n,
+                       const Vec2 *fallback,
+                       uint8_t *valid) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)vecs, vOut);
+
+    Vec2 fb = {0};
+    if (fallback)
+        fb = *fallback;
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    // four vectors per step deinterleaved into lanes, short ones are blended
+    // with the fallback instead of branching
+    simd_f32x4_t eps = simd_set1_f32(kEPSILON * kEPSILON);
+    simd_f32x4_t fx = simd_set1_f32(fb.x);
+    simd_f32x4_t fy = simd_set1_f32(fb.y);
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x, y;
+        simd_load2_f32(vecs[i].elems, &x, &y);
+        simd_f32x4_t lenSqr = simd_mul_f32(x, x);
+        lenSqr = simd_fmadd_f32(y, y, lenSqr);
+
+        simd_f32x4_t ok = simd_cmpge_f32(lenSqr, eps);
+        simd_f32x4_t inv = simd_rsqrt_f32(lenSqr);
+        inv = simd_rsqrt_step_f32(lenSqr, inv);
+        inv = simd_rsqrt_step_f32(lenSqr, inv);
+        x = simd_select_f32(ok, simd_mul_f32(x, inv), fx);
+        y = simd_select_f32(ok, simd_mul_f32(y, inv), fy);
+        simd_store2_f32(vOut[i].elems, x, y);
+        if (valid) {
+            int mask = simd_movemask_f32(ok);
+            for (int k = 0; k < 4; k++)
+                valid[i + k] = (uint8_t)(mask >> k & 1);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        Vec2 v = vecs[i];
+        nml_t lenSqr = Sqr(v.x) + Sqr(v.y);
+        int ok = lenSqr >= kEPSILON * kEPSILON;
+        if (ok) {
+            nml_t inv = 1.0 / sqrt(lenSqr);
+            vOut[i].x = v.x * inv;
+            vOut[i].y = v.y * inv;
+        } else {
+            vOut[i] = fb;
+        }
+        if (valid)
+            valid[i] = (uint8_t)ok;
+    }
     return NML_SUCCESS;
 }
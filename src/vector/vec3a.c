@@ -0,0 +1,54 @@
+#include "vector/vec3a.h"
+#include "vector/vec3a_inline.h"
+#include "utils/errors.h"
+#include "utils/math.h"
+#include "utils/simd.h"
+
+int vec3AFromVec3Array(const Vec3 *vecs, Vec3A *vOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)vecs, vOut);
+
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    // four packed vectors deinterleave into x y z lanes, transposing them
+    // against a zero row gives four padded vectors back
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x, y, z, w = simd_set1_f32(0.0f);
+        simd_load3_f32(vecs[i].elems, &x, &y, &z);
+        simd_transpose4_f32(x, y, z, w);
+        simd_store_f32(vOut[i].elems, x);
+        simd_store_f32(vOut[i + 1].elems, y);
+        simd_store_f32(vOut[i + 2].elems, z);
+        simd_store_f32(vOut[i + 3].elems, w);
+    }
+#endif
+    for (; i < n; i++) {
+        vec3AInit(vecs[i].x, vecs[i].y, vecs[i].z, &vOut[i]);
+    }
+    return NML_SUCCESS;
+}
+
+int vec3AToVec3Array(const Vec3A *vecs, Vec3 *vOut, size_t n) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)vecs, vOut);
+
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x = simd_load_f32(vecs[i].elems);
+        simd_f32x4_t y = simd_load_f32(vecs[i + 1].elems);
+        simd_f32x4_t z = simd_load_f32(vecs[i + 2].elems);
+        simd_f32x4_t w = simd_load_f32(vecs[i + 3].elems);
+        simd_transpose4_f32(x, y, z, w);
+        simd_store3_f32(vOut[i].elems, x, y, z);
+    }
+#endif
+    for (; i < n; i++) {
+        vOut[i].x = vecs[i].x;
+        vOut[i].y = vecs[i].y;
+        vOut[i].z = vecs[i].z;
+    }
+    return NML_SUCCESS;
+}
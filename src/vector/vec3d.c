@@ -1,128 +1,65 @@
 #include "vector/vec3d.h"
+#include "vector/vec3d_inline.h"
 #include "utils/math.h"
 #include "utils/errors.h"
-
-int vec3Init(nml_t x, nml_t y, nml_t z, Vec3 *vOut) {
-    vOut->x = x;
-    vOut->y = y;
-    vOut->z = z;
-    return NML_SUCCESS;
-}
-
-int vec3InitZero(Vec3 *vOut) {
-    return vec3Init(0.0, 0.0, 0.0, vOut);
-}
-
-nml_t vec3Length(Vec3 *vec) {
-    return sqrt(Sqr(vec->x) + Sqr(vec->y) + Sqr(vec->z));
-}
-
-nml_t vec3LengthSqr(Vec3 *vec) {
-    return Sqr(vec->x) + Sqr(vec->y) + Sqr(vec->z);
-}
-
-int vec3Normalize(Vec3 *vec, Vec3 *vOut) {
-    if (vec3IsZero(vec))
-        return NML_EZERODIV;
-    nml_t l = 1.0 / vec3Length(vec);
-    vOut->x = vec->x * l;
-    vOut->y = vec->y * l;
-    vOut->z = vec->z * l;
-    return NML_SUCCESS;
-}
-
-nml_t vec3Dot(Vec3 *vec1, Vec3 *vec2) {
-    return (vec1->x * vec2->x + vec1->y * vec2->y + vec1->z * vec2->z);
-}
-
-int vec3Cross(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut) {
-    vOut->x = (vec1->y * vec2->z) - (vec1->z * vec2->y);
-    vOut->y = (vec1->z * vec2->x) - (vec1->x * vec2->z);
-    vOut->z = (vec1->x * vec2->y) - (vec1->y * vec2->x);
-    return NML_SUCCESS;
-}
-
-int vec3Add(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut) {
-    vOut->x = vec1->x + vec2->x;
-    vOut->y = vec1->y + vec2->y;
-    vOut->z = vec1->z + vec2->z;
-    return NML_SUCCESS;
-}
-
-int vec3Sub(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut) {
-    vOut->x = vec1->x - vec2->x;
-    vOut->y = vec1->y - vec2->y;
-    vOut->z = vec1->z - vec2->z;
-    return NML_SUCCESS;
-}
-
-int vec3Mul(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut) {
-    vOut->x = vec1->x * vec2->x;
-    vOut->y = vec1->y * vec2->y;
-    vOut->z = vec1->z * vec2->z;
-    return NML_SUCCESS;
-}
-
-int vec3Div(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut) {
-    if (fabs(vec2->x) < kEPSILON || fabs(vec2->y) < kEPSILON ||
-        fabs(vec2->z) < kEPSILON) {
-        return NML_EZERODIV;
+#include "utils/simd.h"
+
+int vec3NormalizeBatch(const Vec3 *vecs,
+                       Vec3 *vOut,
+                       size_t n,
+                       const Vec3 *fallback,
+                       uint8_t *valid) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)vecs, vOut);
+
+    Vec3 fb = {0};
+    if (fallback)
+        fb = *fallback;
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    // four vectors per step deinterleaved into lanes, short ones are blended
+    // with the fallback instead of branching
+    simd_f32x4_t eps = simd_set1_f32(kEPSILON * kEPSILON);
+    simd_f32x4_t fx = simd_set1_f32(fb.x);
+    simd_f32x4_t fy = simd_set1_f32(fb.y);
+    simd_f32x4_t fz = simd_set1_f32(fb.z);
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x, y, z;
+        simd_load3_f32(vecs[i].elems, &x, &y, &z);
+        simd_f32x4_t lenSqr = simd_mul_f32(x, x);
+        lenSqr = simd_fmadd_f32(y, y, lenSqr);
+        lenSqr = simd_fmadd_f32(z, z, lenSqr);
+
+        simd_f32x4_t ok = simd_cmpge_f32(lenSqr, eps);
+        simd_f32x4_t inv = simd_rsqrt_f32(lenSqr);
+        inv = simd_rsqrt_step_f32(lenSqr, inv);
+        inv = simd_rsqrt_step_f32(lenSqr, inv);
+        x = simd_select_f32(ok, simd_mul_f32(x, inv), fx);
+        y = simd_select_f32(ok, simd_mul_f32(y, inv), fy);
+        z = simd_select_f32(ok, simd_mul_f32(z, inv), fz);
+        simd_store3_f32(vOut[i].elems, x, y, z);
+        if (valid) {
+            int mask = simd_movemask_f32(ok);
+            for (int k = 0; k < 4; k++)
+                valid[i + k] = (uint8_t)(mask >> k & 1);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        Vec3 v = vecs[i];
+        nml_t lenSqr = Sqr(v.x) + Sqr(v.y) + Sqr(v.z);
+        int ok = lenSqr >= kEPSILON * kEPSILON;
+        if (ok) {
+            nml_t inv = 1.0 / sqrt(lenSqr);
+            vOut[i].x = v.x * inv;
+            vOut[i].y = v.y * inv;
+            vOut[i].z = v.z * inv;
+        } else {
+            vOut[i] = fb;
+        }
+        if (valid)
+            valid[i] = (uint8_t)ok;
     }
-
-    vOut->x = vec1->x / vec2->x;
-    vOut->y = vec1->y / vec2->y;
-    vOut->z = vec1->z / vec2->z;
-    return NML_SUCCESS;
-}
-
-int vec3Scale(Vec3 *vec, nml_t s, Vec3 *vOut) {
-    vOut->x = vec->x * s;
-    vOut->y = vec->y * s;
-    vOut->z = vec->z * s;
-    return NML_SUCCESS;
-}
-
-int vec3Negate(Vec3 *vec, Vec3 *vOut) {
-    vOut->x = -vec->x;
-    vOut->y = -vec->y;
-    vOut->z = -vec->z;
-    return NML_SUCCESS;
-}
-
-int vec3Project(Vec3 *vec1, Vec3 *vec3, Vec3 *vOut) {
-    nml_t lenSqr = vec3LengthSqr(vec3);
-    if (lenSqr < kEPSILON)
-        return NML_EZERODIV;
-
-    nml_t scaler = vec3Dot(vec1, vec3) / lenSqr;
-    vOut->x = vec3->x * scaler;
-    vOut->y = vec3->y * scaler;
-    vOut->z = vec3->z * scaler;
-    return NML_SUCCESS;
-}
-
-int vec3Reject(Vec3 *vec1, Vec3 *vec3, Vec3 *vOut) {
-    nml_t lenSqr = vec3LengthSqr(vec3);
-    if (lenSqr < kEPSILON)
-        return NML_EZERODIV;
-
-    nml_t dot = vec3Dot(vec1, vec3);
-    nml_t scaler = dot / lenSqr;
-
-    vOut->x = vec1->x - (scaler * vec3->x);
-    vOut->y = vec1->y - (scaler * vec3->y);
-    vOut->z = vec1->z - (scaler * vec3->z);
-    return NML_SUCCESS;
-}
-
-int vec3Reflect(Vec3 *vec1, Vec3 *vec2, Vec3 *vOut) {
-    nml_t lenSqr = vec3LengthSqr(vec2);
-    if (lenSqr < kEPSILON)
-        return NML_EZERODIV;
-
-    nml_t scaler = 2.0 * vec3Dot(vec1, vec2) / lenSqr;
-    vOut->x = vec1->x - scaler * vec2->x;
-    vOut->y = vec1->y - scaler * vec2->y;
-    vOut->z = vec1->z - scaler * vec2->z;
     return NML_SUCCESS;
 }
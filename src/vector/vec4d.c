@@ -1,141 +1,69 @@
 #include "vector/vec4d.h"
+#include "vector/vec4d_inline.h"
 #include "utils/math.h"
 #include "utils/errors.h"
-
-int vec4Init(nml_t x, nml_t y, nml_t z, nml_t w, Vec4 *vOut) {
-    vOut->x = x;
-    vOut->y = y;
-    vOut->z = z;
-    vOut->w = w;
-    return NML_SUCCESS;
-}
-
-int vec4InitZero(Vec4 *vOut) {
-    return vec4Init(0.0, 0.0, 0.0, 0.0, vOut);
-}
-
-nml_t vec4Length(Vec4 *vec) {
-    return sqrt(Sqr(vec->x) + Sqr(vec->y) + Sqr(vec->z) + Sqr(vec->w));
-}
-
-nml_t vec4LengthSqr(Vec4 *vec) {
-    return Sqr(vec->x) + Sqr(vec->y) + Sqr(vec->z) + Sqr(vec->w);
-}
-
-int vec4Normalize(Vec4 *vec, Vec4 *vOut) {
-    if (vec4IsZero(vec))
-        return NML_EZERODIV;
-
-    nml_t l = vec4Length(vec);
-    vOut->x = vec->x / l;
-    vOut->y = vec->y / l;
-    vOut->z = vec->z / l;
-    vOut->w = vec->w / l;
-    return NML_SUCCESS;
-}
-
-nml_t vec4Dot(Vec4 *vec1, Vec4 *vec2) {
-    return (vec1->x * vec2->x + vec1->y * vec2->y + vec1->z * vec2->z + vec1->w * vec2->w);
-}
-
-int vec4Cross(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
-    vOut->x = (vec1->y * vec2->z) - (vec1->z * vec2->y);
-    vOut->y = (vec1->z * vec2->x) - (vec1->x * vec2->z);
-    vOut->z = (vec1->x * vec2->y) - (vec1->y * vec2->x);
-    vOut->w = 0.0f;
-    return NML_SUCCESS;
-}
-
-int vec4Add(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
-    vOut->x = vec1->x + vec2->x;
-    vOut->y = vec1->y + vec2->y;
-    vOut->z = vec1->z + vec2->z;
-    vOut->w = vec1->w + vec2->w;
-    return NML_SUCCESS;
-}
-
-int vec4Sub(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
-    vOut->x = vec1->x - vec2->x;
-    vOut->y = vec1->y - vec2->y;
-    vOut->z = vec1->z - vec2->z;
-    vOut->w = vec1->w - vec2->w;
-    return NML_SUCCESS;
-}
-
-int vec4Mul(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
-    vOut->x = vec1->x * vec2->x;
-    vOut->y = vec1->y * vec2->y;
-    vOut->z = vec1->z * vec2->z;
-    vOut->w = vec1->w * vec2->w;
-    return NML_SUCCESS;
-}
-
-int vec4Div(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
-    if (fabs(vec2->x) < kEPSILON || fabs(vec2->y) < kEPSILON || fabs(vec2->z) < kEPSILON ||
-        fabs(vec2->w) < kEPSILON) {
-        return NML_EZERODIV;
+#include "utils/simd.h"
+
+int vec4NormalizeBatch(const Vec4 *vecs,
+                       Vec4 *vOut,
+                       size_t n,
+                       const Vec4 *fallback,
+                       uint8_t *valid) {
+    if (n == 0)
+        return NML_SUCCESS;
+    is_null((void *)vecs, vOut);
+
+    Vec4 fb = {0};
+    if (fallback)
+        fb = *fallback;
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    // four vectors per step deinterleaved into lanes, short ones are blended
+    // with the fallback instead of branching
+    simd_f32x4_t eps = simd_set1_f32(kEPSILON * kEPSILON);
+    simd_f32x4_t fx = simd_set1_f32(fb.x);
+    simd_f32x4_t fy = simd_set1_f32(fb.y);
+    simd_f32x4_t fz = simd_set1_f32(fb.z);
+    simd_f32x4_t fw = simd_set1_f32(fb.w);
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x, y, z, w;
+        simd_load4_f32(vecs[i].elems, &x, &y, &z, &w);
+        simd_f32x4_t lenSqr = simd_mul_f32(x, x);
+        lenSqr = simd_fmadd_f32(y, y, lenSqr);
+        lenSqr = simd_fmadd_f32(z, z, lenSqr);
+        lenSqr = simd_fmadd_f32(w, w, lenSqr);
+
+        simd_f32x4_t ok = simd_cmpge_f32(lenSqr, eps);
+        simd_f32x4_t inv = simd_rsqrt_f32(lenSqr);
+        inv = simd_rsqrt_step_f32(lenSqr, inv);
+        inv = simd_rsqrt_step_f32(lenSqr, inv);
+        x = simd_select_f32(ok, simd_mul_f32(x, inv), fx);
+        y = simd_select_f32(ok, simd_mul_f32(y, inv), fy);
+        z = simd_select_f32(ok, simd_mul_f32(z, inv), fz);
+        w = simd_select_f32(ok, simd_mul_f32(w, inv), fw);
+        simd_store4_f32(vOut[i].elems, x, y, z, w);
+        if (valid) {
+            int mask = simd_movemask_f32(ok);
+            for (int k = 0; k < 4; k++)
+                valid[i + k] = (uint8_t)(mask >> k & 1);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        Vec4 v = vecs[i];
+        nml_t lenSqr = Sqr(v.x) + Sqr(v.y) + Sqr(v.z) + Sqr(v.w);
+        int ok = lenSqr >= kEPSILON * kEPSILON;
+        if (ok) {
+            nml_t inv = 1.0 / sqrt(lenSqr);
+            vOut[i].x = v.x * inv;
+            vOut[i].y = v.y * inv;
+            vOut[i].z = v.z * inv;
+            vOut[i].w = v.w * inv;
+        } else {
+            vOut[i] = fb;
+        }
+        if (valid)
+            valid[i] = (uint8_t)ok;
     }
-
-    vOut->x = vec1->x / vec2->x;
-    vOut->y = vec1->y / vec2->y;
-    vOut->z = vec1->z / vec2->z;
-    vOut->w = vec1->w / vec2->w;
-    return NML_SUCCESS;
-}
-
-int vec4Scale(Vec4 *vec, nml_t s, Vec4 *vOut) {
-    vOut->x = vec->x * s;
-    vOut->y = vec->y * s;
-    vOut->z = vec->z * s;
-    vOut->w = vec->w * s;
-    return NML_SUCCESS;
-}
-
-int vec4Negate(Vec4 *vec, Vec4 *vOut) {
-    vOut->x = -vec->x;
-    vOut->y = -vec->y;
-    vOut->z = -vec->z;
-    vOut->w = -vec->w;
-    return NML_SUCCESS;
-}
-
-int vec4Project(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
-    nml_t lenSqr = vec4LengthSqr(vec2);
-    if (lenSqr < kEPSILON)
-        return NML_EZERODIV;
-
-    nml_t scaler = vec4Dot(vec1, vec2) / lenSqr;
-    vOut->x = vec2->x * scaler;
-    vOut->y = vec2->y * scaler;
-    vOut->z = vec2->z * scaler;
-    vOut->w = vec2->w * scaler;
-    return NML_SUCCESS;
-}
-
-int vec4Reject(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
-    nml_t lenSqr = vec4LengthSqr(vec2);
-    if (lenSqr < kEPSILON)
-        return NML_EZERODIV;
-
-    nml_t dot = vec4Dot(vec1, vec2);
-    nml_t scaler = dot / lenSqr;
-
-    vOut->x = vec1->x - (scaler * vec2->x);
-    vOut->y = vec1->y - (scaler * vec2->y);
-    vOut->z = vec1->z - (scaler * vec2->z);
-    vOut->w = vec1->w - (scaler * vec2->w);
-    return NML_SUCCESS;
-}
-
-int vec4Reflect(Vec4 *vec1, Vec4 *vec2, Vec4 *vOut) {
-    nml_t lenSqr = vec4LengthSqr(vec2);
-    if (lenSqr < kEPSILON)
-        return NML_EZERODIV;
-
-    nml_t scaler = 2.0 * vec4Dot(vec1, vec2) / lenSqr;
-    vOut->x = vec1->x - scaler * vec2->x;
-    vOut->y = vec1->y - scaler * vec2->y;
-    vOut->z = vec1->z - scaler * vec2->z;
-    vOut->w = vec1->w - scaler * vec2->w;
     return NML_SUCCESS;
 }
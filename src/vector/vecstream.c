@@ -0,0 +1,553 @@
+#include "vector/vecstream.h"
+#include "utils/errors.h"
+#include "utils/math.h"
+#include "utils/memory.h"
+#include "utils/simd.h"
+#include <string.h>
+
+/*
+ * allocation
+ */
+
+// components share one block, each padded to the alignment boundary
+static size_t componentStride(size_t count) {
+    size_t per = NML_ALIGNMENT / sizeof(nml_t);
+    return (count + per - 1) / per * per;
+}
+
+static nml_t *allocComponents(size_t count, int components) {
+    size_t bytes = componentStride(count) * components * sizeof(nml_t);
+    nml_t *block = alignedAlloc(NML_ALIGNMENT, bytes);
+    if (block)
+        memset(block, 0, bytes);
+    return block;
+}
+
+int vec3StreamInit(size_t count, Vec3Stream *sOut) {
+    is_null(sOut);
+    nml_t *block = allocComponents(count, 3);
+    if (!block)
+        return NML_ENOMEM;
+
+    size_t stride = componentStride(count);
+    sOut->x = block;
+    sOut->y = block + stride;
+    sOut->z = block + stride * 2;
+    sOut->count = count;
+    return NML_SUCCESS;
+}
+
+void vec3StreamFree(Vec3Stream *stream) {
+    if (!stream)
+        return;
+    alignedFree(stream->x);
+    memset(stream, 0, sizeof(*stream));
+}
+
+int vec4StreamInit(size_t count, Vec4Stream *sOut) {
+    is_null(sOut);
+    nml_t *block = allocComponents(count, 4);
+    if (!block)
+        return NML_ENOMEM;
+
+    size_t stride = componentStride(count);
+    sOut->x = block;
+    sOut->y = block + stride;
+    sOut->z = block + stride * 2;
+    sOut->w = block + stride * 3;
+    sOut->count = count;
+    return NML_SUCCESS;
+}
+
+void vec4StreamFree(Vec4Stream *stream) {
+    if (!stream)
+        return;
+    alignedFree(stream->x);
+    memset(stream, 0, sizeof(*stream));
+}
+
+/*
+ * AoS <-> SoA
+ */
+
+int vec3StreamFromAoS(const Vec3 *vecs, size_t count, Vec3Stream *sOut) {
+    is_null((void *)vecs, sOut);
+    size_t n = MIN(count, sOut->count);
+    const nml_t *src = vecs->elems;
+    size_t i = 0;
+
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x, y, z;
+        simd_load3_f32(&src[i * 3], &x, &y, &z);
+        simd_storeu_f32(&sOut->x[i], x);
+        simd_storeu_f32(&sOut->y[i], y);
+        simd_storeu_f32(&sOut->z[i], z);
+    }
+#endif
+
+    for (; i < n; i++) {
+        sOut->x[i] = src[i * 3];
+        sOut->y[i] = src[i * 3 + 1];
+        sOut->z[i] = src[i * 3 + 2];
+    }
+    return NML_SUCCESS;
+}
+
+int vec3StreamToAoS(const Vec3Stream *stream, Vec3 *vecs, size_t count) {
+    is_null((void *)stream, vecs);
+    size_t n = MIN(count, stream->count);
+    nml_t *dst = vecs->elems;
+    size_t i = 0;
+
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        simd_store3_f32(&dst[i * 3],
+                        simd_loadu_f32(&stream->x[i]),
+                        simd_loadu_f32(&stream->y[i]),
+                        simd_loadu_f32(&stream->z[i]));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i * 3] = stream->x[i];
+        dst[i * 3 + 1] = stream->y[i];
+        dst[i * 3 + 2] = stream->z[i];
+    }
+    return NML_SUCCESS;
+}
+
+int vec4StreamFromAoS(const Vec4 *vecs, size_t count, Vec4Stream *sOut) {
+    is_null((void *)vecs, sOut);
+    size_t n = MIN(count, sOut->count);
+    const nml_t *src = vecs->elems;
+    size_t i = 0;
+
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x, y, z, w;
+        simd_load4_f32(&src[i * 4], &x, &y, &z, &w);
+        simd_storeu_f32(&sOut->x[i], x);
+        simd_storeu_f32(&sOut->y[i], y);
+        simd_storeu_f32(&sOut->z[i], z);
+        simd_storeu_f32(&sOut->w[i], w);
+    }
+#endif
+
+    for (; i < n; i++) {
+        sOut->x[i] = src[i * 4];
+        sOut->y[i] = src[i * 4 + 1];
+        sOut->z[i] = src[i * 4 + 2];
+        sOut->w[i] = src[i * 4 + 3];
+    }
+    return NML_SUCCESS;
+}
+
+int vec4StreamToAoS(const Vec4Stream *stream, Vec4 *vecs, size_t count) {
+    is_null((void *)stream, vecs);
+    size_t n = MIN(count, stream->count);
+    nml_t *dst = vecs->elems;
+    size_t i = 0;
+
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        simd_store4_f32(&dst[i * 4],
+                        simd_loadu_f32(&stream->x[i]),
+                        simd_loadu_f32(&stream->y[i]),
+                        simd_loadu_f32(&stream->z[i]),
+                        simd_loadu_f32(&stream->w[i]));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i * 4] = stream->x[i];
+        dst[i * 4 + 1] = stream->y[i];
+        dst[i * 4 + 2] = stream->z[i];
+        dst[i * 4 + 3] = stream->w[i];
+    }
+    return NML_SUCCESS;
+}
+
+/*
+ * per-component kernels shared by both stream widths
+ *
+ * the vector loops are unrolled by two so 8 lanes are in flight per iteration
+ */
+
+static void addArray(const nml_t *a, const nml_t *b, nml_t *out, size_t n) {
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    for (; i + 8 <= n; i += 8) {
+        simd_f32x4_t r0 =
+            simd_add_f32(simd_loadu_f32(&a[i]), simd_loadu_f32(&b[i]));
+        simd_f32x4_t r1 =
+            simd_add_f32(simd_loadu_f32(&a[i + 4]), simd_loadu_f32(&b[i + 4]));
+        simd_storeu_f32(&out[i], r0);
+        simd_storeu_f32(&out[i + 4], r1);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+static void subArray(const nml_t *a, const nml_t *b, nml_t *out, size_t n) {
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    for (; i + 8 <= n; i += 8) {
+        simd_f32x4_t r0 =
+            simd_sub_f32(simd_loadu_f32(&a[i]), simd_loadu_f32(&b[i]));
+        simd_f32x4_t r1 =
+            simd_sub_f32(simd_loadu_f32(&a[i + 4]), simd_loadu_f32(&b[i + 4]));
+        simd_storeu_f32(&out[i], r0);
+        simd_storeu_f32(&out[i + 4], r1);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = a[i] - b[i];
+    }
+}
+
+static void scaleArray(const nml_t *a, nml_t s, nml_t *out, size_t n) {
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    simd_f32x4_t scaler = simd_set1_f32(s);
+    for (; i + 8 <= n; i += 8) {
+        simd_f32x4_t r0 = simd_mul_f32(simd_loadu_f32(&a[i]), scaler);
+        simd_f32x4_t r1 = simd_mul_f32(simd_loadu_f32(&a[i + 4]), scaler);
+        simd_storeu_f32(&out[i], r0);
+        simd_storeu_f32(&out[i + 4], r1);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = a[i] * s;
+    }
+}
+
+/*
+ * Vec3Stream
+ */
+
+int vec3StreamAdd(const Vec3Stream *s1, const Vec3Stream *s2, Vec3Stream *sOut) {
+    is_null((void *)s1, (void *)s2, sOut);
+    if (s1->count != s2->count || s1->count != sOut->count)
+        return NML_EINVAL;
+
+    addArray(s1->x, s2->x, sOut->x, s1->count);
+    addArray(s1->y, s2->y, sOut->y, s1->count);
+    addArray(s1->z, s2->z, sOut->z, s1->count);
+    return NML_SUCCESS;
+}
+
+int vec3StreamSub(const Vec3Stream *s1, const Vec3Stream *s2, Vec3Stream *sOut) {
+    is_null((void *)s1, (void *)s2, sOut);
+    if (s1->count != s2->count || s1->count != sOut->count)
+        return NML_EINVAL;
+
+    subArray(s1->x, s2->x, sOut->x, s1->count);
+    subArray(s1->y, s2->y, sOut->y, s1->count);
+    subArray(s1->z, s2->z, sOut->z, s1->count);
+    return NML_SUCCESS;
+}
+
+int vec3StreamScale(const Vec3Stream *stream, nml_t s, Vec3Stream *sOut) {
+    is_null((void *)stream, sOut);
+    if (stream->count != sOut->count)
+        return NML_EINVAL;
+
+    scaleArray(stream->x, s, sOut->x, stream->count);
+    scaleArray(stream->y, s, sOut->y, stream->count);
+    scaleArray(stream->z, s, sOut->z, stream->count);
+    return NML_SUCCESS;
+}
+
+int vec3StreamCross(const Vec3Stream *s1,
+                    const Vec3Stream *s2,
+                    Vec3Stream *sOut) {
+    is_null((void *)s1, (void *)s2, sOut);
+    if (s1->count != s2->count || s1->count != sOut->count)
+        return NML_EINVAL;
+
+    size_t n = s1->count;
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t ax = simd_loadu_f32(&s1->x[i]);
+        simd_f32x4_t ay = simd_loadu_f32(&s1->y[i]);
+        simd_f32x4_t az = simd_loadu_f32(&s1->z[i]);
+        simd_f32x4_t bx = simd_loadu_f32(&s2->x[i]);
+        simd_f32x4_t by = simd_loadu_f32(&s2->y[i]);
+        simd_f32x4_t bz = simd_loadu_f32(&s2->z[i]);
+
+        simd_storeu_f32(
+            &sOut->x[i],
+            simd_sub_f32(simd_mul_f32(ay, bz), simd_mul_f32(az, by)));
+        simd_storeu_f32(
+            &sOut->y[i],
+            simd_sub_f32(simd_mul_f32(az, bx), simd_mul_f32(ax, bz)));
+        simd_storeu_f32(
+            &sOut->z[i],
+            simd_sub_f32(simd_mul_f32(ax, by), simd_mul_f32(ay, bx)));
+    }
+#endif
+    for (; i < n; i++) {
+        nml_t ax = s1->x[i], ay = s1->y[i], az = s1->z[i];
+        nml_t bx = s2->x[i], by = s2->y[i], bz = s2->z[i];
+        sOut->x[i] = ay * bz - az * by;
+        sOut->y[i] = az * bx - ax * bz;
+        sOut->z[i] = ax * by - ay * bx;
+    }
+    return NML_SUCCESS;
+}
+
+int vec3StreamDot(const Vec3Stream *s1, const Vec3Stream *s2, nml_t *out) {
+    is_null((void *)s1, (void *)s2, out);
+    if (s1->count != s2->count)
+        return NML_EINVAL;
+
+    size_t n = s1->count;
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t r =
+            simd_mul_f32(simd_loadu_f32(&s1->x[i]), simd_loadu_f32(&s2->x[i]));
+        r = simd_fmadd_f32(
+            simd_loadu_f32(&s1->y[i]), simd_loadu_f32(&s2->y[i]), r);
+        r = simd_fmadd_f32(
+            simd_loadu_f32(&s1->z[i]), simd_loadu_f32(&s2->z[i]), r);
+        simd_storeu_f32(&out[i], r);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = s1->x[i] * s2->x[i] + s1->y[i] * s2->y[i] + s1->z[i] * s2->z[i];
+    }
+    return NML_SUCCESS;
+}
+
+int vec3StreamLength(const Vec3Stream *stream, nml_t *out) {
+    is_null((void *)stream, out);
+
+    size_t n = stream->count;
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x = simd_loadu_f32(&stream->x[i]);
+        simd_f32x4_t y = simd_loadu_f32(&stream->y[i]);
+        simd_f32x4_t z = simd_loadu_f32(&stream->z[i]);
+        simd_f32x4_t len_sqr = simd_mul_f32(x, x);
+        len_sqr = simd_fmadd_f32(y, y, len_sqr);
+        len_sqr = simd_fmadd_f32(z, z, len_sqr);
+        simd_storeu_f32(&out[i], simd_sqrt_f32(len_sqr));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = sqrt(Sqr(stream->x[i]) + Sqr(stream->y[i]) + Sqr(stream->z[i]));
+    }
+    return NML_SUCCESS;
+}
+
+int vec3StreamNormalize(const Vec3Stream *stream, Vec3Stream *sOut) {
+    is_null((void *)stream, sOut);
+    if (stream->count != sOut->count)
+        return NML_EINVAL;
+
+    size_t n = stream->count;
+    size_t i = 0;
+    int zero = 0;
+#if defined(NML_SIMD_F32)
+    simd_f32x4_t eps = simd_set1_f32(kEPSILON * kEPSILON);
+    simd_f32x4_t zeros = simd_set1_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x = simd_loadu_f32(&stream->x[i]);
+        simd_f32x4_t y = simd_loadu_f32(&stream->y[i]);
+        simd_f32x4_t z = simd_loadu_f32(&stream->z[i]);
+        simd_f32x4_t len_sqr = simd_mul_f32(x, x);
+        len_sqr = simd_fmadd_f32(y, y, len_sqr);
+        len_sqr = simd_fmadd_f32(z, z, len_sqr);
+
+        // rsqrt estimate with two newton steps (NML_SQRT_PRECISE of
+        // vmath.h), zero length lanes are masked to 0 instead of branching
+        simd_f32x4_t valid = simd_cmpge_f32(len_sqr, eps);
+        simd_f32x4_t inv = simd_rsqrt_f32(len_sqr);
+        inv = simd_rsqrt_step_f32(len_sqr, inv);
+        inv = simd_rsqrt_step_f32(len_sqr, inv);
+        inv = simd_select_f32(valid, inv, zeros);
+        zero |= simd_movemask_f32(valid) != 0xF;
+
+        simd_storeu_f32(&sOut->x[i], simd_mul_f32(x, inv));
+        simd_storeu_f32(&sOut->y[i], simd_mul_f32(y, inv));
+        simd_storeu_f32(&sOut->z[i], simd_mul_f32(z, inv));
+    }
+#endif
+    for (; i < n; i++) {
+        nml_t len_sqr =
+            Sqr(stream->x[i]) + Sqr(stream->y[i]) + Sqr(stream->z[i]);
+        nml_t inv = 0.0;
+        if (len_sqr >= kEPSILON * kEPSILON)
+            inv = 1.0 / sqrt(len_sqr);
+        else
+            zero = 1;
+        sOut->x[i] = stream->x[i] * inv;
+        sOut->y[i] = stream->y[i] * inv;
+        sOut->z[i] = stream->z[i] * inv;
+    }
+    return zero ? NML_EZERODIV : NML_SUCCESS;
+}
+
+/*
+ * Vec4Stream
+ */
+
+int vec4StreamAdd(const Vec4Stream *s1, const Vec4Stream *s2, Vec4Stream *sOut) {
+    is_null((void *)s1, (void *)s2, sOut);
+    if (s1->count != s2->count || s1->count != sOut->count)
+        return NML_EINVAL;
+
+    addArray(s1->x, s2->x, sOut->x, s1->count);
+    addArray(s1->y, s2->y, sOut->y, s1->count);
+    addArray(s1->z, s2->z, sOut->z, s1->count);
+    addArray(s1->w, s2->w, sOut->w, s1->count);
+    return NML_SUCCESS;
+}
+
+int vec4StreamSub(const Vec4Stream *s1, const Vec4Stream *s2, Vec4Stream *sOut) {
+    is_null((void *)s1, (void *)s2, sOut);
+    if (s1->count != s2->count || s1->count != sOut->count)
+        return NML_EINVAL;
+
+    subArray(s1->x, s2->x, sOut->x, s1->count);
+    subArray(s1->y, s2->y, sOut->y, s1->count);
+    subArray(s1->z, s2->z, sOut->z, s1->count);
+    subArray(s1->w, s2->w, sOut->w, s1->count);
+    return NML_SUCCESS;
+}
+
+int vec4StreamScale(const Vec4Stream *stream, nml_t s, Vec4Stream *sOut) {
+    is_null((void *)stream, sOut);
+    if (stream->count != sOut->count)
+        return NML_EINVAL;
+
+    scaleArray(stream->x, s, sOut->x, stream->count);
+    scaleArray(stream->y, s, sOut->y, stream->count);
+    scaleArray(stream->z, s, sOut->z, stream->count);
+    scaleArray(stream->w, s, sOut->w, stream->count);
+    return NML_SUCCESS;
+}
+
+int vec4StreamCross(const Vec4Stream *s1,
+                    const Vec4Stream *s2,
+                    Vec4Stream *sOut) {
+    is_null((void *)s1, (void *)s2, sOut);
+    if (s1->count != s2->count || s1->count != sOut->count)
+        return NML_EINVAL;
+
+    // same layout for the xyz part, reuse the Vec3Stream kernel
+    Vec3Stream a = {s1->x, s1->y, s1->z, s1->count};
+    Vec3Stream b = {s2->x, s2->y, s2->z, s2->count};
+    Vec3Stream out = {sOut->x, sOut->y, sOut->z, sOut->count};
+    vec3StreamCross(&a, &b, &out);
+    memset(sOut->w, 0, sOut->count * sizeof(nml_t));
+    return NML_SUCCESS;
+}
+
+int vec4StreamDot(const Vec4Stream *s1, const Vec4Stream *s2, nml_t *out) {
+    is_null((void *)s1, (void *)s2, out);
+    if (s1->count != s2->count)
+        return NML_EINVAL;
+
+    size_t n = s1->count;
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t r =
+            simd_mul_f32(simd_loadu_f32(&s1->x[i]), simd_loadu_f32(&s2->x[i]));
+        r = simd_fmadd_f32(
+            simd_loadu_f32(&s1->y[i]), simd_loadu_f32(&s2->y[i]), r);
+        r = simd_fmadd_f32(
+            simd_loadu_f32(&s1->z[i]), simd_loadu_f32(&s2->z[i]), r);
+        r = simd_fmadd_f32(
+            simd_loadu_f32(&s1->w[i]), simd_loadu_f32(&s2->w[i]), r);
+        simd_storeu_f32(&out[i], r);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = s1->x[i] * s2->x[i] + s1->y[i] * s2->y[i] +
+                 s1->z[i] * s2->z[i] + s1->w[i] * s2->w[i];
+    }
+    return NML_SUCCESS;
+}
+
+int vec4StreamLength(const Vec4Stream *stream, nml_t *out) {
+    is_null((void *)stream, out);
+
+    size_t n = stream->count;
+    size_t i = 0;
+#if defined(NML_SIMD_F32)
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x = simd_loadu_f32(&stream->x[i]);
+        simd_f32x4_t y = simd_loadu_f32(&stream->y[i]);
+        simd_f32x4_t z = simd_loadu_f32(&stream->z[i]);
+        simd_f32x4_t w = simd_loadu_f32(&stream->w[i]);
+        simd_f32x4_t len_sqr = simd_mul_f32(x, x);
+        len_sqr = simd_fmadd_f32(y, y, len_sqr);
+        len_sqr = simd_fmadd_f32(z, z, len_sqr);
+        len_sqr = simd_fmadd_f32(w, w, len_sqr);
+        simd_storeu_f32(&out[i], simd_sqrt_f32(len_sqr));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = sqrt(Sqr(stream->x[i]) + Sqr(stream->y[i]) +
+                      Sqr(stream->z[i]) + Sqr(stream->w[i]));
+    }
+    return NML_SUCCESS;
+}
+
+int vec4StreamNormalize(const Vec4Stream *stream, Vec4Stream *sOut) {
+    is_null((void *)stream, sOut);
+    if (stream->count != sOut->count)
+        return NML_EINVAL;
+
+    size_t n = stream->count;
+    size_t i = 0;
+    int zero = 0;
+#if defined(NML_SIMD_F32)
+    simd_f32x4_t eps = simd_set1_f32(kEPSILON * kEPSILON);
+    simd_f32x4_t zeros = simd_set1_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        simd_f32x4_t x = simd_loadu_f32(&stream->x[i]);
+        simd_f32x4_t y = simd_loadu_f32(&stream->y[i]);
+        simd_f32x4_t z = simd_loadu_f32(&stream->z[i]);
+        simd_f32x4_t w = simd_loadu_f32(&stream->w[i]);
+        simd_f32x4_t len_sqr = simd_mul_f32(x, x);
+        len_sqr = simd_fmadd_f32(y, y, len_sqr);
+        len_sqr = simd_fmadd_f32(z, z, len_sqr);
+        len_sqr = simd_fmadd_f32(w, w, len_sqr);
+
+        simd_f32x4_t valid = simd_cmpge_f32(len_sqr, eps);
+        simd_f32x4_t inv = simd_rsqrt_f32(len_sqr);
+        inv = simd_rsqrt_step_f32(len_sqr, inv);
+        inv = simd_rsqrt_step_f32(len_sqr, inv);
+        inv = simd_select_f32(valid, inv, zeros);
+        zero |= simd_movemask_f32(valid) != 0xF;
+
+        simd_storeu_f32(&sOut->x[i], simd_mul_f32(x, inv));
+        simd_storeu_f32(&sOut->y[i], simd_mul_f32(y, inv));
+        simd_storeu_f32(&sOut->z[i], simd_mul_f32(z, inv));
+        simd_storeu_f32(&sOut->w[i], simd_mul_f32(w, inv));
+    }
+#endif
+    for (; i < n; i++) {
+        nml_t len_sqr = Sqr(stream->x[i]) + Sqr(stream->y[i]) +
+                        Sqr(stream->z[i]) + Sqr(stream->w[i]);
+        nml_t inv = 0.0;
+        if (len_sqr >= kEPSILON * kEPSILON)
+            inv = 1.0 / sqrt(len_sqr);
+        else
+            zero = 1;
+        sOut->x[i] = stream->x[i] * inv;
+        sOut->y[i] = stream->y[i] * inv;
+        sOut->z[i] = stream->z[i] * inv;
+        sOut->w[i] = stream->w[i] * inv;
+    }
+    return zero ? NML_EZERODIV : NML_SUCCESS;
+}
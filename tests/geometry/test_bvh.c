@@ -0,0 +1,303 @@
+#include "geometry/bvh.h"
+#include "utils/errors.h"
+#include "utils/thread.h"
+#include "nutest.h"
+#include "test_random.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// n small triangles scattered through a box, in one block of 9 arrays
+static nml_t *randomTriangles(size_t n, unsigned seed, TriangleStream *out) {
+    nml_t *c = malloc(n * 9 * sizeof(nml_t));
+    if (!c)
+        return NULL;
+    for (size_t i = 0; i < n; i++) {
+        for (int k = 0; k < 3; k++) {
+            nml_t center = randomCoord(&seed, 20.0);
+            for (int j = 0; j < 3; j++)
+                c[(3 * j + k) * n + i] = center + randomCoord(&seed, 1.0);
+        }
+    }
+    *out = (TriangleStream){{c, c + n, c + 2 * n, n},
+                            {c + 3 * n, c + 4 * n, c + 5 * n, n},
+                            {c + 6 * n, c + 7 * n, c + 8 * n, n}};
+    return c;
+}
+
+static Ray randomRay(unsigned *s) {
+    Ray r = {{{randomCoord(s, 25.0), randomCoord(s, 25.0), -30.0}},
+             {{randomCoord(s, 0.5), randomCoord(s, 0.5), 1.0}},
+             100.0};
+    return r;
+}
+
+static int slotContains(const BVHNode *node, int c, const nml_t lo[3],
+                        const nml_t hi[3]) {
+    return node->minX[c] <= lo[0] && node->minY[c] <= lo[1] &&
+           node->minZ[c] <= lo[2] && node->maxX[c] >= hi[0] &&
+           node->maxY[c] >= hi[1] && node->maxZ[c] >= hi[2];
+}
+
+// every primitive in exactly one leaf, children after their parents and
+// inside their slot's bounds, leaves no larger than leafSize
+static int checkTree(const BVH *bvh, size_t leafSize) {
+    char *seen = calloc(bvh->primCount + 1, 1);
+    int ok = seen != NULL;
+    for (size_t k = 0; ok && k < bvh->nodeCount; k++) {
+        const BVHNode *node = &bvh->nodes[k];
+        for (int c = 0; ok && c < NML_BVH_WIDTH; c++) {
+            if (node->child[c] == NML_BVH_EMPTY)
+                continue;
+            if (node->count[c] == 0) {
+                ok = node->child[c] > k && node->child[c] < bvh->nodeCount;
+                if (!ok)
+                    break;
+                const BVHNode *sub = &bvh->nodes[node->child[c]];
+                for (int j = 0; ok && j < NML_BVH_WIDTH; j++) {
+                    if (sub->child[j] == NML_BVH_EMPTY)
+                        continue;
+                    nml_t lo[3] = {sub->minX[j], sub->minY[j], sub->minZ[j]};
+                    nml_t hi[3] = {sub->maxX[j], sub->maxY[j], sub->maxZ[j]};
+                    ok = slotContains(node, c, lo, hi);
+                }
+                continue;
+            }
+            ok = node->count[c] <= leafSize &&
+                 node->child[c] + node->count[c] <= bvh->primCount;
+            for (size_t i = node->child[c];
+                 ok && i < node->child[c] + node->count[c]; i++) {
+                const Vec3Stream *v[3] = {&bvh->tris.v0, &bvh->tris.v1,
+                                          &bvh->tris.v2};
+                int corners = bvh->kind == NML_BVH_TRIANGLES ? 3 : 1;
+                if (corners == 1)
+                    v[0] = &bvh->points;
+                for (int j = 0; ok && j < corners; j++) {
+                    nml_t p[3] = {v[j]->x[i], v[j]->y[i], v[j]->z[i]};
+                    ok = slotContains(node, c, p, p);
+                }
+                ok = ok && !seen[bvh->prims[i]];
+                seen[bvh->prims[i]] = 1;
+            }
+        }
+    }
+    for (size_t i = 0; ok && i < bvh->primCount; i++)
+        ok = seen[i];
+    free(seen);
+    return ok;
+}
+
+// the bvh against the brute force search, equal distances count as the
+// same answer
+static int checkRays(const BVH *bvh, const TriangleStream *tris,
+                     unsigned seed, int rays) {
+    int hits = 0;
+    for (int i = 0; i < rays; i++) {
+        Ray r = randomRay(&seed);
+        RayHit got, want;
+        if (bvhIntersectRay(bvh, &r, &got) != NML_SUCCESS)
+            return -1;
+        rayClosestTriangle(&r, tris, &want);
+        if (got.index != want.index &&
+            (got.index == NML_RAY_MISS || want.index == NML_RAY_MISS ||
+             fabs(got.t - want.t) > 1e-4))
+            return -1;
+        if (got.index == want.index && got.index != NML_RAY_MISS &&
+            (fabs(got.t - want.t) > 1e-4 || fabs(got.u - want.u) > 1e-4))
+            return -1;
+        hits += want.index != NML_RAY_MISS;
+    }
+    return hits;
+}
+
+TEST(BVHTests, BuildAndRay) {
+    TriangleStream tris;
+    nml_t *block = randomTriangles(20000, 3, &tris);
+    ASSERT_TRUE(block != NULL);
+
+    // serial, then with the upper levels and subtrees on the pool
+    int counts[2] = {1, 4};
+    size_t leafSizes[2] = {0, 8};
+    for (int t = 0; t < 2; t++) {
+        ASSERT_EQ(threadSetCount(counts[t]), NML_SUCCESS);
+        BVH bvh;
+        ASSERT_EQ(bvhBuildTriangles(&tris, leafSizes[t], &bvh), NML_SUCCESS);
+        ASSERT_EQ((int)bvh.primCount, 20000);
+        ASSERT_TRUE(checkTree(&bvh, leafSizes[t] ? leafSizes[t] : 4));
+        int hits = checkRays(&bvh, &tris, 17, 400);
+        ASSERT_TRUE(hits > 50);
+        bvhFree(&bvh);
+        ASSERT_TRUE(bvh.nodes == NULL);
+    }
+    ASSERT_EQ(threadSetCount(1), NML_SUCCESS);
+    free(block);
+    return TEST_PASS;
+}
+
+TEST(BVHTests, Packets) {
+    TriangleStream tris;
+    nml_t *block = randomTriangles(3000, 9, &tris);
+    ASSERT_TRUE(block != NULL);
+    BVH bvh;
+    ASSERT_EQ(bvhBuildTriangles(&tris, 0, &bvh), NML_SUCCESS);
+
+    unsigned s = 23;
+    for (int p = 0; p < 40; p++) {
+        Ray rays[NML_RAY_PACKET];
+        size_t n = 1 + p % NML_RAY_PACKET;
+        for (size_t k = 0; k < n; k++)
+            rays[k] = randomRay(&s);
+        RayPacket packet;
+        ASSERT_EQ(rayPacketInit(rays, n, &packet), NML_SUCCESS);
+        ASSERT_EQ(bvhIntersectPacket(&bvh, &packet), NML_SUCCESS);
+        for (size_t k = 0; k < NML_RAY_PACKET; k++) {
+            RayHit got, want;
+            rayPacketGetHit(&packet, k, &got);
+            if (k >= n) {
+                ASSERT_EQ((int)got.index, (int)NML_RAY_MISS);
+                continue;
+            }
+            rayClosestTriangle(&rays[k], &tris, &want);
+            ASSERT_EQ(got.index == NML_RAY_MISS, want.index == NML_RAY_MISS);
+            if (want.index != NML_RAY_MISS)
+                ASSERT_NEAR(got.t, want.t, 1e-4);
+        }
+    }
+    bvhFree(&bvh);
+    free(block);
+    return TEST_PASS;
+}
+
+static int compareIndices(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+TEST(BVHTests, PointsQueryBox) {
+    enum { N = 10000 };
+    nml_t *c = malloc(3 * N * sizeof(nml_t));
+    uint32_t *got = malloc(N * sizeof(uint32_t));
+    uint32_t *want = malloc(N * sizeof(uint32_t));
+    ASSERT_TRUE(c && got && want);
+    unsigned s = 31;
+    for (size_t i = 0; i < 3 * N; i++)
+        c[i] = randomCoord(&s, 10.0);
+    // a few duplicates so some leaves have no centroid extent
+    for (size_t i = 0; i < 50; i++) {
+        c[i] = c[N + i] = c[2 * N + i] = 1.0;
+    }
+    Vec3Stream points = {c, c + N, c + 2 * N, N};
+    BVH bvh;
+    ASSERT_EQ(bvhBuildPoints(&points, 0, &bvh), NML_SUCCESS);
+    ASSERT_TRUE(checkTree(&bvh, 4));
+
+    for (int q = 0; q < 20; q++) {
+        AABB box;
+        for (int k = 0; k < 3; k++) {
+            nml_t a = randomCoord(&s, 10.0), b = randomCoord(&s, 10.0);
+            box.min.elems[k] = a < b ? a : b;
+            box.max.elems[k] = a < b ? b : a;
+        }
+        size_t found = 0, expected = 0;
+        ASSERT_EQ(bvhQueryBox(&bvh, &box, got, N, &found), NML_SUCCESS);
+        for (size_t i = 0; i < N; i++) {
+            Vec3 p = {{c[i], c[N + i], c[2 * N + i]}};
+            if (aabbContains(&box, &p))
+                want[expected++] = (uint32_t)i;
+        }
+        ASSERT_EQ((int)found, (int)expected);
+        qsort(got, found, sizeof(uint32_t), compareIndices);
+        for (size_t i = 0; i < found; i++)
+            ASSERT_EQ((int)got[i], (int)want[i]);
+
+        // counting only
+        size_t counted = 0;
+        ASSERT_EQ(bvhQueryBox(&bvh, &box, NULL, 0, &counted), NML_SUCCESS);
+        ASSERT_EQ((int)counted, (int)expected);
+    }
+    bvhFree(&bvh);
+    free(c);
+    free(got);
+    free(want);
+    return TEST_PASS;
+}
+
+TEST(BVHTests, Refit) {
+    TriangleStream tris;
+    nml_t *block = randomTriangles(8000, 5, &tris);
+    ASSERT_TRUE(block != NULL);
+    ASSERT_EQ(threadSetCount(2), NML_SUCCESS);
+    BVH bvh;
+    ASSERT_EQ(bvhBuildTriangles(&tris, 0, &bvh), NML_SUCCESS);
+
+    // shift and wobble every vertex, the tree must follow
+    unsigned s = 77;
+    for (size_t i = 0; i < 9 * 8000; i++)
+        block[i] = block[i] * 0.9 + 1.5 + randomCoord(&s, 0.3);
+    ASSERT_EQ(bvhRefitTriangles(&bvh, &tris), NML_SUCCESS);
+    ASSERT_TRUE(checkTree(&bvh, 4));
+    ASSERT_TRUE(checkRays(&bvh, &tris, 41, 300) > 30);
+
+    // root bounds are the bounds of the new vertices
+    Vec3Stream all = {block, block + 8000, block + 16000, 8000};
+    AABB box;
+    aabbFromPoints(&all, &box);
+    for (int j = 1; j < 3; j++) {
+        Vec3Stream v = {block + 3 * j * 8000, block + (3 * j + 1) * 8000,
+                        block + (3 * j + 2) * 8000, 8000};
+        AABB more;
+        aabbFromPoints(&v, &more);
+        aabbUnion(&box, &more, &box);
+    }
+    for (int k = 0; k < 3; k++) {
+        ASSERT_DOUBLE_EQ(bvh.bounds.min.elems[k], box.min.elems[k]);
+        ASSERT_DOUBLE_EQ(bvh.bounds.max.elems[k], box.max.elems[k]);
+    }
+    ASSERT_EQ(threadSetCount(1), NML_SUCCESS);
+    bvhFree(&bvh);
+    free(block);
+    return TEST_PASS;
+}
+
+TEST(BVHTests, SmallAndErrors) {
+    TriangleStream tris;
+    nml_t *block = randomTriangles(3, 1, &tris);
+    ASSERT_TRUE(block != NULL);
+    BVH bvh;
+
+    // fewer primitives than a leaf: a root with one leaf
+    ASSERT_EQ(bvhBuildTriangles(&tris, 0, &bvh), NML_SUCCESS);
+    ASSERT_EQ((int)bvh.nodeCount, 1);
+    ASSERT_EQ((int)bvh.nodes[0].count[0], 3);
+    ASSERT_TRUE(checkTree(&bvh, 4));
+    ASSERT_EQ(bvhRefitPoints(&bvh, &tris.v0), NML_EINVAL);
+    bvhFree(&bvh);
+
+    TriangleStream none = {{NULL, NULL, NULL, 0}, {NULL, NULL, NULL, 0},
+                           {NULL, NULL, NULL, 0}};
+    ASSERT_EQ(bvhBuildTriangles(&none, 0, &bvh), NML_SUCCESS);
+    ASSERT_EQ((int)bvh.nodeCount, 0);
+    Ray r = randomRay(&(unsigned){1});
+    RayHit hit;
+    ASSERT_EQ(bvhIntersectRay(&bvh, &r, &hit), NML_SUCCESS);
+    ASSERT_EQ((int)hit.index, (int)NML_RAY_MISS);
+    bvhFree(&bvh);
+
+    ASSERT_EQ(bvhBuildTriangles(&tris, NML_BVH_MAX_LEAF + 1, &bvh),
+              NML_EINVAL);
+    tris.v2.count = 2;
+    ASSERT_EQ(bvhBuildTriangles(&tris, 0, &bvh), NML_EINVAL);
+    ASSERT_EQ(bvhBuildTriangles(NULL, 0, &bvh), NML_ENULLMEM);
+
+    ASSERT_EQ(bvhBuildPoints(&tris.v0, 0, &bvh), NML_SUCCESS);
+    ASSERT_EQ(bvhIntersectRay(&bvh, &r, &hit), NML_EINVAL);
+    ASSERT_EQ(bvhQueryBox(&bvh, &bvh.bounds, NULL, 1, &(size_t){0}),
+              NML_ENULLMEM);
+    bvhFree(&bvh);
+    free(block);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,228 @@
+#include "geometry/frustum.h"
+#include "utils/errors.h"
+#include "nutest.h"
+#include "test_random.h"
+#include <math.h>
+#include <stdlib.h>
+
+// right handed perspective looking down -z, 90 degree fov, aspect 1, near 1
+// and far 100, with the camera moved to (eyeX, 0, 0)
+static void perspective(int zeroOne, nml_t eyeX, Mat4 *mOut) {
+    nml_t n = 1.0, f = 100.0;
+    Mat4 proj, view;
+    mat4InitZero(&proj);
+    proj.elems[0] = 1.0;
+    proj.elems[5] = 1.0;
+    proj.elems[11] = -1.0;
+    if (zeroOne) {
+        proj.elems[10] = f / (n - f);
+        proj.elems[14] = f * n / (n - f);
+    } else {
+        proj.elems[10] = (f + n) / (n - f);
+        proj.elems[14] = 2.0 * f * n / (n - f);
+    }
+    mat4Identity(&view);
+    view.elems[12] = -eyeX;
+    mat4MulMat4(&proj, &view, mOut);
+}
+
+static int bitSet(const uint32_t *bits, size_t i) {
+    return (bits[i / 32] >> (i % 32)) & 1u;
+}
+
+// signed distance of the sphere surface, or of the furthest box corner,
+// from the plane that culls it hardest. visible when >= 0
+static double sphereMargin(const Frustum *fr, nml_t x, nml_t y, nml_t z,
+                           nml_t r) {
+    double margin = INFINITY;
+    for (int p = 0; p < 6; p++) {
+        const nml_t *e = fr->planes[p].elems;
+        double d = (double)e[0] * x + (double)e[1] * y + (double)e[2] * z +
+                   e[3] + r;
+        margin = d < margin ? d : margin;
+    }
+    return margin;
+}
+
+static double boxMargin(const Frustum *fr, const nml_t lo[3],
+                        const nml_t hi[3]) {
+    double margin = INFINITY;
+    for (int p = 0; p < 6; p++) {
+        const nml_t *e = fr->planes[p].elems;
+        double d = e[3];
+        for (int k = 0; k < 3; k++)
+            d += (double)e[k] * (e[k] >= 0.0 ? hi[k] : lo[k]);
+        margin = d < margin ? d : margin;
+    }
+    return margin;
+}
+
+TEST(FrustumTests, FromMat4) {
+    Mat4 gl, zo;
+    Frustum a, b;
+    perspective(0, 0.0, &gl);
+    perspective(1, 0.0, &zo);
+    ASSERT_EQ(frustumFromMat4(&gl, 0, &a), NML_SUCCESS);
+    ASSERT_EQ(frustumFromMat4(&zo, NML_FRUSTUM_DEPTH_ZERO_ONE, &b),
+              NML_SUCCESS);
+
+    // both conventions describe the same volume
+    for (int p = 0; p < 6; p++) {
+        for (int k = 0; k < 4; k++)
+            ASSERT_NEAR(a.planes[p].elems[k], b.planes[p].elems[k],
+                        1e-5 * (1.0 + fabs(a.planes[p].elems[k])));
+    }
+
+    // left x >= z, near z <= -1, far z >= -100, unit normals pointing in
+    nml_t h = sqrt(0.5);
+    ASSERT_NEAR(a.planes[0].x, h, 1e-6);
+    ASSERT_NEAR(a.planes[0].z, -h, 1e-6);
+    ASSERT_NEAR(a.planes[0].w, 0.0, 1e-6);
+    ASSERT_NEAR(a.planes[4].z, -1.0, 1e-6);
+    ASSERT_NEAR(a.planes[4].w, -1.0, 1e-5);
+    ASSERT_NEAR(a.planes[5].z, 1.0, 1e-6);
+    ASSERT_NEAR(a.planes[5].w, 100.0, 1e-2);
+
+    ASSERT_EQ(frustumFromMat4(NULL, 0, &a), NML_ENULLMEM);
+    ASSERT_EQ(frustumFromMat4(&gl, 0, NULL), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+TEST(FrustumTests, KnownObjects) {
+    Mat4 vp;
+    Frustum fr;
+    perspective(0, 0.0, &vp);
+    frustumFromMat4(&vp, 0, &fr);
+
+    // clang-format off
+    nml_t x[6] = {0.0, 0.0,  0.0,  20.0, 10.5, 0.0};
+    nml_t y[6] = {0.0, 0.0,  0.0,   0.0,  0.0, 0.0};
+    nml_t z[6] = {-10.0, 10.0, -200.0, -10.0, -10.0, -0.5};
+    nml_t r[6] = {1.0, 1.0,  1.0,   1.0,  1.0, 0.6};
+    // clang-format on
+    int expected[6] = {1, 0, 0, 0, 1, 1};
+    Vec3Stream centers = {x, y, z, 6};
+    uint32_t bits[1] = {0xffffffffu};
+    ASSERT_EQ(frustumTestSpheres(&fr, &centers, r, bits), NML_SUCCESS);
+    for (int i = 0; i < 6; i++)
+        ASSERT_EQ(bitSet(bits, i), expected[i]);
+    ASSERT_EQ((int)(bits[0] >> 6), 0);
+
+    // the same objects as their bounding boxes
+    nml_t lx[6], ly[6], lz[6], hx[6], hy[6], hz[6];
+    for (int i = 0; i < 6; i++) {
+        lx[i] = x[i] - r[i], hx[i] = x[i] + r[i];
+        ly[i] = y[i] - r[i], hy[i] = y[i] + r[i];
+        lz[i] = z[i] - r[i], hz[i] = z[i] + r[i];
+    }
+    Vec3Stream mins = {lx, ly, lz, 6}, maxs = {hx, hy, hz, 6};
+    ASSERT_EQ(frustumTestBoxes(&fr, &mins, &maxs, bits), NML_SUCCESS);
+    for (int i = 0; i < 6; i++)
+        ASSERT_EQ(bitSet(bits, i), expected[i]);
+
+    uint32_t indices[6];
+    size_t visible = 0;
+    ASSERT_EQ(frustumCullSpheres(&fr, &centers, r, indices, &visible),
+              NML_SUCCESS);
+    ASSERT_EQ((int)visible, 3);
+    ASSERT_EQ((int)indices[0], 0);
+    ASSERT_EQ((int)indices[1], 4);
+    ASSERT_EQ((int)indices[2], 5);
+    return TEST_PASS;
+}
+
+TEST(FrustumTests, RandomAgainstReference) {
+    // every length up to a few words, then one past a cull chunk
+    size_t lengths[] = {1, 3, 4, 7, 8, 9, 31, 32, 33, 63, 64, 100, 2049};
+    size_t maxLen = 2049;
+    nml_t *buf = malloc(maxLen * 7 * sizeof(nml_t));
+    uint32_t *bits = malloc((maxLen + 31) / 32 * sizeof(uint32_t));
+    uint32_t *indices = malloc(maxLen * sizeof(uint32_t));
+    ASSERT_TRUE(buf && bits && indices);
+    nml_t *x = buf, *y = buf + maxLen, *z = buf + 2 * maxLen;
+    nml_t *r = buf + 3 * maxLen, *hx = buf + 4 * maxLen;
+    nml_t *hy = buf + 5 * maxLen, *hz = buf + 6 * maxLen;
+
+    Mat4 vp;
+    Frustum fr;
+    perspective(1, 3.0, &vp);
+    frustumFromMat4(&vp, NML_FRUSTUM_DEPTH_ZERO_ONE, &fr);
+
+    unsigned s = 7;
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        size_t n = lengths[l];
+        for (size_t i = 0; i < n; i++) {
+            x[i] = randomCoord(&s, 80.0);
+            y[i] = randomCoord(&s, 80.0);
+            z[i] = randomCoord(&s, 60.0) - 50.0;
+            r[i] = (nml_t)(nextRandom(&s) % 1024) / 128.0;
+            hx[i] = x[i] + r[i];
+            hy[i] = y[i] + r[i];
+            hz[i] = z[i] + r[i];
+        }
+        Vec3Stream centers = {x, y, z, n}, maxs = {hx, hy, hz, n};
+
+        // spheres, bitmask and index forms against the reference
+        ASSERT_EQ(frustumTestSpheres(&fr, &centers, r, bits), NML_SUCCESS);
+        size_t visible = 0, k = 0;
+        ASSERT_EQ(frustumCullSpheres(&fr, &centers, r, indices, &visible),
+                  NML_SUCCESS);
+        for (size_t i = 0; i < n; i++) {
+            double m = sphereMargin(&fr, x[i], y[i], z[i], r[i]);
+            if (fabs(m) > 1e-3)
+                ASSERT_EQ(bitSet(bits, i), m > 0.0);
+            if (bitSet(bits, i))
+                ASSERT_EQ((int)indices[k++], (int)i);
+        }
+        ASSERT_EQ((int)visible, (int)k);
+        if (n % 32)
+            ASSERT_EQ((int)(bits[n / 32] >> (n % 32)), 0);
+
+        // boxes from the centers to the far corner
+        ASSERT_EQ(frustumTestBoxes(&fr, &centers, &maxs, bits), NML_SUCCESS);
+        ASSERT_EQ(frustumCullBoxes(&fr, &centers, &maxs, indices, &visible),
+                  NML_SUCCESS);
+        k = 0;
+        for (size_t i = 0; i < n; i++) {
+            nml_t lo[3] = {x[i], y[i], z[i]}, hi[3] = {hx[i], hy[i], hz[i]};
+            double m = boxMargin(&fr, lo, hi);
+            if (fabs(m) > 1e-3)
+                ASSERT_EQ(bitSet(bits, i), m > 0.0);
+            if (bitSet(bits, i))
+                ASSERT_EQ((int)indices[k++], (int)i);
+        }
+        ASSERT_EQ((int)visible, (int)k);
+    }
+    free(buf);
+    free(bits);
+    free(indices);
+    return TEST_PASS;
+}
+
+TEST(FrustumTests, Errors) {
+    Mat4 vp;
+    Frustum fr;
+    perspective(0, 0.0, &vp);
+    frustumFromMat4(&vp, 0, &fr);
+    nml_t v[4] = {0.0, 0.0, 0.0, 0.0};
+    Vec3Stream a = {v, v, v, 4}, b = {v, v, v, 3};
+    uint32_t bits[1], indices[4];
+    size_t visible;
+
+    ASSERT_EQ(frustumTestSpheres(NULL, &a, v, bits), NML_ENULLMEM);
+    ASSERT_EQ(frustumTestSpheres(&fr, &a, NULL, bits), NML_ENULLMEM);
+    ASSERT_EQ(frustumTestBoxes(&fr, &a, &b, bits), NML_EINVAL);
+    ASSERT_EQ(frustumCullBoxes(&fr, &a, &b, indices, &visible), NML_EINVAL);
+    ASSERT_EQ(frustumCullSpheres(&fr, &a, v, indices, NULL), NML_ENULLMEM);
+
+    // empty streams write nothing
+    Vec3Stream empty = {v, v, v, 0};
+    ASSERT_EQ(frustumCullSpheres(&fr, &empty, v, indices, &visible),
+              NML_SUCCESS);
+    ASSERT_EQ((int)visible, 0);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
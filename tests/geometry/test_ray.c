@@ -0,0 +1,318 @@
+#include "geometry/ray.h"
+#include "utils/errors.h"
+#include "nutest.h"
+#include "test_random.h"
+#include <math.h>
+#include <stdlib.h>
+
+static int bitSet(const uint32_t *bits, size_t i) {
+    return (bits[i / 32] >> (i % 32)) & 1u;
+}
+
+static Ray makeRay(nml_t ox, nml_t oy, nml_t oz, nml_t dx, nml_t dy, nml_t dz,
+                   nml_t tMax) {
+    Ray r = {{{ox, oy, oz}}, {{dx, dy, dz}}, tMax};
+    return r;
+}
+
+/*
+ * double precision references, with the distance of the answer from the
+ * nearest decision boundary so the tests can skip the close calls
+ */
+
+static int refBox(const Ray *r, const double lo[3], const double hi[3],
+                  double *tOut, double *margin) {
+    double tNear = 0.0, tFar = r->tMax;
+    for (int k = 0; k < 3; k++) {
+        double inv = 1.0 / r->dir.elems[k];
+        double t0 = (lo[k] - r->origin.elems[k]) * inv;
+        double t1 = (hi[k] - r->origin.elems[k]) * inv;
+        tNear = fmax(fmin(t0, t1), tNear);
+        tFar = fmin(fmax(t0, t1), tFar);
+    }
+    *tOut = tNear;
+    *margin = fabs(tFar - tNear);
+    return tNear <= tFar;
+}
+
+static int refTriangle(const Ray *r, const double v0[3], const double v1[3],
+                       const double v2[3], double *tOut, double *margin) {
+    double o[3], d[3], e1[3], e2[3], s[3], p[3], q[3];
+    for (int k = 0; k < 3; k++) {
+        o[k] = r->origin.elems[k];
+        d[k] = r->dir.elems[k];
+        e1[k] = v1[k] - v0[k];
+        e2[k] = v2[k] - v0[k];
+        s[k] = o[k] - v0[k];
+    }
+    p[0] = d[1] * e2[2] - d[2] * e2[1];
+    p[1] = d[2] * e2[0] - d[0] * e2[2];
+    p[2] = d[0] * e2[1] - d[1] * e2[0];
+    q[0] = s[1] * e1[2] - s[2] * e1[1];
+    q[1] = s[2] * e1[0] - s[0] * e1[2];
+    q[2] = s[0] * e1[1] - s[1] * e1[0];
+    double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) / det;
+    double v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / det;
+    double t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+    *tOut = t;
+    *margin = fmin(fmin(fabs(u), fabs(v)), fabs(1.0 - u - v));
+    *margin = fmin(*margin, fmin(fabs(t), fabs(r->tMax - t)) / 64.0);
+    return u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= 0.0 && t <= r->tMax;
+}
+
+TEST(RayTests, KnownBoxes) {
+    Ray r = makeRay(0.0, 0.0, -5.0, 0.0, 0.0, 1.0, 100.0);
+    // clang-format off
+    // unit box, off to the side, behind, around the origin, past tMax,
+    // beside the ray on an axis with no direction
+    nml_t lx[6] = {-1.0, 4.0, -1.0, -1.0, -1.0, 2.0};
+    nml_t ly[6] = {-1.0, 4.0, -1.0, -1.0, -1.0, -1.0};
+    nml_t lz[6] = {-1.0, 4.0, -12.0, -6.0, 200.0, -1.0};
+    nml_t hx[6] = {1.0, 6.0, 1.0, 1.0, 1.0, 3.0};
+    nml_t hy[6] = {1.0, 6.0, 1.0, 1.0, 1.0, 1.0};
+    nml_t hz[6] = {1.0, 6.0, -10.0, -4.0, 201.0, 1.0};
+    // clang-format on
+    int expected[6] = {1, 0, 0, 1, 0, 0};
+    Vec3Stream mins = {lx, ly, lz, 6}, maxs = {hx, hy, hz, 6};
+    uint32_t bits[1];
+    nml_t t[6];
+    ASSERT_EQ(rayTestBoxes(&r, &mins, &maxs, t, bits), NML_SUCCESS);
+    for (int i = 0; i < 6; i++)
+        ASSERT_EQ(bitSet(bits, i), expected[i]);
+    ASSERT_EQ((int)(bits[0] >> 6), 0);
+    ASSERT_NEAR(t[0], 4.0, 1e-5);
+    ASSERT_NEAR(t[3], 0.0, 1e-5);
+    // misses come out as INFINITY, compared by size since the tests may
+    // be built with -ffast-math
+    ASSERT_TRUE(t[1] > 1e30 && t[2] > 1e30);
+
+    // tOut is optional
+    ASSERT_EQ(rayTestBoxes(&r, &mins, &maxs, NULL, bits), NML_SUCCESS);
+    ASSERT_EQ((int)bits[0], 0x9);
+    return TEST_PASS;
+}
+
+TEST(RayTests, KnownTriangles) {
+    // clang-format off
+    // three parallel triangles at z = 0, 2, -1 and one along the ray
+    nml_t ax[4] = {-1.0, -1.0, -1.0, 0.0}, ay[4] = {-1.0, -1.0, -1.0, -1.0};
+    nml_t az[4] = {0.0, 2.0, -1.0, -9.0};
+    nml_t bx[4] = {1.0, 1.0, 1.0, 0.0}, by[4] = {-1.0, -1.0, -1.0, 1.0};
+    nml_t bz[4] = {0.0, 2.0, -1.0, -9.0};
+    nml_t cx[4] = {-1.0, -1.0, -1.0, 0.0}, cy[4] = {1.0, 1.0, 1.0, 0.0};
+    nml_t cz[4] = {0.0, 2.0, -1.0, 9.0};
+    // clang-format on
+    TriangleStream tris = {{ax, ay, az, 4}, {bx, by, bz, 4}, {cx, cy, cz, 4}};
+
+    Ray r = makeRay(0.0, 0.0, -5.0, 0.0, 0.0, 1.0, 100.0);
+    uint32_t bits[1];
+    nml_t t[4];
+    ASSERT_EQ(rayTestTriangles(&r, &tris, t, bits), NML_SUCCESS);
+    ASSERT_EQ((int)bits[0], 0x7);
+    ASSERT_NEAR(t[0], 5.0, 1e-5);
+    ASSERT_NEAR(t[1], 7.0, 1e-5);
+    ASSERT_NEAR(t[2], 4.0, 1e-5);
+
+    RayHit hit;
+    ASSERT_EQ(rayClosestTriangle(&r, &tris, &hit), NML_SUCCESS);
+    ASSERT_EQ((int)hit.index, 2);
+    ASSERT_NEAR(hit.t, 4.0, 1e-5);
+    ASSERT_NEAR(hit.u, 0.5, 1e-5);
+    ASSERT_NEAR(hit.v, 0.5, 1e-5);
+
+    // from the other side, and with the reach cut short
+    r = makeRay(0.0, 0.0, 5.0, 0.0, 0.0, -1.0, 4.0);
+    ASSERT_EQ(rayClosestTriangle(&r, &tris, &hit), NML_SUCCESS);
+    ASSERT_EQ((int)hit.index, 1);
+    ASSERT_NEAR(hit.t, 3.0, 1e-5);
+    r.tMax = 2.0;
+    ASSERT_EQ(rayClosestTriangle(&r, &tris, &hit), NML_SUCCESS);
+    ASSERT_EQ((int)hit.index, (int)NML_RAY_MISS);
+    return TEST_PASS;
+}
+
+TEST(RayTests, RandomAgainstReference) {
+    size_t lengths[] = {1, 3, 4, 7, 8, 9, 31, 32, 33, 100, 1500};
+    size_t maxLen = 1500;
+    nml_t *buf = malloc(maxLen * 9 * sizeof(nml_t));
+    nml_t *t = malloc(maxLen * sizeof(nml_t));
+    uint32_t *bits = malloc((maxLen + 31) / 32 * sizeof(uint32_t));
+    ASSERT_TRUE(buf && t && bits);
+    nml_t *c[9];
+    for (int k = 0; k < 9; k++)
+        c[k] = buf + k * maxLen;
+
+    unsigned s = 11;
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        size_t n = lengths[l];
+        Ray r = makeRay(randomCoord(&s, 2.0), randomCoord(&s, 2.0),
+                        randomCoord(&s, 2.0), randomCoord(&s, 1.0),
+                        randomCoord(&s, 1.0), randomCoord(&s, 1.0), 20.0);
+        for (size_t i = 0; i < n; i++) {
+            // a small triangle near a random point, its bounding box
+            for (int k = 0; k < 3; k++) {
+                nml_t center = randomCoord(&s, 4.0);
+                c[k][i] = center + randomCoord(&s, 3.0);
+                c[3 + k][i] = center + randomCoord(&s, 3.0);
+                c[6 + k][i] = center + randomCoord(&s, 3.0);
+            }
+        }
+        TriangleStream tris = {{c[0], c[1], c[2], n},
+                               {c[3], c[4], c[5], n},
+                               {c[6], c[7], c[8], n}};
+
+        ASSERT_EQ(rayTestTriangles(&r, &tris, t, bits), NML_SUCCESS);
+        size_t closest = NML_RAY_MISS;
+        double tClosest = INFINITY, runnerUp = INFINITY;
+        for (size_t i = 0; i < n; i++) {
+            double v0[3] = {c[0][i], c[1][i], c[2][i]};
+            double v1[3] = {c[3][i], c[4][i], c[5][i]};
+            double v2[3] = {c[6][i], c[7][i], c[8][i]};
+            double tRef, margin;
+            int hit = refTriangle(&r, v0, v1, v2, &tRef, &margin);
+            if (margin < 1e-3)
+                continue;
+            ASSERT_EQ(bitSet(bits, i), hit);
+            if (hit) {
+                ASSERT_TRUE(fabs(t[i] - tRef) <= 1e-4 * (1.0 + tRef));
+                if (tRef < tClosest) {
+                    runnerUp = tClosest;
+                    tClosest = tRef;
+                    closest = i;
+                } else if (tRef < runnerUp) {
+                    runnerUp = tRef;
+                }
+            } else {
+                ASSERT_TRUE(t[i] > 1e30);
+            }
+        }
+        if (n % 32)
+            ASSERT_EQ((int)(bits[n / 32] >> (n % 32)), 0);
+        RayHit hit;
+        ASSERT_EQ(rayClosestTriangle(&r, &tris, &hit), NML_SUCCESS);
+        if (closest != NML_RAY_MISS && runnerUp - tClosest > 1e-3)
+            ASSERT_EQ((int)hit.index, (int)closest);
+
+        // boxes from the first two corners of each triangle
+        for (size_t i = 0; i < n; i++) {
+            for (int k = 0; k < 3; k++) {
+                nml_t a = c[k][i], b = c[3 + k][i];
+                c[k][i] = a < b ? a : b;
+                c[3 + k][i] = a < b ? b : a;
+            }
+        }
+        Vec3Stream mins = {c[0], c[1], c[2], n}, maxs = {c[3], c[4], c[5], n};
+        ASSERT_EQ(rayTestBoxes(&r, &mins, &maxs, t, bits), NML_SUCCESS);
+        for (size_t i = 0; i < n; i++) {
+            double lo[3] = {c[0][i], c[1][i], c[2][i]};
+            double hi[3] = {c[3][i], c[4][i], c[5][i]};
+            double tRef, margin;
+            int hit = refBox(&r, lo, hi, &tRef, &margin);
+            if (margin < 1e-3)
+                continue;
+            ASSERT_EQ(bitSet(bits, i), hit);
+            if (hit)
+                ASSERT_TRUE(fabs(t[i] - tRef) <= 1e-4 * (1.0 + tRef));
+        }
+    }
+    free(buf);
+    free(t);
+    free(bits);
+    return TEST_PASS;
+}
+
+TEST(RayTests, Packets) {
+    // 6 of 8 lanes used, all aimed at a grid of triangles around z = 0
+    Ray rays[6];
+    unsigned s = 5;
+    for (int k = 0; k < 6; k++) {
+        rays[k] = makeRay(randomCoord(&s, 3.0), randomCoord(&s, 3.0), -10.0,
+                          randomCoord(&s, 0.2), randomCoord(&s, 0.2), 1.0,
+                          50.0);
+    }
+    RayPacket packet;
+    ASSERT_EQ(rayPacketInit(rays, 6, &packet), NML_SUCCESS);
+
+    enum { N = 200 };
+    nml_t c[9][N];
+    for (int i = 0; i < N; i++) {
+        nml_t x = (nml_t)(i % 10) - 5.0, y = (nml_t)((i / 10) % 10) - 5.0;
+        nml_t z = (nml_t)(i / 100) * 3.0 + randomCoord(&s, 1.0);
+        nml_t corners[9] = {x, y, z, x + 1.3, y, z, x, y + 1.3, z + 0.1};
+        for (int k = 0; k < 9; k++)
+            c[k][i] = corners[k];
+    }
+    for (int i = 0; i < N; i++) {
+        Vec3 v0 = {{c[0][i], c[1][i], c[2][i]}};
+        Vec3 v1 = {{c[3][i], c[4][i], c[5][i]}};
+        Vec3 v2 = {{c[6][i], c[7][i], c[8][i]}};
+        ASSERT_EQ(rayPacketIntersectTriangle(&packet, &v0, &v1, &v2,
+                                             (uint32_t)i, NULL),
+                  NML_SUCCESS);
+    }
+    TriangleStream tris = {{c[0], c[1], c[2], N},
+                           {c[3], c[4], c[5], N},
+                           {c[6], c[7], c[8], N}};
+    for (size_t k = 0; k < NML_RAY_PACKET; k++) {
+        RayHit got, want;
+        ASSERT_EQ(rayPacketGetHit(&packet, k, &got), NML_SUCCESS);
+        if (k >= 6) {
+            ASSERT_EQ((int)got.index, (int)NML_RAY_MISS);
+            continue;
+        }
+        rayClosestTriangle(&rays[k], &tris, &want);
+        ASSERT_EQ((int)got.index, (int)want.index);
+        if (want.index != NML_RAY_MISS) {
+            ASSERT_NEAR(got.t, want.t, 1e-4);
+            ASSERT_NEAR(got.u, want.u, 1e-4);
+            ASSERT_NEAR(got.v, want.v, 1e-4);
+        }
+    }
+
+    // box tests stop at the closest hit, unused lanes never pass
+    Vec3 lo = {{-20.0, -20.0, -20.0}}, hi = {{20.0, 20.0, -9.0}};
+    uint32_t mask;
+    ASSERT_EQ(rayPacketTestBox(&packet, &lo, &hi, &mask), NML_SUCCESS);
+    ASSERT_EQ((int)mask, 0x3f);
+    lo.z = 20.0;
+    hi.z = 21.0;
+    ASSERT_EQ(rayPacketTestBox(&packet, &lo, &hi, &mask), NML_SUCCESS);
+    for (int k = 0; k < 6; k++) {
+        RayHit got;
+        rayPacketGetHit(&packet, k, &got);
+        ASSERT_EQ((int)((mask >> k) & 1u), got.index == NML_RAY_MISS);
+    }
+    ASSERT_EQ((int)(mask >> 6), 0);
+    return TEST_PASS;
+}
+
+TEST(RayTests, Errors) {
+    Ray r = makeRay(0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 1.0);
+    nml_t v[4] = {0.0, 0.0, 0.0, 0.0};
+    Vec3Stream a = {v, v, v, 4}, b = {v, v, v, 3};
+    TriangleStream bad = {a, a, b};
+    uint32_t bits[1];
+    RayHit hit;
+    RayPacket packet;
+
+    ASSERT_EQ(rayTestBoxes(NULL, &a, &a, NULL, bits), NML_ENULLMEM);
+    ASSERT_EQ(rayTestBoxes(&r, &a, &a, NULL, NULL), NML_ENULLMEM);
+    ASSERT_EQ(rayTestBoxes(&r, &a, &b, NULL, bits), NML_EINVAL);
+    ASSERT_EQ(rayTestTriangles(&r, &bad, NULL, bits), NML_EINVAL);
+    ASSERT_EQ(rayClosestTriangle(&r, &bad, &hit), NML_EINVAL);
+    ASSERT_EQ(rayPacketInit(&r, 0, &packet), NML_EINVAL);
+    ASSERT_EQ(rayPacketInit(&r, NML_RAY_PACKET + 1, &packet), NML_EINVAL);
+    ASSERT_EQ(rayPacketInit(&r, 1, &packet), NML_SUCCESS);
+    ASSERT_EQ(rayPacketGetHit(&packet, NML_RAY_PACKET, &hit), NML_EINVAL);
+
+    // degenerate triangles are never hit
+    TriangleStream flat = {a, a, a};
+    ASSERT_EQ(rayClosestTriangle(&r, &flat, &hit), NML_SUCCESS);
+    ASSERT_EQ((int)hit.index, (int)NML_RAY_MISS);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
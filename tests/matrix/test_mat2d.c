@@ -180,6 +180,23 @@ TEST(Mat2Tests, Mat2MulMat2) {
     return TEST_PASS;
 }
 
+TEST(Mat2Tests, Mat2Transpose) {
+    nml_t arr[4] = {1.0, 2.0, 3.0, 4.0};
+    nml_t expected[4] = {1.0, 3.0, 2.0, 4.0};
+    Mat2 m, result;
+    mat2Init(arr, &m);
+
+    ASSERT_EQ(mat2Transpose(&m, &result), NML_SUCCESS);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_DOUBLE_EQ(result.elems[i], expected[i]);
+    }
+    ASSERT_EQ(mat2Transpose(&m, &m), NML_SUCCESS);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_DOUBLE_EQ(m.elems[i], expected[i]);
+    }
+    return TEST_PASS;
+}
+
 int main(void) {
     return RUN_ALL_TESTS();
 }
@@ -0,0 +1,105 @@
+#include "matrix/mat3a.h"
+#include "utils/errors.h"
+#include "nutest.h"
+
+static void testMatrices(Mat3 *m1, Mat3 *m2) {
+    // clang-format off
+    nml_t arr1[9] = {1.0, 4.0, 7.0,
+                     2.0, 5.0, 8.0,
+                     3.0, 6.0, 9.0};
+    nml_t arr2[9] = {9.0, -6.0, 3.0,
+                     8.0, 5.0, -2.0,
+                     7.0, 4.0, 1.0};
+    // clang-format on
+    mat3Init(arr1, m1);
+    mat3Init(arr2, m2);
+}
+
+// same values as the packed matrix, pad lanes still zero
+static int sameAs(Mat3A *padded, Mat3 *packed) {
+    Mat3 back;
+    mat3AToMat3(padded, &back);
+    for (int i = 0; i < 9; i++) {
+        if (back.elems[i] != packed->elems[i])
+            return 0;
+    }
+    for (int c = 0; c < 3; c++) {
+        if (padded->cols[c].pad != 0.0)
+            return 0;
+    }
+    return 1;
+}
+
+TEST(Mat3ATests, Convert) {
+    Mat3 m1, m2;
+    Mat3A a;
+    testMatrices(&m1, &m2);
+    ASSERT_EQ(mat3AFromMat3(&m1, &a), NML_SUCCESS);
+    ASSERT_TRUE(sameAs(&a, &m1));
+
+    Mat3 id;
+    mat3Identity(&id);
+    ASSERT_EQ(mat3AIdentity(&a), NML_SUCCESS);
+    ASSERT_TRUE(sameAs(&a, &id));
+    return TEST_PASS;
+}
+
+TEST(Mat3ATests, ElementWise) {
+    Mat3 m1, m2, e;
+    Mat3A a, b, r;
+    testMatrices(&m1, &m2);
+    mat3AFromMat3(&m1, &a);
+    mat3AFromMat3(&m2, &b);
+
+    ASSERT_EQ(mat3AAdd(&a, &b, &r), NML_SUCCESS);
+    mat3Add(&m1, &m2, &e);
+    ASSERT_TRUE(sameAs(&r, &e));
+    ASSERT_EQ(mat3ASub(&a, &b, &r), NML_SUCCESS);
+    mat3Sub(&m1, &m2, &e);
+    ASSERT_TRUE(sameAs(&r, &e));
+    ASSERT_EQ(mat3AHadamard(&a, &b, &r), NML_SUCCESS);
+    mat3Hadamard(&m1, &m2, &e);
+    ASSERT_TRUE(sameAs(&r, &e));
+    ASSERT_EQ(mat3AScale(&a, 0.5, &r), NML_SUCCESS);
+    mat3Scale(&m1, 0.5, &e);
+    ASSERT_TRUE(sameAs(&r, &e));
+    ASSERT_EQ(mat3ANegate(&a, &r), NML_SUCCESS);
+    mat3Negate(&m1, &e);
+    ASSERT_TRUE(sameAs(&r, &e));
+    ASSERT_EQ(mat3ATranspose(&a, &a), NML_SUCCESS);
+    mat3Transpose(&m1, &e);
+    ASSERT_TRUE(sameAs(&a, &e));
+    return TEST_PASS;
+}
+
+TEST(Mat3ATests, Multiply) {
+    Mat3 m1, m2, e;
+    Mat3A a, b, r;
+    testMatrices(&m1, &m2);
+    mat3AFromMat3(&m1, &a);
+    mat3AFromMat3(&m2, &b);
+
+    ASSERT_EQ(mat3AMulMat3A(&a, &b, &r), NML_SUCCESS);
+    mat3MulMat3(&m1, &m2, &e);
+    ASSERT_TRUE(sameAs(&r, &e));
+
+    Vec3 v = {{0.5, -1.0, 2.0}}, ev;
+    Vec3A va;
+    vec3AFromVec3(&v, &va);
+    ASSERT_EQ(mat3AMulVec3A(&a, &va, &va), NML_SUCCESS);
+    mat3MulVec3(&m1, &v, &ev);
+    ASSERT_DOUBLE_EQ(va.x, ev.x);
+    ASSERT_DOUBLE_EQ(va.y, ev.y);
+    ASSERT_DOUBLE_EQ(va.z, ev.z);
+    ASSERT_DOUBLE_EQ(va.pad, 0.0);
+
+    // out aliasing the right operand
+    ASSERT_EQ(mat3AMulMat3A(&a, &b, &b), NML_SUCCESS);
+    ASSERT_TRUE(sameAs(&b, &e));
+    ASSERT_EQ(mat3AMulMat3A(&a, NULL, &r), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
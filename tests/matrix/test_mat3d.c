@@ -205,6 +205,81 @@ TEST(Mat3Tests, Mat3MulMat3) {
     return TEST_PASS;
 }
 
+TEST(Mat3Tests, Mat3Transpose) {
+    // clang-format off
+    nml_t arr[9] = {1.0, 4.0, 7.0,
+                    2.0, 5.0, 8.0,
+                    3.0, 6.0, 9.0};
+    nml_t expected[9] = {1.0, 2.0, 3.0,
+                         4.0, 5.0, 6.0,
+                         7.0, 8.0, 9.0};
+    // clang-format on
+    Mat3 m, result;
+    mat3Init(arr, &m);
+
+    ASSERT_EQ(mat3Transpose(&m, &result), NML_SUCCESS);
+    for (int i = 0; i < 9; i++) {
+        ASSERT_DOUBLE_EQ(result.elems[i], expected[i]);
+    }
+    ASSERT_EQ(mat3Transpose(&m, &m), NML_SUCCESS);
+    for (int i = 0; i < 9; i++) {
+        ASSERT_DOUBLE_EQ(m.elems[i], expected[i]);
+    }
+    return TEST_PASS;
+}
+
+TEST(Mat3Tests, Mat3MulMat3Aliased) {
+    // clang-format off
+    nml_t arr1[9] = {1.0, 4.0, 7.0,
+                     2.0, 5.0, 8.0,
+                     3.0, 6.0, 9.0};
+    nml_t arr2[9] = {9.0, 6.0, 3.0,
+                     8.0, 5.0, 2.0,
+                     7.0, 4.0, 1.0};
+    nml_t expected[9] = {30.0, 84.0, 138.0,
+                         24.0, 69.0, 114.0,
+                         18.0, 54.0, 90.0};
+    // clang-format on
+    Mat3 m1, m2;
+    mat3Init(arr1, &m1);
+    mat3Init(arr2, &m2);
+    ASSERT_EQ(mat3MulMat3(&m1, &m2, &m1), NML_SUCCESS);
+    for (int i = 0; i < 9; i++) {
+        ASSERT_DOUBLE_EQ(m1.elems[i], expected[i]);
+    }
+
+    mat3Init(arr1, &m1);
+    ASSERT_EQ(mat3MulMat3(&m1, &m2, &m2), NML_SUCCESS);
+    for (int i = 0; i < 9; i++) {
+        ASSERT_DOUBLE_EQ(m2.elems[i], expected[i]);
+    }
+    return TEST_PASS;
+}
+
+TEST(Mat3Tests, Mat3StaysInBounds) {
+    // the 4-wide kernels must not touch the element after the matrix
+    struct {
+        Mat3 m;
+        nml_t guard;
+    } a, b;
+    nml_t arr[9] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0};
+    mat3Init(arr, &a.m);
+    mat3Init(arr, &b.m);
+    a.guard = 42.0;
+    b.guard = -42.0;
+
+    ASSERT_EQ(mat3Add(&a.m, &a.m, &b.m), NML_SUCCESS);
+    ASSERT_EQ(mat3Scale(&a.m, 2.0, &b.m), NML_SUCCESS);
+    ASSERT_EQ(mat3Negate(&a.m, &b.m), NML_SUCCESS);
+    ASSERT_DOUBLE_EQ(b.m.elems[8], -9.0);
+    ASSERT_EQ(mat3MulMat3(&a.m, &a.m, &b.m), NML_SUCCESS);
+    ASSERT_EQ(mat3Transpose(&a.m, &b.m), NML_SUCCESS);
+    ASSERT_DOUBLE_EQ(b.m.elems[8], 9.0);
+    ASSERT_DOUBLE_EQ(a.guard, 42.0);
+    ASSERT_DOUBLE_EQ(b.guard, -42.0);
+    return TEST_PASS;
+}
+
 int main(void) {
     return RUN_ALL_TESTS();
 }
@@ -1,6 +1,8 @@
 #include "matrix/mat4d.h"
 #include "utils/errors.h"
 #include "nutest.h"
+#include <math.h>
+#include <stdlib.h>
 
 TEST(Mat4Tests, Mat4Init) {
     // clang-format off
@@ -228,6 +230,340 @@ TEST(Mat4Tests, Mat4MulMat4) {
     return TEST_PASS;
 }
 
+static void fillBatch(Vec4 *vecs, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        vec4Init((nml_t)(i % 7), (nml_t)(i % 5) - 2.0, (nml_t)(i % 3),
+                 1.0, &vecs[i]);
+    }
+}
+
+TEST(Mat4Tests, Mat4MulVec4Batch) {
+    // clang-format off
+    nml_t mat_arr[16] = {1.0, 5.0, 9.0, 13.0,
+                         2.0, 6.0, 10.0, 14.0,
+                         3.0, 7.0, 11.0, 15.0,
+                         4.0, 8.0, 12.0, 16.0};
+    // clang-format on
+    Mat4 m;
+    mat4Init(mat_arr, &m);
+
+    // odd count so the unrolled loop leaves a tail
+    enum { N = 37 };
+    Vec4 in[N], out[N];
+    fillBatch(in, N);
+
+    ASSERT_EQ(mat4MulVec4Batch(&m, in, out, N), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Vec4 expected;
+        mat4MulVec4(&m, &in[i], &expected);
+        for (int j = 0; j < 4; j++) {
+            ASSERT_DOUBLE_EQ(out[i].elems[j], expected.elems[j]);
+        }
+    }
+    return TEST_PASS;
+}
+
+TEST(Mat4Tests, Mat4MulVec4BatchInPlace) {
+    Mat4 m;
+    mat4Diagonal(2.0, &m);
+    m.cols[3].x = 1.0;
+
+    enum { N = 9 };
+    Vec4 vecs[N], orig[N];
+    fillBatch(vecs, N);
+    fillBatch(orig, N);
+
+    ASSERT_EQ(mat4MulVec4Batch(&m, vecs, vecs, N), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        ASSERT_DOUBLE_EQ(vecs[i].x, 2.0 * orig[i].x + 1.0);
+        ASSERT_DOUBLE_EQ(vecs[i].y, 2.0 * orig[i].y);
+        ASSERT_DOUBLE_EQ(vecs[i].z, 2.0 * orig[i].z);
+        ASSERT_DOUBLE_EQ(vecs[i].w, 2.0);
+    }
+    return TEST_PASS;
+}
+
+TEST(Mat4Tests, Mat4MulVec4BatchStreaming) {
+    Mat4 m;
+    mat4Identity(&m);
+    m.cols[3].y = -3.0;
+
+    // big enough to take the non-temporal store path
+    size_t n = (8u << 20) / sizeof(Vec4) + 3;
+    Vec4 *in = malloc(n * sizeof(Vec4));
+    Vec4 *out = malloc(n * sizeof(Vec4));
+    ASSERT_NOT_NULL(in);
+    ASSERT_NOT_NULL(out);
+    fillBatch(in, n);
+
+    ASSERT_EQ(mat4MulVec4Batch(&m, in, out, n), NML_SUCCESS);
+    int ok = 1;
+    for (size_t i = 0; i < n && ok; i++) {
+        ok = out[i].x == in[i].x && out[i].y == in[i].y - 3.0 &&
+             out[i].z == in[i].z && out[i].w == in[i].w;
+    }
+    free(in);
+    free(out);
+    ASSERT_TRUE(ok);
+    return TEST_PASS;
+}
+
+TEST(Mat4Tests, Mat4MulVec4BatchNull) {
+    Mat4 m;
+    Vec4 v;
+    mat4Identity(&m);
+    ASSERT_EQ(mat4MulVec4Batch(&m, NULL, &v, 1), NML_ENULLMEM);
+    ASSERT_EQ(mat4MulVec4Batch(NULL, &v, &v, 1), NML_ENULLMEM);
+    ASSERT_EQ(mat4MulVec4Batch(&m, NULL, NULL, 0), NML_SUCCESS);
+    return TEST_PASS;
+}
+
+// rotation about z by 30 degrees, scale (2, 0.5, 4), translation (1, -2, 3)
+static void trsMatrix(Mat4 *m) {
+    nml_t c = 0.86602540378, s = 0.5;
+    // clang-format off
+    nml_t arr[16] = {c * 2.0,  s * 2.0, 0.0, 0.0,
+                     -s * 0.5, c * 0.5, 0.0, 0.0,
+                     0.0,      0.0,     4.0, 0.0,
+                     1.0,      -2.0,    3.0, 1.0};
+    // clang-format on
+    mat4Init(arr, m);
+}
+
+static void generalMatrix(Mat4 *m) {
+    // clang-format off
+    nml_t arr[16] = {2.0, 1.0, 0.0, 3.0,
+                     -1.0, 3.0, 2.0, 0.5,
+                     4.0, 0.0, 1.0, -2.0,
+                     0.0, 2.0, -3.0, 1.0};
+    // clang-format on
+    mat4Init(arr, m);
+}
+
+static int isIdentity(Mat4 *m, nml_t tol) {
+    for (int i = 0; i < 16; i++) {
+        nml_t e = (i % 5 == 0) ? 1.0 : 0.0;
+        if (m->elems[i] - e > tol || e - m->elems[i] > tol)
+            return 0;
+    }
+    return 1;
+}
+
+TEST(Mat4Tests, Mat4Determinant) {
+    Mat4 m;
+    mat4Diagonal(2.0, &m);
+    ASSERT_NEAR(mat4Determinant(&m), 16.0, kEPSILON);
+
+    generalMatrix(&m);
+    ASSERT_NEAR(mat4Determinant(&m), -201.0, 1e-4);
+
+    // swapping two columns flips the sign
+    Vec4 tmp = m.cols[0];
+    m.cols[0] = m.cols[2];
+    m.cols[2] = tmp;
+    ASSERT_NEAR(mat4Determinant(&m), 201.0, 1e-4);
+
+    trsMatrix(&m);
+    ASSERT_NEAR(mat4Determinant(&m), 4.0, 1e-5);
+    return TEST_PASS;
+}
+
+TEST(Mat4Tests, Mat4Inverse) {
+    Mat4 m, inv, prod;
+    generalMatrix(&m);
+    ASSERT_EQ(mat4Inverse(&m, &inv), NML_SUCCESS);
+    mat4MulMat4(&m, &inv, &prod);
+    ASSERT_TRUE(isIdentity(&prod, 1e-5));
+    mat4MulMat4(&inv, &m, &prod);
+    ASSERT_TRUE(isIdentity(&prod, 1e-5));
+
+    // in place
+    Mat4 copy = m;
+    ASSERT_EQ(mat4Inverse(&copy, &copy), NML_SUCCESS);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_NEAR(copy.elems[i], inv.elems[i], kEPSILON);
+    }
+    return TEST_PASS;
+}
+
+TEST(Mat4Tests, Mat4InverseSingular) {
+    Mat4 m, inv;
+    generalMatrix(&m);
+    m.cols[3] = m.cols[1];
+    ASSERT_EQ(mat4Inverse(&m, &inv), NML_EZERODIV);
+    ASSERT_EQ(mat4Inverse(NULL, &inv), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+TEST(Mat4Tests, Mat4InverseAffine) {
+    Mat4 m, inv, ref;
+    trsMatrix(&m);
+    ASSERT_EQ(mat4InverseAffine(&m, &inv), NML_SUCCESS);
+    ASSERT_EQ(mat4Inverse(&m, &ref), NML_SUCCESS);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_NEAR(inv.elems[i], ref.elems[i], 1e-5);
+    }
+
+    ASSERT_EQ(mat4InverseAffine(&m, &m), NML_SUCCESS);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_NEAR(m.elems[i], ref.elems[i], 1e-5);
+    }
+
+    // collapsed axis
+    trsMatrix(&m);
+    m.cols[2].z = 0.0;
+    ASSERT_EQ(mat4InverseAffine(&m, &inv), NML_EZERODIV);
+    return TEST_PASS;
+}
+
+TEST(Mat4Tests, Mat4InverseBatch) {
+    enum { BATCH = 5 };
+    Mat4 mats[BATCH], out[BATCH];
+    nml_t dets[BATCH];
+    for (int i = 0; i < BATCH; i++) {
+        generalMatrix(&mats[i]);
+        mats[i].cols[0].x += (nml_t)i;
+    }
+    // one singular matrix in the middle
+    mats[2].cols[3] = mats[2].cols[0];
+
+    ASSERT_EQ(mat4DeterminantBatch(mats, dets, BATCH), NML_SUCCESS);
+    ASSERT_EQ(mat4InverseBatch(mats, out, BATCH), NML_EZERODIV);
+    for (int i = 0; i < BATCH; i++) {
+        ASSERT_NEAR(dets[i], mat4Determinant(&mats[i]), kEPSILON);
+        if (i == 2) {
+            for (int j = 0; j < 16; j++) {
+                ASSERT_DOUBLE_EQ(out[i].elems[j], 0.0);
+            }
+            continue;
+        }
+        Mat4 prod;
+        mat4MulMat4(&mats[i], &out[i], &prod);
+        ASSERT_TRUE(isIdentity(&prod, 1e-5));
+    }
+
+    for (int i = 0; i < BATCH; i++) {
+        trsMatrix(&mats[i]);
+        mats[i].cols[3].x = (nml_t)i;
+    }
+    ASSERT_EQ(mat4InverseAffineBatch(mats, mats, BATCH), NML_SUCCESS);
+    for (int i = 0; i < BATCH; i++) {
+        Mat4 m, prod;
+        trsMatrix(&m);
+        m.cols[3].x = (nml_t)i;
+        mat4MulMat4(&m, &mats[i], &prod);
+        ASSERT_TRUE(isIdentity(&prod, 1e-5));
+    }
+    ASSERT_EQ(mat4InverseBatch(NULL, out, 1), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+TEST(Mat4Tests, Mat4Transpose) {
+    Mat4 m, result;
+    for (int i = 0; i < 16; i++) {
+        m.elems[i] = (nml_t)i;
+    }
+
+    ASSERT_EQ(mat4Transpose(&m, &result), NML_SUCCESS);
+    for (int c = 0; c < 4; c++) {
+        for (int r = 0; r < 4; r++) {
+            ASSERT_DOUBLE_EQ(result.elems[c * 4 + r], (nml_t)(r * 4 + c));
+        }
+    }
+
+    ASSERT_EQ(mat4Transpose(&result, &result), NML_SUCCESS);
+    ASSERT_MEM_EQ(&result, &m, sizeof(Mat4));
+    return TEST_PASS;
+}
+
+TEST(Mat4Tests, Mat4TransposeBatch) {
+    enum { BATCH = 3 };
+    Mat4 mats[BATCH], out[BATCH];
+    for (int k = 0; k < BATCH; k++) {
+        for (int i = 0; i < 16; i++) {
+            mats[k].elems[i] = (nml_t)(k * 16 + i);
+        }
+    }
+
+    ASSERT_EQ(mat4TransposeBatch(mats, out, BATCH), NML_SUCCESS);
+    for (int k = 0; k < BATCH; k++) {
+        Mat4 expected;
+        mat4Transpose(&mats[k], &expected);
+        ASSERT_MEM_EQ(&out[k], &expected, sizeof(Mat4));
+    }
+    ASSERT_EQ(mat4TransposeBatch(mats, NULL, BATCH), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+// rotation about z plus a translation, products of these stay well scaled
+static void rigidMatrix(nml_t angle, nml_t tx, Mat4 *m) {
+    mat4Identity(m);
+    m->cols[0].x = cos(angle);
+    m->cols[0].y = sin(angle);
+    m->cols[1].x = -sin(angle);
+    m->cols[1].y = cos(angle);
+    m->cols[3].x = tx;
+}
+
+TEST(Mat4Tests, Mat4MulMat4Batch) {
+    enum { BATCH = 5 };
+    Mat4 a, mats[BATCH], out[BATCH];
+    generalMatrix(&a);
+    for (int i = 0; i < BATCH; i++) {
+        rigidMatrix(0.3 * i, (nml_t)i, &mats[i]);
+    }
+
+    ASSERT_EQ(mat4MulMat4Batch(&a, mats, out, BATCH), NML_SUCCESS);
+    for (int i = 0; i < BATCH; i++) {
+        Mat4 expected;
+        mat4MulMat4(&a, &mats[i], &expected);
+        for (int j = 0; j < 16; j++) {
+            ASSERT_NEAR(out[i].elems[j], expected.elems[j], 1e-5);
+        }
+    }
+
+    // in place, with the left operand inside the array
+    ASSERT_EQ(mat4MulMat4Batch(&mats[0], mats, mats, BATCH), NML_SUCCESS);
+    Mat4 first;
+    rigidMatrix(0.0, 0.0, &first);
+    for (int i = 0; i < BATCH; i++) {
+        Mat4 m, expected;
+        rigidMatrix(0.3 * i, (nml_t)i, &m);
+        mat4MulMat4(&first, &m, &expected);
+        for (int j = 0; j < 16; j++) {
+            ASSERT_NEAR(mats[i].elems[j], expected.elems[j], 1e-5);
+        }
+    }
+    ASSERT_EQ(mat4MulMat4Batch(NULL, mats, out, BATCH), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+TEST(Mat4Tests, Mat4MulChain) {
+    enum { CHAIN = 23 };
+    Mat4 mats[CHAIN], result;
+    for (int i = 0; i < CHAIN; i++) {
+        rigidMatrix(0.1 * i, 0.5 * i, &mats[i]);
+    }
+
+    ASSERT_EQ(mat4MulChain(mats, 0, &result), NML_SUCCESS);
+    ASSERT_TRUE(isIdentity(&result, 0.0));
+
+    // every length through the short path, the interleaved one and the
+    // remainder handling
+    for (size_t n = 1; n <= CHAIN; n++) {
+        Mat4 fold = mats[0];
+        for (size_t i = 1; i < n; i++) {
+            mat4MulMat4(&fold, &mats[i], &fold);
+        }
+        ASSERT_EQ(mat4MulChain(mats, n, &result), NML_SUCCESS);
+        for (int j = 0; j < 16; j++) {
+            ASSERT_NEAR(result.elems[j], fold.elems[j], 1e-3);
+        }
+    }
+    ASSERT_EQ(mat4MulChain(NULL, 2, &result), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
 int main(void) {
     return RUN_ALL_TESTS();
 }
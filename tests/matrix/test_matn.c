@@ -0,0 +1,188 @@
+#include "matrix/matn.h"
+#include "utils/errors.h"
+#include "utils/thread.h"
+#include "nutest.h"
+#include <math.h>
+
+// deterministic values in [-1, 1)
+static void fill(MatN *mat, unsigned seed) {
+    unsigned s = seed * 2654435761u + 1;
+    for (size_t j = 0; j < mat->cols; j++) {
+        for (size_t i = 0; i < mat->rows; i++) {
+            s = s * 1103515245u + 12345u;
+            MATN_AT(mat, i, j) = (nml_t)((s >> 8) % 2048) / 1024.0 - 1.0;
+        }
+    }
+}
+
+static void naiveGemm(nml_t alpha, const MatN *a, const MatN *b, nml_t beta,
+                      MatN *c) {
+    for (size_t i = 0; i < c->rows; i++) {
+        for (size_t j = 0; j < c->cols; j++) {
+            double sum = 0.0;
+            for (size_t p = 0; p < a->cols; p++) {
+                sum += (double)MATN_AT(a, i, p) * MATN_AT(b, p, j);
+            }
+            MATN_AT(c, i, j) = alpha * sum + beta * MATN_AT(c, i, j);
+        }
+    }
+}
+
+static int sameMatrix(const MatN *a, const MatN *b, nml_t tol) {
+    for (size_t j = 0; j < a->cols; j++) {
+        for (size_t i = 0; i < a->rows; i++) {
+            if (!(fabs(MATN_AT(a, i, j) - MATN_AT(b, i, j)) <= tol))
+                return 0;
+        }
+    }
+    return 1;
+}
+
+TEST(MatNTests, MatNInit) {
+    MatN m;
+    ASSERT_EQ(matNInit(5, 3, &m), NML_SUCCESS);
+    ASSERT_EQ((int)m.rows, 5);
+    ASSERT_EQ((int)m.cols, 3);
+    ASSERT_TRUE(m.ld >= m.rows);
+    ASSERT_TRUE(m.ld * sizeof(nml_t) % 32 == 0);
+    for (size_t j = 0; j < 3; j++) {
+        for (size_t i = 0; i < 5; i++) {
+            ASSERT_DOUBLE_EQ(MATN_AT(&m, i, j), 0.0);
+        }
+    }
+    ASSERT_EQ(matNIdentity(&m), NML_SUCCESS);
+    ASSERT_DOUBLE_EQ(MATN_AT(&m, 2, 2), 1.0);
+    ASSERT_DOUBLE_EQ(MATN_AT(&m, 3, 2), 0.0);
+    matNFree(&m);
+    ASSERT_NULL(m.data);
+
+    ASSERT_EQ(matNInit(0, 3, &m), NML_EINVAL);
+    ASSERT_EQ(matNInit(3, 3, NULL), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+TEST(MatNTests, MatNMulSmall) {
+    // clang-format off
+    nml_t a[6] = {1.0, 4.0,   // Column 0
+                  2.0, 5.0,   // Column 1
+                  3.0, 6.0};  // Column 2
+    nml_t b[6] = {7.0, 9.0, 11.0,
+                  8.0, 10.0, 12.0};
+    nml_t expected[4] = {58.0, 139.0,
+                         64.0, 154.0};
+    // clang-format on
+    MatN ma = {a, 2, 3, 2}, mb = {b, 3, 2, 3}, mc;
+    ASSERT_EQ(matNInit(2, 2, &mc), NML_SUCCESS);
+    ASSERT_EQ(matNMul(&ma, &mb, &mc), NML_SUCCESS);
+    for (size_t j = 0; j < 2; j++) {
+        for (size_t i = 0; i < 2; i++) {
+            ASSERT_DOUBLE_EQ(MATN_AT(&mc, i, j), expected[j * 2 + i]);
+        }
+    }
+    matNFree(&mc);
+    return TEST_PASS;
+}
+
+TEST(MatNTests, MatNGemmBlocked) {
+    // odd shapes that cross every block and tile edge
+    size_t shapes[][3] = {{1, 1, 1},     {7, 5, 3},     {9, 4, 17},
+                          {130, 67, 33}, {33, 300, 70}, {257, 129, 1030}};
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        size_t m = shapes[s][0], k = shapes[s][1], n = shapes[s][2];
+        MatN a, b, c, expected;
+        ASSERT_EQ(matNInit(m, k, &a), NML_SUCCESS);
+        ASSERT_EQ(matNInit(k, n, &b), NML_SUCCESS);
+        ASSERT_EQ(matNInit(m, n, &c), NML_SUCCESS);
+        ASSERT_EQ(matNInit(m, n, &expected), NML_SUCCESS);
+        fill(&a, 1);
+        fill(&b, 2);
+        fill(&c, 3);
+        ASSERT_EQ(matNCopy(&c, &expected), NML_SUCCESS);
+
+        ASSERT_EQ(matNGemm(0.5, &a, &b, -2.0, &c), NML_SUCCESS);
+        naiveGemm(0.5, &a, &b, -2.0, &expected);
+        ASSERT_TRUE(sameMatrix(&c, &expected, 1e-3 * (nml_t)k));
+
+        // padding rows stay untouched
+        for (size_t j = 0; j < n; j++) {
+            for (size_t i = m; i < c.ld; i++) {
+                ASSERT_DOUBLE_EQ(MATN_AT(&c, i, j), 0.0);
+            }
+        }
+
+        matNFree(&a);
+        matNFree(&b);
+        matNFree(&c);
+        matNFree(&expected);
+    }
+    return TEST_PASS;
+}
+
+TEST(MatNTests, MatNGemmThreaded) {
+    // above the threading threshold, the tall one spans several packed slices
+    size_t shapes[][3] = {{300, 200, 150}, {2100, 20, 70}};
+    ASSERT_EQ(threadSetCount(4), NML_SUCCESS);
+    for (size_t s = 0; s < 2; s++) {
+        size_t m = shapes[s][0], k = shapes[s][1], n = shapes[s][2];
+        MatN a, b, c, expected;
+        ASSERT_EQ(matNInit(m, k, &a), NML_SUCCESS);
+        ASSERT_EQ(matNInit(k, n, &b), NML_SUCCESS);
+        ASSERT_EQ(matNInit(m, n, &c), NML_SUCCESS);
+        ASSERT_EQ(matNInit(m, n, &expected), NML_SUCCESS);
+        fill(&a, 5);
+        fill(&b, 6);
+        fill(&c, 7);
+        ASSERT_EQ(matNCopy(&c, &expected), NML_SUCCESS);
+
+        ASSERT_EQ(matNGemm(1.5, &a, &b, 1.0, &c), NML_SUCCESS);
+        naiveGemm(1.5, &a, &b, 1.0, &expected);
+        ASSERT_TRUE(sameMatrix(&c, &expected, 1e-3 * (nml_t)k));
+
+        matNFree(&a);
+        matNFree(&b);
+        matNFree(&c);
+        matNFree(&expected);
+    }
+    ASSERT_EQ(threadSetCount(1), NML_SUCCESS);
+    return TEST_PASS;
+}
+
+TEST(MatNTests, MatNGemmBetaZero) {
+    // beta == 0 must not read c, NaNs in it don't leak into the result
+    MatN a, b, c;
+    ASSERT_EQ(matNInit(3, 3, &a), NML_SUCCESS);
+    ASSERT_EQ(matNInit(3, 3, &b), NML_SUCCESS);
+    ASSERT_EQ(matNInit(3, 3, &c), NML_SUCCESS);
+    matNIdentity(&a);
+    fill(&b, 4);
+    for (size_t j = 0; j < 3; j++) {
+        for (size_t i = 0; i < 3; i++) {
+            MATN_AT(&c, i, j) = NAN;
+        }
+    }
+    ASSERT_EQ(matNGemm(1.0, &a, &b, 0.0, &c), NML_SUCCESS);
+    ASSERT_TRUE(sameMatrix(&c, &b, 0.0));
+    matNFree(&a);
+    matNFree(&b);
+    matNFree(&c);
+    return TEST_PASS;
+}
+
+TEST(MatNTests, MatNInvalid) {
+    MatN a, b, c;
+    ASSERT_EQ(matNInit(3, 4, &a), NML_SUCCESS);
+    ASSERT_EQ(matNInit(3, 4, &b), NML_SUCCESS);
+    ASSERT_EQ(matNInit(3, 3, &c), NML_SUCCESS);
+    ASSERT_EQ(matNMul(&a, &b, &c), NML_EINVAL); // inner dimensions differ
+    ASSERT_EQ(matNCopy(&a, &c), NML_EINVAL);
+    ASSERT_EQ(matNMul(&c, &c, &c), NML_EINVAL); // output aliases input
+    ASSERT_EQ(matNMul(&a, NULL, &c), NML_ENULLMEM);
+    matNFree(&a);
+    matNFree(&b);
+    matNFree(&c);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
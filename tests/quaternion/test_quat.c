@@ -0,0 +1,248 @@
+#include "nutest.h"
+#include "quaternion/quat.h"
+#include "utils/errors.h"
+
+#define TOL 1e-5
+
+static void axisAngle(nml_t x, nml_t y, nml_t z, nml_t angle, Quat *qOut) {
+    Vec3 axis = {{x, y, z}};
+    quatFromAxisAngle(&axis, angle, qOut);
+}
+
+TEST(QuatTest, FromAxisAngle) {
+    Quat q;
+    Vec3 zero = {{0.0, 0.0, 0.0}};
+    axisAngle(0.0, 0.0, 2.0, kPI_2, &q);
+    ASSERT_NEAR(q.x, 0.0, TOL);
+    ASSERT_NEAR(q.z, sin(kPI_4), TOL);
+    ASSERT_NEAR(q.w, cos(kPI_4), TOL);
+    ASSERT_NEAR(quatLength(&q), 1.0, TOL);
+    ASSERT_EQ(quatFromAxisAngle(&zero, 1.0, &q), NML_EZERODIV);
+    return TEST_PASS;
+}
+
+TEST(QuatTest, Mul) {
+    // two quarter turns about z make a half turn
+    Quat a, b, r;
+    axisAngle(0.0, 0.0, 1.0, kPI_2, &a);
+    ASSERT_EQ(quatMul(&a, &a, &r), NML_SUCCESS);
+    ASSERT_NEAR(r.z, 1.0, TOL);
+    ASSERT_NEAR(r.w, 0.0, TOL);
+
+    // against the scalar hamilton product
+    quatInit(0.1, -0.7, 0.3, 0.6, &a);
+    quatInit(-0.4, 0.2, 0.8, -0.1, &b);
+    ASSERT_EQ(quatMul(&a, &b, &r), NML_SUCCESS);
+    ASSERT_NEAR(r.x, a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y, TOL);
+    ASSERT_NEAR(r.y, a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x, TOL);
+    ASSERT_NEAR(r.z, a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w, TOL);
+    ASSERT_NEAR(r.w, a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z, TOL);
+
+    // q * q^-1 = identity, in place
+    Quat inv;
+    ASSERT_EQ(quatInverse(&a, &inv), NML_SUCCESS);
+    ASSERT_EQ(quatMul(&a, &inv, &a), NML_SUCCESS);
+    ASSERT_NEAR(a.x, 0.0, TOL);
+    ASSERT_NEAR(a.w, 1.0, TOL);
+    return TEST_PASS;
+}
+
+TEST(QuatTest, RotateVec3) {
+    Quat q;
+    Vec3 v = {{1.0, 0.0, 0.0}}, r;
+    axisAngle(0.0, 0.0, 1.0, kPI_2, &q);
+    ASSERT_EQ(quatRotateVec3(&q, &v, &r), NML_SUCCESS);
+    ASSERT_NEAR(r.x, 0.0, TOL);
+    ASSERT_NEAR(r.y, 1.0, TOL);
+    ASSERT_NEAR(r.z, 0.0, TOL);
+
+    // composition order: rotate by b first, then a
+    Quat a, b, ab;
+    Vec3 r1, r2;
+    axisAngle(1.0, 0.0, 0.0, 0.7, &a);
+    axisAngle(0.0, 1.0, 1.0, -1.2, &b);
+    quatMul(&a, &b, &ab);
+    v = (Vec3){{0.3, -2.0, 1.5}};
+    quatRotateVec3(&b, &v, &r1);
+    quatRotateVec3(&a, &r1, &r1);
+    quatRotateVec3(&ab, &v, &r2);
+    ASSERT_NEAR(r1.x, r2.x, TOL);
+    ASSERT_NEAR(r1.y, r2.y, TOL);
+    ASSERT_NEAR(r1.z, r2.z, TOL);
+    return TEST_PASS;
+}
+
+TEST(QuatTest, MatrixRoundTrip) {
+    // one rotation per branch of the matrix -> quaternion conversion
+    const nml_t axes[4][4] = {{1.0, 2.0, 3.0, 0.5},
+                              {1.0, 0.1, 0.1, 3.0},
+                              {0.1, 1.0, 0.1, 3.0},
+                              {0.1, 0.1, 1.0, 3.0}};
+    for (int i = 0; i < 4; i++) {
+        Quat q, back;
+        Mat3 m3;
+        Mat4 m4;
+        axisAngle(axes[i][0], axes[i][1], axes[i][2], axes[i][3], &q);
+        ASSERT_EQ(quatToMat3(&q, &m3), NML_SUCCESS);
+        ASSERT_EQ(quatToMat4(&q, &m4), NML_SUCCESS);
+
+        Vec3 v = {{0.5, -1.0, 2.0}}, rq, rm;
+        quatRotateVec3(&q, &v, &rq);
+        mat3MulVec3(&m3, &v, &rm);
+        ASSERT_NEAR(rq.x, rm.x, TOL);
+        ASSERT_NEAR(rq.y, rm.y, TOL);
+        ASSERT_NEAR(rq.z, rm.z, TOL);
+        ASSERT_DOUBLE_EQ(m4.elems[15], 1.0);
+        ASSERT_DOUBLE_EQ(m4.elems[12], 0.0);
+
+        ASSERT_EQ(quatFromMat4(&m4, &back), NML_SUCCESS);
+        // q and -q are the same rotation
+        nml_t s = quatDot(&q, &back) < 0.0 ? -1.0 : 1.0;
+        for (int k = 0; k < 4; k++) {
+            ASSERT_NEAR(back.elems[k] * s, q.elems[k], TOL);
+        }
+        ASSERT_EQ(quatFromMat3(&m3, &back), NML_SUCCESS);
+        ASSERT_NEAR(fabs(quatDot(&q, &back)), 1.0, TOL);
+    }
+    return TEST_PASS;
+}
+
+TEST(QuatTest, Interpolation) {
+    Quat a, b, r, e;
+    axisAngle(0.0, 1.0, 0.0, 0.2, &a);
+    axisAngle(0.0, 1.0, 0.0, 1.4, &b);
+
+    ASSERT_EQ(quatSlerp(&a, &b, 0.25, &r), NML_SUCCESS);
+    axisAngle(0.0, 1.0, 0.0, 0.5, &e);
+    for (int k = 0; k < 4; k++) {
+        ASSERT_NEAR(r.elems[k], e.elems[k], TOL);
+    }
+
+    ASSERT_EQ(quatNlerp(&a, &b, 0.5, &r), NML_SUCCESS);
+    axisAngle(0.0, 1.0, 0.0, 0.8, &e);
+    for (int k = 0; k < 4; k++) {
+        ASSERT_NEAR(r.elems[k], e.elems[k], TOL);
+    }
+
+    // shortest arc: -b is the same rotation as b
+    Quat nb;
+    quatInit(-b.x, -b.y, -b.z, -b.w, &nb);
+    ASSERT_EQ(quatSlerp(&a, &nb, 0.25, &r), NML_SUCCESS);
+    axisAngle(0.0, 1.0, 0.0, 0.5, &e);
+    ASSERT_NEAR(fabs(quatDot(&r, &e)), 1.0, TOL);
+
+    // nearly identical inputs take the nlerp path
+    ASSERT_EQ(quatSlerp(&a, &a, 0.3, &r), NML_SUCCESS);
+    ASSERT_NEAR(quatDot(&r, &a), 1.0, TOL);
+    return TEST_PASS;
+}
+
+TEST(QuatTest, Batch) {
+    enum { N = 9 };
+    Quat a[N], b[N], out[N];
+    Mat4 mats[N];
+    for (int i = 0; i < N; i++) {
+        axisAngle(1.0, (nml_t)i, 0.5, 0.1 * i, &a[i]);
+        axisAngle(-0.5, 1.0, (nml_t)i, 0.3 + 0.05 * i, &b[i]);
+    }
+
+    ASSERT_EQ(quatMulBatch(a, b, out, N), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Quat e;
+        quatMul(&a[i], &b[i], &e);
+        for (int k = 0; k < 4; k++) {
+            ASSERT_NEAR(out[i].elems[k], e.elems[k], TOL);
+        }
+    }
+
+    ASSERT_EQ(quatSlerpBatch(a, b, 0.4, out, N), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Quat e;
+        quatSlerp(&a[i], &b[i], 0.4, &e);
+        for (int k = 0; k < 4; k++) {
+            ASSERT_NEAR(out[i].elems[k], e.elems[k], TOL);
+        }
+    }
+
+    ASSERT_EQ(quatNlerpBatch(a, b, 0.4, out, N), NML_SUCCESS);
+    ASSERT_EQ(quatToMat4Batch(out, mats, N), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Mat4 e;
+        quatToMat4(&out[i], &e);
+        for (int k = 0; k < 16; k++) {
+            ASSERT_NEAR(mats[i].elems[k], e.elems[k], TOL);
+        }
+    }
+
+    // a zero quaternion in the middle
+    quatInit(0.0, 0.0, 0.0, 0.0, &a[4]);
+    ASSERT_EQ(quatNormalizeBatch(a, out, N), NML_EZERODIV);
+    ASSERT_DOUBLE_EQ(out[4].w, 1.0);
+    ASSERT_NEAR(quatLength(&out[5]), 1.0, TOL);
+
+    Vec3 in[N], rot[N];
+    for (int i = 0; i < N; i++) {
+        in[i] = (Vec3){{(nml_t)i, 1.0, -0.5 * i}};
+    }
+    ASSERT_EQ(quatRotateVec3Batch(&b[2], in, rot, N), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Vec3 e;
+        quatRotateVec3(&b[2], &in[i], &e);
+        ASSERT_NEAR(rot[i].x, e.x, TOL);
+        ASSERT_NEAR(rot[i].y, e.y, TOL);
+        ASSERT_NEAR(rot[i].z, e.z, TOL);
+    }
+    ASSERT_EQ(quatMulBatch(a, NULL, out, N), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+// every slerp case inside one group of four: the nlerp fallback, the
+// flipped short arc, a plain blend and a half turn
+TEST(QuatTest, BatchMixedLanes) {
+    enum { N = 8 };
+    Quat a[N], b[N], out[N];
+    for (int i = 0; i < N; i++) {
+        axisAngle(1.0, 0.5 * i, -0.25, 0.3 + 0.2 * i, &a[i]);
+    }
+    b[0] = a[0];
+    axisAngle(0.0, 1.0, 1.0, 2.0, &b[1]);
+    quatInit(-b[1].x, -b[1].y, -b[1].z, -b[1].w, &b[1]);
+    axisAngle(1.0, 0.0, 0.0, -1.0, &b[2]);
+    axisAngle(0.0, 0.0, 1.0, 3.1, &b[3]);
+    for (int i = 4; i < N; i++) {
+        quatInit(-a[i].x, -a[i].y, -a[i].z, -a[i].w, &b[i]);
+    }
+
+    nml_t ts[] = {0.0, 0.3, 1.0};
+    for (int k = 0; k < 3; k++) {
+        ASSERT_EQ(quatSlerpBatch(a, b, ts[k], out, N), NML_SUCCESS);
+        for (int i = 0; i < N; i++) {
+            Quat e;
+            quatSlerp(&a[i], &b[i], ts[k], &e);
+            for (int c = 0; c < 4; c++) {
+                ASSERT_NEAR(out[i].elems[c], e.elems[c], TOL);
+            }
+        }
+        ASSERT_EQ(quatNlerpBatch(a, b, ts[k], out, N), NML_SUCCESS);
+        for (int i = 0; i < N; i++) {
+            Quat e;
+            quatNlerp(&a[i], &b[i], ts[k], &e);
+            for (int c = 0; c < 4; c++) {
+                ASSERT_NEAR(out[i].elems[c], e.elems[c], TOL);
+            }
+        }
+    }
+
+    // in place, outputs may alias inputs
+    Quat e;
+    quatSlerp(&a[3], &b[3], 0.6, &e);
+    ASSERT_EQ(quatSlerpBatch(a, b, 0.6, a, N), NML_SUCCESS);
+    for (int c = 0; c < 4; c++) {
+        ASSERT_NEAR(a[3].elems[c], e.elems[c], TOL);
+    }
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
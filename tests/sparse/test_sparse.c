@@ -0,0 +1,231 @@
+#include "sparse/sparse.h"
+#include "utils/errors.h"
+#include "utils/thread.h"
+#include "nutest.h"
+#include "test_random.h"
+#include <math.h>
+#include <stdlib.h>
+
+// rows of 0 to 40 nonzeros so every kernel sees empty rows, short tails and
+// full vector steps, with a few duplicate triplets mixed in
+static size_t randomTriplets(size_t rows, size_t cols, uint32_t **r,
+                             uint32_t **c, nml_t **v) {
+    unsigned s = 42;
+    size_t cap = rows * 41, nnz = 0;
+    *r = malloc(cap * sizeof(uint32_t));
+    *c = malloc(cap * sizeof(uint32_t));
+    *v = malloc(cap * sizeof(nml_t));
+    for (size_t i = 0; i < rows; i++) {
+        size_t count = nextRandom(&s) % 41;
+        for (size_t k = 0; k < count; k++) {
+            (*r)[nnz] = (uint32_t)i;
+            (*c)[nnz] = nextRandom(&s) % cols;
+            (*v)[nnz] = (nml_t)(nextRandom(&s) % 2048) / 1024.0 - 1.0;
+            nnz++;
+        }
+    }
+    return nnz;
+}
+
+// dense reference straight from the triplets
+static void referenceMulVec(const uint32_t *r, const uint32_t *c,
+                            const nml_t *v, size_t nnz, const nml_t *x,
+                            size_t rows, double *y) {
+    for (size_t i = 0; i < rows; i++) {
+        y[i] = 0.0;
+    }
+    for (size_t k = 0; k < nnz; k++) {
+        y[r[k]] += (double)v[k] * x[c[k]];
+    }
+}
+
+TEST(SparseTests, FromCOO) {
+    // clang-format off
+    // [1 0 2]
+    // [0 0 0]
+    // [3 4 0]   (the 4 given as 1 + 3)
+    uint32_t r[6] = {2, 0, 2, 0, 2, 2};
+    uint32_t c[6] = {1, 2, 0, 0, 1, 1};
+    nml_t v[6] = {1.0, 2.0, 3.0, 1.0, 3.0, 0.0};
+    // clang-format on
+    SparseCSR csr;
+    ASSERT_EQ(sparseCSRFromCOO(3, 3, r, c, v, 6, &csr), NML_SUCCESS);
+    ASSERT_EQ((int)csr.nnz, 4);
+    size_t rowPtr[4] = {0, 2, 2, 4};
+    uint32_t colIdx[4] = {0, 2, 0, 1};
+    nml_t values[4] = {1.0, 2.0, 3.0, 4.0};
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ((int)csr.rowPtr[i], (int)rowPtr[i]);
+        ASSERT_EQ((int)csr.colIdx[i], (int)colIdx[i]);
+        ASSERT_DOUBLE_EQ(csr.values[i], values[i]);
+    }
+
+    SparseCSC csc;
+    ASSERT_EQ(sparseCSCFromCOO(3, 3, r, c, v, 6, &csc), NML_SUCCESS);
+    size_t colPtr[4] = {0, 2, 3, 4};
+    uint32_t rowIdx[4] = {0, 2, 2, 0};
+    nml_t cscValues[4] = {1.0, 3.0, 4.0, 2.0};
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ((int)csc.colPtr[i], (int)colPtr[i]);
+        ASSERT_EQ((int)csc.rowIdx[i], (int)rowIdx[i]);
+        ASSERT_DOUBLE_EQ(csc.values[i], cscValues[i]);
+    }
+
+    nml_t x[3] = {1.0, 2.0, 3.0}, y[3];
+    ASSERT_EQ(sparseCSRMulVec(&csr, x, y), NML_SUCCESS);
+    ASSERT_DOUBLE_EQ(y[0], 7.0);
+    ASSERT_DOUBLE_EQ(y[1], 0.0);
+    ASSERT_DOUBLE_EQ(y[2], 11.0);
+    ASSERT_EQ(sparseCSCMulVec(&csc, x, y), NML_SUCCESS);
+    ASSERT_DOUBLE_EQ(y[0], 7.0);
+    ASSERT_DOUBLE_EQ(y[2], 11.0);
+
+    sparseCSRFree(&csr);
+    sparseCSCFree(&csc);
+    ASSERT_NULL(csr.rowPtr);
+    return TEST_PASS;
+}
+
+TEST(SparseTests, Conversion) {
+    uint32_t *r, *c;
+    nml_t *v;
+    size_t nnz = randomTriplets(300, 200, &r, &c, &v);
+    SparseCSR csr, back;
+    SparseCSC csc, direct;
+    ASSERT_EQ(sparseCSRFromCOO(300, 200, r, c, v, nnz, &csr), NML_SUCCESS);
+    ASSERT_EQ(sparseCSCFromCOO(300, 200, r, c, v, nnz, &direct), NML_SUCCESS);
+    ASSERT_EQ(sparseCSRToCSC(&csr, &csc), NML_SUCCESS);
+    ASSERT_EQ(sparseCSCToCSR(&csc, &back), NML_SUCCESS);
+
+    ASSERT_EQ((int)csc.nnz, (int)direct.nnz);
+    ASSERT_MEM_EQ(csc.colPtr, direct.colPtr, 201 * sizeof(size_t));
+    ASSERT_MEM_EQ(csc.rowIdx, direct.rowIdx, csc.nnz * sizeof(uint32_t));
+    ASSERT_MEM_EQ(back.rowPtr, csr.rowPtr, 301 * sizeof(size_t));
+    ASSERT_MEM_EQ(back.colIdx, csr.colIdx, csr.nnz * sizeof(uint32_t));
+    for (size_t k = 0; k < csr.nnz; k++) {
+        ASSERT_NEAR(back.values[k], csr.values[k], 1e-6);
+    }
+
+    sparseCSRFree(&csr);
+    sparseCSRFree(&back);
+    sparseCSCFree(&csc);
+    sparseCSCFree(&direct);
+    free(r);
+    free(c);
+    free(v);
+    return TEST_PASS;
+}
+
+TEST(SparseTests, MulVecThreaded) {
+    enum { ROWS = 6000, COLS = 5000 };
+    uint32_t *r, *c;
+    nml_t *v;
+    size_t nnz = randomTriplets(ROWS, COLS, &r, &c, &v);
+    nml_t *x = malloc(COLS * sizeof(nml_t));
+    nml_t *y = malloc(ROWS * sizeof(nml_t));
+    double *expected = malloc(ROWS * sizeof(double));
+    for (size_t j = 0; j < COLS; j++) {
+        x[j] = (nml_t)(j % 13) * 0.25 - 1.5;
+    }
+    referenceMulVec(r, c, v, nnz, x, ROWS, expected);
+
+    SparseCSR csr;
+    SparseCSC csc;
+    ASSERT_EQ(sparseCSRFromCOO(ROWS, COLS, r, c, v, nnz, &csr), NML_SUCCESS);
+    ASSERT_EQ(sparseCSCFromCOO(ROWS, COLS, r, c, v, nnz, &csc), NML_SUCCESS);
+
+    int counts[] = {1, 4};
+    for (int t = 0; t < 2; t++) {
+        ASSERT_EQ(threadSetCount(counts[t]), NML_SUCCESS);
+        ASSERT_EQ(sparseCSRMulVec(&csr, x, y), NML_SUCCESS);
+        for (size_t i = 0; i < ROWS; i++) {
+            ASSERT_NEAR(y[i], expected[i], 1e-3);
+        }
+        // enough nonzeros for the CSC product to split into partial sums
+        ASSERT_EQ(sparseCSCMulVec(&csc, x, y), NML_SUCCESS);
+        for (size_t i = 0; i < ROWS; i++) {
+            ASSERT_NEAR(y[i], expected[i], 1e-3);
+        }
+    }
+    ASSERT_EQ(threadSetCount(1), NML_SUCCESS);
+
+    sparseCSRFree(&csr);
+    sparseCSCFree(&csc);
+    free(r);
+    free(c);
+    free(v);
+    free(x);
+    free(y);
+    free(expected);
+    return TEST_PASS;
+}
+
+// 6 right hand sides fit one short panel, 75 span two packed chunks with a
+// ragged last panel and are wide enough that the row grain hits its floor
+TEST(SparseTests, MulMatN) {
+    enum { ROWS = 700, COLS = 500 };
+    uint32_t *r, *c;
+    nml_t *v;
+    size_t nnz = randomTriplets(ROWS, COLS, &r, &c, &v);
+    SparseCSR csr;
+    ASSERT_EQ(sparseCSRFromCOO(ROWS, COLS, r, c, v, nnz, &csr), NML_SUCCESS);
+    double *expected = malloc(ROWS * sizeof(double));
+
+    size_t widths[] = {6, 75};
+    for (int w = 0; w < 2; w++) {
+        size_t rhs = widths[w];
+        MatN b, out;
+        ASSERT_EQ(matNInit(COLS, rhs, &b), NML_SUCCESS);
+        ASSERT_EQ(matNInit(ROWS, rhs, &out), NML_SUCCESS);
+        for (size_t j = 0; j < rhs; j++) {
+            for (size_t i = 0; i < COLS; i++) {
+                MATN_AT(&b, i, j) = (nml_t)((i * 7 + j * 3) % 11) * 0.125;
+            }
+        }
+        ASSERT_EQ(threadSetCount(4), NML_SUCCESS);
+        ASSERT_EQ(sparseCSRMulMatN(&csr, &b, &out), NML_SUCCESS);
+        ASSERT_EQ(threadSetCount(1), NML_SUCCESS);
+
+        // every column against the vector product
+        for (size_t j = 0; j < rhs; j++) {
+            referenceMulVec(r, c, v, nnz, &MATN_AT(&b, 0, j), ROWS, expected);
+            for (size_t i = 0; i < ROWS; i++) {
+                ASSERT_NEAR(MATN_AT(&out, i, j), expected[i], 1e-3);
+            }
+        }
+
+        ASSERT_EQ(sparseCSRMulMatN(&csr, &out, &b), NML_EINVAL);
+        matNFree(&b);
+        matNFree(&out);
+    }
+
+    free(expected);
+    sparseCSRFree(&csr);
+    free(r);
+    free(c);
+    free(v);
+    return TEST_PASS;
+}
+
+TEST(SparseTests, Invalid) {
+    uint32_t r[2] = {0, 3}, c[2] = {0, 1};
+    nml_t v[2] = {1.0, 2.0};
+    SparseCSR csr;
+    ASSERT_EQ(sparseCSRFromCOO(3, 3, r, c, v, 2, &csr), NML_EINVAL);
+    ASSERT_NULL(csr.rowPtr);
+    ASSERT_EQ(sparseCSRFromCOO(3, 3, NULL, c, v, 2, &csr), NML_ENULLMEM);
+    ASSERT_EQ(sparseCSRFromCOO((size_t)INT32_MAX + 1, 3, r, c, v, 0, &csr),
+              NML_EINVAL);
+
+    // an empty matrix is fine
+    nml_t x[4] = {1.0, 2.0, 3.0, 4.0}, y[4] = {9.0, 9.0, 9.0, 9.0};
+    ASSERT_EQ(sparseCSRFromCOO(4, 4, NULL, NULL, NULL, 0, &csr), NML_SUCCESS);
+    ASSERT_EQ(sparseCSRMulVec(&csr, x, y), NML_SUCCESS);
+    ASSERT_DOUBLE_EQ(y[3], 0.0);
+    sparseCSRFree(&csr);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,174 @@
+#include "transform/cache.h"
+#include "utils/errors.h"
+#include "utils/thread.h"
+#include "nutest.h"
+#include "transform_helpers.h"
+#include <math.h>
+#include <stdlib.h>
+
+static int listed(const uint32_t *list, size_t n, uint32_t node) {
+    for (size_t k = 0; k < n; k++) {
+        if (list[k] == node)
+            return 1;
+    }
+    return 0;
+}
+
+TEST(TransformCacheTests, DirtySubtreeOnly) {
+    // 0 -> (1 -> (3, 4), 2) and 5 -> 6
+    int32_t parents[7] = {-1, 0, 0, 1, 1, -1, 5};
+    Mat4 expected[7];
+    TransformCache cache;
+    ASSERT_EQ(transformCacheInit(parents, 7, 0, &cache), NML_SUCCESS);
+    ASSERT_NULL(cache.inverses);
+    for (size_t i = 0; i < 7; i++) {
+        Mat4 m;
+        localMatrix(i, &m);
+        ASSERT_EQ(transformCacheSetLocal(&cache, i, &m), NML_SUCCESS);
+    }
+
+    size_t n;
+    ASSERT_EQ(transformCacheUpdate(&cache), NML_SUCCESS);
+    transformCacheChanged(&cache, &n);
+    ASSERT_EQ((int)n, 7);
+    referenceWorlds(parents, cache.locals, 7, expected);
+    ASSERT_TRUE(sameWorlds(cache.worlds, expected, 7, 1e-5));
+
+    // moving node 1 touches 1, 3 and 4 and leaves the rest alone
+    Mat4 moved;
+    localMatrix(11, &moved);
+    moved.cols[3].y = 2.0;
+    ASSERT_EQ(transformCacheSetLocal(&cache, 1, &moved), NML_SUCCESS);
+    ASSERT_EQ(transformCacheUpdate(&cache), NML_SUCCESS);
+    const uint32_t *changed = transformCacheChanged(&cache, &n);
+    ASSERT_EQ((int)n, 3);
+    ASSERT_EQ((int)changed[0], 1); // parents come first
+    ASSERT_TRUE(listed(changed, n, 3) && listed(changed, n, 4));
+    referenceWorlds(parents, cache.locals, 7, expected);
+    ASSERT_TRUE(sameWorlds(cache.worlds, expected, 7, 1e-5));
+
+    // writing a local in place, two dirty nodes in separate trees
+    cache.locals[6].cols[3].x = -1.0;
+    ASSERT_EQ(transformCacheMarkDirty(&cache, 6), NML_SUCCESS);
+    ASSERT_EQ(transformCacheMarkDirty(&cache, 2), NML_SUCCESS);
+    ASSERT_EQ(transformCacheMarkDirty(&cache, 2), NML_SUCCESS);
+    ASSERT_EQ(transformCacheUpdate(&cache), NML_SUCCESS);
+    changed = transformCacheChanged(&cache, &n);
+    ASSERT_EQ((int)n, 2);
+    ASSERT_TRUE(listed(changed, n, 2) && listed(changed, n, 6));
+    referenceWorlds(parents, cache.locals, 7, expected);
+    ASSERT_TRUE(sameWorlds(cache.worlds, expected, 7, 1e-5));
+
+    // nothing dirty, nothing changed
+    ASSERT_EQ(transformCacheUpdate(&cache), NML_SUCCESS);
+    transformCacheChanged(&cache, &n);
+    ASSERT_EQ((int)n, 0);
+
+    // a dirty leaf does not drag its clean parent along
+    ASSERT_EQ(transformCacheMarkDirty(&cache, 4), NML_SUCCESS);
+    ASSERT_EQ(transformCacheUpdate(&cache), NML_SUCCESS);
+    changed = transformCacheChanged(&cache, &n);
+    ASSERT_EQ((int)n, 1);
+    ASSERT_EQ((int)changed[0], 4);
+
+    transformCacheFree(&cache);
+    ASSERT_NULL(cache.worlds);
+    return TEST_PASS;
+}
+
+TEST(TransformCacheTests, Inverses) {
+    int32_t parents[4] = {-1, 0, 1, 0};
+    TransformCache cache;
+    ASSERT_EQ(transformCacheInit(parents, 4, NML_TCACHE_INVERSES, &cache),
+              NML_SUCCESS);
+    for (size_t i = 0; i < 4; i++) {
+        Mat4 m;
+        localMatrix(i + 3, &m);
+        m.cols[1].y *= 2.0; // non-uniform scale
+        transformCacheSetLocal(&cache, i, &m);
+    }
+    ASSERT_EQ(transformCacheUpdate(&cache), NML_SUCCESS);
+    for (size_t i = 0; i < 4; i++) {
+        Mat4 product, identity;
+        mat4Identity(&identity);
+        mat4MulMat4(&cache.worlds[i], &cache.inverses[i], &product);
+        ASSERT_TRUE(sameWorlds(&product, &identity, 1, 1e-5));
+    }
+
+    // a singular node zeroes its own inverse and its subtree's, the rest of
+    // the update still goes through
+    Mat4 flat;
+    localMatrix(1, &flat);
+    flat.cols[2].z = 0.0;
+    ASSERT_EQ(transformCacheSetLocal(&cache, 1, &flat), NML_SUCCESS);
+    ASSERT_EQ(transformCacheMarkDirty(&cache, 3), NML_SUCCESS);
+    ASSERT_EQ(transformCacheUpdate(&cache), NML_EZERODIV);
+    ASSERT_TRUE(cache.inverses[2].elems[0] == 0.0);
+    Mat4 product, identity;
+    mat4Identity(&identity);
+    mat4MulMat4(&cache.worlds[3], &cache.inverses[3], &product);
+    ASSERT_TRUE(sameWorlds(&product, &identity, 1, 1e-5));
+
+    transformCacheFree(&cache);
+    return TEST_PASS;
+}
+
+TEST(TransformCacheTests, LargeTreeThreaded) {
+    enum { N = 20000 };
+    int32_t *parents = malloc(N * sizeof(int32_t));
+    Mat4 *expected = malloc(N * sizeof(Mat4));
+    ASSERT_TRUE(parents && expected);
+    for (size_t k = 0; k < N; k++) {
+        size_t slot = (k * 7919) % N;
+        parents[slot] = k == 0 ? -1 : (int32_t)((((k - 1) / 3) * 7919) % N);
+    }
+
+    TransformCache cache;
+    ASSERT_EQ(transformCacheInit(parents, N, 0, &cache), NML_SUCCESS);
+    for (size_t i = 0; i < N; i++) {
+        localMatrix(i, &cache.locals[i]);
+    }
+    ASSERT_EQ(threadSetCount(4), NML_SUCCESS);
+    ASSERT_EQ(transformCacheUpdate(&cache), NML_SUCCESS);
+
+    // the subtree of tree node 1 is roughly a third of the nodes
+    size_t node = 7919 % N;
+    cache.locals[node].cols[3].y = 3.0;
+    transformCacheMarkDirty(&cache, node);
+    ASSERT_EQ(transformCacheUpdate(&cache), NML_SUCCESS);
+    size_t n;
+    transformCacheChanged(&cache, &n);
+    ASSERT_TRUE(n > N / 4 && n < N / 2);
+    referenceWorlds(parents, cache.locals, N, expected);
+    ASSERT_TRUE(sameWorlds(cache.worlds, expected, N, 1e-4));
+    ASSERT_EQ(threadSetCount(1), NML_SUCCESS);
+
+    transformCacheFree(&cache);
+    free(parents);
+    free(expected);
+    return TEST_PASS;
+}
+
+TEST(TransformCacheTests, InvalidInput) {
+    int32_t parents[2] = {-1, 0};
+    int32_t cycle[2] = {1, 0};
+    TransformCache cache;
+    Mat4 m;
+    mat4Identity(&m);
+    ASSERT_EQ(transformCacheInit(cycle, 2, 0, &cache), NML_EINVAL);
+    ASSERT_NULL(cache.locals);
+    ASSERT_EQ(transformCacheInit(parents, 2, 0, &cache), NML_SUCCESS);
+    ASSERT_EQ(transformCacheSetLocal(&cache, 2, &m), NML_EINVAL);
+    ASSERT_EQ(transformCacheMarkDirty(&cache, 5), NML_EINVAL);
+    ASSERT_EQ(transformCacheSetLocal(&cache, 0, NULL), NML_ENULLMEM);
+    transformCacheFree(&cache);
+
+    ASSERT_EQ(transformCacheInit(NULL, 0, 0, &cache), NML_SUCCESS);
+    ASSERT_EQ(transformCacheUpdate(&cache), NML_SUCCESS);
+    transformCacheFree(&cache);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,84 @@
+#include "transform/hierarchy.h"
+#include "utils/errors.h"
+#include "utils/thread.h"
+#include "nutest.h"
+#include "transform_helpers.h"
+#include <math.h>
+#include <stdlib.h>
+
+TEST(HierarchyTests, SmallTree) {
+    // two trees: 0 -> (1 -> (3, 4), 2) and 5 -> 6
+    int32_t parents[7] = {-1, 0, 0, 1, 1, -1, 5};
+    Mat4 locals[7], worlds[7], expected[7];
+    for (size_t i = 0; i < 7; i++) {
+        localMatrix(i, &locals[i]);
+    }
+
+    Mat4Hierarchy h;
+    ASSERT_EQ(mat4HierarchyInit(parents, 7, &h), NML_SUCCESS);
+    ASSERT_EQ((int)h.levelCount, 3);
+    ASSERT_EQ((int)h.levels[1], 2); // two roots
+    ASSERT_EQ(mat4HierarchyEvaluate(&h, locals, worlds), NML_SUCCESS);
+
+    referenceWorlds(parents, locals, 7, expected);
+    ASSERT_TRUE(sameWorlds(worlds, expected, 7, 1e-5));
+    mat4HierarchyFree(&h);
+    ASSERT_NULL(h.order);
+    return TEST_PASS;
+}
+
+TEST(HierarchyTests, LargeTreeThreaded) {
+    // parents always come before children here, but the evaluator does not
+    // rely on that: node order is shuffled by the stride permutation below
+    enum { N = 20000 };
+    int32_t *parents = malloc(N * sizeof(int32_t));
+    Mat4 *locals = malloc(N * sizeof(Mat4));
+    Mat4 *worlds = malloc(N * sizeof(Mat4));
+    Mat4 *expected = malloc(N * sizeof(Mat4));
+    ASSERT_TRUE(parents && locals && worlds && expected);
+
+    // node k of a 3-ary tree is stored at slot (k * 7919) % N
+    for (size_t k = 0; k < N; k++) {
+        size_t slot = (k * 7919) % N;
+        parents[slot] = k == 0 ? -1 : (int32_t)((((k - 1) / 3) * 7919) % N);
+        localMatrix(k, &locals[slot]);
+    }
+    referenceWorlds(parents, locals, N, expected);
+
+    Mat4Hierarchy h;
+    ASSERT_EQ(mat4HierarchyInit(parents, N, &h), NML_SUCCESS);
+    int counts[] = {1, 4};
+    for (int t = 0; t < 2; t++) {
+        ASSERT_EQ(threadSetCount(counts[t]), NML_SUCCESS);
+        ASSERT_EQ(mat4HierarchyEvaluate(&h, locals, worlds), NML_SUCCESS);
+        ASSERT_TRUE(sameWorlds(worlds, expected, N, 1e-4));
+    }
+    mat4HierarchyFree(&h);
+
+    free(parents);
+    free(locals);
+    free(worlds);
+    free(expected);
+    return TEST_PASS;
+}
+
+TEST(HierarchyTests, InvalidParents) {
+    Mat4Hierarchy h;
+    int32_t outOfRange[3] = {-1, 0, 3};
+    int32_t cycle[4] = {-1, 2, 3, 1};
+    int32_t self[2] = {-1, 1};
+    ASSERT_EQ(mat4HierarchyInit(outOfRange, 3, &h), NML_EINVAL);
+    ASSERT_EQ(mat4HierarchyInit(cycle, 4, &h), NML_EINVAL);
+    ASSERT_NULL(h.order);
+    ASSERT_EQ(mat4HierarchyInit(self, 2, &h), NML_EINVAL);
+    ASSERT_EQ(mat4HierarchyInit(NULL, 2, &h), NML_ENULLMEM);
+
+    ASSERT_EQ(mat4HierarchyInit(NULL, 0, &h), NML_SUCCESS);
+    ASSERT_EQ(mat4HierarchyEvaluate(&h, NULL, NULL), NML_SUCCESS);
+    mat4HierarchyFree(&h);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,49 @@
+#ifndef __TRANSFORM_HELPERS_H__
+#define __TRANSFORM_HELPERS_H__
+
+#include "matrix/mat4d.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// small rotation about z plus a translation, varied by node index
+static inline void localMatrix(size_t i, Mat4 *m) {
+    nml_t angle = 0.01 * (nml_t)(i % 17);
+    mat4Identity(m);
+    m->cols[0].x = cos(angle);
+    m->cols[0].y = sin(angle);
+    m->cols[1].x = -sin(angle);
+    m->cols[1].y = cos(angle);
+    m->cols[3].x = 0.1 * (nml_t)(i % 5);
+    m->cols[3].z = 0.2;
+}
+
+// worlds by walking each node's parent chain and folding with mat4MulMat4
+static inline void referenceWorlds(const int32_t *parents,
+                                   const Mat4 *locals,
+                                   size_t n,
+                                   Mat4 *worlds) {
+    for (size_t i = 0; i < n; i++) {
+        Mat4 w = locals[i];
+        for (int32_t p = parents[i]; p >= 0; p = parents[p]) {
+            Mat4 l = locals[p];
+            mat4MulMat4(&l, &w, &w);
+        }
+        worlds[i] = w;
+    }
+}
+
+static inline int sameWorlds(const Mat4 *a,
+                             const Mat4 *b,
+                             size_t n,
+                             nml_t tol) {
+    for (size_t i = 0; i < n; i++) {
+        for (int j = 0; j < 16; j++) {
+            if (fabs(a[i].elems[j] - b[i].elems[j]) > tol)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+#endif // !__TRANSFORM_HELPERS_H__
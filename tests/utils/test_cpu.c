@@ -0,0 +1,40 @@
+#include "utils/cpu.h"
+#include "nutest.h"
+
+TEST(CpuTests, FeaturesAreConsistent) {
+    unsigned int f = cpuFeatures();
+    // wider ISAs always imply the narrower ones they extend
+    if (f & NML_CPU_AVX2)
+        ASSERT_TRUE(f & NML_CPU_AVX);
+    if (f & NML_CPU_AVX)
+        ASSERT_TRUE(f & NML_CPU_SSE2);
+#if defined(ARCH_X86) && defined(__x86_64__)
+    ASSERT_TRUE(f & NML_CPU_SSE2);
+#endif
+    ASSERT_EQ(cpuFeatures(), f);
+    return TEST_PASS;
+}
+
+TEST(CpuTests, HasAVX2FMA) {
+    unsigned int features = cpuFeatures();
+    int expected = (features & NML_CPU_AVX2) && (features & NML_CPU_FMA);
+    ASSERT_EQ(cpuHasAVX2FMA() != 0, expected);
+    return TEST_PASS;
+}
+
+TEST(CpuTests, BackendName) {
+    const char *name = cpuBackendName();
+    ASSERT_NOT_NULL(name);
+    if ((cpuFeatures() & NML_CPU_AVX2) && (cpuFeatures() & NML_CPU_FMA)) {
+#if defined(NML_DISPATCH_AVX2)
+        ASSERT_EQ(strcmp(name, "avx2+fma"), 0);
+#endif
+    } else {
+        ASSERT_NE(strcmp(name, "avx2+fma"), 0);
+    }
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,97 @@
+#include "utils/errors.h"
+#include "utils/thread.h"
+#include "nutest.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+
+typedef struct Hits {
+    atomic_int *counts;
+    atomic_int calls;
+} Hits;
+
+static void countRange(void *ctx, size_t begin, size_t end) {
+    Hits *hits = ctx;
+    atomic_fetch_add(&hits->calls, 1);
+    for (size_t i = begin; i < end; i++) {
+        atomic_fetch_add(&hits->counts[i], 1);
+    }
+}
+
+static int everyIndexOnce(Hits *hits, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (atomic_load(&hits->counts[i]) != 1)
+            return 0;
+    }
+    return 1;
+}
+
+TEST(ThreadTests, CoversRangeOnce) {
+    enum { N = 100003 };
+    ASSERT_EQ(threadSetCount(4), NML_SUCCESS);
+    ASSERT_EQ(threadCount(), 4);
+
+    Hits hits = {calloc(N, sizeof(atomic_int)), 0};
+    ASSERT_NOT_NULL(hits.counts);
+    for (int rep = 0; rep < 10; rep++) {
+        for (size_t i = 0; i < N; i++) {
+            atomic_store(&hits.counts[i], 0);
+        }
+        ASSERT_EQ(parallelFor(N, 1000, countRange, &hits), NML_SUCCESS);
+        ASSERT_TRUE(everyIndexOnce(&hits, N));
+    }
+    free(hits.counts);
+    return TEST_PASS;
+}
+
+TEST(ThreadTests, SmallLoopsRunInline) {
+    enum { N = 10 };
+    atomic_int counts[N] = {0};
+    Hits hits = {counts, 0};
+    ASSERT_EQ(threadSetCount(4), NML_SUCCESS);
+
+    ASSERT_EQ(parallelFor(N, 64, countRange, &hits), NML_SUCCESS);
+    ASSERT_EQ(atomic_load(&hits.calls), 1);
+    ASSERT_TRUE(everyIndexOnce(&hits, N));
+
+    ASSERT_EQ(parallelFor(0, 1, countRange, &hits), NML_SUCCESS);
+    ASSERT_EQ(atomic_load(&hits.calls), 1);
+    ASSERT_EQ(parallelFor(N, 1, NULL, &hits), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+static void nestedRange(void *ctx, size_t begin, size_t end) {
+    Hits *hits = ctx;
+    // the inner loop must not deadlock on the pool the outer one holds
+    for (size_t i = begin; i < end; i++) {
+        parallelFor(1, 1, countRange, &(Hits){&hits->counts[i], 0});
+    }
+}
+
+TEST(ThreadTests, NestedLoops) {
+    enum { N = 4096 };
+    Hits hits = {calloc(N, sizeof(atomic_int)), 0};
+    ASSERT_NOT_NULL(hits.counts);
+    ASSERT_EQ(threadSetCount(3), NML_SUCCESS);
+    ASSERT_EQ(parallelFor(N, 16, nestedRange, &hits), NML_SUCCESS);
+    ASSERT_TRUE(everyIndexOnce(&hits, N));
+    free(hits.counts);
+    return TEST_PASS;
+}
+
+TEST(ThreadTests, SetCount) {
+    ASSERT_EQ(threadSetCount(0), NML_EINVAL);
+    ASSERT_EQ(threadSetCount(1), NML_SUCCESS);
+    ASSERT_EQ(threadCount(), 1);
+
+    enum { N = 1000 };
+    atomic_int counts[N] = {0};
+    Hits hits = {counts, 0};
+    ASSERT_EQ(parallelFor(N, 1, countRange, &hits), NML_SUCCESS);
+    ASSERT_EQ(atomic_load(&hits.calls), 1);
+    ASSERT_TRUE(everyIndexOnce(&hits, N));
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
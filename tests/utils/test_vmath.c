@@ -0,0 +1,301 @@
+#include "utils/errors.h"
+#include "utils/math.h"
+#include "utils/vmath.h"
+#include "nutest.h"
+#include "test_random.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// the documented bounds of vmath.h
+#define TRIG_ULP 2.5
+#define TAN_ULP 3.5
+#define ATAN2_ULP 3.5
+#define EXP_ULP 1.5
+#define LOG_ULP 1.5
+
+enum { N = 20011 };
+static nml_t in[N], in2[N], out[N], out2[N];
+
+// inputs are built and checked through their bits, the release tests are
+// compiled with -ffast-math which may fold isnan / isinf away
+static float fromBits(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static uint32_t toBits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static int isNanBits(float f) {
+    return (toBits(f) & 0x7fffffffu) > 0x7f800000u;
+}
+
+static float lane(simd_f32x4_t v, int i) {
+    float f[4];
+    simd_storeu_f32(f, v);
+    return f[i];
+}
+
+// distance to the exact result in units of the float spacing around it
+static double ulpError(double got, double ref) {
+    int e;
+    frexp(ref, &e);
+    return fabs(got - ref) / ldexp(1.0, e - 24 < -149 ? -149 : e - 24);
+}
+
+// floats with bit patterns spread over [lo, hi], both signs if asked
+static void fillBits(uint32_t lo, uint32_t hi, int bothSigns, unsigned seed) {
+    for (size_t i = 0; i < N; i++) {
+        uint32_t u = lo + nextRandom(&seed) % (hi - lo + 1);
+        if (bothSigns && (nextRandom(&seed) & 1))
+            u |= 0x80000000u;
+        in[i] = fromBits(u);
+    }
+}
+
+static double maxUlp(const nml_t *got, double (*ref)(double)) {
+    double worst = 0.0;
+    for (size_t i = 0; i < N; i++) {
+        double e = ulpError(got[i], ref(in[i]));
+        worst = e > worst ? e : worst;
+    }
+    return worst;
+}
+
+TEST(VMathTests, SinCosTan) {
+    // random floats up to 8192, then the ones right next to multiples of
+    // pi/2 where the reduced argument is smallest
+    fillBits(0, 0x46000000u, 1, 7);
+    for (size_t k = 1; k < 5215; k += 3) {
+        float f = (float)(k * 1.57079632679489662);
+        in[N - 1 - k / 3 * 2] = f;
+        in[N - 2 - k / 3 * 2] = fromBits(toBits(f) + 1);
+    }
+
+    ASSERT_EQ(SinBatch(in, out, N), NML_SUCCESS);
+    ASSERT_TRUE(maxUlp(out, sin) <= TRIG_ULP);
+    ASSERT_EQ(CosBatch(in, out, N), NML_SUCCESS);
+    ASSERT_TRUE(maxUlp(out, cos) <= TRIG_ULP);
+    ASSERT_EQ(TanBatch(in, out, N), NML_SUCCESS);
+    ASSERT_TRUE(maxUlp(out, tan) <= TAN_ULP);
+
+    ASSERT_EQ(SinCosBatch(in, out, out2, N), NML_SUCCESS);
+    ASSERT_TRUE(maxUlp(out, sin) <= TRIG_ULP);
+    ASSERT_TRUE(maxUlp(out2, cos) <= TRIG_ULP);
+    return TEST_PASS;
+}
+
+TEST(VMathTests, ExpLog) {
+    // exp over its normal range
+    unsigned s = 11;
+    for (size_t i = 0; i < N; i++) {
+        in[i] = (nml_t)((double)nextRandom(&s) / (1u << 24) * 176.0 - 87.3);
+    }
+    ASSERT_EQ(ExpBatch(in, out, N), NML_SUCCESS);
+    ASSERT_TRUE(maxUlp(out, exp) <= EXP_ULP);
+
+    // log over every positive finite float, subnormals included
+    fillBits(1, 0x7f7fffffu, 0, 13);
+    ASSERT_EQ(LogBatch(in, out, N), NML_SUCCESS);
+    ASSERT_TRUE(maxUlp(out, log) <= LOG_ULP);
+    return TEST_PASS;
+}
+
+TEST(VMathTests, Atan2) {
+    unsigned s = 17;
+    fillBits(0x20000000u, 0x5f000000u, 1, 19);
+    for (size_t i = 0; i < N; i++) {
+        // a third of the pairs close to the diagonal |y| = |x|
+        if (i % 3 == 0)
+            in2[i] = in[i] * (nml_t)((nextRandom(&s) % 2048) / 1024.0f - 1.0f);
+        else
+            in2[i] = fromBits((0x20000000u + nextRandom(&s) % 0x3f000000u) |
+                              (nextRandom(&s) & 1u) << 31);
+    }
+    ASSERT_EQ(Atan2Batch(in, in2, out, N), NML_SUCCESS);
+    double worst = 0.0;
+    for (size_t i = 0; i < N; i++) {
+        double e = ulpError(out[i], atan2(in[i], in2[i]));
+        worst = e > worst ? e : worst;
+    }
+    ASSERT_TRUE(worst <= ATAN2_ULP);
+    return TEST_PASS;
+}
+
+TEST(VMathTests, Pow) {
+    // x over all normal floats, y chosen so |y * log x| stays below 88
+    unsigned s = 23;
+    fillBits(0x00800000u, 0x7f7fffffu, 0, 29);
+    for (size_t i = 0; i < N; i++) {
+        double t = (double)nextRandom(&s) / (1u << 24) * 176.0 - 88.0;
+        double y = t / log(in[i]);
+        in2[i] = (nml_t)(fabs(y) < 1e30 ? y : 1.0);
+    }
+    ASSERT_EQ(PowBatch(in, in2, out, N), NML_SUCCESS);
+    for (size_t i = 0; i < N; i++) {
+        double ref = pow(in[i], in2[i]);
+        if (ref < 1.2e-38 || ref > 3.4e38)
+            continue;
+        double t = fabs(in2[i] * log(in[i]));
+        ASSERT_TRUE(ulpError(out[i], ref) <= 2.0 + t / 5.0);
+    }
+    return TEST_PASS;
+}
+
+static simd_f32x4_t vec4(float a, float b, float c, float d) {
+    float f[4] = {a, b, c, d};
+    return simd_loadu_f32(f);
+}
+
+TEST(VMathTests, SpecialValues) {
+    float inf = fromBits(0x7f800000u), nan = fromBits(0x7fc00000u);
+    float pi = (float)3.14159265358979324;
+
+    simd_f32x4_t v = SimdExp(vec4(inf, -inf, nan, 100.0f));
+    ASSERT_EQ(toBits(lane(v, 0)), 0x7f800000u);
+    ASSERT_EQ(toBits(lane(v, 1)), 0u);
+    ASSERT_TRUE(isNanBits(lane(v, 2)));
+    ASSERT_EQ(toBits(lane(v, 3)), 0x7f800000u);
+    ASSERT_TRUE(lane(SimdExp(simd_set1_f32(-100.0f)), 0) < 1.2e-38f);
+
+    v = SimdLog(vec4(0.0f, -1.0f, inf, 1.0f));
+    ASSERT_EQ(toBits(lane(v, 0)), 0xff800000u);
+    ASSERT_TRUE(isNanBits(lane(v, 1)));
+    ASSERT_EQ(toBits(lane(v, 2)), 0x7f800000u);
+    ASSERT_EQ(toBits(lane(v, 3)), 0u);
+
+    // quadrants and signed zeros like libm
+    v = SimdAtan2(vec4(0.0f, -0.0f, 1.0f, -1.0f),
+                  vec4(-1.0f, -1.0f, 0.0f, 0.0f));
+    ASSERT_FLOAT_EQ(lane(v, 0), pi);
+    ASSERT_FLOAT_EQ(lane(v, 1), -pi);
+    ASSERT_FLOAT_EQ(lane(v, 2), pi / 2.0f);
+    ASSERT_FLOAT_EQ(lane(v, 3), -pi / 2.0f);
+    v = SimdAtan2(vec4(0.0f, -0.0f, 3.0f, -2.0f),
+                  vec4(0.0f, 5.0f, -3.0f, -2.0f));
+    ASSERT_EQ(toBits(lane(v, 0)), 0u);
+    ASSERT_EQ(toBits(lane(v, 1)), 0x80000000u);
+    ASSERT_FLOAT_EQ(lane(v, 2), 0.75f * pi);
+    ASSERT_FLOAT_EQ(lane(v, 3), -0.75f * pi);
+
+    // negative bases with integer exponents, everything to the 0 is 1
+    v = SimdPow(vec4(-2.0f, -2.0f, -2.0f, nan), vec4(3.0f, 2.0f, 0.5f, 0.0f));
+    ASSERT_FLOAT_EQ(lane(v, 0), -8.0f);
+    ASSERT_FLOAT_EQ(lane(v, 1), 4.0f);
+    ASSERT_TRUE(isNanBits(lane(v, 2)));
+    ASSERT_FLOAT_EQ(lane(v, 3), 1.0f);
+    v = SimdPow(vec4(0.0f, 0.0f, 10.0f, 0.5f),
+                vec4(2.0f, -1.0f, 40.0f, 200.0f));
+    ASSERT_EQ(toBits(lane(v, 0)), 0u);
+    ASSERT_EQ(toBits(lane(v, 1)), 0x7f800000u);
+    ASSERT_EQ(toBits(lane(v, 2)), 0x7f800000u);
+    ASSERT_TRUE(lane(v, 3) < 1.2e-38f);
+    return TEST_PASS;
+}
+
+TEST(VMathTests, Lanes) {
+    simd_f32x4_t x = vec4(-3.0f, 0.5f, 1.0f, 20.0f);
+    simd_f32x4_t s, c;
+    SimdSinCos(x, &s, &c);
+    for (int i = 0; i < 4; i++) {
+        double xi = lane(x, i);
+        ASSERT_TRUE(ulpError(lane(SimdSin(x), i), sin(xi)) <= TRIG_ULP);
+        ASSERT_TRUE(ulpError(lane(SimdCos(x), i), cos(xi)) <= TRIG_ULP);
+        ASSERT_TRUE(ulpError(lane(s, i), sin(xi)) <= TRIG_ULP);
+        ASSERT_TRUE(ulpError(lane(c, i), cos(xi)) <= TRIG_ULP);
+        ASSERT_TRUE(ulpError(lane(SimdTan(x), i), tan(xi)) <= TAN_ULP);
+        ASSERT_TRUE(ulpError(lane(SimdExp(x), i), exp(xi)) <= EXP_ULP);
+    }
+    return TEST_PASS;
+}
+
+TEST(VMathTests, TailsAndAliasing) {
+    // every tail length of both the 4 and the 8 lane loops, in place
+    for (size_t n = 1; n <= 19; n++) {
+        nml_t a[19], b[19], x[19];
+        for (size_t i = 0; i < n; i++) {
+            a[i] = b[i] = x[i] = (nml_t)i * 0.37 - 2.0;
+        }
+        ASSERT_EQ(ExpBatch(a, out, n), NML_SUCCESS);
+        ASSERT_EQ(ExpBatch(a, a, n), NML_SUCCESS);
+        ASSERT_MEM_EQ(a, out, n * sizeof(nml_t));
+        ASSERT_EQ(SinCosBatch(b, b, out2, n), NML_SUCCESS);
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_TRUE(ulpError(b[i], sin(x[i])) <= TRIG_ULP);
+        }
+    }
+    ASSERT_EQ(SinBatch(NULL, out, 4), NML_ENULLMEM);
+    ASSERT_EQ(PowBatch(in, NULL, out, 4), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+TEST(VMathTests, RSqrtTiers) {
+    // relative error bounds per tier, the neon estimate is coarser
+#if defined(DEFINE_SIMD__NEON)
+    const double bound[3] = {4e-3, 3e-5, 2.5e-7};
+#else
+    const double bound[3] = {3.7e-4, 2.5e-7, 1.2e-7};
+#endif
+    fillBits(0x00800000u, 0x7f7fffffu, 0, 31);
+    for (int tier = NML_SQRT_FAST; tier <= NML_SQRT_PRECISE; tier++) {
+        double rs = 0.0, sq = 0.0;
+        ASSERT_EQ(RSqrtBatch(in, out, N, tier), NML_SUCCESS);
+        ASSERT_EQ(SqrtBatch(in, out2, N, tier), NML_SUCCESS);
+        for (size_t i = 0; i < N; i++) {
+            double r = 1.0 / sqrt(in[i]), s = sqrt(in[i]);
+            double e = fabs(out[i] - r) / r;
+            rs = e > rs ? e : rs;
+            e = fabs(out2[i] - s) / s;
+            sq = e > sq ? e : sq;
+        }
+        ASSERT_TRUE(rs <= bound[tier]);
+        // one more rounding for x * rsqrt(x)
+        ASSERT_TRUE(sq <= bound[tier] + 6e-8);
+    }
+
+    // exact at the edges, including the 4 and 8 lane tails
+    nml_t edge[5] = {0.0, fromBits(0x7f800000u), 4.0, 0.0, 4.0};
+    ASSERT_EQ(SqrtBatch(edge, out, 5, NML_SQRT_FAST), NML_SUCCESS);
+    ASSERT_EQ(toBits(out[0]), 0u);
+    ASSERT_EQ(toBits(out[1]), 0x7f800000u);
+    ASSERT_EQ(toBits(out[3]), 0u);
+    ASSERT_EQ(RSqrtBatch(edge, out, 5, NML_SQRT_PRECISE), NML_SUCCESS);
+    ASSERT_EQ(toBits(out[0]), 0x7f800000u);
+    ASSERT_EQ(toBits(out[1]), 0u);
+    ASSERT_TRUE(fabs(out[4] - 0.5) <= 1e-7);
+    ASSERT_TRUE(isNanBits(lane(SimdSqrt(simd_set1_f32(-1.0f), 1), 0)));
+    ASSERT_TRUE(fabs(lane(SimdRSqrt(simd_set1_f32(0.25f), 2), 3) - 2.0) <=
+                3e-7);
+
+    ASSERT_TRUE(fabs(Q_RSqrt(4.0) - 0.5) <= 1e-7);
+    ASSERT_TRUE(fabs(Q_Sqrt(2.0) - 1.41421356237309505) <= 3e-7);
+
+    // out of range tiers run as NML_SQRT_PRECISE, lanes and batches alike
+    ASSERT_EQ(RSqrtBatch(in, out, N, NML_SQRT_PRECISE), NML_SUCCESS);
+    ASSERT_EQ(SqrtBatch(in, out2, N, NML_SQRT_PRECISE), NML_SUCCESS);
+    const int badTiers[3] = {-1, NML_SQRT_PRECISE + 1, 1000};
+    static nml_t rs[N], sq[N];
+    for (int k = 0; k < 3; k++) {
+        ASSERT_EQ(RSqrtBatch(in, rs, N, badTiers[k]), NML_SUCCESS);
+        ASSERT_EQ(SqrtBatch(in, sq, N, badTiers[k]), NML_SUCCESS);
+        ASSERT_MEM_EQ(rs, out, N * sizeof(nml_t));
+        ASSERT_MEM_EQ(sq, out2, N * sizeof(nml_t));
+
+        simd_f32x4_t x = simd_set1_f32(0.3f);
+        ASSERT_EQ(toBits(lane(SimdRSqrt(x, badTiers[k]), 0)),
+                  toBits(lane(SimdRSqrt(x, NML_SQRT_PRECISE), 0)));
+        ASSERT_EQ(toBits(lane(SimdSqrt(x, badTiers[k]), 2)),
+                  toBits(lane(SimdSqrt(x, NML_SQRT_PRECISE), 2)));
+    }
+    ASSERT_EQ(SqrtBatch(NULL, out, N, NML_SQRT_FAST), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
@@ -25,7 +25,7 @@ TEST(Vec2Test, InitZero) {
 
 TEST(Vec2Test, Length) {
     Vec2 v = {{1.0, 2.0}};
-    ASSERT_FLOAT_EQ(vec2Length(&v), sqrtf(1.0 + 4.0));
+    ASSERT_FLOAT_EQ(vec2Length(&v), (nml_t)sqrt(1.0 + 4.0));
     return TEST_PASS;
 }
 
@@ -39,7 +39,7 @@ TEST(Vec2Test, Normalize) {
     Vec2 v = {{1.0, 2.0}};
     Vec2 out;
     ASSERT_EQ(vec2Normalize(&v, &out), NML_SUCCESS);
-    float len = vec2Length(&v);
+    nml_t len = vec2Length(&v);
     ASSERT_FLOAT_EQ(out.x, v.x / len);
     ASSERT_FLOAT_EQ(out.y, v.y / len);
     return TEST_PASS;
@@ -52,6 +52,35 @@ TEST(Vec2Test, NormalizeZeroFails) {
     return TEST_PASS;
 }
 
+TEST(Vec2Test, NormalizeBatch) {
+    // 11 vectors cover the four wide loop and its tail, one zero in each
+    Vec2 vecs[11], out[11], fallback = {{1.0, 0.0}};
+    uint8_t valid[11];
+    for (int i = 0; i < 11; i++) {
+        Vec2 v = {{(nml_t)(i + 1) * 0.5, -(nml_t)i - 1.0}};
+        vecs[i] = v;
+    }
+    vecs[1].x = vecs[9].x = 0.0;
+    vecs[1].y = vecs[9].y = 0.0;
+
+    ASSERT_EQ(vec2NormalizeBatch(vecs, out, 11, &fallback, valid),
+              NML_SUCCESS);
+    for (int i = 0; i < 11; i++) {
+        Vec2 e = fallback;
+        if (i != 1 && i != 9)
+            vec2Normalize(&vecs[i], &e);
+        ASSERT_TRUE(vec2Near(&out[i], &e, 1e-6));
+        ASSERT_EQ(valid[i], i != 1 && i != 9);
+    }
+
+    // in place, zero vectors stay zero without a fallback
+    ASSERT_EQ(vec2NormalizeBatch(vecs, vecs, 11, NULL, NULL), NML_SUCCESS);
+    ASSERT_TRUE(vec2Near(&vecs[3], &out[3], 1e-6));
+    ASSERT_DOUBLE_EQ(vecs[9].x, 0.0);
+    ASSERT_EQ(vec2NormalizeBatch(NULL, out, 11, NULL, NULL), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
 TEST(Vec2Test, DotProduct) {
     Vec2 a = {{1.0, 2.0}};
     Vec2 b = {{4.0, 3.0}};
@@ -0,0 +1,179 @@
+#include "nutest.h"
+#include "vector/vec3a.h"
+#include "utils/errors.h"
+
+static void vec3Pair(Vec3 *a, Vec3 *b, Vec3A *aa, Vec3A *ab) {
+    vec3Init(1.5, -2.0, 3.0, a);
+    vec3Init(-0.5, 4.0, 2.0, b);
+    vec3AFromVec3(a, aa);
+    vec3AFromVec3(b, ab);
+}
+
+TEST(Vec3ATest, InitAndConvert) {
+    Vec3A v;
+    Vec3 p;
+    ASSERT_EQ(vec3AInit(1.0, 2.0, 3.0, &v), NML_SUCCESS);
+    ASSERT_DOUBLE_EQ(v.pad, 0.0);
+    ASSERT_EQ(vec3AToVec3(&v, &p), NML_SUCCESS);
+    ASSERT_DOUBLE_EQ(p.x, 1.0);
+    ASSERT_DOUBLE_EQ(p.y, 2.0);
+    ASSERT_DOUBLE_EQ(p.z, 3.0);
+    ASSERT_EQ((int)sizeof(Vec3A), (int)(4 * sizeof(nml_t)));
+    return TEST_PASS;
+}
+
+TEST(Vec3ATest, ArrayConvert) {
+    // odd count so both the 4-wide loop and the tail run
+    enum { N = 11 };
+    Vec3 in[N], out[N];
+    Vec3A padded[N];
+    for (int i = 0; i < N; i++) {
+        vec3Init((nml_t)i, -0.5 * i, 2.0 + i, &in[i]);
+    }
+
+    ASSERT_EQ(vec3AFromVec3Array(in, padded, N), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        ASSERT_DOUBLE_EQ(padded[i].x, in[i].x);
+        ASSERT_DOUBLE_EQ(padded[i].y, in[i].y);
+        ASSERT_DOUBLE_EQ(padded[i].z, in[i].z);
+        ASSERT_DOUBLE_EQ(padded[i].pad, 0.0);
+    }
+    ASSERT_EQ(vec3AToVec3Array(padded, out, N), NML_SUCCESS);
+    ASSERT_MEM_EQ(in, out, sizeof(in));
+    return TEST_PASS;
+}
+
+TEST(Vec3ATest, Arithmetic) {
+    Vec3 a, b, e;
+    Vec3A aa, ab, r;
+    vec3Pair(&a, &b, &aa, &ab);
+
+    vec3AAdd(&aa, &ab, &r);
+    vec3Add(&a, &b, &e);
+    ASSERT_DOUBLE_EQ(r.x, e.x);
+    ASSERT_DOUBLE_EQ(r.z, e.z);
+
+    vec3ASub(&aa, &ab, &r);
+    vec3Sub(&a, &b, &e);
+    ASSERT_DOUBLE_EQ(r.y, e.y);
+
+    vec3AMul(&aa, &ab, &r);
+    vec3Mul(&a, &b, &e);
+    ASSERT_DOUBLE_EQ(r.x, e.x);
+
+    ASSERT_EQ(vec3ADiv(&aa, &ab, &r), NML_SUCCESS);
+    vec3Div(&a, &b, &e);
+    ASSERT_NEAR(r.y, e.y, kEPSILON);
+    ASSERT_DOUBLE_EQ(r.pad, 0.0);
+
+    vec3AScale(&aa, -3.0, &r);
+    ASSERT_DOUBLE_EQ(r.z, -9.0);
+    vec3ANegate(&aa, &r);
+    ASSERT_DOUBLE_EQ(r.x, -1.5);
+    ASSERT_DOUBLE_EQ(r.pad, 0.0);
+
+    Vec3A zero;
+    vec3AInitZero(&zero);
+    ASSERT_EQ(vec3ADiv(&aa, &zero, &r), NML_EZERODIV);
+    return TEST_PASS;
+}
+
+TEST(Vec3ATest, DotCrossLength) {
+    Vec3 a, b, e;
+    Vec3A aa, ab, r;
+    vec3Pair(&a, &b, &aa, &ab);
+
+    ASSERT_NEAR(vec3ADot(&aa, &ab), vec3Dot(&a, &b), kEPSILON);
+    ASSERT_NEAR(vec3ALength(&aa), vec3Length(&a), 1e-5);
+    ASSERT_NEAR(vec3ALengthSqr(&aa), vec3LengthSqr(&a), 1e-5);
+
+    ASSERT_EQ(vec3ACross(&aa, &ab, &r), NML_SUCCESS);
+    vec3Cross(&a, &b, &e);
+    ASSERT_NEAR(r.x, e.x, kEPSILON);
+    ASSERT_NEAR(r.y, e.y, kEPSILON);
+    ASSERT_NEAR(r.z, e.z, kEPSILON);
+    ASSERT_DOUBLE_EQ(r.pad, 0.0);
+
+    // in place
+    vec3ACross(&aa, &ab, &aa);
+    ASSERT_NEAR(aa.x, e.x, kEPSILON);
+    return TEST_PASS;
+}
+
+// every output starts with a garbage pad and has to come back with pad == 0
+TEST(Vec3ATest, OutputsClearPad) {
+    Vec3 a, b, v;
+    Vec3A aa, ab, r;
+    vec3Pair(&a, &b, &aa, &ab);
+
+#define CHECK_PAD(call)               \
+    do {                              \
+        r.pad = 9.0;                  \
+        ASSERT_EQ(call, NML_SUCCESS); \
+        ASSERT_DOUBLE_EQ(r.pad, 0.0); \
+    } while (0)
+
+    CHECK_PAD(vec3AInit(1.0, 2.0, 3.0, &r));
+    CHECK_PAD(vec3AInitZero(&r));
+    CHECK_PAD(vec3AFromVec3(&a, &r));
+    CHECK_PAD(vec3AAdd(&aa, &ab, &r));
+    CHECK_PAD(vec3ASub(&aa, &ab, &r));
+    CHECK_PAD(vec3AMul(&aa, &ab, &r));
+    CHECK_PAD(vec3ADiv(&aa, &ab, &r));
+    CHECK_PAD(vec3ACross(&aa, &ab, &r));
+    CHECK_PAD(vec3AScale(&aa, 2.5, &r));
+    CHECK_PAD(vec3ANegate(&aa, &r));
+    CHECK_PAD(vec3ANormalize(&aa, &r));
+    CHECK_PAD(vec3AProject(&aa, &ab, &r));
+    CHECK_PAD(vec3AReject(&aa, &ab, &r));
+    CHECK_PAD(vec3AReflect(&aa, &ab, &r));
+#undef CHECK_PAD
+
+    Vec3 vecs[9];
+    Vec3A outs[9];
+    for (int i = 0; i < 9; i++) {
+        vec3Init((nml_t)i, 1.0, -2.0, &vecs[i]);
+        outs[i].pad = 9.0;
+    }
+    ASSERT_EQ(vec3AFromVec3Array(vecs, outs, 9), NML_SUCCESS);
+    for (int i = 0; i < 9; i++)
+        ASSERT_DOUBLE_EQ(outs[i].pad, 0.0);
+
+    // a chain fed only through the api keeps the invariant, so the dot
+    // products inside it see the xyz lanes only
+    vec3AAdd(&aa, &ab, &r);
+    vec3ANormalize(&r, &r);
+    vec3AToVec3(&r, &v);
+    ASSERT_NEAR(vec3ALength(&r), 1.0, 1e-5);
+    ASSERT_NEAR(vec3Length(&v), 1.0, 1e-5);
+    return TEST_PASS;
+}
+
+TEST(Vec3ATest, NormalizeProject) {
+    Vec3 a, b, e;
+    Vec3A aa, ab, r, zero;
+    vec3Pair(&a, &b, &aa, &ab);
+    vec3AInitZero(&zero);
+
+    ASSERT_EQ(vec3ANormalize(&aa, &r), NML_SUCCESS);
+    vec3Normalize(&a, &e);
+    ASSERT_NEAR(r.x, e.x, 1e-6);
+    ASSERT_NEAR(r.z, e.z, 1e-6);
+    ASSERT_EQ(vec3ANormalize(&zero, &r), NML_EZERODIV);
+
+    ASSERT_EQ(vec3AProject(&aa, &ab, &r), NML_SUCCESS);
+    vec3Project(&a, &b, &e);
+    ASSERT_NEAR(r.y, e.y, 1e-5);
+    ASSERT_EQ(vec3AReject(&aa, &ab, &r), NML_SUCCESS);
+    vec3Reject(&a, &b, &e);
+    ASSERT_NEAR(r.x, e.x, 1e-5);
+    ASSERT_EQ(vec3AReflect(&aa, &ab, &r), NML_SUCCESS);
+    vec3Reflect(&a, &b, &e);
+    ASSERT_NEAR(r.z, e.z, 1e-5);
+    ASSERT_EQ(vec3AProject(&aa, &zero, &r), NML_EZERODIV);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}
@@ -28,7 +28,7 @@ TEST(Vec3Test, Initzero) {
 
 TEST(Vec3Test, Length) {
     Vec3 v = {{1.0, 2.0, 3.0}};
-    ASSERT_DOUBLE_EQ(vec3Length(&v), sqrtf(1.0 + 4.0 + 9.0));
+    ASSERT_DOUBLE_EQ(vec3Length(&v), (nml_t)sqrt(1.0 + 4.0 + 9.0));
     return TEST_PASS;
 }
 
@@ -42,7 +42,7 @@ TEST(Vec3Test, Normalize) {
     Vec3 v = {{1.0, 2.0, 3.0}};
     Vec3 out;
     ASSERT_EQ(vec3Normalize(&v, &out), NML_SUCCESS);
-    float len = vec3Length(&v);
+    nml_t len = vec3Length(&v);
     ASSERT_DOUBLE_EQ(out.x, v.x / len);
     ASSERT_DOUBLE_EQ(out.y, v.y / len);
     ASSERT_DOUBLE_EQ(out.z, v.z / len);
@@ -56,6 +56,36 @@ TEST(Vec3Test, NormalizezeroFails) {
     return TEST_PASS;
 }
 
+TEST(Vec3Test, NormalizeBatch) {
+    // 11 vectors cover the four wide loop and its tail, one zero in each
+    Vec3 vecs[11], out[11], fallback = {{1.0, 0.0, 0.0}};
+    uint8_t valid[11];
+    for (int i = 0; i < 11; i++) {
+        Vec3 v = {{(nml_t)(i + 1) * 0.5, -(nml_t)i - 1.0, (nml_t)(i + 3) * 0.5}};
+        vecs[i] = v;
+    }
+    vecs[1].x = vecs[9].x = 0.0;
+    vecs[1].y = vecs[9].y = 0.0;
+    vecs[1].z = vecs[9].z = 0.0;
+
+    ASSERT_EQ(vec3NormalizeBatch(vecs, out, 11, &fallback, valid),
+              NML_SUCCESS);
+    for (int i = 0; i < 11; i++) {
+        Vec3 e = fallback;
+        if (i != 1 && i != 9)
+            vec3Normalize(&vecs[i], &e);
+        ASSERT_TRUE(vec3Near(&out[i], &e, 1e-6));
+        ASSERT_EQ(valid[i], i != 1 && i != 9);
+    }
+
+    // in place, zero vectors stay zero without a fallback
+    ASSERT_EQ(vec3NormalizeBatch(vecs, vecs, 11, NULL, NULL), NML_SUCCESS);
+    ASSERT_TRUE(vec3Near(&vecs[3], &out[3], 1e-6));
+    ASSERT_DOUBLE_EQ(vecs[9].x, 0.0);
+    ASSERT_EQ(vec3NormalizeBatch(NULL, out, 11, NULL, NULL), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
 TEST(Vec3Test, DotProduct) {
     Vec3 a = {{1.0, 2.0, 3.0}};
     Vec3 b = {{4.0, 3.0, 2.0}};
@@ -30,7 +30,7 @@ TEST(Vec4Test, Initzero) {
 
 TEST(Vec4Test, Length) {
     Vec4 v = {{1.0, 2.0, 3.0, 4.0}};
-    ASSERT_DOUBLE_EQ(vec4Length(&v), sqrtf(1.0 + 4.0 + 9.0 + 16.0));
+    ASSERT_DOUBLE_EQ(vec4Length(&v), (nml_t)sqrt(1.0 + 4.0 + 9.0 + 16.0));
     return TEST_PASS;
 }
 
@@ -44,7 +44,7 @@ TEST(Vec4Test, Normalize) {
     Vec4 v = {{1.0, 2.0, 3.0, 4.0}};
     Vec4 out;
     ASSERT_EQ(vec4Normalize(&v, &out), NML_SUCCESS);
-    float len = vec4Length(&v);
+    nml_t len = vec4Length(&v);
     ASSERT_DOUBLE_EQ(out.x, v.x / len);
     ASSERT_DOUBLE_EQ(out.y, v.y / len);
     ASSERT_DOUBLE_EQ(out.z, v.z / len);
@@ -59,6 +59,37 @@ TEST(Vec4Test, NormalizezeroFails) {
     return TEST_PASS;
 }
 
+TEST(Vec4Test, NormalizeBatch) {
+    // 11 vectors cover the four wide loop and its tail, one zero in each
+    Vec4 vecs[11], out[11], fallback = {{1.0, 0.0, 0.0, 0.0}};
+    uint8_t valid[11];
+    for (int i = 0; i < 11; i++) {
+        Vec4 v = {{(nml_t)(i + 1) * 0.5, -(nml_t)i - 1.0, (nml_t)(i + 3) * 0.5, -(nml_t)i - 3.0}};
+        vecs[i] = v;
+    }
+    vecs[1].x = vecs[9].x = 0.0;
+    vecs[1].y = vecs[9].y = 0.0;
+    vecs[1].z = vecs[9].z = 0.0;
+    vecs[1].w = vecs[9].w = 0.0;
+
+    ASSERT_EQ(vec4NormalizeBatch(vecs, out, 11, &fallback, valid),
+              NML_SUCCESS);
+    for (int i = 0; i < 11; i++) {
+        Vec4 e = fallback;
+        if (i != 1 && i != 9)
+            vec4Normalize(&vecs[i], &e);
+        ASSERT_TRUE(vec4Near(&out[i], &e, 1e-6));
+        ASSERT_EQ(valid[i], i != 1 && i != 9);
+    }
+
+    // in place, zero vectors stay zero without a fallback
+    ASSERT_EQ(vec4NormalizeBatch(vecs, vecs, 11, NULL, NULL), NML_SUCCESS);
+    ASSERT_TRUE(vec4Near(&vecs[3], &out[3], 1e-6));
+    ASSERT_DOUBLE_EQ(vecs[9].x, 0.0);
+    ASSERT_EQ(vec4NormalizeBatch(NULL, out, 11, NULL, NULL), NML_ENULLMEM);
+    return TEST_PASS;
+}
+
 TEST(Vec4Test, DotProduct) {
     Vec4 a = {{1.0, 2.0, 3.0, 4.0}};
     Vec4 b = {{4.0, 3.0, 2.0, 1.0}};
@@ -165,7 +196,7 @@ TEST(Vec4Test, Reject) {
 TEST(Vec4Test, Reflect) {
     Vec4 a = {{1.0, -1.0, 0.0, 0.0}};
     Vec4 n = {{0.0, 1.0, 0.0, 0.0}};
-    Vec4 normalized_n;
+    Vec4 normalized_n = {{0}};
     vec4Normalize(&n, &normalized_n);
     Vec4 out;
     ASSERT_EQ(vec4Reflect(&a, &normalized_n, &out), NML_SUCCESS);
@@ -0,0 +1,253 @@
+#include "nutest.h"
+#include "vector/vecstream.h"
+#include "utils/errors.h"
+
+// odd sizes so every kernel runs both its vector loop and the scalar tail
+#define N 19
+
+static void fillVec3(Vec3 *vecs, size_t n, nml_t offset) {
+    for (size_t i = 0; i < n; i++) {
+        vec3Init(offset + (nml_t)i, (nml_t)(i % 4) - 1.5, 0.5 * (nml_t)i,
+                 &vecs[i]);
+    }
+}
+
+static void fillVec4(Vec4 *vecs, size_t n, nml_t offset) {
+    for (size_t i = 0; i < n; i++) {
+        vec4Init(offset + (nml_t)i, (nml_t)(i % 4) - 1.5, 0.5 * (nml_t)i,
+                 (nml_t)(i % 3), &vecs[i]);
+    }
+}
+
+TEST(Vec3StreamTest, InitFree) {
+    Vec3Stream s;
+    ASSERT_EQ(vec3StreamInit(N, &s), NML_SUCCESS);
+    ASSERT_EQ((int)s.count, N);
+    for (int i = 0; i < N; i++) {
+        ASSERT_DOUBLE_EQ(s.x[i], 0.0);
+        ASSERT_DOUBLE_EQ(s.y[i], 0.0);
+        ASSERT_DOUBLE_EQ(s.z[i], 0.0);
+    }
+    vec3StreamFree(&s);
+    ASSERT_NULL(s.x);
+    ASSERT_EQ((int)s.count, 0);
+    return TEST_PASS;
+}
+
+TEST(Vec3StreamTest, AoSRoundTrip) {
+    Vec3 in[N], out[N];
+    fillVec3(in, N, 1.0);
+
+    Vec3Stream s;
+    vec3StreamInit(N, &s);
+    ASSERT_EQ(vec3StreamFromAoS(in, N, &s), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        ASSERT_DOUBLE_EQ(s.x[i], in[i].x);
+        ASSERT_DOUBLE_EQ(s.y[i], in[i].y);
+        ASSERT_DOUBLE_EQ(s.z[i], in[i].z);
+    }
+
+    ASSERT_EQ(vec3StreamToAoS(&s, out, N), NML_SUCCESS);
+    ASSERT_MEM_EQ(in, out, sizeof(in));
+    vec3StreamFree(&s);
+    return TEST_PASS;
+}
+
+TEST(Vec3StreamTest, AddSubScale) {
+    Vec3 a[N], b[N];
+    fillVec3(a, N, 1.0);
+    fillVec3(b, N, -4.0);
+
+    Vec3Stream sa, sb, out;
+    vec3StreamInit(N, &sa);
+    vec3StreamInit(N, &sb);
+    vec3StreamInit(N, &out);
+    vec3StreamFromAoS(a, N, &sa);
+    vec3StreamFromAoS(b, N, &sb);
+
+    ASSERT_EQ(vec3StreamAdd(&sa, &sb, &out), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Vec3 e;
+        vec3Add(&a[i], &b[i], &e);
+        ASSERT_DOUBLE_EQ(out.x[i], e.x);
+        ASSERT_DOUBLE_EQ(out.y[i], e.y);
+        ASSERT_DOUBLE_EQ(out.z[i], e.z);
+    }
+
+    ASSERT_EQ(vec3StreamSub(&sa, &sb, &out), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Vec3 e;
+        vec3Sub(&a[i], &b[i], &e);
+        ASSERT_DOUBLE_EQ(out.x[i], e.x);
+        ASSERT_DOUBLE_EQ(out.y[i], e.y);
+        ASSERT_DOUBLE_EQ(out.z[i], e.z);
+    }
+
+    // in place
+    ASSERT_EQ(vec3StreamScale(&sa, 2.5, &sa), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Vec3 e;
+        vec3Scale(&a[i], 2.5, &e);
+        ASSERT_DOUBLE_EQ(sa.x[i], e.x);
+        ASSERT_DOUBLE_EQ(sa.y[i], e.y);
+        ASSERT_DOUBLE_EQ(sa.z[i], e.z);
+    }
+
+    vec3StreamFree(&sa);
+    vec3StreamFree(&sb);
+    vec3StreamFree(&out);
+    return TEST_PASS;
+}
+
+TEST(Vec3StreamTest, CrossDotLength) {
+    Vec3 a[N], b[N];
+    fillVec3(a, N, 1.0);
+    fillVec3(b, N, -4.0);
+
+    Vec3Stream sa, sb, out;
+    vec3StreamInit(N, &sa);
+    vec3StreamInit(N, &sb);
+    vec3StreamInit(N, &out);
+    vec3StreamFromAoS(a, N, &sa);
+    vec3StreamFromAoS(b, N, &sb);
+
+    nml_t dots[N], lens[N];
+    ASSERT_EQ(vec3StreamCross(&sa, &sb, &out), NML_SUCCESS);
+    ASSERT_EQ(vec3StreamDot(&sa, &sb, dots), NML_SUCCESS);
+    ASSERT_EQ(vec3StreamLength(&sa, lens), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Vec3 e;
+        vec3Cross(&a[i], &b[i], &e);
+        ASSERT_NEAR(out.x[i], e.x, kEPSILON);
+        ASSERT_NEAR(out.y[i], e.y, kEPSILON);
+        ASSERT_NEAR(out.z[i], e.z, kEPSILON);
+        ASSERT_NEAR(dots[i], vec3Dot(&a[i], &b[i]), kEPSILON);
+        ASSERT_NEAR(lens[i], vec3Length(&a[i]), 1e-5);
+    }
+
+    vec3StreamFree(&sa);
+    vec3StreamFree(&sb);
+    vec3StreamFree(&out);
+    return TEST_PASS;
+}
+
+TEST(Vec3StreamTest, Normalize) {
+    Vec3 a[N];
+    fillVec3(a, N, 1.0);
+
+    Vec3Stream sa, out;
+    vec3StreamInit(N, &sa);
+    vec3StreamInit(N, &out);
+    vec3StreamFromAoS(a, N, &sa);
+
+    ASSERT_EQ(vec3StreamNormalize(&sa, &out), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Vec3 e;
+        vec3Normalize(&a[i], &e);
+        ASSERT_NEAR(out.x[i], e.x, 1e-6);
+        ASSERT_NEAR(out.y[i], e.y, 1e-6);
+        ASSERT_NEAR(out.z[i], e.z, 1e-6);
+    }
+
+    // a zero vector in the vector loop and one in the tail
+    sa.x[2] = sa.y[2] = sa.z[2] = 0.0;
+    sa.x[N - 1] = sa.y[N - 1] = sa.z[N - 1] = 0.0;
+    ASSERT_EQ(vec3StreamNormalize(&sa, &out), NML_EZERODIV);
+    ASSERT_DOUBLE_EQ(out.x[2], 0.0);
+    ASSERT_DOUBLE_EQ(out.z[N - 1], 0.0);
+    ASSERT_NEAR(out.x[3] * out.x[3] + out.y[3] * out.y[3] + out.z[3] * out.z[3],
+                1.0, 1e-5);
+
+    vec3StreamFree(&sa);
+    vec3StreamFree(&out);
+    return TEST_PASS;
+}
+
+TEST(Vec3StreamTest, CountMismatch) {
+    Vec3Stream a, b;
+    vec3StreamInit(4, &a);
+    vec3StreamInit(5, &b);
+    ASSERT_EQ(vec3StreamAdd(&a, &b, &a), NML_EINVAL);
+    ASSERT_EQ(vec3StreamAdd(&a, NULL, &a), NML_ENULLMEM);
+    vec3StreamFree(&a);
+    vec3StreamFree(&b);
+    return TEST_PASS;
+}
+
+TEST(Vec4StreamTest, AoSRoundTrip) {
+    Vec4 in[N], out[N];
+    fillVec4(in, N, 1.0);
+
+    Vec4Stream s;
+    ASSERT_EQ(vec4StreamInit(N, &s), NML_SUCCESS);
+    ASSERT_EQ(vec4StreamFromAoS(in, N, &s), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        ASSERT_DOUBLE_EQ(s.x[i], in[i].x);
+        ASSERT_DOUBLE_EQ(s.y[i], in[i].y);
+        ASSERT_DOUBLE_EQ(s.z[i], in[i].z);
+        ASSERT_DOUBLE_EQ(s.w[i], in[i].w);
+    }
+
+    ASSERT_EQ(vec4StreamToAoS(&s, out, N), NML_SUCCESS);
+    ASSERT_MEM_EQ(in, out, sizeof(in));
+    vec4StreamFree(&s);
+    return TEST_PASS;
+}
+
+TEST(Vec4StreamTest, Arithmetic) {
+    Vec4 a[N], b[N];
+    fillVec4(a, N, 1.0);
+    fillVec4(b, N, -4.0);
+
+    Vec4Stream sa, sb, out;
+    vec4StreamInit(N, &sa);
+    vec4StreamInit(N, &sb);
+    vec4StreamInit(N, &out);
+    vec4StreamFromAoS(a, N, &sa);
+    vec4StreamFromAoS(b, N, &sb);
+
+    nml_t dots[N], lens[N];
+    ASSERT_EQ(vec4StreamAdd(&sa, &sb, &out), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        ASSERT_DOUBLE_EQ(out.w[i], a[i].w + b[i].w);
+    }
+    ASSERT_EQ(vec4StreamSub(&sa, &sb, &out), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        ASSERT_DOUBLE_EQ(out.x[i], a[i].x - b[i].x);
+    }
+    ASSERT_EQ(vec4StreamScale(&sa, -2.0, &out), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        ASSERT_DOUBLE_EQ(out.y[i], a[i].y * -2.0);
+    }
+
+    ASSERT_EQ(vec4StreamCross(&sa, &sb, &out), NML_SUCCESS);
+    ASSERT_EQ(vec4StreamDot(&sa, &sb, dots), NML_SUCCESS);
+    ASSERT_EQ(vec4StreamLength(&sa, lens), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Vec4 e;
+        vec4Cross(&a[i], &b[i], &e);
+        ASSERT_NEAR(out.x[i], e.x, kEPSILON);
+        ASSERT_NEAR(out.y[i], e.y, kEPSILON);
+        ASSERT_NEAR(out.z[i], e.z, kEPSILON);
+        ASSERT_DOUBLE_EQ(out.w[i], 0.0);
+        ASSERT_NEAR(dots[i], vec4Dot(&a[i], &b[i]), kEPSILON);
+        ASSERT_NEAR(lens[i], vec4Length(&a[i]), 1e-5);
+    }
+
+    ASSERT_EQ(vec4StreamNormalize(&sa, &out), NML_SUCCESS);
+    for (int i = 0; i < N; i++) {
+        Vec4 e;
+        vec4Normalize(&a[i], &e);
+        ASSERT_NEAR(out.x[i], e.x, 1e-6);
+        ASSERT_NEAR(out.w[i], e.w, 1e-6);
+    }
+
+    vec4StreamFree(&sa);
+    vec4StreamFree(&sb);
+    vec4StreamFree(&out);
+    return TEST_PASS;
+}
+
+int main(void) {
+    return RUN_ALL_TESTS();
+}